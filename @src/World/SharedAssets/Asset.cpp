@@ -1,59 +1,487 @@
 #include "Asset.h"
+#include "AssetArchive.h"
+#include "AssetBlobStore.h"
+#include "AssetCodec.h"
+#include "AssetLoader.h"
+#include "MeshFormat.h"
+#include "StreamingReadQueue.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <stdexcept>
 
 namespace Aincrad {
 namespace World {
 
-Asset::Asset(const AssetMetadata& metadata)
+Asset::Asset(const AssetMetadata& metadata, AssetHandle handle)
     : m_metadata(metadata)
-    , m_isLoaded(false)
+    , m_handle(handle)
+    , m_state(AssetLoadState::Unloaded)
+    , m_config()
+    , m_payloadVersion(0)
+    , m_qualityLevel(0)
+    , m_partial(false)
+    , m_refining(false)
+    , m_lastUse(0)
+    , m_loadDuration(0)
+    , m_unloadCount(0)
+    , m_updateScheduled(false)
 {
 }
 
 Asset::~Asset() {
-    if (m_isLoaded) {
+    if (m_state.load() != AssetLoadState::Unloaded) {
         unload();
     }
 }
 
-void Asset::load(const AssetLoadingConfig& config) {
-    if (m_isLoaded) {
-        return;
+std::shared_future<void> Asset::load(const AssetLoadingConfig& config, AssetLoader* loader) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Share an in-flight or completed load; failed loads may be retried
+    AssetLoadState state = m_state.load();
+    if (state == AssetLoadState::Loading || state == AssetLoadState::Loaded) {
+        return m_loadFuture;
     }
 
     m_config = config;
+    m_state = AssetLoadState::Loading;
+
+    auto promise = std::make_shared<std::promise<void>>();
+    m_loadFuture = promise->get_future().share();
+    std::shared_future<void> future = m_loadFuture;
+    lock.unlock();
 
     // Load asset based on configuration
-    if (config.asyncLoading) {
-        // Start async loading
-        // TODO: Implement async loading
+    if (config.asyncLoading && loader &&
+        config.strategy != AssetLoadingConfig::LoadingStrategy::Immediate) {
+        // Keep the asset alive until the worker has finished with it
+        auto self = shared_from_this();
+        loader->submit(config.priority, config.strategy, [self, promise, loader]() {
+            self->completeLoad(*promise, loader);
+        });
+    } else {
+        // Load immediately on the calling thread
+        completeLoad(*promise, loader);
+    }
+
+    return future;
+}
+
+void Asset::completeLoad(std::promise<void>& promise, AssetLoader* loader) {
+    auto start = std::chrono::steady_clock::now();
+    std::exception_ptr error;
+    std::shared_ptr<const std::vector<uint8_t>> payload;
+    uint32_t prefixLevel = 0;
+    try {
+        payload = acquirePayload(loader, &prefixLevel);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    // Publish the new state and collect callbacks in one step so whenLoaded
+    // cannot register a callback that would never run
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_loadDuration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        if (!error) {
+            std::atomic_store(&m_payload, payload);
+            ++m_payloadVersion;
+            m_qualityLevel = prefixLevel;
+            m_partial = prefixLevel > 0;
+        }
+        m_state = error ? AssetLoadState::Failed : AssetLoadState::Loaded;
+        callbacks.swap(m_loadCallbacks);
+    }
+
+    if (m_loadObserver) {
+        m_loadObserver(*this, !error);
+    }
+    if (error) {
+        promise.set_exception(error);
     } else {
-        // Load immediately
-        // TODO: Implement immediate loading
+        promise.set_value();
+    }
+
+    for (auto& callback : callbacks) {
+        callback();
+    }
+}
+
+void Asset::whenLoaded(std::function<void()> callback) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        AssetLoadState state = m_state.load();
+        if (state != AssetLoadState::Loaded && state != AssetLoadState::Failed) {
+            m_loadCallbacks.push_back(std::move(callback));
+            return;
+        }
+    }
+
+    callback();
+}
+
+std::shared_ptr<const std::vector<uint8_t>> Asset::acquirePayload(AssetLoader* loader, uint32_t* prefixLevel) const {
+    std::optional<ContentHash> hash;
+    if (m_blobStore && !m_metadata.contentHash.empty()) {
+        hash = ContentHash::fromHex(m_metadata.contentHash);
+    }
+
+    // Another asset already holds these bytes; share them without any I/O
+    if (hash) {
+        if (auto shared = m_blobStore->acquire(*hash)) {
+            return shared;
+        }
+    }
+
+    auto payload = std::make_shared<const std::vector<uint8_t>>(readPayload(loader, prefixLevel));
+    // A prefix is private to this asset until the full payload replaces it
+    if (prefixLevel && *prefixLevel > 0) {
+        return payload;
+    }
+    // Only publish bytes that match their hash, so a stale hash after an edit
+    // costs sharing but never serves the wrong payload
+    if (hash && Sha256::hash(payload->data(), payload->size()) == *hash) {
+        return m_blobStore->publish(*hash, std::move(payload));
+    }
+    return payload;
+}
+
+std::vector<uint8_t> Asset::readPayload(AssetLoader* loader, uint32_t* prefixLevel) const {
+    if (m_metadata.sourcePath.empty()) {
+        return {};
+    }
+    if (!m_metadata.archiveEntry.empty()) {
+        return readArchivePayload(loader);
+    }
+    if (m_config.streaming) {
+        if (auto reader = m_streamingReader.lock()) {
+            return readStreamedPayload(*reader, loader, prefixLevel);
+        }
+    }
+
+    std::ifstream file(m_metadata.sourcePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open asset payload: " + m_metadata.sourcePath);
+    }
+
+    // A size of 0 means the payload runs to the end of the file
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    if (m_metadata.sourceOffset > fileSize) {
+        throw std::runtime_error("Asset payload offset out of range: " + m_metadata.assetId);
+    }
+    uint64_t size = m_metadata.sourceSize ? m_metadata.sourceSize : fileSize - m_metadata.sourceOffset;
+    if (m_metadata.sourceOffset + size > fileSize) {
+        throw std::runtime_error("Asset payload truncated: " + m_metadata.assetId);
     }
 
-    m_isLoaded = true;
+    std::vector<uint8_t> data(size);
+    file.seekg(static_cast<std::streamoff>(m_metadata.sourceOffset));
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size))) {
+        throw std::runtime_error("Failed to read asset payload: " + m_metadata.assetId);
+    }
+    if (isCompressedAsset(data.data(), data.size())) {
+        return decompressPayload(data.data(), data.size(), loader);
+    }
+    return data;
+}
+
+std::vector<uint8_t> Asset::readStreamedPayload(StreamingReadQueue& reader, AssetLoader* loader,
+                                                uint32_t* prefixLevel) const {
+    auto file = std::make_shared<StreamFile>();
+    file->open(m_metadata.sourcePath);
+
+    uint64_t fileSize = file->size();
+    if (m_metadata.sourceOffset > fileSize) {
+        throw std::runtime_error("Asset payload offset out of range: " + m_metadata.assetId);
+    }
+    uint64_t size = m_metadata.sourceSize ? m_metadata.sourceSize : fileSize - m_metadata.sourceOffset;
+    if (m_metadata.sourceOffset + size > fileSize) {
+        throw std::runtime_error("Asset payload truncated: " + m_metadata.assetId);
+    }
+
+    // Chunks land in the staging ring and are copied once, straight into
+    // the payload; compressed payloads then decode from that copy
+    std::vector<uint8_t> data;
+    if (prefixLevel) {
+        // The first chunk holds the mesh's LOD table, or the block table
+        // in front of it; what is read there carries over to a full read
+        data.resize(size_t(std::min<uint64_t>(size, reader.getChunkSize())));
+        reader.readInto(file, m_metadata.sourceOffset, data.size(), data.data());
+        if (auto prefix = readMeshPrefix(reader, file, data, size, *prefixLevel)) {
+            return std::move(*prefix);
+        }
+    }
+    size_t read = data.size();
+    data.resize(size_t(size));
+    reader.readInto(std::move(file), m_metadata.sourceOffset + read, data.size() - read, data.data() + read);
+    if (isCompressedAsset(data.data(), data.size())) {
+        return decompressPayload(data.data(), data.size(), loader);
+    }
+    return data;
+}
+
+std::optional<std::vector<uint8_t>> Asset::readMeshPrefix(StreamingReadQueue& reader,
+                                                         const std::shared_ptr<StreamFile>& file,
+                                                         std::vector<uint8_t>& data, uint64_t size,
+                                                         uint32_t& level) const {
+    // Extends the bytes read so far to length, within the payload
+    auto readTo = [&](uint64_t length) {
+        size_t read = data.size();
+        length = std::min(length, size);
+        if (length > read) {
+            data.resize(size_t(length));
+            try {
+                reader.readInto(file, m_metadata.sourceOffset + read, data.size() - read, data.data() + read);
+            } catch (...) {
+                data.resize(read);
+                throw;
+            }
+        }
+    };
+
+    // Anything that is not a mesh with coarser LODs, or whose tables do not
+    // parse, is read whole instead
+    try {
+        constexpr size_t TableSize = sizeof(MeshFormat::Header) + MeshFormat::MaxLodCount * sizeof(MeshFormat::LodEntry);
+        if (!isCompressedAsset(data.data(), data.size())) {
+            if (!MeshView::isMesh(data.data(), data.size())) {
+                return std::nullopt;
+            }
+            uint32_t lodCount = reinterpret_cast<const MeshFormat::Header*>(data.data())->lodCount;
+            if (lodCount < 2) {
+                return std::nullopt;
+            }
+            size_t required = MeshView::requiredSize(data.data(), data.size(), lodCount - 1);
+            if (required >= size) {
+                return std::nullopt;
+            }
+            readTo(required);
+            data.resize(required);
+            level = lodCount - 1;
+            return std::move(data);
+        }
+
+        // Decode the LOD table from the first blocks, then only as far as
+        // the coarsest LOD. Only the table has been read so far, so the raw
+        // size comes from its blocks rather than compressedAssetRawSize.
+        uint64_t rawSize = 0;
+        for (const CompressedFormat::BlockEntry& block : compressedBlockTable(data.data(), data.size())) {
+            rawSize += block.rawSize;
+        }
+        std::vector<uint8_t> head(size_t(std::min<uint64_t>(TableSize, rawSize)));
+        readTo(compressedPrefixSize(data.data(), data.size(), head.size()));
+        decompressAssetPrefix(data.data(), data.size(), head.data(), head.size());
+        if (!MeshView::isMesh(head.data(), head.size())) {
+            return std::nullopt;
+        }
+        uint32_t lodCount = reinterpret_cast<const MeshFormat::Header*>(head.data())->lodCount;
+        if (lodCount < 2) {
+            return std::nullopt;
+        }
+        size_t required = MeshView::requiredSize(head.data(), head.size(), lodCount - 1);
+        if (required >= rawSize) {
+            return std::nullopt;
+        }
+        // The blocks must be there before their raw size is allocated
+        uint64_t compressedRequired = compressedPrefixSize(data.data(), data.size(), required);
+        readTo(compressedRequired);
+        if (data.size() < compressedRequired) {
+            return std::nullopt;
+        }
+        std::vector<uint8_t> prefix(required);
+        decompressAssetPrefix(data.data(), data.size(), prefix.data(), prefix.size());
+        level = lodCount - 1;
+        return prefix;
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+}
+
+std::vector<uint8_t> Asset::readArchivePayload(AssetLoader* loader) const {
+    // The archive stays mapped across assets; only this entry's pages fault in
+    auto archive = AssetArchive::openShared(m_metadata.sourcePath);
+    auto entry = archive->find(m_metadata.archiveEntry);
+    if (!entry) {
+        throw std::runtime_error("Asset archive entry not found: " + m_metadata.archiveEntry +
+                                 " in " + m_metadata.sourcePath);
+    }
+    if (!entry->verify()) {
+        throw std::runtime_error("Asset archive entry failed checksum: " + m_metadata.archiveEntry);
+    }
+
+    // Compressed entries decode straight from the mapping
+    if (isCompressedAsset(entry->data, entry->size)) {
+        return decompressPayload(entry->data, entry->size, loader);
+    }
+    return std::vector<uint8_t>(entry->data, entry->data + entry->size);
+}
+
+std::vector<uint8_t> Asset::decompressPayload(const uint8_t* data, size_t size, AssetLoader* loader) const {
+    // Each block decodes into its own slice of the one payload allocation.
+    // That allocation is the asset's own, not MemoryManager pool memory:
+    // pool blocks belong to a handle and go with deallocateMemory, while a
+    // payload can outlive it in a blob store share or a reload snapshot.
+    // The blocking thread drains blocks too, so helpers run in the Immediate
+    // band to finish this load before new ones start.
+    std::vector<uint8_t> payload;
+    ParallelFor parallelFor;
+    if (loader) {
+        int priority = m_config.priority;
+        parallelFor = [loader, priority](size_t count, const std::function<void(size_t)>& work) {
+            loader->parallelFor(count, work, priority, AssetLoadingConfig::LoadingStrategy::Immediate);
+        };
+    }
+
+    try {
+        // The raw size is only trusted once the block table checks out
+        // against the bytes actually read
+        payload.resize(compressedAssetRawSize(data, size));
+        decompressAsset(data, size, payload.data(), payload.size(), parallelFor);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error("Failed to decompress asset payload " + m_metadata.assetId + ": " + e.what());
+    }
+    return payload;
+}
+
+bool Asset::reload(AssetLoader* loader) {
+    if (!isLoaded()) {
+        return false;
+    }
+
+    // Read outside the lock; readers keep the old payload until the swap
+    auto start = std::chrono::steady_clock::now();
+    return swapPayload(std::make_shared<const std::vector<uint8_t>>(readPayload(loader)), 0, start);
+}
+
+bool Asset::replacePayload(std::vector<uint8_t> payload, uint32_t qualityLevel) {
+    if (!isLoaded()) {
+        return false;
+    }
+    return swapPayload(std::make_shared<const std::vector<uint8_t>>(std::move(payload)), qualityLevel,
+                       std::chrono::steady_clock::time_point());
+}
+
+bool Asset::restorePayload(AssetLoader* loader) {
+    if (!isLoaded()) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    return swapPayload(acquirePayload(loader), 0, start);
+}
+
+bool Asset::refinePayload(AssetLoader* loader) {
+    if (!m_partial.load() || m_refining.exchange(true)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const std::vector<uint8_t>> payload;
+    try {
+        payload = acquirePayload(loader);
+    } catch (...) {
+        m_refining = false;
+        throw;
+    }
+    m_refining = false;
+    return swapPayload(std::move(payload), 0, start, true);
+}
+
+bool Asset::swapPayload(std::shared_ptr<const std::vector<uint8_t>> payload, uint32_t qualityLevel,
+                        std::chrono::steady_clock::time_point start, bool onlyIfPartial) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state.load() != AssetLoadState::Loaded) {
+        return false; // Unloaded while we were reading
+    }
+    if (onlyIfPartial && !m_partial.load()) {
+        return false; // Another swap got there first
+    }
+    std::atomic_store(&m_payload, std::move(payload));
+    ++m_payloadVersion;
+    m_qualityLevel = qualityLevel;
+    m_partial = false;
+    // Only full reads count as load time; trimming is not a reload cost
+    if (start != std::chrono::steady_clock::time_point()) {
+        m_loadDuration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    }
+    return true;
+}
+
+void Asset::markUsed(uint64_t stamp) {
+    // Concurrent hits may land out of order; the newest stamp wins
+    uint64_t last = m_lastUse.load(std::memory_order_relaxed);
+    while (last < stamp && !m_lastUse.compare_exchange_weak(last, stamp, std::memory_order_relaxed)) {
+    }
 }
 
 void Asset::unload() {
-    if (!m_isLoaded) {
-        return;
+    std::shared_future<void> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_state.load() == AssetLoadState::Unloaded) {
+            return;
+        }
+        pending = m_loadFuture;
+    }
+
+    // Let an in-flight load settle before tearing down its payload
+    if (m_state.load() == AssetLoadState::Loading && pending.valid()) {
+        pending.wait();
     }
 
     // Unload asset
-    // TODO: Implement unloading
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::atomic_store(&m_payload, std::shared_ptr<const std::vector<uint8_t>>());
+    m_loadFuture = std::shared_future<void>();
+    m_qualityLevel = 0;
+    m_partial = false;
+    m_loadCallbacks.clear();
+    m_updateTasks.clear();
+    ++m_unloadCount;
+    m_state = AssetLoadState::Unloaded;
+}
+
+bool Asset::update() {
+    // Cleared first: a request made while the tasks run schedules another update
+    m_updateScheduled = false;
 
-    m_isLoaded = false;
+    std::vector<AssetUpdateTask> tasks;
+    uint64_t unloadCount;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        tasks.swap(m_updateTasks);
+        unloadCount = m_unloadCount;
+    }
+
+    // Tasks run unlocked so they may use the asset, including adding tasks
+    auto finished = std::remove_if(tasks.begin(), tasks.end(), [](AssetUpdateTask& task) { return !task(); });
+    tasks.erase(finished, tasks.end());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_unloadCount != unloadCount) {
+        tasks.clear();
+    }
+    m_updateTasks.insert(m_updateTasks.begin(), std::make_move_iterator(tasks.begin()),
+                         std::make_move_iterator(tasks.end()));
+    return !m_updateTasks.empty();
 }
 
-void Asset::update() {
-    if (!m_isLoaded) {
-        return;
+void Asset::addUpdateTask(AssetUpdateTask task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_updateTasks.push_back(std::move(task));
     }
+    requestUpdates();
+}
 
-    // Update asset state
-    // TODO: Implement update logic
+void Asset::requestUpdates() {
+    if (m_updateScheduler && !m_updateScheduled.exchange(true)) {
+        m_updateScheduler(shared_from_this());
+    }
 }
 
 } // namespace World
-} // namespace Aincrad 
\ No newline at end of file
+} // namespace Aincrad
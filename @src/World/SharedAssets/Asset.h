@@ -1,12 +1,25 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 #include <memory>
+#include "AssetHandle.h"
 
 namespace Aincrad {
 namespace World {
 
+class AssetBlobStore;
+class AssetLoader;
+class StreamFile;
+class StreamingReadQueue;
+
 struct AssetMetadata {
     std::string assetId;
     std::string assetType;
@@ -15,6 +28,18 @@ struct AssetMetadata {
     std::string version;
     std::string permissions;
     std::string usage;
+
+    // Payload location; an empty path means the asset has no payload on disk.
+    // With archiveEntry set, sourcePath is a packed archive and the payload
+    // is that entry; offset and size are then ignored.
+    std::string sourcePath;
+    std::string archiveEntry;
+    uint64_t sourceOffset = 0;
+    uint64_t sourceSize = 0;
+
+    // Hex SHA-256 of the decoded payload; assets with the same hash share one
+    // resident copy. Empty when unknown.
+    std::string contentHash;
 };
 
 struct AssetLoadingConfig {
@@ -31,28 +56,140 @@ struct AssetLoadingConfig {
         bool shaderCompilation;
         bool textureCompression;
         bool memoryManagement;
+        uint32_t audioSampleRate; // Imported audio is resampled to this
     } platformSettings;
 };
 
-class Asset {
+enum class AssetLoadState {
+    Unloaded,
+    Loading,
+    Loaded,
+    Failed
+};
+
+class Asset;
+
+// Sees every settled load attempt, before waiters and whenLoaded callbacks
+using AssetLoadObserver = std::function<void(const Asset& asset, bool succeeded)>;
+// Puts an asset on its owner's list of assets to update next frame
+using AssetUpdateScheduler = std::function<void(std::shared_ptr<Asset> asset)>;
+// Per-frame work such as a fade or incremental decode; return false when done
+using AssetUpdateTask = std::function<bool()>;
+
+class Asset : public std::enable_shared_from_this<Asset> {
 public:
-    Asset(const AssetMetadata& metadata);
+    Asset(const AssetMetadata& metadata, AssetHandle handle = AssetHandle());
     ~Asset();
 
     // Asset lifecycle
-    void load(const AssetLoadingConfig& config);
+    // Asynchronous loads are queued on the loader unless the strategy is
+    // Immediate; the asset must then be owned by a shared_ptr. Repeated calls
+    // while a load is in flight return the same future. Streamed loads of a
+    // mesh with LODs read through the streaming reader settle as soon as
+    // the coarsest LOD is in: the payload is the prefix that holds it, at
+    // the quality level of the LODs it leaves out, and isPartial() is true
+    // until refinePayload() reads the rest.
+    std::shared_future<void> load(const AssetLoadingConfig& config, AssetLoader* loader = nullptr);
     void unload();
-    void update();
+
+    // Runs the pending update tasks once. Returns true while tasks remain;
+    // the owner only updates assets that asked for it, so idle assets cost
+    // nothing per frame.
+    bool update();
+    // Adds per-frame work and schedules the asset for updates. Safe from any
+    // thread; tasks are dropped on unload.
+    void addUpdateTask(AssetUpdateTask task);
+    void requestUpdates();
+
+    // Re-reads the payload of a loaded asset and swaps it in atomically, so
+    // holders of this Asset see either the old or the new payload, never a
+    // mix. Returns false if the asset is not loaded. Throws if the new
+    // payload cannot be read, keeping the old one. Compressed payloads
+    // decode across the loader's workers when one is given. The new payload
+    // is private to this asset, since its file no longer matches the hash.
+    bool reload(AssetLoader* loader = nullptr);
+
+    // Quality steps under memory pressure. replacePayload swaps in a reduced
+    // copy of the payload, such as a texture without its top mips, the same
+    // way reload swaps; qualityLevel is how many steps it sits below full
+    // quality. restorePayload reads the full payload back in at level 0,
+    // sharing it again when its hash still matches. Both return false if
+    // the asset is not loaded.
+    bool replacePayload(std::vector<uint8_t> payload, uint32_t qualityLevel);
+    bool restorePayload(AssetLoader* loader = nullptr);
+
+    // Swaps a coarse-first load's prefix for the full payload. Returns false
+    // if the asset is not partial, is already being refined, or was stepped,
+    // reloaded or unloaded while the payload was read. Throws if the payload
+    // cannot be read, keeping the prefix.
+    bool refinePayload(AssetLoader* loader = nullptr);
+
+    // Run a callback once the current or next load settles (loaded or failed).
+    // Runs immediately if the asset has already settled. Pending callbacks
+    // are dropped on unload.
+    void whenLoaded(std::function<void()> callback);
+
+    // Must be set before the asset is shared or loaded
+    void setLoadObserver(AssetLoadObserver observer) { m_loadObserver = std::move(observer); }
+    void setUpdateScheduler(AssetUpdateScheduler scheduler) { m_updateScheduler = std::move(scheduler); }
+    void setBlobStore(std::shared_ptr<AssetBlobStore> blobStore) { m_blobStore = std::move(blobStore); }
+    // Streamed loads of loose payload files read through this ring while it
+    // lives, instead of through a stream of their own
+    void setStreamingReader(std::weak_ptr<StreamingReadQueue> reader) { m_streamingReader = std::move(reader); }
+    // Lock-free use stamp from MemoryManager::nextUseStamp; keeps the newest
+    void markUsed(uint64_t stamp);
 
     // Getters
     const AssetMetadata& getMetadata() const { return m_metadata; }
-    bool isLoaded() const { return m_isLoaded; }
+    AssetHandle getHandle() const { return m_handle; }
+    bool isLoaded() const { return m_state.load() == AssetLoadState::Loaded; }
+    AssetLoadState getLoadState() const { return m_state.load(); }
+    // Snapshot of the payload, null while not loaded. Reloads, quality steps
+    // and refinement swap in a new payload on other threads; holding the
+    // snapshot keeps the bytes it points at alive.
+    std::shared_ptr<const std::vector<uint8_t>> getPayload() const { return std::atomic_load(&m_payload); }
+    uint32_t getPayloadVersion() const { return m_payloadVersion.load(); }
+    uint32_t getQualityLevel() const { return m_qualityLevel.load(); }
+    bool isPartial() const { return m_partial.load(); }
+    uint64_t getLastUse() const { return m_lastUse.load(std::memory_order_relaxed); }
+    std::chrono::microseconds getLoadDuration() const { return m_loadDuration; }
 
 private:
+    void completeLoad(std::promise<void>& promise, AssetLoader* loader);
+    // With prefixLevel set, a streamed mesh may come back as its coarse
+    // prefix, with prefixLevel the number of LODs it leaves out
+    std::shared_ptr<const std::vector<uint8_t>> acquirePayload(AssetLoader* loader, uint32_t* prefixLevel = nullptr) const;
+    std::vector<uint8_t> readPayload(AssetLoader* loader, uint32_t* prefixLevel = nullptr) const;
+    std::vector<uint8_t> readArchivePayload(AssetLoader* loader) const;
+    std::vector<uint8_t> readStreamedPayload(StreamingReadQueue& reader, AssetLoader* loader, uint32_t* prefixLevel) const;
+    std::optional<std::vector<uint8_t>> readMeshPrefix(StreamingReadQueue& reader, const std::shared_ptr<StreamFile>& file,
+                                                       std::vector<uint8_t>& data, uint64_t size, uint32_t& level) const;
+    std::vector<uint8_t> decompressPayload(const uint8_t* data, size_t size, AssetLoader* loader) const;
+    bool swapPayload(std::shared_ptr<const std::vector<uint8_t>> payload, uint32_t qualityLevel,
+                     std::chrono::steady_clock::time_point start, bool onlyIfPartial = false);
+
     AssetMetadata m_metadata;
-    bool m_isLoaded;
+    AssetHandle m_handle;
+    std::atomic<AssetLoadState> m_state;
     AssetLoadingConfig m_config;
+    std::shared_ptr<const std::vector<uint8_t>> m_payload; // Accessed with std::atomic_load/store
+    std::atomic<uint32_t> m_payloadVersion;
+    std::atomic<uint32_t> m_qualityLevel;
+    std::atomic<bool> m_partial;  // Payload is a coarse-first prefix
+    std::atomic<bool> m_refining;
+    std::atomic<uint64_t> m_lastUse;
+    std::shared_future<void> m_loadFuture;
+    std::vector<std::function<void()>> m_loadCallbacks;
+    std::chrono::microseconds m_loadDuration;
+    AssetLoadObserver m_loadObserver;
+    AssetUpdateScheduler m_updateScheduler;
+    std::shared_ptr<AssetBlobStore> m_blobStore;
+    std::weak_ptr<StreamingReadQueue> m_streamingReader;
+    std::vector<AssetUpdateTask> m_updateTasks;
+    uint64_t m_unloadCount; // Lets update() drop tasks that were running across an unload
+    std::atomic<bool> m_updateScheduled;
+    std::mutex m_mutex;
 };
 
 } // namespace World
-} // namespace Aincrad 
\ No newline at end of file
+} // namespace Aincrad
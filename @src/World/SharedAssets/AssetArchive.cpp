@@ -0,0 +1,306 @@
+#include "AssetArchive.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace Aincrad {
+namespace World {
+
+using namespace ArchiveFormat;
+
+namespace {
+
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+// Slicing-by-8 tables: table k advances a byte through k further zero bytes
+CrcTables makeCrcTables() {
+    CrcTables tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t k = 1; k < tables.size(); ++k) {
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+uint64_t alignUp(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+std::mutex g_sharedMutex;
+std::unordered_map<std::string, std::shared_ptr<const AssetArchive>> g_sharedArchives;
+
+} // namespace
+
+uint32_t ArchiveFormat::crc32(const uint8_t* data, size_t size, uint32_t crc) {
+    static const CrcTables tables = makeCrcTables();
+    crc = ~crc;
+
+    // Eight bytes per step; the format is little-endian like its hosts
+    for (; size >= 8; data += 8, size -= 8) {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, data, 4);
+        std::memcpy(&high, data + 4, 4);
+        low ^= crc;
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^
+              tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+              tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^
+              tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+    }
+    for (; size > 0; ++data, --size) {
+        crc = tables[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+AssetArchive::AssetArchive()
+    : m_header(nullptr)
+    , m_toc(nullptr)
+{
+}
+
+AssetArchive::~AssetArchive() {
+}
+
+void AssetArchive::open(const std::string& path) {
+    MappedFile file;
+    file.open(path);
+
+    // Validate the header and table of contents; payloads stay untouched
+    if (file.size() < sizeof(Header)) {
+        throw std::runtime_error("Asset archive too small: " + path);
+    }
+    const auto* header = reinterpret_cast<const Header*>(file.data());
+    if (header->magic != Magic || header->version != Version) {
+        throw std::runtime_error("Unsupported asset archive format: " + path);
+    }
+
+    const uint64_t size = file.size();
+    auto fits = [size](uint64_t offset, uint64_t bytes) {
+        return offset <= size && bytes <= size - offset;
+    };
+    if (!fits(header->tocOffset, uint64_t(header->entryCount) * sizeof(TocEntry)) ||
+        !fits(header->namesOffset, header->namesSize) ||
+        header->tocOffset % alignof(TocEntry) != 0) {
+        throw std::runtime_error("Corrupt asset archive: " + path);
+    }
+
+    const auto* toc = reinterpret_cast<const TocEntry*>(file.data() + header->tocOffset);
+    for (uint32_t i = 0; i < header->entryCount; ++i) {
+        if (!fits(toc[i].offset, toc[i].size) ||
+            uint64_t(toc[i].nameOffset) + toc[i].nameLength > header->namesSize) {
+            throw std::runtime_error("Corrupt asset archive: " + path);
+        }
+    }
+
+    m_file = std::move(file);
+    m_header = header;
+    m_toc = toc;
+}
+
+std::optional<AssetArchiveEntry> AssetArchive::find(std::string_view entryName) const {
+    if (!m_header) {
+        return std::nullopt;
+    }
+
+    const TocEntry* end = m_toc + m_header->entryCount;
+    const TocEntry* it = std::lower_bound(m_toc, end, entryName,
+        [this](const TocEntry& entry, std::string_view key) { return name(entry) < key; });
+    if (it == end || name(*it) != entryName) {
+        return std::nullopt;
+    }
+    return entry(size_t(it - m_toc));
+}
+
+AssetArchiveEntry AssetArchive::entry(size_t index) const {
+    if (!m_header || index >= m_header->entryCount) {
+        throw std::out_of_range("Asset archive entry out of range");
+    }
+
+    const TocEntry& toc = m_toc[index];
+    AssetArchiveEntry entry;
+    entry.name = name(toc);
+    entry.data = m_file.data() + toc.offset;
+    entry.size = toc.size;
+    entry.checksum = toc.checksum;
+    return entry;
+}
+
+std::string_view AssetArchive::name(const TocEntry& entry) const {
+    const char* names = reinterpret_cast<const char*>(m_file.data() + m_header->namesOffset);
+    return std::string_view(names + entry.nameOffset, entry.nameLength);
+}
+
+std::shared_ptr<const AssetArchive> AssetArchive::openShared(const std::string& path) {
+    std::lock_guard<std::mutex> lock(g_sharedMutex);
+    auto it = g_sharedArchives.find(path);
+    if (it != g_sharedArchives.end()) {
+        return it->second;
+    }
+
+    auto archive = std::make_shared<AssetArchive>();
+    archive->open(path);
+    g_sharedArchives.emplace(path, archive);
+    return archive;
+}
+
+void AssetArchive::releaseShared() {
+    std::lock_guard<std::mutex> lock(g_sharedMutex);
+    g_sharedArchives.clear();
+}
+
+void AssetArchive::releaseShared(const std::string& path) {
+    std::lock_guard<std::mutex> lock(g_sharedMutex);
+    g_sharedArchives.erase(path);
+}
+
+AssetArchiveWriter::AssetArchiveWriter(uint32_t alignment)
+    : m_alignment(alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("Archive alignment must be a power of two");
+    }
+}
+
+void AssetArchiveWriter::addFile(const std::string& name, const std::string& sourcePath) {
+    m_entries.push_back({name, sourcePath, {}});
+}
+
+void AssetArchiveWriter::addData(const std::string& name, std::vector<uint8_t> data) {
+    m_entries.push_back({name, std::string(), std::move(data)});
+}
+
+ContentHash AssetArchiveWriter::contentHash(const PendingEntry& entry, std::vector<char>& buffer) {
+    if (entry.sourcePath.empty()) {
+        return Sha256::hash(entry.data.data(), entry.data.size());
+    }
+
+    std::ifstream source(entry.sourcePath, std::ios::binary);
+    if (!source.is_open()) {
+        throw std::runtime_error("Failed to open archive input: " + entry.sourcePath);
+    }
+    Sha256 sha;
+    while (source) {
+        source.read(buffer.data(), std::streamsize(buffer.size()));
+        std::streamsize read = source.gcount();
+        if (read <= 0) {
+            break;
+        }
+        sha.update(reinterpret_cast<const uint8_t*>(buffer.data()), size_t(read));
+    }
+    return sha.finish();
+}
+
+void AssetArchiveWriter::write(const std::string& path) const {
+    std::vector<const PendingEntry*> sorted;
+    sorted.reserve(m_entries.size());
+    for (const auto& entry : m_entries) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const PendingEntry* a, const PendingEntry* b) {
+        return a->name < b->name;
+    });
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        if (sorted[i]->name == sorted[i - 1]->name) {
+            throw std::runtime_error("Duplicate archive entry: " + sorted[i]->name);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create asset archive: " + path);
+    }
+
+    // Reserve the header; it is rewritten once the offsets are known
+    Header header{};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t offset = sizeof(header);
+
+    const std::vector<char> padding(m_alignment, 0);
+    auto padTo = [&](uint64_t target) {
+        file.write(padding.data(), std::streamsize(target - offset));
+        offset = target;
+    };
+
+    std::vector<TocEntry> toc;
+    std::string names;
+    toc.reserve(sorted.size());
+    std::vector<char> buffer(1024 * 1024);
+    std::unordered_map<ContentHash, size_t, ContentHashHasher> stored; // First TOC entry per payload
+    for (const PendingEntry* pending : sorted) {
+        TocEntry entry{};
+        entry.nameOffset = uint32_t(names.size());
+        entry.nameLength = uint32_t(pending->name.size());
+        names += pending->name;
+
+        // Identical payloads are stored once; later entries alias the first
+        ContentHash hash = contentHash(*pending, buffer);
+        auto [first, inserted] = stored.emplace(hash, toc.size());
+        if (!inserted) {
+            const TocEntry& original = toc[first->second];
+            entry.offset = original.offset;
+            entry.size = original.size;
+            entry.checksum = original.checksum;
+            toc.push_back(entry);
+            continue;
+        }
+
+        padTo(alignUp(offset, m_alignment));
+        entry.offset = offset;
+        if (pending->sourcePath.empty()) {
+            entry.size = pending->data.size();
+            entry.checksum = crc32(pending->data.data(), pending->data.size());
+            file.write(reinterpret_cast<const char*>(pending->data.data()), std::streamsize(pending->data.size()));
+        } else {
+            // Stream large sources through a fixed buffer, checksumming as we go
+            std::ifstream source(pending->sourcePath, std::ios::binary);
+            if (!source.is_open()) {
+                throw std::runtime_error("Failed to open archive input: " + pending->sourcePath);
+            }
+            while (source) {
+                source.read(buffer.data(), std::streamsize(buffer.size()));
+                std::streamsize read = source.gcount();
+                if (read <= 0) {
+                    break;
+                }
+                entry.checksum = crc32(reinterpret_cast<const uint8_t*>(buffer.data()), size_t(read), entry.checksum);
+                file.write(buffer.data(), read);
+                entry.size += uint64_t(read);
+            }
+        }
+        offset += entry.size;
+        toc.push_back(entry);
+    }
+
+    padTo(alignUp(offset, alignof(TocEntry)));
+    header.magic = Magic;
+    header.version = Version;
+    header.entryCount = uint32_t(toc.size());
+    header.alignment = m_alignment;
+    header.tocOffset = offset;
+    header.namesOffset = offset + toc.size() * sizeof(TocEntry);
+    header.namesSize = names.size();
+
+    file.write(reinterpret_cast<const char*>(toc.data()), std::streamsize(toc.size() * sizeof(TocEntry)));
+    file.write(names.data(), std::streamsize(names.size()));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!file) {
+        throw std::runtime_error("Failed to write asset archive: " + path);
+    }
+}
+
+} // namespace World
+} // namespace Aincrad
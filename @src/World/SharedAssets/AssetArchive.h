@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ContentHash.h"
+#include "MappedFile.h"
+
+namespace Aincrad {
+namespace World {
+
+// On-disk layout of a packed asset archive (little-endian):
+//   Header | entry payloads, each aligned | TocEntry[entryCount] | names
+// The table of contents is sorted by name, so lookups are a binary search
+// over the mapping. Payloads start on alignment boundaries so each entry
+// pages in on its own. Entries with identical bytes may point at the same
+// payload. All offsets are from the start of the file.
+namespace ArchiveFormat {
+
+constexpr uint32_t Magic = 0x4B504941; // "AIPK"
+constexpr uint32_t Version = 1;
+constexpr uint32_t DefaultAlignment = 4096;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t alignment;
+    uint64_t tocOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+struct TocEntry {
+    uint32_t nameOffset; // Into the names block
+    uint32_t nameLength;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t checksum;   // CRC-32 of the payload
+    uint32_t reserved;
+};
+
+// CRC-32 (IEEE); pass the previous result to continue a running checksum
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+} // namespace ArchiveFormat
+
+// Zero-copy view of one archive entry; valid while the archive is open
+struct AssetArchiveEntry {
+    std::string_view name;
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+    uint32_t checksum = 0;
+
+    bool verify() const { return ArchiveFormat::crc32(data, size_t(size)) == checksum; }
+};
+
+// Read side: maps an archive once and serves entries in place. Payload
+// pages are faulted in only when an entry is actually read.
+class AssetArchive {
+public:
+    AssetArchive();
+    ~AssetArchive();
+
+    // Maps the file and validates the header and table of contents. Throws
+    // std::runtime_error on a missing or malformed archive.
+    void open(const std::string& path);
+
+    std::optional<AssetArchiveEntry> find(std::string_view name) const;
+
+    // Getters
+    size_t size() const { return m_header ? m_header->entryCount : 0; }
+    AssetArchiveEntry entry(size_t index) const;
+    const std::string& path() const { return m_file.path(); }
+
+    // Process-wide cache so every asset in an archive shares one mapping
+    static std::shared_ptr<const AssetArchive> openShared(const std::string& path);
+    static void releaseShared();
+    // Drops one cached mapping, e.g. after the archive was rewritten; current
+    // holders keep the old mapping until they let go
+    static void releaseShared(const std::string& path);
+
+private:
+    std::string_view name(const ArchiveFormat::TocEntry& entry) const;
+
+    MappedFile m_file;
+    const ArchiveFormat::Header* m_header;
+    const ArchiveFormat::TocEntry* m_toc;
+};
+
+// Write side: used by the aincrad-asset tool to pack files into an archive
+class AssetArchiveWriter {
+public:
+    explicit AssetArchiveWriter(uint32_t alignment = ArchiveFormat::DefaultAlignment);
+
+    // Entry names must be unique; duplicates throw when writing. Entries with
+    // identical bytes share one stored payload, found by SHA-256.
+    void addFile(const std::string& name, const std::string& sourcePath);
+    void addData(const std::string& name, std::vector<uint8_t> data);
+    void write(const std::string& path) const;
+
+private:
+    struct PendingEntry {
+        std::string name;
+        std::string sourcePath; // Streamed at write time when set
+        std::vector<uint8_t> data;
+    };
+
+    static ContentHash contentHash(const PendingEntry& entry, std::vector<char>& buffer);
+
+    uint32_t m_alignment;
+    std::vector<PendingEntry> m_entries;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,76 @@
+#include "AssetBlobStore.h"
+#include <algorithm>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+constexpr size_t MinPruneThreshold = 64;
+
+} // namespace
+
+AssetBlobStore::AssetBlobStore()
+    : m_pruneThreshold(MinPruneThreshold)
+    , m_sharedLoads(0)
+    , m_sharedBytes(0)
+{
+}
+
+AssetBlobStore::~AssetBlobStore() {
+}
+
+AssetBlobStore::Payload AssetBlobStore::acquire(const ContentHash& hash) {
+    Payload payload;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_blobs.find(hash);
+        if (it == m_blobs.end()) {
+            return nullptr;
+        }
+        payload = it->second.lock();
+        if (!payload) {
+            m_blobs.erase(it);
+            return nullptr;
+        }
+    }
+
+    m_sharedLoads.fetch_add(1, std::memory_order_relaxed);
+    m_sharedBytes.fetch_add(payload->size(), std::memory_order_relaxed);
+    return payload;
+}
+
+AssetBlobStore::Payload AssetBlobStore::publish(const ContentHash& hash, Payload payload) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& blob = m_blobs[hash];
+    if (Payload existing = blob.lock()) {
+        m_sharedLoads.fetch_add(1, std::memory_order_relaxed);
+        m_sharedBytes.fetch_add(existing->size(), std::memory_order_relaxed);
+        return existing;
+    }
+    blob = payload;
+
+    // Released blobs leave expired entries behind; sweep them whenever the
+    // table doubles so the cost stays amortized constant per publish
+    if (m_blobs.size() >= m_pruneThreshold) {
+        pruneExpired();
+        m_pruneThreshold = std::max(MinPruneThreshold, m_blobs.size() * 2);
+    }
+    return payload;
+}
+
+void AssetBlobStore::pruneExpired() {
+    for (auto it = m_blobs.begin(); it != m_blobs.end();) {
+        it = it->second.expired() ? m_blobs.erase(it) : std::next(it);
+    }
+}
+
+AssetBlobStats AssetBlobStore::getStats() const {
+    AssetBlobStats stats;
+    stats.sharedLoads = m_sharedLoads.load(std::memory_order_relaxed);
+    stats.sharedBytes = m_sharedBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ContentHash.h"
+
+namespace Aincrad {
+namespace World {
+
+struct AssetBlobStats {
+    uint64_t sharedLoads = 0; // Loads served by a payload another asset already held
+    uint64_t sharedBytes = 0; // Bytes those loads did not read or store again
+};
+
+// In-memory content-addressed payload store. Assets whose metadata carries a
+// content hash share one resident copy of identical payload bytes, whatever
+// their ID, platform or version. The store only holds weak references: a
+// blob lives exactly as long as some asset holds its payload, so shared
+// payloads are reference counted by the assets themselves.
+class AssetBlobStore {
+public:
+    using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+
+    AssetBlobStore();
+    ~AssetBlobStore();
+
+    // The resident payload with this hash, or null if no asset holds one
+    Payload acquire(const ContentHash& hash);
+    // Registers a freshly read payload and returns the copy to keep. If
+    // another load of the same hash won the race, that copy is returned and
+    // the new one can be dropped.
+    Payload publish(const ContentHash& hash, Payload payload);
+
+    // Getters; lock-free
+    AssetBlobStats getStats() const;
+
+private:
+    void pruneExpired();
+
+    std::unordered_map<ContentHash, std::weak_ptr<const std::vector<uint8_t>>, ContentHashHasher> m_blobs;
+    size_t m_pruneThreshold;
+    std::atomic<uint64_t> m_sharedLoads;
+    std::atomic<uint64_t> m_sharedBytes;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace World
+} // namespace Aincrad
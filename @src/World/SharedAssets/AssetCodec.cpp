@@ -0,0 +1,372 @@
+#include "AssetCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Aincrad {
+namespace World {
+
+using namespace CompressedFormat;
+
+namespace {
+
+constexpr size_t MinMatch = 4;
+constexpr size_t LastLiterals = 5;   // The block always ends in a few literals
+constexpr size_t MatchSearchEnd = 12; // No match starts this close to the end
+constexpr size_t MaxOffset = 65535;
+constexpr int HashBits = 14;
+constexpr uint8_t RunMask = 15;
+// A token, two offset bytes and length bytes of 255 decode to fewer than
+// 256 bytes each, so no block decodes to more than this many times its size
+constexpr uint64_t MaxExpansion = 256;
+
+uint32_t read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HashBits);
+}
+
+// Lengths of 15 and up spill into bytes of 255 plus a final remainder
+uint8_t* writeLength(uint8_t* output, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *output++ = 255;
+    }
+    *output++ = uint8_t(length);
+    return output;
+}
+
+size_t readLength(const uint8_t*& input, const uint8_t* end) {
+    size_t length = 0;
+    uint8_t byte;
+    do {
+        if (input >= end) {
+            throw std::runtime_error("Compressed block truncated");
+        }
+        byte = *input++;
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+uint8_t* writeSequence(uint8_t* output, const uint8_t* literals, size_t literalLength,
+                       size_t offset, size_t matchLength) {
+    uint8_t* token = output++;
+    if (literalLength >= RunMask) {
+        *token = RunMask << 4;
+        output = writeLength(output, literalLength - RunMask);
+    } else {
+        *token = uint8_t(literalLength << 4);
+    }
+    std::memcpy(output, literals, literalLength);
+    output += literalLength;
+
+    // The final sequence carries literals only
+    if (matchLength == 0) {
+        return output;
+    }
+    *output++ = uint8_t(offset);
+    *output++ = uint8_t(offset >> 8);
+    size_t extra = matchLength - MinMatch;
+    if (extra >= RunMask) {
+        *token |= RunMask;
+        output = writeLength(output, extra - RunMask);
+    } else {
+        *token |= uint8_t(extra);
+    }
+    return output;
+}
+
+Header readHeader(const uint8_t* data, size_t size) {
+    if (!isCompressedAsset(data, size)) {
+        throw std::runtime_error("Not a compressed asset payload");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    return header;
+}
+
+// Rounds up without wrapping for sizes near UINT64_MAX
+uint64_t blocksFor(uint64_t bytes, uint32_t blockSize) {
+    return bytes / blockSize + (bytes % blockSize != 0);
+}
+
+// Checks the header against the table and the first count entries against
+// the payload; with requireData false only the table itself must be present.
+// Blocks follow the table in order without overlapping, and none claims to
+// expand past MaxExpansion, so raw sizes stay bounded by the bytes read.
+std::vector<BlockEntry> readBlockTable(const uint8_t* data, size_t size, const Header& header, uint32_t count,
+                                       bool requireData) {
+    if (header.blockSize == 0 || header.blockSize > MaxBlockSize ||
+        header.blockCount != blocksFor(header.rawSize, header.blockSize) ||
+        (size - sizeof(Header)) / sizeof(BlockEntry) < header.blockCount) {
+        throw std::runtime_error("Corrupt compressed asset header");
+    }
+
+    std::vector<BlockEntry> blocks(count);
+    if (!blocks.empty()) {
+        std::memcpy(blocks.data(), data + sizeof(Header), blocks.size() * sizeof(BlockEntry));
+    }
+    uint64_t end = sizeof(Header) + uint64_t(header.blockCount) * sizeof(BlockEntry);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t rawSize = std::min<uint64_t>(header.blockSize, header.rawSize - uint64_t(i) * header.blockSize);
+        const BlockEntry& block = blocks[i];
+        if (block.rawSize != rawSize || block.compressedSize > block.rawSize ||
+            block.rawSize > block.compressedSize * MaxExpansion || block.offset < end ||
+            block.offset > UINT64_MAX - block.compressedSize ||
+            (requireData && (block.offset > size || block.compressedSize > size - block.offset))) {
+            throw std::runtime_error("Corrupt compressed asset block table");
+        }
+        end = block.offset + block.compressedSize;
+    }
+    return blocks;
+}
+
+uint32_t blocksForPrefix(const Header& header, uint64_t rawPrefix) {
+    if (rawPrefix > header.rawSize) {
+        throw std::runtime_error("Compressed asset prefix is past the end of the payload");
+    }
+    return header.blockSize ? uint32_t(blocksFor(rawPrefix, header.blockSize)) : 0;
+}
+
+} // namespace
+
+size_t LzCodec::compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t LzCodec::compress(const uint8_t* input, size_t size, uint8_t* output) {
+    uint8_t* op = output;
+    size_t anchor = 0;
+
+    if (size >= MatchSearchEnd) {
+        std::vector<int32_t> table(size_t(1) << HashBits, -1);
+        const size_t searchEnd = size - MatchSearchEnd;
+        const size_t matchEnd = size - LastLiterals;
+
+        size_t ip = 0;
+        while (ip <= searchEnd) {
+            uint32_t sequence = read32(input + ip);
+            uint32_t slot = hashSequence(sequence);
+            int32_t candidate = table[slot];
+            table[slot] = int32_t(ip);
+
+            if (candidate < 0 || ip - size_t(candidate) > MaxOffset || read32(input + candidate) != sequence) {
+                // Skip faster through data that keeps failing to match
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t match = size_t(candidate);
+            size_t length = MinMatch;
+            while (ip + length < matchEnd && input[match + length] == input[ip + length]) {
+                ++length;
+            }
+            while (ip > anchor && match > 0 && input[ip - 1] == input[match - 1]) {
+                --ip;
+                --match;
+                ++length;
+            }
+
+            op = writeSequence(op, input + anchor, ip - anchor, ip - match, length);
+            ip += length;
+            anchor = ip;
+            if (ip <= searchEnd) {
+                table[hashSequence(read32(input + ip - 2))] = int32_t(ip - 2);
+            }
+        }
+    }
+
+    op = writeSequence(op, input + anchor, size - anchor, 0, 0);
+    return size_t(op - output);
+}
+
+void LzCodec::decompress(const uint8_t* input, size_t size, uint8_t* output, size_t outputSize) {
+    const uint8_t* ip = input;
+    const uint8_t* const inputEnd = input + size;
+    uint8_t* op = output;
+    uint8_t* const outputEnd = output + outputSize;
+
+    for (;;) {
+        if (ip >= inputEnd) {
+            throw std::runtime_error("Compressed block truncated");
+        }
+        uint8_t token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == RunMask) {
+            literalLength += readLength(ip, inputEnd);
+        }
+        if (literalLength > size_t(inputEnd - ip) || literalLength > size_t(outputEnd - op)) {
+            throw std::runtime_error("Compressed block literals out of range");
+        }
+        std::memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+        if (ip == inputEnd) {
+            break;
+        }
+
+        if (inputEnd - ip < 2) {
+            throw std::runtime_error("Compressed block truncated");
+        }
+        size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+        ip += 2;
+        size_t matchLength = token & RunMask;
+        if (matchLength == RunMask) {
+            matchLength += readLength(ip, inputEnd);
+        }
+        matchLength += MinMatch;
+        if (offset == 0 || offset > size_t(op - output) || matchLength > size_t(outputEnd - op)) {
+            throw std::runtime_error("Compressed block match out of range");
+        }
+
+        // Overlapping matches repeat the last offset bytes; each copy doubles
+        // the span that is known to repeat, so runs cost log2 copies
+        const uint8_t* match = op - offset;
+        size_t period = offset;
+        while (matchLength > 0) {
+            size_t chunk = std::min(period, matchLength);
+            std::memcpy(op, match, chunk);
+            op += chunk;
+            matchLength -= chunk;
+            period += chunk;
+        }
+    }
+
+    if (op != outputEnd) {
+        throw std::runtime_error("Compressed block size mismatch");
+    }
+}
+
+bool isCompressedAsset(const uint8_t* data, size_t size) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    return header.magic == Magic && header.version == Version;
+}
+
+uint64_t compressedAssetRawSize(const uint8_t* data, size_t size) {
+    const Header header = readHeader(data, size);
+    readBlockTable(data, size, header, header.blockCount, true);
+    return header.rawSize;
+}
+
+std::vector<uint8_t> compressAsset(const uint8_t* data, size_t size, uint32_t blockSize) {
+    if (blockSize == 0 || blockSize > MaxBlockSize) {
+        throw std::invalid_argument("Compression block size must be positive and at most MaxBlockSize");
+    }
+
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.blockSize = blockSize;
+    header.blockCount = uint32_t((uint64_t(size) + blockSize - 1) / blockSize);
+    header.rawSize = size;
+
+    std::vector<BlockEntry> blocks(header.blockCount);
+    size_t dataOffset = sizeof(Header) + blocks.size() * sizeof(BlockEntry);
+    std::vector<uint8_t> output(dataOffset);
+    output.reserve(dataOffset + LzCodec::compressBound(size));
+
+    std::vector<uint8_t> scratch(LzCodec::compressBound(blockSize));
+    for (uint32_t i = 0; i < header.blockCount; ++i) {
+        const uint8_t* raw = data + size_t(i) * blockSize;
+        size_t rawSize = std::min<size_t>(blockSize, size - size_t(i) * blockSize);
+        size_t compressedSize = LzCodec::compress(raw, rawSize, scratch.data());
+
+        // Incompressible blocks are stored as-is and decode with a memcpy
+        const uint8_t* stored = compressedSize < rawSize ? scratch.data() : raw;
+        BlockEntry& block = blocks[i];
+        block.offset = output.size();
+        block.compressedSize = uint32_t(std::min(compressedSize, rawSize));
+        block.rawSize = uint32_t(rawSize);
+        output.insert(output.end(), stored, stored + block.compressedSize);
+    }
+
+    std::memcpy(output.data(), &header, sizeof(header));
+    if (!blocks.empty()) {
+        std::memcpy(output.data() + sizeof(header), blocks.data(), blocks.size() * sizeof(BlockEntry));
+    }
+    return output;
+}
+
+void decompressAsset(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize,
+                     const ParallelFor& parallelFor) {
+    const Header header = readHeader(data, size);
+    if (outputSize != header.rawSize) {
+        throw std::runtime_error("Compressed asset output size mismatch");
+    }
+    // Validate the whole table up front so workers only decode
+    const std::vector<BlockEntry> blocks = readBlockTable(data, size, header, header.blockCount, true);
+
+    auto decodeBlock = [&](size_t i) {
+        const BlockEntry& block = blocks[i];
+        decompressAssetBlock(block, data + block.offset, block.compressedSize, output + i * size_t(header.blockSize));
+    };
+
+    if (parallelFor && blocks.size() > 1) {
+        parallelFor(blocks.size(), decodeBlock);
+    } else {
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            decodeBlock(i);
+        }
+    }
+}
+
+uint64_t compressedPrefixSize(const uint8_t* data, size_t size, uint64_t rawPrefix) {
+    const Header header = readHeader(data, size);
+    const uint32_t count = blocksForPrefix(header, rawPrefix);
+    uint64_t prefix = sizeof(Header) + uint64_t(header.blockCount) * sizeof(BlockEntry);
+    for (const BlockEntry& block : readBlockTable(data, size, header, count, false)) {
+        prefix = std::max(prefix, block.offset + block.compressedSize);
+    }
+    return prefix;
+}
+
+void decompressAssetPrefix(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize) {
+    const Header header = readHeader(data, size);
+    const std::vector<BlockEntry> blocks =
+        readBlockTable(data, size, header, blocksForPrefix(header, outputSize), true);
+
+    // Whole blocks decode in place; a partly wanted last block goes through scratch
+    std::vector<uint8_t> scratch;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const BlockEntry& block = blocks[i];
+        size_t offset = i * size_t(header.blockSize);
+        size_t wanted = std::min<size_t>(block.rawSize, outputSize - offset);
+        uint8_t* target = output + offset;
+        if (wanted < block.rawSize) {
+            scratch.resize(block.rawSize);
+            target = scratch.data();
+        }
+        decompressAssetBlock(block, data + block.offset, block.compressedSize, target);
+        if (target == scratch.data()) {
+            std::memcpy(output + offset, scratch.data(), wanted);
+        }
+    }
+}
+
+std::vector<BlockEntry> compressedBlockTable(const uint8_t* data, size_t size) {
+    const Header header = readHeader(data, size);
+    return readBlockTable(data, size, header, header.blockCount, false);
+}
+
+void decompressAssetBlock(const BlockEntry& block, const uint8_t* data, size_t size, uint8_t* output) {
+    if (size < block.compressedSize || block.compressedSize > block.rawSize) {
+        throw std::runtime_error("Compressed asset block is truncated");
+    }
+    if (block.compressedSize == block.rawSize) {
+        std::memcpy(output, data, block.rawSize);
+    } else {
+        LzCodec::decompress(data, block.compressedSize, output, block.rawSize);
+    }
+}
+
+} // namespace World
+} // namespace Aincrad
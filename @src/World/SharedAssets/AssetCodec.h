@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// On-disk layout of a compressed asset payload (little-endian):
+//   Header | BlockEntry[blockCount] | block data
+// Blocks are compressed independently, so they decode in parallel straight
+// into their slice of the output. A block whose compressed size equals its
+// raw size is stored uncompressed. All offsets are from the start of the
+// payload.
+namespace CompressedFormat {
+
+constexpr uint32_t Magic = 0x315A4941; // "AIZ1"
+constexpr uint32_t Version = 1;
+constexpr uint32_t DefaultBlockSize = 256 * 1024;
+// Largest block a payload may declare, so a corrupt header cannot make a
+// reader allocate more than this per block
+constexpr uint32_t MaxBlockSize = 16 * 1024 * 1024;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blockSize;  // Raw bytes per block; the last block may be shorter
+    uint32_t blockCount;
+    uint64_t rawSize;
+};
+
+struct BlockEntry {
+    uint64_t offset;
+    uint32_t compressedSize;
+    uint32_t rawSize;
+};
+
+} // namespace CompressedFormat
+
+// LZ77 block codec in the LZ4 family: greedy hash-chain-free matching over a
+// 64 KiB window, byte-aligned tokens, no entropy stage. Decoding is a tight
+// copy loop, which is the point; ratio is traded for speed.
+namespace LzCodec {
+
+size_t compressBound(size_t size);
+// Returns the compressed size written to output, which must hold compressBound(size)
+size_t compress(const uint8_t* input, size_t size, uint8_t* output);
+// Decodes exactly outputSize bytes. Throws std::runtime_error on corrupt input
+// instead of reading or writing out of bounds.
+void decompress(const uint8_t* input, size_t size, uint8_t* output, size_t outputSize);
+
+} // namespace LzCodec
+
+// Runs work(0) .. work(count - 1), possibly concurrently, and returns once
+// all have run
+using ParallelFor = std::function<void(size_t count, const std::function<void(size_t)>& work)>;
+
+// True if the payload starts with a compressed asset header
+bool isCompressedAsset(const uint8_t* data, size_t size);
+// Validates the header and the whole block table against the size bytes
+// present before returning the decoded size, so the result is bounded by
+// what those bytes can really decode to. Throws std::runtime_error on a
+// malformed or truncated payload.
+uint64_t compressedAssetRawSize(const uint8_t* data, size_t size);
+
+std::vector<uint8_t> compressAsset(const uint8_t* data, size_t size,
+                                   uint32_t blockSize = CompressedFormat::DefaultBlockSize);
+// Decodes into output, which must hold compressedAssetRawSize() bytes. Blocks
+// fan out through parallelFor when given. Throws std::runtime_error on a
+// malformed payload.
+void decompressAsset(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize,
+                     const ParallelFor& parallelFor = ParallelFor());
+
+// Progressive reads: the first bytes of a payload decode from the first
+// blocks, which sit at the front of the file. compressedPrefixSize needs
+// only the header and block table and says how much of the file holds the
+// first rawPrefix bytes; decompressAssetPrefix decodes them from that much.
+uint64_t compressedPrefixSize(const uint8_t* data, size_t size, uint64_t rawPrefix);
+void decompressAssetPrefix(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize);
+
+// Random access, one block at a time: compressedBlockTable validates and
+// returns the table from the header and table alone, so a reader can fetch
+// any block's bytes by itself; decompressAssetBlock then decodes them into
+// block.rawSize bytes of output.
+std::vector<CompressedFormat::BlockEntry> compressedBlockTable(const uint8_t* data, size_t size);
+void decompressAssetBlock(const CompressedFormat::BlockEntry& block, const uint8_t* data, size_t size,
+                          uint8_t* output);
+
+} // namespace World
+} // namespace Aincrad
@@ -1,39 +1,464 @@
 #include "AssetDatabase.h"
+#include "ContentHash.h"
+#include <algorithm>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_set>
+#include <json/json.h>
 
 namespace Aincrad {
 namespace World {
 
-AssetDatabase::AssetDatabase() {
+std::vector<AssetMetadata> parseAssetMetadataJson(std::istream& input) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    if (!Json::parseFromStream(builder, input, &root, &errors)) {
+        throw std::runtime_error("Failed to parse asset metadata: " + errors);
+    }
+
+    // Process each asset entry
+    std::vector<AssetMetadata> entries;
+    entries.reserve(root["assets"].size());
+    for (const auto& asset : root["assets"]) {
+        AssetMetadata metadata;
+        metadata.assetId = asset["id"].asString();
+        metadata.assetType = asset["type"].asString();
+        metadata.version = asset["version"].asString();
+        metadata.permissions = asset["permissions"].asString();
+        metadata.usage = asset["usage"].asString();
+        metadata.sourcePath = asset["path"].asString();
+        metadata.archiveEntry = asset["entry"].asString();
+        metadata.sourceOffset = asset["offset"].asUInt64();
+        metadata.sourceSize = asset["size"].asUInt64();
+        metadata.contentHash = asset["hash"].asString();
+        if (!metadata.contentHash.empty() && !ContentHash::fromHex(metadata.contentHash)) {
+            throw std::runtime_error("Invalid content hash for asset: " + metadata.assetId);
+        }
+
+        // Process platforms
+        for (const auto& platform : asset["platforms"]) {
+            metadata.platforms.push_back(platform.asString());
+        }
+
+        // Process dependencies
+        for (const auto& dependency : asset["dependencies"]) {
+            metadata.dependencies.push_back(dependency.asString());
+        }
+
+        entries.push_back(std::move(metadata));
+    }
+
+    return entries;
+}
+
+AssetDatabase::AssetDatabase()
+    : m_deadDependencies(0)
+    , m_platformViewsStale(false)
+{
+    internString(std::string()); // Id 0 is the empty string
 }
 
 AssetDatabase::~AssetDatabase() {
-    m_metadata.clear();
+    m_records.clear();
+}
+
+AssetDatabase::Record* AssetDatabase::findRecord(AssetHandle handle) {
+    if (!handle.isValid() || handle.index >= m_records.size()) {
+        return nullptr;
+    }
+    Record& record = m_records[handle.index];
+    return record.generation == handle.generation ? &record : nullptr;
+}
+
+AssetDatabase::Record& AssetDatabase::recordFor(AssetHandle handle) {
+    if (handle.index >= m_records.size()) {
+        m_records.resize(size_t(handle.index) + 1);
+    }
+
+    // A new generation means the slot was recycled for a different asset
+    Record& record = m_records[handle.index];
+    if (record.generation != handle.generation) {
+        record = Record();
+        record.generation = handle.generation;
+    }
+    return record;
+}
+
+uint32_t AssetDatabase::internString(const std::string& value) {
+    auto it = m_stringIds.find(value);
+    if (it != m_stringIds.end()) {
+        return it->second;
+    }
+    uint32_t id = uint32_t(m_strings.size());
+    m_strings.push_back(value);
+    m_stringIds.emplace(m_strings.back(), id);
+    return id;
+}
+
+AssetHandle AssetPlatformView::operator[](size_t position) const {
+    if (position < m_handles.size()) {
+        return m_handles[position];
+    }
+    return m_database->handleForIndexSlot(*m_index, m_slots.first[position - m_handles.size()]);
+}
+
+AssetHandle AssetDatabase::insertRecord(const AssetMetadata& metadata, bool indexed) {
+    // Checked before anything changes, so a bad entry leaves no trace
+    PlatformMask platforms;
+    try {
+        platforms = toPlatformMask(metadata.platforms);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string(e.what()) + " in asset " + metadata.assetId);
+    }
+
+    // Intern dependencies first; a dependency that is not known yet keeps a
+    // placeholder record so adding it later resolves to the same handle
+    AssetHandle handle = m_handles.intern(metadata.assetId);
+    uint32_t dependencyFirst = uint32_t(m_dependencyArena.size());
+    for (const auto& dependency : metadata.dependencies) {
+        AssetHandle dependencyHandle = m_handles.intern(dependency);
+        recordFor(dependencyHandle).dependentCount++;
+        auto first = m_dependencyArena.begin() + dependencyFirst;
+        if (std::find(first, m_dependencyArena.end(), dependencyHandle) == m_dependencyArena.end()) {
+            m_dependents[dependencyHandle].push_back(handle);
+        }
+        m_dependencyArena.push_back(dependencyHandle);
+    }
+
+    Record& record = recordFor(handle);
+    record.present = true;
+    record.indexed = indexed;
+    record.platforms = platforms;
+    record.assetType = internString(metadata.assetType);
+    record.permissions = internString(metadata.permissions);
+    record.usage = internString(metadata.usage);
+    record.sourcePath = internString(metadata.sourcePath);
+    record.archiveEntry = internString(metadata.archiveEntry);
+    record.contentHash = internString(metadata.contentHash);
+    StoredAssetVersion version = storeAssetVersion(metadata.version);
+    record.versionText = version.exact ? 0 : internString(metadata.version);
+    record.dependencyFirst = dependencyFirst;
+    record.dependencyCount = uint32_t(metadata.dependencies.size());
+    record.version = version.packed;
+    record.sourceOffset = metadata.sourceOffset;
+    record.sourceSize = metadata.sourceSize;
+    record.metadata.reset();
+
+    // Indexed entries are listed by the index's own views
+    for (size_t platform = 0; !indexed && platform < AssetPlatformCount; ++platform) {
+        if (platforms & platformBit(AssetPlatform(platform))) {
+            m_platformViews[platform].push_back(handle.index);
+        }
+    }
+    return handle;
+}
+
+AssetHandle AssetDatabase::materializeFromIndex(const std::string& assetId) {
+    // Another thread may have materialized it between our locks
+    AssetHandle handle = m_handles.find(assetId);
+    Record* record = findRecord(handle);
+    if (record && record->present) {
+        return handle;
+    }
+
+    if (!m_index || m_removedFromIndex.count(assetId)) {
+        return AssetHandle();
+    }
+    auto view = m_index->find(assetId);
+    if (!view) {
+        return AssetHandle();
+    }
+    return insertRecord(view->toMetadata(), true);
+}
+
+AssetHandle AssetDatabase::handleForIndexSlot(const AssetMetadataIndex& index, uint32_t slot) {
+    std::string assetId(index.entry(slot).assetId());
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_index.get() != &index || m_removedFromIndex.count(assetId)) {
+            return AssetHandle();
+        }
+        AssetHandle handle = m_handles.find(assetId);
+        Record* record = findRecord(handle);
+        if (record && record->present) {
+            return record->indexed ? handle : AssetHandle();
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (m_index.get() != &index) {
+        return AssetHandle();
+    }
+    AssetHandle handle = materializeFromIndex(assetId);
+    Record* record = findRecord(handle);
+    return record && record->indexed ? handle : AssetHandle();
+}
+
+bool AssetDatabase::ensurePresent(AssetHandle handle) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        Record* record = findRecord(handle);
+        if (!record) {
+            return false;
+        }
+        if (record->present || !m_index) {
+            return record->present;
+        }
+    }
+
+    // Placeholder for a dependency that lives in the index but was never used
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Record* record = findRecord(handle);
+    if (record && !record->present) {
+        materializeFromIndex(m_handles.getAssetId(handle));
+        record = findRecord(handle);
+    }
+    return record && record->present;
+}
+
+std::shared_ptr<AssetMetadata> AssetDatabase::buildMetadata(AssetHandle handle, const Record& record) const {
+    // Not make_shared: the cached weak_ptr would pin the whole allocation
+    std::shared_ptr<AssetMetadata> metadata(new AssetMetadata());
+    metadata->assetId = m_handles.getAssetId(handle);
+    metadata->assetType = m_strings[record.assetType];
+    metadata->platforms = platformNames(record.platforms);
+    metadata->version = record.versionText ? m_strings[record.versionText] : formatAssetVersion(record.version);
+    metadata->permissions = m_strings[record.permissions];
+    metadata->usage = m_strings[record.usage];
+    metadata->sourcePath = m_strings[record.sourcePath];
+    metadata->archiveEntry = m_strings[record.archiveEntry];
+    metadata->sourceOffset = record.sourceOffset;
+    metadata->sourceSize = record.sourceSize;
+    metadata->contentHash = m_strings[record.contentHash];
+
+    metadata->dependencies.reserve(record.dependencyCount);
+    for (uint32_t i = 0; i < record.dependencyCount; ++i) {
+        metadata->dependencies.push_back(m_handles.getAssetId(m_dependencyArena[record.dependencyFirst + i]));
+    }
+    return metadata;
+}
+
+void AssetDatabase::releaseIfUnused(AssetHandle handle) {
+    Record* record = findRecord(handle);
+    if (record && !record->present && record->dependentCount == 0) {
+        *record = Record();
+        m_handles.release(handle);
+    }
+}
+
+void AssetDatabase::forgetDependent(AssetHandle dependency, AssetHandle dependent) {
+    auto it = m_dependents.find(dependency);
+    if (it == m_dependents.end()) {
+        return;
+    }
+    auto& dependents = it->second;
+    auto position = std::find(dependents.begin(), dependents.end(), dependent);
+    if (position != dependents.end()) {
+        *position = dependents.back();
+        dependents.pop_back();
+    }
+    if (dependents.empty()) {
+        m_dependents.erase(it);
+    }
+}
+
+void AssetDatabase::compactDependencyArena() {
+    std::vector<AssetHandle> arena;
+    arena.reserve(m_dependencyArena.size() - m_deadDependencies);
+    for (Record& record : m_records) {
+        if (record.present) {
+            auto first = m_dependencyArena.begin() + record.dependencyFirst;
+            record.dependencyFirst = uint32_t(arena.size());
+            arena.insert(arena.end(), first, first + record.dependencyCount);
+        }
+    }
+    m_dependencyArena.swap(arena);
+    m_deadDependencies = 0;
+}
+
+void AssetDatabase::rebuildPlatformViews() {
+    for (auto& view : m_platformViews) {
+        view.clear();
+    }
+    for (uint32_t index = 0; index < m_records.size(); ++index) {
+        const Record& record = m_records[index];
+        for (size_t platform = 0; record.present && !record.indexed && platform < AssetPlatformCount; ++platform) {
+            if (record.platforms & platformBit(AssetPlatform(platform))) {
+                m_platformViews[platform].push_back(index);
+            }
+        }
+    }
+    m_platformViewsStale = false;
 }
 
 void AssetDatabase::addAssetMetadata(const AssetMetadata& metadata) {
-    auto it = m_metadata.find(metadata.assetId);
-    if (it != m_metadata.end()) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Record* record = findRecord(m_handles.find(metadata.assetId));
+    bool indexed = m_index && m_index->find(metadata.assetId) && !m_removedFromIndex.count(metadata.assetId);
+    if ((record && record->present) || indexed) {
         throw std::runtime_error("Asset metadata already exists: " + metadata.assetId);
     }
 
-    m_metadata[metadata.assetId] = std::make_shared<AssetMetadata>(metadata);
+    insertRecord(metadata);
+}
+
+AssetHandle AssetDatabase::getHandle(const std::string& assetId) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        AssetHandle handle = m_handles.find(assetId);
+        Record* record = findRecord(handle);
+        if (record && record->present) {
+            return handle;
+        }
+        if (!m_index) {
+            return AssetHandle();
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    return materializeFromIndex(assetId);
 }
 
 std::shared_ptr<AssetMetadata> AssetDatabase::getAssetMetadata(const std::string& assetId) {
-    auto it = m_metadata.find(assetId);
-    if (it == m_metadata.end()) {
+    AssetHandle handle = getHandle(assetId);
+    return handle.isValid() ? getAssetMetadata(handle) : nullptr;
+}
+
+std::shared_ptr<AssetMetadata> AssetDatabase::getAssetMetadata(AssetHandle handle) {
+    if (!ensurePresent(handle)) {
         return nullptr;
     }
 
-    return it->second;
+    std::shared_ptr<AssetMetadata> metadata;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        Record* record = findRecord(handle);
+        if (!record || !record->present) {
+            return nullptr;
+        }
+        if (auto cached = record->metadata.lock()) {
+            return cached;
+        }
+        metadata = buildMetadata(handle, *record);
+    }
+
+    // Only cached while held, so idle records keep their compact size
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Record* record = findRecord(handle);
+    if (!record || !record->present) {
+        return nullptr;
+    }
+    if (auto cached = record->metadata.lock()) {
+        return cached;
+    }
+    record->metadata = metadata;
+    return metadata;
 }
 
 void AssetDatabase::removeAssetMetadata(const std::string& assetId) {
-    auto it = m_metadata.find(assetId);
-    if (it != m_metadata.end()) {
-        m_metadata.erase(it);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    AssetHandle handle = m_handles.find(assetId);
+    Record* record = findRecord(handle);
+    if (record && record->present) {
+        uint32_t dependencyFirst = record->dependencyFirst;
+        uint32_t dependencyCount = record->dependencyCount;
+        uint32_t dependentCount = record->dependentCount;
+        *record = Record();
+        record->generation = handle.generation;
+        record->dependentCount = dependentCount;
+        m_deadDependencies += dependencyCount;
+        m_platformViewsStale = true;
+
+        for (uint32_t i = 0; i < dependencyCount; ++i) {
+            AssetHandle dependency = m_dependencyArena[dependencyFirst + i];
+            auto first = m_dependencyArena.begin() + dependencyFirst;
+            if (std::find(first, first + i, dependency) == first + i) {
+                forgetDependent(dependency, handle);
+            }
+            Record* dependencyRecord = findRecord(dependency);
+            if (dependencyRecord && dependencyRecord->dependentCount > 0) {
+                dependencyRecord->dependentCount--;
+                releaseIfUnused(dependency);
+            }
+        }
+
+        // Still-referenced IDs keep their handle as a missing-dependency placeholder
+        releaseIfUnused(handle);
+
+        if (m_deadDependencies * 2 > m_dependencyArena.size()) {
+            compactDependencyArena();
+        }
+    }
+
+    // The mapping is read-only, so indexed entries are hidden instead
+    if (m_index && m_index->find(assetId)) {
+        m_removedFromIndex.insert(assetId);
+    }
+}
+
+std::string AssetDatabase::getAssetId(AssetHandle handle) const {
+    return m_handles.getAssetId(handle);
+}
+
+std::vector<AssetHandle> AssetDatabase::getDependencies(AssetHandle handle) {
+    if (!ensurePresent(handle)) {
+        return {};
+    }
+
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    Record* record = findRecord(handle);
+    if (!record || !record->present) {
+        return {};
     }
+    auto first = m_dependencyArena.begin() + record->dependencyFirst;
+    return std::vector<AssetHandle>(first, first + record->dependencyCount);
+}
+
+std::vector<AssetHandle> AssetDatabase::getDependents(AssetHandle handle) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_dependents.find(handle);
+    return it != m_dependents.end() ? it->second : std::vector<AssetHandle>();
+}
+
+AssetPlatformView AssetDatabase::getAssetsForPlatform(AssetPlatform platform) {
+    AssetPlatformView assets;
+    assets.m_database = this;
+    if (size_t(platform) >= AssetPlatformCount) {
+        return assets;
+    }
+
+    // Removals leave the runtime views stale; rebuilding is the only write
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    if (m_platformViewsStale) {
+        lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+            if (m_platformViewsStale) {
+                rebuildPlatformViews();
+            }
+        }
+        lock.lock();
+    }
+
+    const auto& view = m_platformViews[size_t(platform)];
+    assets.m_handles.reserve(view.size());
+    for (uint32_t index : view) {
+        assets.m_handles.push_back(AssetHandle{index, m_records[index].generation});
+    }
+
+    // Indexed entries, used or not, come from the view compiled into the index
+    if (m_index) {
+        assets.m_index = m_index;
+        assets.m_slots = m_index->platformSlots(platform);
+    }
+    return assets;
+}
+
+void AssetDatabase::attachIndex(std::shared_ptr<const AssetMetadataIndex> index) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_index = std::move(index);
+    m_removedFromIndex.clear();
 }
 
 bool AssetDatabase::validateAsset(const std::string& assetId) {
@@ -52,21 +477,165 @@ bool AssetDatabase::validateAsset(const std::string& assetId) {
 }
 
 bool AssetDatabase::checkDependencies(const std::string& assetId) {
-    auto metadata = getAssetMetadata(assetId);
-    if (!metadata) {
+    AssetHandle handle = getHandle(assetId);
+    if (!handle.isValid()) {
         return false;
     }
 
-    // Check each dependency
-    for (const auto& dependency : metadata->dependencies) {
-        auto depMetadata = getAssetMetadata(dependency);
-        if (!depMetadata) {
+    // Walk the whole closure so missing transitive dependencies and cycles fail too
+    AssetDependencyGraph graph;
+    std::string error;
+    return collectDependencies(handle, graph, error);
+}
+
+AssetDependencyGraph AssetDatabase::buildDependencyGraph(const std::string& assetId) {
+    AssetHandle handle = getHandle(assetId);
+    if (!handle.isValid()) {
+        throw std::runtime_error("Asset not found: " + assetId);
+    }
+    return buildDependencyGraph(handle);
+}
+
+AssetDependencyGraph AssetDatabase::buildDependencyGraph(AssetHandle handle) {
+    AssetDependencyGraph graph;
+    std::string error;
+    if (!collectDependencies(handle, graph, error)) {
+        throw std::runtime_error(error);
+    }
+
+    // Assign each asset to the wave after its deepest dependency
+    AssetHandleMap<size_t> waveOf;
+    for (AssetHandle id : graph.order) {
+        size_t wave = 0;
+        for (AssetHandle dependency : graph.dependencies[id]) {
+            wave = std::max(wave, waveOf[dependency] + 1);
+        }
+        waveOf[id] = wave;
+        if (graph.waves.size() <= wave) {
+            graph.waves.resize(wave + 1);
+        }
+        graph.waves[wave].push_back(id);
+    }
+
+    return graph;
+}
+
+bool AssetDatabase::collectDependencies(AssetHandle root, AssetDependencyGraph& graph, std::string& error) {
+    struct Frame {
+        AssetHandle id;
+        std::vector<AssetHandle> dependencies;
+        size_t next;
+    };
+
+    // Names are only needed to describe failures
+    auto name = [this](AssetHandle handle) {
+        try {
+            return getAssetId(handle);
+        } catch (const std::out_of_range&) {
+            return std::string("<removed asset>");
+        }
+    };
+
+    graph.root = root;
+    if (!ensurePresent(root)) {
+        error = "Asset not found: " + name(root);
+        return false;
+    }
+
+    std::unordered_set<AssetHandle, AssetHandleHash> visiting;
+    std::unordered_set<AssetHandle, AssetHandleHash> visited;
+    std::vector<Frame> stack;
+    stack.push_back({root, getDependencies(root), 0});
+    visiting.insert(root);
+
+    // Iterative depth-first search; post-order gives dependencies first
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+
+        if (frame.next == frame.dependencies.size()) {
+            visiting.erase(frame.id);
+            visited.insert(frame.id);
+            graph.order.push_back(frame.id);
+            stack.pop_back();
+            continue;
+        }
+
+        const AssetHandle dependency = frame.dependencies[frame.next++];
+        const AssetHandle parent = frame.id;
+
+        auto& parentDependencies = graph.dependencies[parent];
+        if (std::find(parentDependencies.begin(), parentDependencies.end(), dependency) != parentDependencies.end()) {
+            continue;
+        }
+        parentDependencies.push_back(dependency);
+        graph.dependents[dependency].push_back(parent);
+
+        if (visited.count(dependency)) {
+            continue;
+        }
+        if (visiting.count(dependency)) {
+            // Report the cycle from where it re-enters the stack
+            error = "Dependency cycle detected: ";
+            auto start = std::find_if(stack.begin(), stack.end(),
+                [&](const Frame& f) { return f.id == dependency; });
+            for (auto it = start; it != stack.end(); ++it) {
+                error += name(it->id) + " -> ";
+            }
+            error += name(dependency);
             return false;
         }
+        if (!ensurePresent(dependency)) {
+            error = "Missing dependency " + name(dependency) + " of asset " + name(parent);
+            return false;
+        }
+
+        visiting.insert(dependency);
+        stack.push_back({dependency, getDependencies(dependency), 0});
     }
 
     return true;
 }
 
+AssetCriticalPath AssetDependencyGraph::criticalPath(
+    const AssetHandleMap<std::chrono::microseconds>& costs) const {
+    AssetHandleMap<std::chrono::microseconds> finish;
+    AssetHandleMap<AssetHandle> previous;
+
+    // order is topological, so every dependency is finished before its dependents
+    for (AssetHandle id : order) {
+        std::chrono::microseconds start(0);
+        auto deps = dependencies.find(id);
+        if (deps != dependencies.end()) {
+            for (AssetHandle dependency : deps->second) {
+                if (previous.count(id) == 0 || finish[dependency] > start) {
+                    start = finish[dependency];
+                    previous[id] = dependency;
+                }
+            }
+        }
+
+        auto cost = costs.find(id);
+        finish[id] = start + (cost != costs.end() ? cost->second : std::chrono::microseconds(0));
+    }
+
+    AssetCriticalPath path;
+    if (order.empty()) {
+        return path;
+    }
+
+    path.duration = finish[root];
+    for (AssetHandle id = root;;) {
+        path.assets.push_back(id);
+        auto it = previous.find(id);
+        if (it == previous.end()) {
+            break;
+        }
+        id = it->second;
+    }
+    std::reverse(path.assets.begin(), path.assets.end());
+
+    return path;
+}
+
 } // namespace World
-} // namespace Aincrad 
\ No newline at end of file
+} // namespace Aincrad
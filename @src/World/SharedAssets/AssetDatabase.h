@@ -1,30 +1,179 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <deque>
+#include <istream>
 #include <memory>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "Asset.h"
+#include "AssetHandle.h"
+#include "AssetMetadataIndex.h"
+#include "AssetPlatform.h"
 
 namespace Aincrad {
 namespace World {
 
+template <typename Value>
+using AssetHandleMap = std::unordered_map<AssetHandle, Value, AssetHandleHash>;
+
+struct AssetCriticalPath {
+    std::vector<AssetHandle> assets; // Deepest dependency first, root last
+    std::chrono::microseconds duration{0};
+};
+
+// Transitive dependency closure of one asset
+struct AssetDependencyGraph {
+    AssetHandle root;
+    std::vector<AssetHandle> order;                 // Topological order, dependencies first
+    std::vector<std::vector<AssetHandle>> waves;    // Each wave depends only on earlier waves
+    AssetHandleMap<std::vector<AssetHandle>> dependencies;
+    AssetHandleMap<std::vector<AssetHandle>> dependents;
+
+    // Longest chain of dependent loads, weighted by per-asset cost
+    AssetCriticalPath criticalPath(const AssetHandleMap<std::chrono::microseconds>& costs) const;
+};
+
+// Parses the source metadata.json format ({"assets": [...]})
+std::vector<AssetMetadata> parseAssetMetadataJson(std::istream& input);
+
+class AssetDatabase;
+
+// Assets that ship for one platform. Runtime entries are handles already;
+// indexed entries stay slots of the index's compiled view until read, so
+// taking a view neither copies ids nor makes the index resident.
+class AssetPlatformView {
+public:
+    class Iterator {
+    public:
+        Iterator(const AssetPlatformView* view, size_t position) : m_view(view), m_position(position) {}
+        AssetHandle operator*() const { return (*m_view)[m_position]; }
+        Iterator& operator++() { ++m_position; return *this; }
+        bool operator!=(const Iterator& other) const { return m_position != other.m_position; }
+
+    private:
+        const AssetPlatformView* m_view;
+        size_t m_position;
+    };
+
+    size_t size() const { return m_handles.size() + m_slots.size(); }
+    bool empty() const { return size() == 0; }
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size()); }
+
+    // Indexed entries materialize here on first use. Entries removed or
+    // overlaid since the view was taken give an invalid handle.
+    AssetHandle operator[](size_t position) const;
+
+private:
+    friend class AssetDatabase;
+
+    AssetDatabase* m_database = nullptr;
+    std::vector<AssetHandle> m_handles;
+    std::shared_ptr<const AssetMetadataIndex> m_index; // Keeps the slots mapped
+    AssetSlotList m_slots;
+};
+
 class AssetDatabase {
 public:
     AssetDatabase();
     ~AssetDatabase();
 
-    // Asset metadata management
+    // Asset metadata management. Metadata is stored compactly and rebuilt
+    // on request; the returned object is shared while anyone holds it.
+    // Adding throws std::runtime_error on an unknown platform.
     void addAssetMetadata(const AssetMetadata& metadata);
     std::shared_ptr<AssetMetadata> getAssetMetadata(const std::string& assetId);
+    std::shared_ptr<AssetMetadata> getAssetMetadata(AssetHandle handle);
     void removeAssetMetadata(const std::string& assetId);
 
+    // Handles; string IDs are resolved here and nowhere else
+    // getHandle returns an invalid handle for unknown assets
+    AssetHandle getHandle(const std::string& assetId);
+    std::string getAssetId(AssetHandle handle) const;
+    std::vector<AssetHandle> getDependencies(AssetHandle handle);
+    // Direct dependents among the records materialized so far; every loaded
+    // asset has a record, so this covers all loaded dependents. Served from
+    // a reverse index, not a scan.
+    std::vector<AssetHandle> getDependents(AssetHandle handle) const;
+
+    // Assets that ship for the platform, indexed ones included, in no
+    // particular order. Served from per-platform views, not a scan.
+    AssetPlatformView getAssetsForPlatform(AssetPlatform platform);
+
+    // Serve lookups from a compiled, memory-mapped index. Entries added at
+    // runtime overlay the index; indexed entries are materialized on first use.
+    void attachIndex(std::shared_ptr<const AssetMetadataIndex> index);
+    std::shared_ptr<const AssetMetadataIndex> getIndex() const { return m_index; }
+
     // Asset validation
     bool validateAsset(const std::string& assetId);
     bool checkDependencies(const std::string& assetId);
 
+    // Dependency graph; throws on missing dependencies or cycles
+    AssetDependencyGraph buildDependencyGraph(const std::string& assetId);
+    AssetDependencyGraph buildDependencyGraph(AssetHandle handle);
+
 private:
-    std::unordered_map<std::string, std::shared_ptr<AssetMetadata>> m_metadata;
+    friend class AssetPlatformView;
+
+    // Dense per-handle storage, kept small for a million assets: repeated
+    // strings are interned, platforms are a bitmask, the version is packed
+    // (see storeAssetVersion) and dependencies are a span of handles in one
+    // shared arena
+    struct Record {
+        uint32_t generation = 0;
+        uint32_t dependentCount = 0;  // Live records that list this asset as a dependency
+        bool present = false;         // False for placeholders of unknown dependencies
+        bool indexed = false;         // Materialized from the index, which lists it per platform
+        PlatformMask platforms = 0;
+        uint32_t assetType = 0;       // Interned string ids
+        uint32_t permissions = 0;
+        uint32_t usage = 0;
+        uint32_t sourcePath = 0;
+        uint32_t archiveEntry = 0;
+        uint32_t contentHash = 0;
+        uint32_t versionText = 0;     // Only for versions the packed form does not give back
+        uint32_t dependencyFirst = 0; // Span of m_dependencyArena
+        uint32_t dependencyCount = 0;
+        uint64_t version = 0;
+        uint64_t sourceOffset = 0;
+        uint64_t sourceSize = 0;
+        std::weak_ptr<AssetMetadata> metadata; // Last rebuilt copy, while held
+    };
+
+    Record* findRecord(AssetHandle handle);
+    Record& recordFor(AssetHandle handle);
+    AssetHandle insertRecord(const AssetMetadata& metadata, bool indexed = false);
+    AssetHandle materializeFromIndex(const std::string& assetId);
+    AssetHandle handleForIndexSlot(const AssetMetadataIndex& index, uint32_t slot);
+    bool ensurePresent(AssetHandle handle);
+    std::shared_ptr<AssetMetadata> buildMetadata(AssetHandle handle, const Record& record) const;
+    void releaseIfUnused(AssetHandle handle);
+    void forgetDependent(AssetHandle dependency, AssetHandle dependent);
+    void compactDependencyArena();
+    void rebuildPlatformViews();
+    uint32_t internString(const std::string& value);
+    bool collectDependencies(AssetHandle root, AssetDependencyGraph& graph, std::string& error);
+
+    AssetHandleRegistry m_handles;
+    std::vector<Record> m_records;
+    std::deque<std::string> m_strings; // Never moves, so the ids below can view it
+    std::unordered_map<std::string_view, uint32_t> m_stringIds;
+    std::vector<AssetHandle> m_dependencyArena;
+    AssetHandleMap<std::vector<AssetHandle>> m_dependents; // Only assets something depends on
+    size_t m_deadDependencies;         // Arena entries of removed records
+    std::array<std::vector<uint32_t>, AssetPlatformCount> m_platformViews; // Runtime record indices
+    bool m_platformViewsStale;         // Set by removals; rebuilt on the next query
+    std::unordered_set<std::string> m_removedFromIndex;
+    std::shared_ptr<const AssetMetadataIndex> m_index;
+    mutable std::shared_mutex m_mutex;
 };
 
 } // namespace World
-} // namespace Aincrad 
\ No newline at end of file
+} // namespace Aincrad
@@ -0,0 +1,100 @@
+#include "AssetHandle.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace Aincrad {
+namespace World {
+
+AssetHandleRegistry::AssetHandleRegistry() {
+}
+
+AssetHandleRegistry::~AssetHandleRegistry() {
+}
+
+AssetHandle AssetHandleRegistry::intern(std::string_view assetId) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_indices.find(assetId);
+        if (it != m_indices.end()) {
+            return AssetHandle{it->second, m_slots[it->second].generation};
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_indices.find(assetId);
+    if (it != m_indices.end()) {
+        return AssetHandle{it->second, m_slots[it->second].generation};
+    }
+
+    // Reuse a released slot when possible to keep handle indices dense
+    uint32_t index;
+    if (!m_freeSlots.empty()) {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        Slot& slot = m_slots[index];
+        slot.assetId = std::string(assetId);
+        slot.alive = true;
+    } else {
+        if (m_slots.size() >= UINT32_MAX) {
+            throw std::runtime_error("Asset handle registry is full");
+        }
+        index = uint32_t(m_slots.size());
+        m_slots.push_back(Slot{std::string(assetId), 1, true});
+    }
+
+    m_indices.emplace(m_slots[index].assetId, index);
+    return AssetHandle{index, m_slots[index].generation};
+}
+
+AssetHandle AssetHandleRegistry::find(std::string_view assetId) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_indices.find(assetId);
+    if (it == m_indices.end()) {
+        return AssetHandle();
+    }
+    return AssetHandle{it->second, m_slots[it->second].generation};
+}
+
+void AssetHandleRegistry::release(AssetHandle handle) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (handle.index >= m_slots.size()) {
+        return;
+    }
+
+    Slot& slot = m_slots[handle.index];
+    if (!slot.alive || slot.generation != handle.generation) {
+        return;
+    }
+
+    m_indices.erase(slot.assetId);
+    slot.assetId.clear();
+    slot.alive = false;
+    // Skip 0 on wrap-around; it marks invalid handles
+    slot.generation = slot.generation == UINT32_MAX ? 1 : slot.generation + 1;
+    m_freeSlots.push_back(handle.index);
+}
+
+bool AssetHandleRegistry::isAlive(AssetHandle handle) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return handle.index < m_slots.size() &&
+           m_slots[handle.index].alive &&
+           m_slots[handle.index].generation == handle.generation;
+}
+
+std::string AssetHandleRegistry::getAssetId(AssetHandle handle) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    if (handle.index >= m_slots.size() ||
+        !m_slots[handle.index].alive ||
+        m_slots[handle.index].generation != handle.generation) {
+        throw std::out_of_range("Stale or invalid asset handle");
+    }
+    return m_slots[handle.index].assetId;
+}
+
+size_t AssetHandleRegistry::size() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_indices.size();
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// Compact interned asset ID. The index addresses a registry slot; the
+// generation changes whenever the slot is reused, so stale handles to
+// removed assets never alias a newer asset. Generation 0 is never issued.
+struct AssetHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool isValid() const { return generation != 0; }
+    uint64_t value() const { return (uint64_t(generation) << 32) | index; }
+
+    bool operator==(const AssetHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const AssetHandle& other) const { return !(*this == other); }
+};
+
+struct AssetHandleHash {
+    size_t operator()(const AssetHandle& handle) const {
+        // Fibonacci hashing spreads sequential indices across buckets and shards
+        return size_t((handle.value() * 0x9E3779B97F4A7C15ull) >> 16);
+    }
+};
+
+// Maps string asset IDs to handles. Strings are only hashed here, at the
+// API edge; everything behind it keys by handle.
+class AssetHandleRegistry {
+public:
+    AssetHandleRegistry();
+    ~AssetHandleRegistry();
+
+    // Returns the existing handle or assigns a new one
+    AssetHandle intern(std::string_view assetId);
+    // Returns an invalid handle if the ID was never interned
+    AssetHandle find(std::string_view assetId) const;
+    // Frees the slot for reuse and invalidates outstanding handles
+    void release(AssetHandle handle);
+
+    bool isAlive(AssetHandle handle) const;
+    // Throws std::out_of_range for stale or invalid handles
+    std::string getAssetId(AssetHandle handle) const;
+    size_t size() const;
+
+private:
+    struct Slot {
+        std::string assetId;
+        uint32_t generation;
+        bool alive;
+    };
+
+    // Keys view the live slots' IDs, so lookups never build a string
+    std::unordered_map<std::string_view, uint32_t> m_indices;
+    std::deque<Slot> m_slots; // Never moves, so the keys above can view it
+    std::vector<uint32_t> m_freeSlots;
+    mutable std::shared_mutex m_mutex;
+};
+
+} // namespace World
+} // namespace Aincrad
+
+namespace std {
+
+template <>
+struct hash<Aincrad::World::AssetHandle> : Aincrad::World::AssetHandleHash {};
+
+} // namespace std
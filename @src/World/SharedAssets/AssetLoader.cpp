@@ -0,0 +1,176 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+int strategyBand(AssetLoadingConfig::LoadingStrategy strategy) {
+    switch (strategy) {
+        case AssetLoadingConfig::LoadingStrategy::Immediate:
+            return 0;
+        case AssetLoadingConfig::LoadingStrategy::Streaming:
+            return 1;
+        case AssetLoadingConfig::LoadingStrategy::Background:
+            return 2;
+        default:
+            throw std::runtime_error("Unknown loading strategy");
+    }
+}
+
+} // namespace
+
+bool AssetLoader::TaskOrder::operator()(const Task& a, const Task& b) const {
+    // std::priority_queue pops the "largest" element, so return true when
+    // a should run after b
+    if (a.band != b.band) {
+        return a.band > b.band;
+    }
+    if (a.priority != b.priority) {
+        return a.priority < b.priority;
+    }
+    return a.sequence > b.sequence;
+}
+
+AssetLoader::AssetLoader(size_t workerCount)
+    : m_nextSequence(0)
+    , m_stopping(false)
+    , m_queueDepth(0)
+    , m_activeTasks(0)
+{
+    if (workerCount == 0) {
+        // Leave one hardware thread for the game loop
+        size_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = std::max<size_t>(1, hardwareThreads > 1 ? hardwareThreads - 1 : 1);
+    }
+
+    m_workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+
+        // Drop queued work; abandoned promises report broken_promise to waiters
+        while (!m_tasks.empty()) {
+            m_tasks.pop();
+        }
+        m_queueDepth = 0;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void AssetLoader::cancelQueued() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_tasks.empty()) {
+        m_tasks.pop();
+    }
+    m_queueDepth = 0;
+}
+
+void AssetLoader::submit(int priority, AssetLoadingConfig::LoadingStrategy strategy, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) {
+            throw std::runtime_error("Asset loader is shutting down");
+        }
+
+        m_tasks.push(Task{strategyBand(strategy), priority, m_nextSequence++, std::move(task)});
+        m_queueDepth.store(m_tasks.size(), std::memory_order_relaxed);
+    }
+    m_condition.notify_one();
+}
+
+void AssetLoader::parallelFor(size_t count, const std::function<void(size_t)>& work, int priority,
+                              AssetLoadingConfig::LoadingStrategy strategy) {
+    struct Batch {
+        std::function<void(size_t)> work;
+        size_t count;
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t done = 0;
+        std::exception_ptr error;
+
+        // Claims items until none are left; helpers that start late find
+        // nothing to claim and never touch the caller's work
+        void drain() {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                std::exception_ptr failure;
+                try {
+                    work(i);
+                } catch (...) {
+                    failure = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (failure && !error) {
+                    error = failure;
+                }
+                if (++done == count) {
+                    finished.notify_all();
+                }
+            }
+        }
+    };
+
+    if (count == 0) {
+        return;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->work = work;
+    batch->count = count;
+
+    size_t helpers = std::min(count - 1, m_workers.size());
+    for (size_t i = 0; i < helpers; ++i) {
+        try {
+            submit(priority, strategy, [batch]() { batch->drain(); });
+        } catch (const std::runtime_error&) {
+            break; // Shutting down; the caller finishes alone
+        }
+    }
+
+    batch->drain();
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&batch]() { return batch->done == batch->count; });
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+void AssetLoader::workerLoop() {
+    for (;;) {
+        std::function<void()> work;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping) {
+                return;
+            }
+
+            // priority_queue::top is const; the work is moved out before popping
+            work = std::move(const_cast<Task&>(m_tasks.top()).work);
+            m_tasks.pop();
+            m_queueDepth.store(m_tasks.size(), std::memory_order_relaxed);
+            m_activeTasks.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Tasks report their own failures through their promise
+        work();
+        m_activeTasks.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace World
+} // namespace Aincrad
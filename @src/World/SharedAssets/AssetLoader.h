@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "Asset.h"
+
+namespace Aincrad {
+namespace World {
+
+// Handle returned by asynchronous loads. The asset pointer is valid
+// immediately; its payload is usable once the future becomes ready.
+struct AssetLoadHandle {
+    std::shared_ptr<Asset> asset;
+    std::shared_future<void> ready;
+
+    bool isReady() const {
+        return ready.valid() &&
+               ready.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+};
+
+class AssetLoader {
+public:
+    // A workerCount of 0 sizes the pool from the hardware concurrency
+    explicit AssetLoader(size_t workerCount = 0);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Queue a load task. Streaming tasks always run before Background tasks;
+    // within a strategy, higher priority runs first, then submission order.
+    void submit(int priority, AssetLoadingConfig::LoadingStrategy strategy, std::function<void()> task);
+
+    // Run work(0) .. work(count - 1) across the pool and return once all have
+    // run, rethrowing the first failure. The caller works through items too and
+    // never waits on queued helpers, so this is safe to call from a load task.
+    void parallelFor(size_t count, const std::function<void(size_t)>& work, int priority,
+                     AssetLoadingConfig::LoadingStrategy strategy);
+
+    // Drop every queued task but keep the workers; running tasks finish.
+    // Abandoned promises report broken_promise to waiters.
+    void cancelQueued();
+
+    // Getters; the counts are lock-free and may trail the queue slightly
+    size_t getWorkerCount() const { return m_workers.size(); }
+    size_t getQueueDepth() const { return m_queueDepth.load(std::memory_order_relaxed); }
+    size_t getActiveTaskCount() const { return m_activeTasks.load(std::memory_order_relaxed); }
+
+private:
+    struct Task {
+        int band;
+        int priority;
+        uint64_t sequence;
+        std::function<void()> work;
+    };
+
+    struct TaskOrder {
+        bool operator()(const Task& a, const Task& b) const;
+    };
+
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::priority_queue<Task, std::vector<Task>, TaskOrder> m_tasks;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    uint64_t m_nextSequence;
+    bool m_stopping;
+    std::atomic<size_t> m_queueDepth;
+    std::atomic<size_t> m_activeTasks;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -1,16 +1,194 @@
 #include "AssetManager.h"
+#include "AssetArchive.h"
+#include "MeshFormat.h"
+#include "TextureFormat.h"
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
-#include <json/json.h>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_set>
 
 namespace Aincrad {
 namespace World {
 
-AssetManager::AssetManager() {
+namespace {
+
+// Shared by the completion callbacks of one loadAssetGraph call
+struct GraphLoadState {
+    AssetDependencyGraph graph;
+    AssetHandleMap<std::shared_ptr<Asset>> assets;
+    AssetLoadingConfig config;
+    AssetLoader* loader = nullptr;
+    std::function<void(const std::shared_ptr<Asset>&)> onQueued;
+
+    std::mutex mutex;
+    AssetHandleMap<size_t> remainingDependencies;
+    size_t pendingAssets = 0;
+    bool settled = false;
+    std::promise<void> promise;
+};
+
+void failGraphLoad(GraphLoadState& state, const std::string& message) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.settled) {
+        state.settled = true;
+        state.promise.set_exception(std::make_exception_ptr(std::runtime_error(message)));
+    }
+}
+
+void launchGraphNode(const std::shared_ptr<GraphLoadState>& state, AssetHandle id) {
+    const auto& asset = state->assets.at(id);
+    try {
+        asset->load(state->config, state->loader);
+    } catch (const std::exception& e) {
+        failGraphLoad(*state, "Failed to queue asset " + asset->getMetadata().assetId + ": " + e.what());
+        return;
+    }
+    state->onQueued(asset);
+
+    asset->whenLoaded([state, id]() {
+        const auto& loaded = state->assets.at(id);
+        if (!loaded->isLoaded()) {
+            failGraphLoad(*state, "Failed to load asset " + loaded->getMetadata().assetId + " while loading " +
+                state->assets.at(state->graph.root)->getMetadata().assetId);
+            return;
+        }
+
+        std::vector<AssetHandle> ready;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->settled) {
+                return;
+            }
+            if (--state->pendingAssets == 0) {
+                state->settled = true;
+                state->promise.set_value();
+                return;
+            }
+
+            auto dependents = state->graph.dependents.find(id);
+            if (dependents != state->graph.dependents.end()) {
+                for (AssetHandle dependent : dependents->second) {
+                    if (--state->remainingDependencies[dependent] == 0) {
+                        ready.push_back(dependent);
+                    }
+                }
+            }
+        }
+
+        // Launch outside the lock; a resident asset completes synchronously
+        for (AssetHandle dependent : ready) {
+            launchGraphNode(state, dependent);
+        }
+    });
+}
+
+// Longest run of same-file reads handed to one worker; keeps big files
+// from serializing the whole batch on one thread
+constexpr size_t MaxBatchReadRun = 64;
+
+// Physical read order: by file, then position. Archive payloads are laid out
+// in entry name order, so the name stands in for their offset.
+bool readsBefore(const std::shared_ptr<Asset>& a, const std::shared_ptr<Asset>& b) {
+    const AssetMetadata& left = a->getMetadata();
+    const AssetMetadata& right = b->getMetadata();
+    return std::tie(left.sourcePath, left.sourceOffset, left.archiveEntry) <
+           std::tie(right.sourcePath, right.sourceOffset, right.archiveEntry);
+}
+
+std::string describeFailure(const std::shared_future<void>& future) {
+    try {
+        future.get();
+    } catch (const std::exception& e) {
+        return e.what();
+    } catch (...) {
+        return "Unknown error";
+    }
+    return std::string();
+}
+
+// Watcher paths and metadata paths may be relative or go through symlinks
+std::string normalizeAssetPath(const std::string& path) {
+    std::error_code error;
+    auto normalized = std::filesystem::weakly_canonical(path, error);
+    if (error) {
+        normalized = std::filesystem::absolute(path, error).lexically_normal();
+    }
+    return normalized.string();
+}
+
+// Trims a full-quality or already reduced payload at level current down to
+// level; nullopt when it has nothing left to drop
+using PayloadTrim = std::function<std::optional<std::vector<uint8_t>>(
+    const std::vector<uint8_t>& payload, uint32_t current, uint32_t level)>;
+
+// Built-in quality steps: going down trims the resident payload, going back
+// up reads the full payload again and trims that to the level
+std::optional<size_t> stepQuality(Asset& asset, uint32_t level, AssetLoader* loader, const PayloadTrim& trim) {
+    if (level < asset.getQualityLevel() && !asset.restorePayload(loader)) {
+        return std::nullopt;
+    }
+    uint32_t current = asset.getQualityLevel();
+    auto payload = asset.getPayload();
+    if (!payload) {
+        return std::nullopt;
+    }
+    if (level == current) {
+        return payload->size();
+    }
+
+    auto trimmed = trim(*payload, current, level);
+    if (!trimmed) {
+        return std::nullopt;
+    }
+    size_t size = trimmed->size();
+    if (!asset.replacePayload(std::move(*trimmed), level)) {
+        return std::nullopt;
+    }
+    return size;
+}
+
+std::optional<std::vector<uint8_t>> trimTexture(const std::vector<uint8_t>& payload, uint32_t current,
+                                                uint32_t level) {
+    // A reduced texture is a smaller texture, so only the extra levels drop
+    if (!TextureView::isTexture(payload.data(), payload.size()) ||
+        level - current >= TextureView(payload.data(), payload.size()).mipCount()) {
+        return std::nullopt;
+    }
+    return dropTopMips(payload.data(), payload.size(), level - current);
+}
+
+std::optional<std::vector<uint8_t>> trimMesh(const std::vector<uint8_t>& payload, uint32_t, uint32_t level) {
+    // LOD 0 is stored last, so without the finest LODs the payload is a
+    // prefix that MeshView still reads; its LOD table keeps every level
+    if (!MeshView::isMesh(payload.data(), payload.size())) {
+        return std::nullopt;
+    }
+    MeshView view(payload.data(), payload.size());
+    if (level >= view.lodCount()) {
+        return std::nullopt;
+    }
+    return std::vector<uint8_t>(payload.begin(), payload.begin() + view.residentSize(level));
+}
+
+} // namespace
+
+AssetManager::AssetManager()
+    : m_updateList(std::make_shared<UpdateList>())
+    , m_unloadQueue(std::make_shared<UnloadQueue>())
+    , m_unloadBudget(std::chrono::milliseconds(1))
+    , m_telemetry(std::make_shared<AssetTelemetry>())
+    , m_blobStore(std::make_shared<AssetBlobStore>())
+{
     initializeAssetDatabase();
+    initializeAssetLoader();
     initializeStreamingSystem();
     initializeMemoryManager();
+    initializePrefetcher();
 }
 
 AssetManager::~AssetManager() {
@@ -28,6 +206,11 @@ void AssetManager::initializeAssetDatabase() {
     initializePlatformSettings();
 }
 
+void AssetManager::initializeAssetLoader() {
+    // Initialize the worker pool used for asynchronous loads
+    m_assetLoader = std::make_unique<AssetLoader>();
+}
+
 void AssetManager::initializeStreamingSystem() {
     // Initialize streaming system
     m_streamingSystem = std::make_unique<StreamingSystem>();
@@ -37,9 +220,19 @@ void AssetManager::initializeStreamingSystem() {
     config.enableStreaming = true;
     config.streamBufferSize = 1024 * 1024; // 1MB buffer
     config.streamDistance = 100.0f;
-    config.strategy = StreamingStrategy::DistanceBased;
+    config.strategy = StreamingConfig::StreamingStrategy::DistanceBased;
     
     m_streamingSystem->configure(config);
+    m_streamingSystem->setCallbacks(
+        [this](AssetHandle handle, int priority) {
+            return loadAssetAsync(handle, priority, AssetLoadingConfig::LoadingStrategy::Streaming);
+        },
+        [this](AssetHandle handle) {
+            // Only frees the asset if nothing else is still using it. Like
+            // unloadAsset, the budget stays charged until the payload is
+            // retired at the frame boundary.
+            evictAsset(handle);
+        });
 }
 
 void AssetManager::initializeMemoryManager() {
@@ -50,47 +243,73 @@ void AssetManager::initializeMemoryManager() {
     MemoryConfig config;
     config.maxMemoryUsage = 1024 * 1024 * 1024; // 1GB max memory
     config.enablePaging = true;
-    config.strategy = PagingStrategy::PoolAllocation;
+    config.strategy = MemoryConfig::PagingStrategy::PoolAllocation;
     
     m_memoryManager->configure(config);
+    m_memoryManager->setEvictionCallback([this](AssetHandle handle) {
+        return evictAsset(handle);
+    });
+    m_memoryManager->setQualityCallback([this](AssetHandle handle, uint32_t level) {
+        return changeAssetQuality(handle, level);
+    });
+    // Cache hits stamp the asset instead of taking the manager's lock
+    m_memoryManager->setUseStampCallback([this](AssetHandle handle) -> uint64_t {
+        auto asset = m_loadedAssets.find(handle);
+        return asset ? asset->getLastUse() : 0;
+    });
+
+    // Textures step down a mip and meshes a LOD at a time
+    setQualityHandler("texture", [this](const std::shared_ptr<Asset>& asset, uint32_t level) {
+        return stepQuality(*asset, level, m_assetLoader.get(), trimTexture);
+    });
+    setQualityHandler("model", [this](const std::shared_ptr<Asset>& asset, uint32_t level) {
+        return stepQuality(*asset, level, m_assetLoader.get(), trimMesh);
+    });
+}
+
+void AssetManager::initializePrefetcher() {
+    m_prefetcher = std::make_unique<AssetPrefetcher>();
+
+    // Background loads only run once streaming and explicit loads are served
+    m_prefetcher->setCallback([this](const std::string& assetId, int priority) {
+        AssetHandle handle = m_assetDatabase->getHandle(assetId);
+        if (!handle.isValid()) {
+            return; // Floor sets may list assets this build does not ship
+        }
+        try {
+            loadAssetAsync(handle, priority, AssetLoadingConfig::LoadingStrategy::Background);
+        } catch (const std::exception&) {
+            // Prefetching is best effort; a real load will report the error
+        }
+    });
 }
 
 void AssetManager::loadAssetMetadata() {
-    // Load asset metadata from JSON file
+    // Prefer the compiled index: mapping it is O(1) regardless of asset count
+    if (std::filesystem::exists("assets/metadata.bin")) {
+        auto index = std::make_shared<AssetMetadataIndex>();
+        index->open("assets/metadata.bin");
+        m_assetDatabase->attachIndex(index);
+        return;
+    }
+
+    // Fall back to parsing the source JSON
     std::ifstream file("assets/metadata.json");
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open asset metadata file");
     }
     
-    Json::Value root;
-    Json::Reader reader;
-    if (!reader.parse(file, root)) {
-        throw std::runtime_error("Failed to parse asset metadata");
-    }
-    
-    // Process each asset entry
-    for (const auto& asset : root["assets"]) {
-        AssetMetadata metadata;
-        metadata.assetId = asset["id"].asString();
-        metadata.assetType = asset["type"].asString();
-        
-        // Process platforms
-        for (const auto& platform : asset["platforms"]) {
-            metadata.platforms.push_back(platform.asString());
-        }
-        
-        // Process dependencies
-        for (const auto& dependency : asset["dependencies"]) {
-            metadata.dependencies.push_back(dependency.asString());
-        }
-        
-        // Add metadata to database
+    // Add metadata to database
+    for (const auto& metadata : parseAssetMetadataJson(file)) {
         m_assetDatabase->addAssetMetadata(metadata);
     }
 }
 
 void AssetManager::initializePlatformSettings() {
-    // Initialize platform-specific settings
+    m_platformSettings = defaultPlatformSettings();
+}
+
+PlatformSpecificSettings AssetManager::defaultPlatformSettings() {
     PlatformSpecificSettings settings;
     
     // Windows settings
@@ -98,18 +317,21 @@ void AssetManager::initializePlatformSettings() {
     settings.windows.shaderCompilation = true;
     settings.windows.textureCompression = true;
     settings.windows.memoryManagement = true;
+    settings.windows.audioSampleRate = 48000;
     
     // Mac settings
     settings.mac.meshOptimization = true;
     settings.mac.shaderCompilation = true;
     settings.mac.textureCompression = true;
     settings.mac.memoryManagement = true;
+    settings.mac.audioSampleRate = 48000;
     
     // Linux settings
     settings.linux.meshOptimization = true;
     settings.linux.shaderCompilation = true;
     settings.linux.textureCompression = true;
     settings.linux.memoryManagement = true;
+    settings.linux.audioSampleRate = 48000;
     
     // VR settings
     settings.vr.motionControllerOptimization = true;
@@ -117,72 +339,661 @@ void AssetManager::initializePlatformSettings() {
     settings.vr.performanceOptimization = true;
     settings.vr.assetStreaming = true;
     
-    m_platformSettings = settings;
+    return settings;
 }
 
-std::shared_ptr<Asset> AssetManager::loadAsset(const std::string& assetId) {
-    // Check if asset is already loaded
-    auto it = m_loadedAssets.find(assetId);
-    if (it != m_loadedAssets.end()) {
-        return it->second;
+AssetLoadingConfig AssetManager::makeLoadingConfig(bool async, int priority, AssetLoadingConfig::LoadingStrategy strategy) const {
+    AssetLoadingConfig config;
+    config.asyncLoading = async;
+    config.streaming = strategy == AssetLoadingConfig::LoadingStrategy::Streaming;
+    config.priority = priority;
+    config.strategy = strategy;
+
+    // Pick the settings for the platform we were built for
+#if defined(PLATFORM_WINDOWS)
+    config.platformSettings = m_platformSettings.windows;
+#elif defined(PLATFORM_MACOS)
+    config.platformSettings = m_platformSettings.mac;
+#else
+    config.platformSettings = m_platformSettings.linux;
+#endif
+
+    return config;
+}
+
+AssetHandle AssetManager::resolveHandle(const std::string& assetId) {
+    AssetHandle handle = m_assetDatabase->getHandle(assetId);
+    if (!handle.isValid()) {
+        throw std::runtime_error("Asset not found: " + assetId);
+    }
+    return handle;
+}
+
+std::shared_ptr<Asset> AssetManager::findOrCreateAsset(AssetHandle handle) {
+    // Fast path: resolve an already registered asset under a shared shard lock
+    auto asset = m_loadedAssets.find(handle);
+    if (asset) {
+        m_telemetry->recordCacheHit();
+        asset->markUsed(m_memoryManager->nextUseStamp());
+        return asset;
     }
     
-    // Get asset metadata
-    auto metadata = m_assetDatabase->getAssetMetadata(assetId);
-    if (!metadata) {
-        throw std::runtime_error("Asset not found: " + assetId);
+    // Racing callers for the same handle all receive the single inserted asset
+    auto [created, inserted] = m_loadedAssets.findOrInsert(handle, [this, handle]() {
+        // Get asset metadata
+        auto metadata = m_assetDatabase->getAssetMetadata(handle);
+        if (!metadata) {
+            throw std::runtime_error("Asset not found: handle " + std::to_string(handle.index));
+        }
+        auto asset = std::make_shared<Asset>(*metadata, handle);
+        std::shared_ptr<AssetTelemetry> telemetry = m_telemetry;
+        asset->setLoadObserver([telemetry](const Asset& loaded, bool succeeded) {
+            auto payload = loaded.getPayload();
+            telemetry->recordLoad(loaded.getMetadata().assetType, loaded.getLoadDuration(),
+                                  payload ? payload->size() : 0, succeeded);
+        });
+        asset->setBlobStore(m_blobStore);
+        asset->setStreamingReader(m_streamingSystem->getReader());
+        std::shared_ptr<UpdateList> updateList = m_updateList;
+        asset->setUpdateScheduler([updateList](std::shared_ptr<Asset> scheduled) {
+            std::lock_guard<std::mutex> lock(updateList->mutex);
+            updateList->assets.push_back(std::move(scheduled));
+            updateList->size.store(updateList->assets.size(), std::memory_order_relaxed);
+        });
+        return asset;
+    });
+    if (inserted) {
+        m_telemetry->recordCacheMiss();
+    } else {
+        m_telemetry->recordCacheHit();
     }
+    return created;
+}
+
+std::shared_ptr<Asset> AssetManager::loadAsset(const std::string& assetId) {
+    return loadAsset(resolveHandle(assetId));
+}
+
+std::shared_ptr<Asset> AssetManager::loadAsset(AssetHandle handle) {
+    auto asset = findOrCreateAsset(handle);
     
-    // Create asset loading configuration
-    AssetLoadingConfig config;
-    config.asyncLoading = true;
-    config.streaming = true;
-    config.priority = 1;
-    config.strategy = LoadingStrategy::Streaming;
-    config.platformSettings = m_platformSettings;
+    // Load on the calling thread, or wait for a load already queued elsewhere
+    auto config = makeLoadingConfig(false, 1, AssetLoadingConfig::LoadingStrategy::Immediate);
+    auto ready = asset->load(config, m_assetLoader.get());
+    trackWhenLoaded(asset);
+    ready.get();
     
-    // Load asset
-    auto asset = std::make_shared<Asset>(metadata);
-    asset->load(config);
+    return asset;
+}
+
+AssetLoadHandle AssetManager::loadAssetAsync(const std::string& assetId, int priority,
+    AssetLoadingConfig::LoadingStrategy strategy) {
+    return loadAssetAsync(resolveHandle(assetId), priority, strategy);
+}
+
+AssetLoadHandle AssetManager::loadAssetAsync(AssetHandle assetHandle, int priority,
+    AssetLoadingConfig::LoadingStrategy strategy) {
+    auto asset = findOrCreateAsset(assetHandle);
     
-    // Add to loaded assets
-    m_loadedAssets[assetId] = asset;
+    auto config = makeLoadingConfig(true, priority, strategy);
+    AssetLoadHandle handle;
+    handle.asset = asset;
+    handle.ready = asset->load(config, m_assetLoader.get());
+    trackWhenLoaded(asset);
     
-    return asset;
+    return handle;
+}
+
+void AssetManager::trackWhenLoaded(const std::shared_ptr<Asset>& asset) {
+    // Charge resident payloads to the memory budget; repeat calls for the
+    // same load only refresh the numbers
+    std::weak_ptr<Asset> weak = asset;
+    asset->whenLoaded([this, weak]() {
+        // An asset unloaded while its load ran is no longer charged
+        auto loaded = weak.lock();
+        auto payload = loaded ? loaded->getPayload() : nullptr;
+        if (payload && loaded->isLoaded() && m_loadedAssets.find(loaded->getHandle()) == loaded) {
+            m_memoryManager->trackAsset(loaded->getHandle(), payload->size(),
+                                        loaded->getLoadDuration(), loaded->getMetadata().assetType);
+            if (loaded->isPartial()) {
+                refineAsset(loaded);
+            }
+        }
+    });
+}
+
+void AssetManager::refineAsset(const std::shared_ptr<Asset>& asset) {
+    // The rest of a coarse-first load reads at background priority, so every
+    // waiting load draws something before any of them gets its detail
+    std::weak_ptr<Asset> weak = asset;
+    AssetLoader* loader = m_assetLoader.get();
+    m_assetLoader->submit(0, AssetLoadingConfig::LoadingStrategy::Background,
+                          [this, weak, loader]() {
+        auto refining = weak.lock();
+        if (!refining || m_loadedAssets.find(refining->getHandle()) != refining) {
+            return;
+        }
+        try {
+            auto payload = refining->refinePayload(loader) ? refining->getPayload() : nullptr;
+            if (payload) {
+                m_memoryManager->trackAsset(refining->getHandle(), payload->size(),
+                                            refining->getLoadDuration(), refining->getMetadata().assetType, true);
+            }
+        } catch (const std::exception&) {
+            // The prefix stays resident; a quality restore or reload reads it again
+        }
+    });
+}
+
+bool AssetManager::evictAsset(AssetHandle handle) {
+    // Only the cache may hold the asset; anything else still using it keeps it
+    auto asset = m_loadedAssets.eraseIf(handle, [](const std::shared_ptr<Asset>& candidate) {
+        return candidate.use_count() == 1 && candidate->isLoaded();
+    });
+    if (!asset) {
+        return false;
+    }
+    queueUnload(std::move(asset));
+    return true;
+}
+
+void AssetManager::queueUnload(std::shared_ptr<Asset> asset) {
+    std::lock_guard<std::mutex> lock(m_unloadQueue->mutex);
+    m_unloadQueue->pending.push_back(std::move(asset));
+    m_unloadQueue->size.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AssetManager::retireUnloads(bool flush) {
+    std::vector<std::shared_ptr<Asset>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_unloadQueue->mutex);
+        pending.swap(m_unloadQueue->pending);
+    }
+    if (pending.empty()) {
+        return;
+    }
+
+    // Budget is released a chunk at a time under one lock; the clock is only
+    // checked between chunks, and at least one chunk retires every frame
+    constexpr size_t ChunkSize = 64;
+    auto deadline = std::chrono::steady_clock::now() + m_unloadBudget;
+    std::vector<std::shared_ptr<Asset>> batch;
+    std::vector<std::shared_ptr<Asset>> carried;
+    std::vector<AssetHandle> handles;
+    size_t next = 0;
+    do {
+        size_t end = std::min(pending.size(), next + ChunkSize);
+        handles.clear();
+        for (; next < end; ++next) {
+            auto& asset = pending[next];
+            // A worker must not wait on a load that may be queued behind it
+            if (!flush && asset->getLoadState() == AssetLoadState::Loading) {
+                carried.push_back(std::move(asset));
+                continue;
+            }
+            // A handle loaded again since keeps its budget for the new asset
+            if (!m_loadedAssets.find(asset->getHandle())) {
+                handles.push_back(asset->getHandle());
+            }
+            batch.push_back(std::move(asset));
+        }
+        if (m_memoryManager) {
+            m_memoryManager->deallocateMemory(handles);
+        }
+    } while (next < pending.size() && (flush || std::chrono::steady_clock::now() < deadline));
+
+    carried.insert(carried.end(), std::make_move_iterator(pending.begin() + next),
+                   std::make_move_iterator(pending.end()));
+    {
+        std::lock_guard<std::mutex> lock(m_unloadQueue->mutex);
+        // Ahead of anything unloaded since the swap, to keep the order
+        m_unloadQueue->pending.insert(m_unloadQueue->pending.begin(), std::make_move_iterator(carried.begin()),
+                                      std::make_move_iterator(carried.end()));
+        if (batch.empty()) {
+            return;
+        }
+        m_unloadQueue->retired.push_back(std::move(batch));
+    }
+
+    // Releasing runs ahead of background prefetches so the memory comes back first
+    if (!flush && m_assetLoader) {
+        auto queue = m_unloadQueue;
+        m_assetLoader->submit(std::numeric_limits<int>::max(), AssetLoadingConfig::LoadingStrategy::Background,
+                              [queue]() { queue->releaseBatch(); });
+    }
+}
+
+void AssetManager::UnloadQueue::releaseBatch() {
+    std::vector<std::shared_ptr<Asset>> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (retired.empty()) {
+            return; // Already taken by flushUnloads
+        }
+        batch = std::move(retired.front());
+        retired.pop_front();
+        ++releasing;
+    }
+
+    // Usually the last references, so the payloads are freed here
+    size_t count = batch.size();
+    for (const auto& asset : batch) {
+        asset->unload();
+    }
+    batch.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --releasing;
+        size.fetch_sub(count, std::memory_order_relaxed);
+    }
+    released.notify_all();
+}
+
+void AssetManager::flushUnloads() {
+    retireUnloads(true);
+
+    // Take every retired batch, including those no worker has reached yet
+    std::vector<std::shared_ptr<Asset>> assets;
+    {
+        std::lock_guard<std::mutex> lock(m_unloadQueue->mutex);
+        for (auto& batch : m_unloadQueue->retired) {
+            assets.insert(assets.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        }
+        m_unloadQueue->retired.clear();
+    }
+
+    // In-flight loads settle on this thread so no worker waits on the pool
+    for (const auto& asset : assets) {
+        if (asset->getLoadState() == AssetLoadState::Loading) {
+            asset->unload();
+        }
+    }
+    auto release = [&assets](size_t i) {
+        assets[i]->unload();
+        assets[i].reset();
+    };
+    if (m_assetLoader) {
+        m_assetLoader->parallelFor(assets.size(), release, 0, AssetLoadingConfig::LoadingStrategy::Immediate);
+    } else {
+        for (size_t i = 0; i < assets.size(); ++i) {
+            release(i);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_unloadQueue->mutex);
+    m_unloadQueue->size.fetch_sub(assets.size(), std::memory_order_relaxed);
+    m_unloadQueue->released.wait(lock, [this]() { return m_unloadQueue->releasing == 0; });
+}
+
+void AssetManager::setQualityHandler(const std::string& assetType, AssetQualityHandler handler) {
+    std::lock_guard<std::mutex> lock(m_qualityHandlerMutex);
+    m_qualityHandlers[assetType] = std::move(handler);
+}
+
+std::optional<size_t> AssetManager::changeAssetQuality(AssetHandle handle, uint32_t level) {
+    auto asset = m_loadedAssets.find(handle);
+    if (!asset || !asset->isLoaded()) {
+        return std::nullopt;
+    }
+
+    AssetQualityHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(m_qualityHandlerMutex);
+        auto it = m_qualityHandlers.find(asset->getMetadata().assetType);
+        if (it == m_qualityHandlers.end()) {
+            return std::nullopt; // This type can only be evicted
+        }
+        handler = it->second;
+    }
+
+    // A payload that no longer parses, or a file gone since the load, only
+    // means this asset cannot change quality
+    try {
+        return handler(asset, level);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::vector<AssetBatchResult> AssetManager::loadAssets(const std::vector<std::string>& assetIds, int priority) {
+    std::vector<AssetBatchResult> results(assetIds.size());
+    std::vector<std::vector<AssetHandle>> closures(assetIds.size());
+    AssetHandleMap<size_t> resolvedRoots; // First request of each root; repeats share its closure
+    AssetHandleMap<std::shared_ptr<Asset>> assets;
+    AssetHandleMap<std::string> failures;
+
+    // Resolve every ID and merge the dependency closures, each asset once
+    for (size_t i = 0; i < assetIds.size(); ++i) {
+        AssetBatchResult& result = results[i];
+        result.assetId = assetIds[i];
+        result.handle = m_assetDatabase->getHandle(assetIds[i]);
+        if (!result.handle.isValid()) {
+            result.error = "Asset not found: " + assetIds[i];
+            continue;
+        }
+
+        auto [root, firstRequest] = resolvedRoots.emplace(result.handle, i);
+        if (!firstRequest) {
+            closures[i] = closures[root->second];
+            result.error = results[root->second].error;
+            continue;
+        }
+        try {
+            closures[i] = m_assetDatabase->buildDependencyGraph(result.handle).order;
+            for (AssetHandle id : closures[i]) {
+                if (!assets.count(id)) {
+                    assets.emplace(id, findOrCreateAsset(id));
+                }
+            }
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+    }
+
+    // Sort the reads that are still needed, then hand each worker a run of
+    // neighbouring reads from one file; everything else is already resident
+    // or in flight and only needs its future
+    AssetHandleMap<std::shared_future<void>> futures;
+    std::vector<std::shared_ptr<Asset>> reads;
+    auto config = makeLoadingConfig(false, priority, AssetLoadingConfig::LoadingStrategy::Immediate);
+    for (const auto& [id, asset] : assets) {
+        AssetLoadState state = asset->getLoadState();
+        if (state == AssetLoadState::Unloaded || state == AssetLoadState::Failed) {
+            reads.push_back(asset);
+        } else {
+            futures[id] = asset->load(config, m_assetLoader.get());
+        }
+    }
+    std::sort(reads.begin(), reads.end(), readsBefore);
+
+    struct ReadRun {
+        std::vector<std::shared_ptr<Asset>> assets;
+        std::vector<std::shared_future<void>> loads;
+        std::promise<void> done;
+    };
+    std::vector<std::shared_ptr<ReadRun>> runs;
+    for (size_t begin = 0; begin < reads.size();) {
+        size_t end = begin + 1;
+        while (end < reads.size() && end - begin < MaxBatchReadRun &&
+               reads[end]->getMetadata().sourcePath == reads[begin]->getMetadata().sourcePath) {
+            ++end;
+        }
+
+        auto run = std::make_shared<ReadRun>();
+        run->assets.assign(reads.begin() + begin, reads.begin() + end);
+        runs.push_back(run);
+        try {
+            // Immediate loads read inline; the loader is only handed on so
+            // compressed payloads can spread their blocks across workers
+            AssetLoader* loader = m_assetLoader.get();
+            m_assetLoader->submit(priority, AssetLoadingConfig::LoadingStrategy::Streaming, [run, config, loader]() {
+                try {
+                    for (const auto& asset : run->assets) {
+                        run->loads.push_back(asset->load(config, loader));
+                    }
+                    run->done.set_value();
+                } catch (...) {
+                    run->done.set_exception(std::current_exception());
+                }
+            });
+        } catch (const std::exception&) {
+            runs.pop_back(); // Loader shutting down; failed below like a dropped run
+            for (const auto& asset : run->assets) {
+                failures[asset->getHandle()] = "Asset loader is shutting down";
+            }
+        }
+        begin = end;
+    }
+
+    for (const auto& run : runs) {
+        // A run dropped by a stopping loader reports broken_promise here
+        std::string error = describeFailure(run->done.get_future().share());
+        for (size_t i = 0; i < run->assets.size(); ++i) {
+            AssetHandle id = run->assets[i]->getHandle();
+            if (error.empty()) {
+                futures[id] = run->loads[i];
+            } else {
+                failures[id] = error;
+            }
+        }
+    }
+    for (const auto& [id, future] : futures) {
+        std::string error = describeFailure(future);
+        if (!error.empty()) {
+            failures[id] = error;
+        }
+    }
+    for (const auto& [id, asset] : assets) {
+        trackWhenLoaded(asset);
+    }
+
+    // An asset only succeeds if its whole closure is resident
+    for (size_t i = 0; i < results.size(); ++i) {
+        AssetBatchResult& result = results[i];
+        if (!result.error.empty() || !result.handle.isValid()) {
+            continue;
+        }
+        for (AssetHandle id : closures[i]) {
+            auto failure = failures.find(id);
+            if (failure == failures.end()) {
+                continue;
+            }
+            result.error = id == result.handle ? failure->second
+                : "Failed to load dependency " + assets.at(id)->getMetadata().assetId + ": " + failure->second;
+            break;
+        }
+        if (result.error.empty()) {
+            result.asset = assets.at(result.handle);
+        }
+    }
+
+    return results;
+}
+
+AssetGraphLoadHandle AssetManager::loadAssetGraph(const std::string& assetId, int priority,
+    AssetLoadingConfig::LoadingStrategy strategy) {
+    return loadAssetGraph(resolveHandle(assetId), priority, strategy);
+}
+
+AssetGraphLoadHandle AssetManager::loadAssetGraph(AssetHandle root, int priority,
+    AssetLoadingConfig::LoadingStrategy strategy) {
+    auto state = std::make_shared<GraphLoadState>();
+    state->graph = m_assetDatabase->buildDependencyGraph(root);
+    for (AssetHandle id : state->graph.order) {
+        state->assets[id] = findOrCreateAsset(id);
+        state->remainingDependencies[id] = state->graph.dependencies[id].size();
+    }
+    state->pendingAssets = state->graph.order.size();
+    state->config = makeLoadingConfig(true, priority, strategy);
+    state->loader = m_assetLoader.get();
+    state->onQueued = [this](const std::shared_ptr<Asset>& asset) {
+        trackWhenLoaded(asset);
+    };
+
+    AssetGraphLoadHandle handle;
+    handle.asset = state->assets[root];
+    handle.ready = state->promise.get_future().share();
+    handle.graph = state->graph;
+    handle.assets = state->assets;
+
+    // The first wave has no dependencies and can start right away
+    for (AssetHandle id : state->graph.waves.front()) {
+        launchGraphNode(state, id);
+    }
+
+    return handle;
+}
+
+AssetCriticalPath AssetGraphLoadHandle::criticalPath() const {
+    AssetHandleMap<std::chrono::microseconds> costs;
+    for (const auto& [id, asset] : assets) {
+        costs[id] = asset->getLoadDuration();
+    }
+    return graph.criticalPath(costs);
 }
 
 void AssetManager::unloadAsset(const std::string& assetId) {
-    auto it = m_loadedAssets.find(assetId);
-    if (it != m_loadedAssets.end()) {
-        it->second->unload();
-        m_loadedAssets.erase(it);
+    AssetHandle handle = m_assetDatabase->getHandle(assetId);
+    if (handle.isValid()) {
+        unloadAsset(handle);
+    }
+}
+
+void AssetManager::unloadAsset(AssetHandle handle) {
+    // Detached now; the payload and its budget go at the frame boundary
+    auto asset = m_loadedAssets.erase(handle);
+    if (asset) {
+        queueUnload(std::move(asset));
+    } else {
+        m_memoryManager->deallocateMemory(handle);
     }
 }
 
+void AssetManager::enableHotReload(const std::vector<std::string>& directories, AssetReloadCallback callback) {
+    disableHotReload();
+    m_reloadCallback = std::move(callback);
+    m_assetWatcher = std::make_unique<AssetWatcher>();
+    m_assetWatcher->start(directories, [this](const std::vector<std::string>& paths) {
+        reloadChangedFiles(paths);
+    });
+}
+
+void AssetManager::disableHotReload() {
+    // Joins the watcher thread, so no reload is running once this returns
+    m_assetWatcher.reset();
+    m_reloadCallback = nullptr;
+}
+
+void AssetManager::reloadChangedFiles(const std::vector<std::string>& paths) {
+    std::unordered_set<std::string> changed;
+    for (const auto& path : paths) {
+        changed.insert(normalizeAssetPath(path));
+    }
+
+    // Assets backed by a changed file first, then loaded dependents breadth
+    // first so each asset reloads after what it depends on changed
+    std::vector<std::shared_ptr<Asset>> pending;
+    std::unordered_set<AssetHandle, AssetHandleHash> queued;
+    for (auto& asset : m_loadedAssets.values()) {
+        const AssetMetadata& metadata = asset->getMetadata();
+        if (asset->isLoaded() && !metadata.sourcePath.empty() &&
+            changed.count(normalizeAssetPath(metadata.sourcePath))) {
+            if (!metadata.archiveEntry.empty()) {
+                AssetArchive::releaseShared(metadata.sourcePath);
+            }
+            queued.insert(asset->getHandle());
+            pending.push_back(std::move(asset));
+        }
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        auto asset = pending[i];
+        std::exception_ptr error;
+        try {
+            auto payload = asset->reload(m_assetLoader.get()) ? asset->getPayload() : nullptr;
+            if (payload) {
+                m_telemetry->recordReload(payload->size());
+                m_memoryManager->trackAsset(asset->getHandle(), payload->size(),
+                                            asset->getLoadDuration(), asset->getMetadata().assetType, true);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        if (m_reloadCallback) {
+            m_reloadCallback(asset, error);
+        }
+
+        for (AssetHandle dependent : m_assetDatabase->getDependents(asset->getHandle())) {
+            auto loaded = m_loadedAssets.find(dependent);
+            if (loaded && loaded->isLoaded() && queued.insert(dependent).second) {
+                pending.push_back(std::move(loaded));
+            }
+        }
+    }
+}
+
+AssetManagerStats AssetManager::stats() const {
+    AssetManagerStats stats;
+    stats.loads = m_telemetry->snapshot();
+    if (m_assetLoader) {
+        stats.loadQueueDepth = m_assetLoader->getQueueDepth();
+        stats.activeLoads = m_assetLoader->getActiveTaskCount();
+    }
+    stats.updatingAssets = m_updateList->size.load(std::memory_order_relaxed);
+    stats.pendingUnloads = m_unloadQueue->size.load(std::memory_order_relaxed);
+    if (m_memoryManager) {
+        stats.memory = m_memoryManager->getCounters();
+    }
+    stats.blobs = m_blobStore->getStats();
+    if (m_streamingSystem) {
+        stats.streaming = m_streamingSystem->getStats();
+    }
+    return stats;
+}
+
 void AssetManager::update() {
+    // Queue prefetches before streaming so nearby streamed loads still win
+    m_prefetcher->update();
+
     // Update streaming system
     m_streamingSystem->update();
     
     // Update memory manager
     m_memoryManager->update();
+
+    // Retire this frame's unloads and evictions together
+    retireUnloads(false);
     
-    // Update loaded assets
-    for (auto& [id, asset] : m_loadedAssets) {
-        asset->update();
+    // Update only the assets with pending work; the cost follows the active
+    // set, not the resident set. Assets scheduled during this pass run next frame.
+    std::vector<std::shared_ptr<Asset>> updating;
+    {
+        std::lock_guard<std::mutex> lock(m_updateList->mutex);
+        updating.swap(m_updateList->assets);
+        m_updateList->size.store(0, std::memory_order_relaxed);
+    }
+    for (const auto& asset : updating) {
+        if (asset->update()) {
+            asset->requestUpdates();
+        }
     }
 }
 
 void AssetManager::cleanup() {
-    // Unload all assets
-    for (auto& [id, asset] : m_loadedAssets) {
-        asset->unload();
+    // Stop the watcher first so no reload runs during teardown, and drop
+    // queued loads rather than wait for them
+    disableHotReload();
+    m_prefetcher.reset();
+    if (m_assetLoader) {
+        m_assetLoader->cancelQueued();
     }
+
+    // Unload every asset in one batch across the workers, then stop them
+    auto assets = m_loadedAssets.values();
     m_loadedAssets.clear();
+    for (const auto& asset : assets) {
+        queueUnload(asset);
+    }
+    flushUnloads();
+    m_assetLoader.reset();
+
+    // A load still running during the flush may have started another
+    for (const auto& asset : assets) {
+        asset->unload();
+    }
+    assets.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_updateList->mutex);
+        m_updateList->assets.clear();
+        m_updateList->size.store(0, std::memory_order_relaxed);
+    }
     
     // Cleanup systems
     m_streamingSystem.reset();
     m_memoryManager.reset();
     m_assetDatabase.reset();
+    AssetArchive::releaseShared();
 }
 
 } // namespace World
@@ -1,24 +1,165 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "Asset.h"
+#include "AssetBlobStore.h"
 #include "AssetDatabase.h"
+#include "AssetLoader.h"
+#include "AssetPrefetcher.h"
+#include "AssetTelemetry.h"
+#include "AssetWatcher.h"
+#include "ConcurrentAssetTable.h"
 #include "StreamingSystem.h"
 #include "MemoryManager.h"
 
 namespace Aincrad {
 namespace World {
 
+struct PlatformSpecificSettings {
+    AssetLoadingConfig::PlatformSpecificSettings windows;
+    AssetLoadingConfig::PlatformSpecificSettings mac;
+    AssetLoadingConfig::PlatformSpecificSettings linux;
+    struct VRSettings {
+        bool motionControllerOptimization;
+        bool roomScaleSupport;
+        bool performanceOptimization;
+        bool assetStreaming;
+    } vr;
+};
+
+// Load of an asset together with its dependency closure
+struct AssetGraphLoadHandle {
+    std::shared_ptr<Asset> asset;
+    std::shared_future<void> ready;
+    AssetDependencyGraph graph;
+    AssetHandleMap<std::shared_ptr<Asset>> assets;
+
+    bool isReady() const {
+        return ready.valid() &&
+               ready.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Longest chain of dependent loads by measured load time; valid once ready
+    AssetCriticalPath criticalPath() const;
+};
+
+// Outcome of one requested asset in a batched load
+struct AssetBatchResult {
+    std::string assetId;
+    AssetHandle handle;            // Invalid if the ID is unknown
+    std::shared_ptr<Asset> asset;  // Set once the asset and its dependencies are resident
+    std::string error;             // Why the asset or one of its dependencies failed
+
+    bool ok() const { return asset != nullptr; }
+};
+
+// Point-in-time view of the asset pipeline; every field is read without locks
+struct AssetManagerStats {
+    AssetLoadTelemetry loads;
+    size_t loadQueueDepth = 0;  // Loads waiting for a worker
+    size_t activeLoads = 0;     // Loads running on workers
+    size_t updatingAssets = 0;  // Assets with pending per-frame work
+    size_t pendingUnloads = 0;  // Unloaded assets whose payloads are not released yet
+    MemoryStats memory;         // Counters only; MemoryManager::getStats has the category breakdown
+    AssetBlobStats blobs;       // Payloads shared between assets with the same content hash
+    StreamingStats streaming;
+};
+
+// Moves a resident asset to a quality level (0 is full; each level above
+// drops detail such as the top mip or the highest LOD) and returns its
+// resident size there, or nullopt if it cannot. Runs on the thread driving
+// memory updates, without manager locks held.
+using AssetQualityHandler = std::function<std::optional<size_t>(const std::shared_ptr<Asset>& asset, uint32_t level)>;
+
+// Reports each hot-reloaded asset; error is null when the new payload is live
+using AssetReloadCallback = std::function<void(const std::shared_ptr<Asset>& asset, std::exception_ptr error)>;
+
 class AssetManager {
 public:
     AssetManager();
     ~AssetManager();
 
     // Asset loading and unloading
+    // loadAsset blocks until the payload is resident; loadAssetAsync queues
+    // the load on the worker pool and returns immediately. String IDs are
+    // resolved to handles once; hot paths should keep and pass handles.
+    AssetHandle resolveHandle(const std::string& assetId);
     std::shared_ptr<Asset> loadAsset(const std::string& assetId);
+    std::shared_ptr<Asset> loadAsset(AssetHandle handle);
+    AssetLoadHandle loadAssetAsync(const std::string& assetId, int priority = 1,
+        AssetLoadingConfig::LoadingStrategy strategy = AssetLoadingConfig::LoadingStrategy::Streaming);
+    AssetLoadHandle loadAssetAsync(AssetHandle handle, int priority = 1,
+        AssetLoadingConfig::LoadingStrategy strategy = AssetLoadingConfig::LoadingStrategy::Streaming);
     void unloadAsset(const std::string& assetId);
+    void unloadAsset(AssetHandle handle);
+
+    // Unloads are deferred to the frame boundary. unloadAsset detaches the
+    // asset at once, so lookups miss and a later load starts fresh; update()
+    // then retires the queued unloads in batches, releasing their budget
+    // under one lock and their payloads on a background worker. Retiring
+    // stops at the budget and the rest carry over to the next frame.
+    // flushUnloads releases everything queued before it returns; it must not
+    // be called from a loader task.
+    void setUnloadBudget(std::chrono::microseconds budget) { m_unloadBudget = budget; }
+    void flushUnloads();
+
+    // Load many assets and their dependencies in one call, blocking until all
+    // have settled. The combined dependency closure is loaded once, with
+    // reads sorted by file and offset and issued in per-file runs on the
+    // worker pool. Results follow the request order; failures are reported
+    // per asset instead of thrown. Must not be called from a loader task.
+    std::vector<AssetBatchResult> loadAssets(const std::vector<std::string>& assetIds, int priority = 1);
+
+    // Load an asset and its transitive dependencies on the worker pool. Each
+    // asset starts as soon as its own dependencies are resident; shared
+    // dependencies load once. Throws on missing dependencies or cycles.
+    AssetGraphLoadHandle loadAssetGraph(const std::string& assetId, int priority = 1,
+        AssetLoadingConfig::LoadingStrategy strategy = AssetLoadingConfig::LoadingStrategy::Streaming);
+    AssetGraphLoadHandle loadAssetGraph(AssetHandle handle, int priority = 1,
+        AssetLoadingConfig::LoadingStrategy strategy = AssetLoadingConfig::LoadingStrategy::Streaming);
+
+    // Hot reload: watches the directories for rewritten payload files and
+    // re-reads the loaded assets backed by them, then their loaded
+    // dependents, in place. Handles and Asset pointers stay valid; a failed
+    // reload keeps the old payload. The callback runs on the watcher thread.
+    void enableHotReload(const std::vector<std::string>& directories, AssetReloadCallback callback = nullptr);
+    void disableHotReload();
+    void reloadChangedFiles(const std::vector<std::string>& paths);
+
+    // Positioned streaming around observers; see StreamingSystem
+    StreamingSystem& getStreamingSystem() { return *m_streamingSystem; }
+
+    // Budgets, overall and per asset type; see MemoryManager. With the
+    // QualityBased strategy, a type over budget steps its assets down
+    // through the type's quality handler before evicting any, and steps
+    // them back up once there is headroom. Textures and models come with
+    // handlers that drop top mips and finest LODs from the resident payload
+    // through Asset::replacePayload; setting a handler replaces them.
+    MemoryManager& getMemoryManager() { return *m_memoryManager; }
+    void setQualityHandler(const std::string& assetType, AssetQualityHandler handler);
+
+    // Warms floor and zone asset sets ahead of players at background
+    // priority; feed it player positions and teleport gates. See AssetPrefetcher
+    AssetPrefetcher& getPrefetcher() { return *m_prefetcher; }
+
+    // Telemetry for sizing budgets and finding slow assets; cheap enough to
+    // poll every frame
+    AssetManagerStats stats() const;
+
+    // Per-platform pipeline switches, such as whether textures ship block
+    // compressed; the import tool applies the same ones offline
+    static PlatformSpecificSettings defaultPlatformSettings();
 
     // Update and cleanup
     void update();
@@ -27,18 +168,63 @@ public:
 private:
     // Initialization
     void initializeAssetDatabase();
+    void initializeAssetLoader();
     void initializeStreamingSystem();
     void initializeMemoryManager();
+    void initializePrefetcher();
     void loadAssetMetadata();
     void initializePlatformSettings();
 
+    // Loading helpers
+    AssetLoadingConfig makeLoadingConfig(bool async, int priority, AssetLoadingConfig::LoadingStrategy strategy) const;
+    std::shared_ptr<Asset> findOrCreateAsset(AssetHandle handle);
+    void trackWhenLoaded(const std::shared_ptr<Asset>& asset);
+    void refineAsset(const std::shared_ptr<Asset>& asset);
+    bool evictAsset(AssetHandle handle);
+    void queueUnload(std::shared_ptr<Asset> asset);
+    void retireUnloads(bool flush);
+    std::optional<size_t> changeAssetQuality(AssetHandle handle, uint32_t level);
+
+    // Assets that asked to be updated next frame. Shared with the update
+    // schedulers of created assets, which may outlive the manager.
+    struct UpdateList {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Asset>> assets;
+        std::atomic<size_t> size{0};
+    };
+
+    // Unloaded assets waiting for the frame boundary, and retired batches
+    // waiting for a worker to release them. Shared with those workers.
+    struct UnloadQueue {
+        std::mutex mutex;
+        std::condition_variable released;
+        std::vector<std::shared_ptr<Asset>> pending;
+        std::deque<std::vector<std::shared_ptr<Asset>>> retired;
+        size_t releasing = 0;         // Batches being released by workers
+        std::atomic<size_t> size{0};  // Assets not released yet
+
+        // Unloads one retired batch, if any is left
+        void releaseBatch();
+    };
+
     // Systems
+    std::shared_ptr<UpdateList> m_updateList;
+    std::shared_ptr<UnloadQueue> m_unloadQueue;
+    std::chrono::microseconds m_unloadBudget;
+    std::shared_ptr<AssetTelemetry> m_telemetry; // Shared with the load observers of created assets
+    std::shared_ptr<AssetBlobStore> m_blobStore;  // Shared with created assets
     std::unique_ptr<AssetDatabase> m_assetDatabase;
     std::unique_ptr<StreamingSystem> m_streamingSystem;
+    std::unique_ptr<AssetPrefetcher> m_prefetcher;
     std::unique_ptr<MemoryManager> m_memoryManager;
+    std::unique_ptr<AssetLoader> m_assetLoader;
+    std::unique_ptr<AssetWatcher> m_assetWatcher;
+    AssetReloadCallback m_reloadCallback;
+    std::unordered_map<std::string, AssetQualityHandler> m_qualityHandlers; // By asset type
+    std::mutex m_qualityHandlerMutex;
 
-    // Asset storage
-    std::unordered_map<std::string, std::shared_ptr<Asset>> m_loadedAssets;
+    // Asset storage; safe to resolve from streaming and gameplay threads
+    ConcurrentAssetTable<AssetHandle, std::shared_ptr<Asset>, AssetHandleHash> m_loadedAssets;
 
     // Platform settings
     PlatformSpecificSettings m_platformSettings;
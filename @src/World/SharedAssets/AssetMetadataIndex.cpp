@@ -0,0 +1,341 @@
+#include "AssetMetadataIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace Aincrad {
+namespace World {
+
+namespace MetadataIndexFormat {
+
+uint64_t hash(std::string_view key, uint64_t seed) {
+    uint64_t h = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+
+    // FNV-1a alone leaves the low bits poorly mixed for short keys
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace MetadataIndexFormat
+
+using namespace MetadataIndexFormat;
+
+AssetMetadataView::AssetMetadataView(const uint8_t* base, const Header& header, const Entry& entry)
+    : m_base(base)
+    , m_header(&header)
+    , m_entry(&entry)
+{
+}
+
+// open() only checks the regions; references inside entries are checked
+// as they are read, so a corrupt entry cannot point outside the mapping
+std::string_view AssetMetadataView::string(const StringRef& ref) const {
+    if (ref.offset > m_header->stringsSize || ref.length > m_header->stringsSize - ref.offset) {
+        throw std::runtime_error("Corrupt metadata index: string out of bounds");
+    }
+    return std::string_view(reinterpret_cast<const char*>(m_base + m_header->stringsOffset + ref.offset), ref.length);
+}
+
+std::string_view AssetMetadataView::listItem(const ListRef& list, size_t index) const {
+    if (index >= list.count) {
+        throw std::out_of_range("Metadata list index out of range");
+    }
+    uint64_t itemCount = (m_header->platformSlotsOffset - m_header->listsOffset) / sizeof(StringRef);
+    if (uint64_t(list.first) + index >= itemCount) {
+        throw std::runtime_error("Corrupt metadata index: list out of bounds");
+    }
+    const auto* items = reinterpret_cast<const StringRef*>(m_base + m_header->listsOffset);
+    return string(items[list.first + index]);
+}
+
+std::string AssetMetadataView::versionString() const {
+    return m_entry->versionText.length ? std::string(string(m_entry->versionText)) : formatAssetVersion(version());
+}
+
+AssetMetadata AssetMetadataView::toMetadata() const {
+    AssetMetadata metadata;
+    metadata.assetId = std::string(assetId());
+    metadata.assetType = std::string(assetType());
+    metadata.version = versionString();
+    metadata.permissions = std::string(permissions());
+    metadata.usage = std::string(usage());
+    metadata.sourcePath = std::string(sourcePath());
+    metadata.archiveEntry = std::string(archiveEntry());
+    metadata.contentHash = std::string(contentHash());
+    metadata.sourceOffset = sourceOffset();
+    metadata.sourceSize = sourceSize();
+
+    metadata.platforms = platformNames(platforms());
+    metadata.dependencies.reserve(dependencyCount());
+    for (size_t i = 0; i < dependencyCount(); ++i) {
+        metadata.dependencies.emplace_back(dependency(i));
+    }
+
+    return metadata;
+}
+
+AssetMetadataIndex::AssetMetadataIndex()
+    : m_header(nullptr)
+    , m_buckets(nullptr)
+    , m_entries(nullptr)
+{
+}
+
+AssetMetadataIndex::~AssetMetadataIndex() {
+}
+
+void AssetMetadataIndex::open(const std::string& path) {
+    MappedFile file;
+    file.open(path);
+
+    // Validate only the header and table bounds; entries are read on demand
+    if (file.size() < sizeof(Header)) {
+        throw std::runtime_error("Metadata index too small: " + path);
+    }
+    const auto* header = reinterpret_cast<const Header*>(file.data());
+    if (header->magic != Magic || header->version != Version) {
+        throw std::runtime_error("Unsupported metadata index format: " + path);
+    }
+
+    const uint64_t size = file.size();
+    auto fits = [size](uint64_t offset, uint64_t bytes) {
+        return offset <= size && bytes <= size - offset;
+    };
+    if (header->entryCount > 0 && header->bucketCount == 0) {
+        throw std::runtime_error("Corrupt metadata index: " + path);
+    }
+    if (!fits(header->bucketsOffset, uint64_t(header->bucketCount) * sizeof(int32_t)) ||
+        !fits(header->entriesOffset, uint64_t(header->entryCount) * sizeof(Entry)) ||
+        !fits(header->stringsOffset, header->stringsSize) ||
+        header->listsOffset > header->platformSlotsOffset ||
+        header->platformSlotsOffset > header->stringsOffset ||
+        header->entriesOffset % alignof(Entry) != 0) {
+        throw std::runtime_error("Corrupt metadata index: " + path);
+    }
+    for (const ListRef& view : header->platformViews) {
+        if (view.count > header->entryCount ||
+            !fits(header->platformSlotsOffset + uint64_t(view.first) * sizeof(uint32_t),
+                  uint64_t(view.count) * sizeof(uint32_t))) {
+            throw std::runtime_error("Corrupt metadata index: " + path);
+        }
+    }
+
+    m_file = std::move(file);
+    m_header = header;
+    m_buckets = reinterpret_cast<const int32_t*>(m_file.data() + header->bucketsOffset);
+    m_entries = reinterpret_cast<const Entry*>(m_file.data() + header->entriesOffset);
+}
+
+std::optional<AssetMetadataView> AssetMetadataIndex::find(std::string_view assetId) const {
+    if (!m_header || m_header->entryCount == 0) {
+        return std::nullopt;
+    }
+
+    // Displacement lookup: negative values encode the slot directly
+    int32_t displacement = m_buckets[hash(assetId, 0) % m_header->bucketCount];
+    uint64_t slot = displacement < 0
+        ? uint64_t(-int64_t(displacement) - 1)
+        : hash(assetId, uint64_t(displacement)) % m_header->entryCount;
+    if (slot >= m_header->entryCount) {
+        return std::nullopt;
+    }
+
+    // Keys that are not in the index still land on some slot
+    AssetMetadataView view = entry(slot);
+    if (view.assetId() != assetId) {
+        return std::nullopt;
+    }
+    return view;
+}
+
+AssetMetadataView AssetMetadataIndex::entry(size_t slot) const {
+    if (!m_header || slot >= m_header->entryCount) {
+        throw std::out_of_range("Metadata index slot out of range");
+    }
+    return AssetMetadataView(m_file.data(), *m_header, m_entries[slot]);
+}
+
+AssetSlotList AssetMetadataIndex::platformSlots(AssetPlatform platform) const {
+    if (!m_header || size_t(platform) >= AssetPlatformCount) {
+        return AssetSlotList();
+    }
+    const ListRef& view = m_header->platformViews[size_t(platform)];
+    const auto* slots = reinterpret_cast<const uint32_t*>(m_file.data() + m_header->platformSlotsOffset);
+    return AssetSlotList{slots + view.first, view.count};
+}
+
+void AssetMetadataIndexWriter::add(const AssetMetadata& metadata) {
+    m_entries.push_back(metadata);
+}
+
+void AssetMetadataIndexWriter::write(const std::string& path) const {
+    const uint32_t entryCount = static_cast<uint32_t>(m_entries.size());
+    const uint32_t bucketCount = std::max<uint32_t>(1, entryCount);
+
+    // Group keys by their first-level bucket
+    std::vector<std::vector<uint32_t>> buckets(bucketCount);
+    {
+        std::unordered_map<std::string, uint32_t> seen;
+        for (uint32_t i = 0; i < entryCount; ++i) {
+            const auto& id = m_entries[i].assetId;
+            if (!seen.emplace(id, i).second) {
+                throw std::runtime_error("Duplicate asset id in metadata: " + id);
+            }
+            buckets[hash(id, 0) % bucketCount].push_back(i);
+        }
+    }
+
+    // Place the largest buckets first while the slot table is still sparse
+    std::vector<uint32_t> bucketOrder(bucketCount);
+    for (uint32_t i = 0; i < bucketCount; ++i) {
+        bucketOrder[i] = i;
+    }
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<int32_t> displacements(bucketCount, 0);
+    std::vector<int64_t> slotOwner(entryCount, -1);
+    size_t next = 0;
+    for (; next < bucketOrder.size() && buckets[bucketOrder[next]].size() > 1; ++next) {
+        const auto& keys = buckets[bucketOrder[next]];
+        std::vector<uint64_t> slots;
+        for (int32_t d = 1;; ++d) {
+            if (d == INT32_MAX) {
+                throw std::runtime_error("Failed to build perfect hash for metadata index");
+            }
+            slots.clear();
+            bool placed = true;
+            for (uint32_t key : keys) {
+                uint64_t slot = hash(m_entries[key].assetId, uint64_t(d)) % entryCount;
+                if (slotOwner[slot] >= 0 || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (placed) {
+                for (size_t k = 0; k < keys.size(); ++k) {
+                    slotOwner[slots[k]] = keys[k];
+                }
+                displacements[bucketOrder[next]] = d;
+                break;
+            }
+        }
+    }
+
+    // Single-key buckets take the remaining free slots directly
+    uint64_t freeSlot = 0;
+    for (; next < bucketOrder.size() && buckets[bucketOrder[next]].size() == 1; ++next) {
+        while (slotOwner[freeSlot] >= 0) {
+            ++freeSlot;
+        }
+        slotOwner[freeSlot] = buckets[bucketOrder[next]][0];
+        displacements[bucketOrder[next]] = -int32_t(freeSlot) - 1;
+    }
+
+    // Build the string pool, sharing repeated strings such as types and paths
+    std::string strings;
+    std::unordered_map<std::string, StringRef> pooled;
+    auto intern = [&](const std::string& value) {
+        auto it = pooled.find(value);
+        if (it != pooled.end()) {
+            return it->second;
+        }
+        if (strings.size() + value.size() > UINT32_MAX) {
+            throw std::runtime_error("Metadata index string pool exceeds 4 GB");
+        }
+        StringRef ref{uint32_t(strings.size()), uint32_t(value.size())};
+        strings += value;
+        pooled.emplace(value, ref);
+        return ref;
+    };
+
+    std::vector<StringRef> lists;
+    auto list = [&](const std::vector<std::string>& values) {
+        ListRef ref{uint32_t(lists.size()), uint32_t(values.size())};
+        for (const auto& value : values) {
+            lists.push_back(intern(value));
+        }
+        return ref;
+    };
+
+    std::vector<Entry> entries(entryCount);
+    std::vector<uint32_t> platformViews[AssetPlatformCount];
+    for (uint32_t slot = 0; slot < entryCount; ++slot) {
+        const AssetMetadata& metadata = m_entries[size_t(slotOwner[slot])];
+        Entry& entry = entries[slot];
+        try {
+            entry.platforms = toPlatformMask(metadata.platforms);
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(std::string(e.what()) + " in asset " + metadata.assetId);
+        }
+        for (size_t platform = 0; platform < AssetPlatformCount; ++platform) {
+            if (entry.platforms & platformBit(AssetPlatform(platform))) {
+                platformViews[platform].push_back(slot);
+            }
+        }
+        entry.assetId = intern(metadata.assetId);
+        entry.assetType = intern(metadata.assetType);
+        entry.permissions = intern(metadata.permissions);
+        entry.usage = intern(metadata.usage);
+        entry.sourcePath = intern(metadata.sourcePath);
+        entry.archiveEntry = intern(metadata.archiveEntry);
+        entry.contentHash = intern(metadata.contentHash);
+        StoredAssetVersion version = storeAssetVersion(metadata.version);
+        entry.version = version.packed;
+        entry.versionText = version.exact ? StringRef{0, 0} : intern(metadata.version);
+        entry.dependencies = list(metadata.dependencies);
+        entry.sourceOffset = metadata.sourceOffset;
+        entry.sourceSize = metadata.sourceSize;
+    }
+
+    auto align = [](uint64_t offset, uint64_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    };
+
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.entryCount = entryCount;
+    header.bucketCount = bucketCount;
+    header.bucketsOffset = sizeof(Header);
+    header.entriesOffset = align(header.bucketsOffset + uint64_t(bucketCount) * sizeof(int32_t), alignof(Entry));
+    header.listsOffset = header.entriesOffset + uint64_t(entryCount) * sizeof(Entry);
+    header.platformSlotsOffset = header.listsOffset + lists.size() * sizeof(StringRef);
+    std::vector<uint32_t> platformSlots;
+    for (size_t platform = 0; platform < AssetPlatformCount; ++platform) {
+        header.platformViews[platform] = ListRef{uint32_t(platformSlots.size()), uint32_t(platformViews[platform].size())};
+        platformSlots.insert(platformSlots.end(), platformViews[platform].begin(), platformViews[platform].end());
+    }
+    header.stringsOffset = header.platformSlotsOffset + platformSlots.size() * sizeof(uint32_t);
+    header.stringsSize = strings.size();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create metadata index: " + path);
+    }
+
+    const char padding[alignof(Entry)] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(displacements.data()), std::streamsize(displacements.size() * sizeof(int32_t)));
+    file.write(padding, std::streamsize(header.entriesOffset - (header.bucketsOffset + uint64_t(bucketCount) * sizeof(int32_t))));
+    file.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(entries.size() * sizeof(Entry)));
+    file.write(reinterpret_cast<const char*>(lists.data()), std::streamsize(lists.size() * sizeof(StringRef)));
+    file.write(reinterpret_cast<const char*>(platformSlots.data()), std::streamsize(platformSlots.size() * sizeof(uint32_t)));
+    file.write(strings.data(), std::streamsize(strings.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to write metadata index: " + path);
+    }
+}
+
+} // namespace World
+} // namespace Aincrad
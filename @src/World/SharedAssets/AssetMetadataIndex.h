@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Asset.h"
+#include "AssetPlatform.h"
+#include "MappedFile.h"
+
+namespace Aincrad {
+namespace World {
+
+// On-disk layout of a compiled metadata index (little-endian). Entries are
+// stored in perfect-hash slot order, so a lookup is two hashes, one table
+// read and one key comparison. All offsets are from the start of the file.
+// The slots of each platform's entries are listed up front, so a platform
+// view is a slice of the file rather than a scan.
+namespace MetadataIndexFormat {
+
+constexpr uint32_t Magic = 0x58444941; // "AIDX"
+constexpr uint32_t Version = 5;
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct ListRef {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t bucketCount;
+    uint64_t bucketsOffset;        // int32_t displacement per bucket
+    uint64_t entriesOffset;        // Entry per slot
+    uint64_t listsOffset;          // StringRef per list element
+    uint64_t platformSlotsOffset;  // uint32_t slots, grouped by platform
+    uint64_t stringsOffset;        // Raw UTF-8 bytes, not NUL terminated
+    uint64_t stringsSize;
+    ListRef platformViews[AssetPlatformCount]; // Into the platform slots, in slot order
+};
+
+struct Entry {
+    StringRef assetId;
+    StringRef assetType;
+    StringRef permissions;
+    StringRef usage;
+    StringRef sourcePath;
+    StringRef archiveEntry;
+    StringRef contentHash;
+    StringRef versionText; // Empty unless the packed version does not give the text back
+    ListRef dependencies;
+    PlatformMask platforms;
+    uint32_t reserved;  // Zero
+    uint64_t version;   // See storeAssetVersion
+    uint64_t sourceOffset;
+    uint64_t sourceSize;
+};
+
+// Seeded 64-bit FNV-1a with a final avalanche step
+uint64_t hash(std::string_view key, uint64_t seed);
+
+} // namespace MetadataIndexFormat
+
+// Zero-copy view of one entry; strings point into the mapping and stay valid
+// for the lifetime of the index
+class AssetMetadataView {
+public:
+    AssetMetadataView(const uint8_t* base, const MetadataIndexFormat::Header& header,
+                      const MetadataIndexFormat::Entry& entry);
+
+    std::string_view assetId() const { return string(m_entry->assetId); }
+    std::string_view assetType() const { return string(m_entry->assetType); }
+    uint64_t version() const { return m_entry->version; }
+    // The version as written in metadata.json
+    std::string versionString() const;
+    std::string_view permissions() const { return string(m_entry->permissions); }
+    std::string_view usage() const { return string(m_entry->usage); }
+    std::string_view sourcePath() const { return string(m_entry->sourcePath); }
+    std::string_view archiveEntry() const { return string(m_entry->archiveEntry); }
+    std::string_view contentHash() const { return string(m_entry->contentHash); }
+    uint64_t sourceOffset() const { return m_entry->sourceOffset; }
+    uint64_t sourceSize() const { return m_entry->sourceSize; }
+
+    PlatformMask platforms() const { return m_entry->platforms; }
+    bool supports(AssetPlatform platform) const { return (m_entry->platforms & platformBit(platform)) != 0; }
+    size_t dependencyCount() const { return m_entry->dependencies.count; }
+    std::string_view dependency(size_t index) const { return listItem(m_entry->dependencies, index); }
+
+    // Copies the entry into an owning AssetMetadata
+    AssetMetadata toMetadata() const;
+
+private:
+    std::string_view string(const MetadataIndexFormat::StringRef& ref) const;
+    std::string_view listItem(const MetadataIndexFormat::ListRef& list, size_t index) const;
+
+    const uint8_t* m_base;
+    const MetadataIndexFormat::Header* m_header;
+    const MetadataIndexFormat::Entry* m_entry;
+};
+
+// Slots of the index entries for one platform, in slot order
+struct AssetSlotList {
+    const uint32_t* first = nullptr;
+    size_t count = 0;
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return first + count; }
+    size_t size() const { return count; }
+};
+
+// Read side: maps a compiled index and answers lookups in place
+class AssetMetadataIndex {
+public:
+    AssetMetadataIndex();
+    ~AssetMetadataIndex();
+
+    // Maps the file and validates its header and table bounds. Throws
+    // std::runtime_error on a missing or malformed index; entries that
+    // point outside their regions throw the same when read.
+    void open(const std::string& path);
+
+    std::optional<AssetMetadataView> find(std::string_view assetId) const;
+
+    // Getters
+    size_t size() const { return m_header ? m_header->entryCount : 0; }
+    AssetMetadataView entry(size_t slot) const;
+    // Precomputed when the index was compiled
+    AssetSlotList platformSlots(AssetPlatform platform) const;
+
+private:
+    MappedFile m_file;
+    const MetadataIndexFormat::Header* m_header;
+    const int32_t* m_buckets;
+    const MetadataIndexFormat::Entry* m_entries;
+};
+
+// Write side: used by the aincrad-asset tool to compile metadata offline
+class AssetMetadataIndexWriter {
+public:
+    void add(const AssetMetadata& metadata);
+    void write(const std::string& path) const;
+
+private:
+    std::vector<AssetMetadata> m_entries;
+};
+
+} // namespace World
+} // namespace Aincrad
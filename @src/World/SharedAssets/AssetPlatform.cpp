@@ -0,0 +1,111 @@
+#include "AssetPlatform.h"
+#include <stdexcept>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+constexpr std::string_view PlatformNames[AssetPlatformCount] = {"windows", "mac", "linux", "vr"};
+
+} // namespace
+
+std::optional<AssetPlatform> parseAssetPlatform(std::string_view name) {
+    for (size_t i = 0; i < AssetPlatformCount; ++i) {
+        if (PlatformNames[i] == name) {
+            return AssetPlatform(i);
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view assetPlatformName(AssetPlatform platform) {
+    if (size_t(platform) >= AssetPlatformCount) {
+        throw std::out_of_range("Unknown asset platform");
+    }
+    return PlatformNames[size_t(platform)];
+}
+
+PlatformMask toPlatformMask(const std::vector<std::string>& names) {
+    PlatformMask mask = 0;
+    for (const auto& name : names) {
+        auto platform = parseAssetPlatform(name);
+        if (!platform) {
+            throw std::runtime_error("Unknown platform: " + name);
+        }
+        mask |= platformBit(*platform);
+    }
+    return mask;
+}
+
+std::vector<std::string> platformNames(PlatformMask mask) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < AssetPlatformCount; ++i) {
+        if (mask & platformBit(AssetPlatform(i))) {
+            names.emplace_back(PlatformNames[i]);
+        }
+    }
+    return names;
+}
+
+namespace {
+
+// Packs the longest valid "major[.minor[.patch]]" prefix and returns how
+// many characters it covers; 0 when the version does not start with one
+uint64_t packVersionPrefix(std::string_view version, size_t& consumed) {
+    const uint64_t limits[3] = {UINT16_MAX, UINT16_MAX, UINT32_MAX};
+    uint64_t parts[3] = {0, 0, 0};
+    size_t part = 0;
+    bool digits = false;
+    consumed = 0;
+    uint64_t packed = 0;
+    for (size_t i = 0; i < version.size(); ++i) {
+        char c = version[i];
+        if (c == '.' && digits && part < 2) {
+            ++part;
+            digits = false;
+        } else if (c >= '0' && c <= '9' && parts[part] * 10 + uint64_t(c - '0') <= limits[part]) {
+            parts[part] = parts[part] * 10 + uint64_t(c - '0');
+            digits = true;
+            consumed = i + 1;
+            packed = parts[0] << 48 | parts[1] << 32 | parts[2];
+        } else {
+            break;
+        }
+    }
+    return packed;
+}
+
+} // namespace
+
+uint64_t packAssetVersion(std::string_view version) {
+    if (version.empty()) {
+        return 0;
+    }
+
+    size_t consumed;
+    uint64_t packed = packVersionPrefix(version, consumed);
+    if (consumed != version.size()) {
+        throw std::runtime_error("Invalid asset version: " + std::string(version));
+    }
+    return packed;
+}
+
+std::string formatAssetVersion(uint64_t packed) {
+    if (packed == 0) {
+        return std::string();
+    }
+    return std::to_string(packed >> 48) + "." + std::to_string((packed >> 32) & UINT16_MAX) + "." +
+           std::to_string(packed & UINT32_MAX);
+}
+
+StoredAssetVersion storeAssetVersion(std::string_view version) {
+    StoredAssetVersion stored;
+    size_t consumed;
+    stored.packed = packVersionPrefix(version, consumed);
+    stored.exact = formatAssetVersion(stored.packed) == version;
+    return stored;
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// Platforms an asset can ship for. Records and compiled indexes store them
+// as a bitmask, so platform filtering is a mask test rather than string
+// comparisons. Adding a platform changes the metadata index format.
+enum class AssetPlatform : uint8_t {
+    Windows,
+    Mac,
+    Linux,
+    VR,
+    Count
+};
+
+using PlatformMask = uint32_t;
+
+constexpr size_t AssetPlatformCount = size_t(AssetPlatform::Count);
+
+constexpr PlatformMask platformBit(AssetPlatform platform) {
+    return PlatformMask(1) << uint32_t(platform);
+}
+
+// Names as written in metadata.json: windows, mac, linux, vr
+std::optional<AssetPlatform> parseAssetPlatform(std::string_view name);
+std::string_view assetPlatformName(AssetPlatform platform);
+
+// Throws std::runtime_error on an unknown platform name
+PlatformMask toPlatformMask(const std::vector<std::string>& names);
+std::vector<std::string> platformNames(PlatformMask mask);
+
+// Versions are "major[.minor[.patch]]" and pack into one integer that
+// orders the same way: 16 bits of major, 16 of minor and 32 of patch. An
+// empty version packs to 0 (unversioned). Throws std::runtime_error on
+// anything else.
+uint64_t packAssetVersion(std::string_view version);
+// Formats all three parts, or an empty string for 0
+std::string formatAssetVersion(uint64_t packed);
+
+// How metadata stores any version string: packed is its numeric
+// "major[.minor[.patch]]" prefix, so "1.0.0-beta" orders as 1.0.0, and
+// exact says whether formatAssetVersion(packed) gives the text back.
+// Versions that do not, such as "1.2", "0.0.0" or "1.0.0-beta", keep their
+// text alongside. Never throws.
+struct StoredAssetVersion {
+    uint64_t packed = 0;
+    bool exact = true;
+};
+
+StoredAssetVersion storeAssetVersion(std::string_view version);
+
+} // namespace World
+} // namespace Aincrad
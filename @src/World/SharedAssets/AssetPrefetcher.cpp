@@ -0,0 +1,215 @@
+#include "AssetPrefetcher.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+// Weight of the newest sample in the smoothed velocity; damps jitter from
+// strafing and small corrections
+constexpr float VelocitySmoothing = 0.5f;
+
+struct Approach {
+    float distance; // Closest distance on the ground plane (x/z)
+    float seconds;  // When it is reached
+};
+
+// Closest approach of a straight path starting at from to point, within the
+// look-ahead window
+Approach closestApproach(const PrefetchLocation& from, float velocityX, float velocityZ,
+                         float lookAhead, const PrefetchLocation& point) {
+    float dx = point.x - from.x;
+    float dz = point.z - from.z;
+    float speedSquared = velocityX * velocityX + velocityZ * velocityZ;
+    float seconds = 0.0f;
+    if (speedSquared > 0.0f) {
+        seconds = std::clamp((dx * velocityX + dz * velocityZ) / speedSquared, 0.0f, lookAhead);
+    }
+    float gapX = dx - velocityX * seconds;
+    float gapZ = dz - velocityZ * seconds;
+    return {std::sqrt(gapX * gapX + gapZ * gapZ), seconds};
+}
+
+} // namespace
+
+AssetPrefetcher::AssetPrefetcher()
+    : m_config()
+    , m_requestCount(0)
+{
+}
+
+AssetPrefetcher::~AssetPrefetcher() {
+}
+
+void AssetPrefetcher::configure(const PrefetchConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+}
+
+void AssetPrefetcher::setCallback(PrefetchCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callback = std::move(callback);
+}
+
+void AssetPrefetcher::setFloorAssets(uint32_t floor, std::vector<std::string> assets) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_floorAssets[floor] = std::move(assets);
+}
+
+void AssetPrefetcher::addZone(uint32_t floor, PrefetchZone zone) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_zones[floor].push_back(std::move(zone));
+}
+
+void AssetPrefetcher::setGates(std::vector<PrefetchGate> gates) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_gates.clear();
+    for (auto& gate : gates) {
+        m_gates[gate.location.floor].push_back(gate);
+    }
+}
+
+void AssetPrefetcher::observePlayer(uint32_t playerId, const PrefetchLocation& location, Clock::time_point time) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto [it, inserted] = m_players.try_emplace(playerId);
+    PlayerTrack& player = it->second;
+
+    float elapsed = std::chrono::duration<float>(time - player.time).count();
+    if (inserted || location.floor != player.location.floor) {
+        player.velocityX = 0.0f;
+        player.velocityZ = 0.0f;
+    } else if (elapsed > 0.0f) {
+        float velocityX = (location.x - player.location.x) / elapsed;
+        float velocityZ = (location.z - player.location.z) / elapsed;
+        player.velocityX += (velocityX - player.velocityX) * VelocitySmoothing;
+        player.velocityZ += (velocityZ - player.velocityZ) * VelocitySmoothing;
+    }
+    player.location = location;
+    player.time = time;
+}
+
+void AssetPrefetcher::removePlayer(uint32_t playerId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_players.erase(playerId);
+}
+
+void AssetPrefetcher::want(const std::vector<std::string>& assets, float seconds,
+                           std::unordered_map<std::string, float>& urgency) const {
+    for (const auto& asset : assets) {
+        auto [it, inserted] = urgency.emplace(asset, seconds);
+        if (!inserted) {
+            it->second = std::min(it->second, seconds);
+        }
+    }
+}
+
+void AssetPrefetcher::predict(const PlayerTrack& player, std::unordered_map<std::string, float>& urgency) const {
+    const float lookAhead = m_config.lookAheadSeconds;
+
+    auto floorAssets = m_floorAssets.find(player.location.floor);
+    if (floorAssets != m_floorAssets.end()) {
+        want(floorAssets->second, 0.0f, urgency);
+    }
+
+    auto zones = m_zones.find(player.location.floor);
+    if (zones != m_zones.end()) {
+        for (const auto& zone : zones->second) {
+            Approach approach = closestApproach(player.location, player.velocityX, player.velocityZ, lookAhead, zone.center);
+            if (approach.distance <= zone.radius + m_config.zoneMargin) {
+                want(zone.assets, approach.seconds, urgency);
+            }
+        }
+    }
+
+    // A gate on the path means the floor behind it is about to be needed
+    auto gates = m_gates.find(player.location.floor);
+    if (gates == m_gates.end()) {
+        return;
+    }
+    for (const auto& gate : gates->second) {
+        Approach approach = closestApproach(player.location, player.velocityX, player.velocityZ, lookAhead, gate.location);
+        if (approach.distance > m_config.gateRadius) {
+            continue;
+        }
+
+        const PrefetchLocation& destination = gate.destination;
+        auto destinationAssets = m_floorAssets.find(destination.floor);
+        if (destinationAssets != m_floorAssets.end()) {
+            want(destinationAssets->second, approach.seconds, urgency);
+        }
+        auto destinationZones = m_zones.find(destination.floor);
+        if (destinationZones == m_zones.end()) {
+            continue;
+        }
+        for (const auto& zone : destinationZones->second) {
+            Approach arrival = closestApproach(destination, 0.0f, 0.0f, 0.0f, zone.center);
+            if (arrival.distance <= zone.radius + m_config.zoneMargin) {
+                want(zone.assets, approach.seconds, urgency);
+            }
+        }
+    }
+}
+
+void AssetPrefetcher::update(Clock::time_point now) {
+    std::vector<std::string> requests;
+    PrefetchCallback callback;
+    int priority;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unordered_map<std::string, float> urgency;
+        for (const auto& [playerId, player] : m_players) {
+            predict(player, urgency);
+        }
+
+        std::vector<std::pair<float, std::string>> ranked;
+        ranked.reserve(urgency.size());
+        for (auto& [asset, seconds] : urgency) {
+            ranked.emplace_back(seconds, asset);
+        }
+        std::sort(ranked.begin(), ranked.end());
+
+        m_predicted.clear();
+        auto reissue = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(m_config.reissueSeconds));
+        for (auto& [seconds, asset] : ranked) {
+            if (requests.size() < m_config.maxRequestsPerUpdate) {
+                auto last = m_lastRequested.find(asset);
+                if (last == m_lastRequested.end() || now - last->second >= reissue) {
+                    m_lastRequested[asset] = now;
+                    requests.push_back(asset);
+                }
+            }
+            m_predicted.push_back(std::move(asset));
+        }
+
+        // Forget requests old enough to be reissued anyway
+        for (auto it = m_lastRequested.begin(); it != m_lastRequested.end();) {
+            it = now - it->second >= reissue ? m_lastRequested.erase(it) : std::next(it);
+        }
+
+        m_requestCount += requests.size();
+        callback = m_callback;
+        priority = m_config.priority;
+    }
+
+    if (callback) {
+        for (const auto& asset : requests) {
+            callback(asset, priority);
+        }
+    }
+}
+
+std::vector<std::string> AssetPrefetcher::getPredictedAssets() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_predicted;
+}
+
+uint64_t AssetPrefetcher::getRequestCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_requestCount;
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// A point in Aincrad; mirrors SAO::World::Location
+struct PrefetchLocation {
+    uint32_t floor = 1;
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+// A teleport gate and where it leads; mirrors SAO::World::TeleportGate
+struct PrefetchGate {
+    uint32_t id = 0;
+    PrefetchLocation location;
+    PrefetchLocation destination;
+};
+
+// Assets needed around one zone of a floor
+struct PrefetchZone {
+    std::string name;
+    PrefetchLocation center;
+    float radius = 0.0f;
+    std::vector<std::string> assets;
+};
+
+struct PrefetchConfig {
+    float lookAheadSeconds = 3.0f;  // How far recent movement is extrapolated
+    float gateRadius = 25.0f;       // Approaching a gate this closely warms its destination
+    float zoneMargin = 25.0f;       // Zones are warmed this far before the player enters
+    float reissueSeconds = 10.0f;   // Minimum time between requests for one asset
+    size_t maxRequestsPerUpdate = 64;
+    int priority = 0;
+};
+
+// Starts a low-priority load; unknown assets are the caller's to ignore
+using PrefetchCallback = std::function<void(const std::string& assetId, int priority)>;
+
+// Predicts which floor and zone asset sets players will need soon and warms
+// them ahead of time. Each player's recent movement is extrapolated a few
+// seconds ahead. Zones along that path are prefetched, and so is everything
+// behind a teleport gate the path approaches, so stepping through a gate
+// lands on a warm floor. Requests are ranked by how soon they are needed and
+// rate limited per update.
+class AssetPrefetcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    AssetPrefetcher();
+    ~AssetPrefetcher();
+
+    // Configuration; the callback runs on the thread calling update(), after
+    // the prefetcher's lock is released
+    void configure(const PrefetchConfig& config);
+    void setCallback(PrefetchCallback callback);
+
+    // World layout. The floor set is kept warm while a player is on the
+    // floor or heading there through a gate.
+    void setFloorAssets(uint32_t floor, std::vector<std::string> assets);
+    void addZone(uint32_t floor, PrefetchZone zone);
+    void setGates(std::vector<PrefetchGate> gates);
+
+    // Copies the gates of every floor from a world system such as
+    // SAO::World::WorldSystem: anything whose getAllFloors() yields floors
+    // with getTeleportGates(), holding gates with getId(), getLocation(),
+    // getDestination() and isActive()
+    template <typename WorldSystem>
+    void syncGates(const WorldSystem& world);
+
+    // Player movement; a floor change (teleport) restarts the velocity estimate
+    void observePlayer(uint32_t playerId, const PrefetchLocation& location, Clock::time_point time = Clock::now());
+    void removePlayer(uint32_t playerId);
+
+    void update(Clock::time_point now = Clock::now());
+
+    // Getters
+    std::vector<std::string> getPredictedAssets() const; // Most urgent first, as of the last update
+    uint64_t getRequestCount() const;
+
+private:
+    struct PlayerTrack {
+        PrefetchLocation location;
+        Clock::time_point time;
+        float velocityX = 0.0f;
+        float velocityZ = 0.0f;
+    };
+
+    void predict(const PlayerTrack& player, std::unordered_map<std::string, float>& urgency) const;
+    void want(const std::vector<std::string>& assets, float seconds,
+              std::unordered_map<std::string, float>& urgency) const;
+
+    PrefetchConfig m_config;
+    PrefetchCallback m_callback;
+    std::unordered_map<uint32_t, std::vector<std::string>> m_floorAssets;
+    std::unordered_map<uint32_t, std::vector<PrefetchZone>> m_zones;
+    std::unordered_map<uint32_t, std::vector<PrefetchGate>> m_gates; // By the floor they stand on
+    std::unordered_map<uint32_t, PlayerTrack> m_players;
+    std::unordered_map<std::string, Clock::time_point> m_lastRequested;
+    std::vector<std::string> m_predicted;
+    uint64_t m_requestCount;
+    mutable std::mutex m_mutex;
+};
+
+template <typename WorldSystem>
+void AssetPrefetcher::syncGates(const WorldSystem& world) {
+    auto toLocation = [](const auto& location) {
+        return PrefetchLocation{location.floor, location.x, location.y, location.z};
+    };
+
+    std::vector<PrefetchGate> gates;
+    for (const auto& floor : world.getAllFloors()) {
+        for (const auto& gate : floor->getTeleportGates()) {
+            if (gate->isActive()) {
+                gates.push_back({gate->getId(), toLocation(gate->getLocation()), toLocation(gate->getDestination())});
+            }
+        }
+    }
+    setGates(std::move(gates));
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,151 @@
+#include "AssetTelemetry.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+size_t bucketFor(uint64_t micros) {
+    size_t bucket = 0;
+    while (micros != 0 && bucket + 1 < LatencyHistogramSnapshot::BucketCount) {
+        micros >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+const std::string OtherAssetTypes = "other";
+
+} // namespace
+
+uint64_t LatencyHistogramSnapshot::percentileMicros(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, uint64_t(std::ceil(fraction * double(count))));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+        seen += buckets[bucket];
+        if (seen >= target) {
+            return std::min(bucketUpperBound(bucket), maxMicros);
+        }
+    }
+    return maxMicros;
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_count(0)
+    , m_totalMicros(0)
+    , m_maxMicros(0)
+{
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(std::chrono::microseconds latency) {
+    uint64_t micros = uint64_t(std::max<int64_t>(latency.count(), 0));
+    m_buckets[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_totalMicros.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t current = m_maxMicros.load(std::memory_order_relaxed);
+    while (micros > current && !m_maxMicros.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogramSnapshot LatencyHistogram::snapshot() const {
+    LatencyHistogramSnapshot snapshot;
+    for (size_t bucket = 0; bucket < m_buckets.size(); ++bucket) {
+        snapshot.buckets[bucket] = m_buckets[bucket].load(std::memory_order_relaxed);
+    }
+    snapshot.count = m_count.load(std::memory_order_relaxed);
+    snapshot.totalMicros = m_totalMicros.load(std::memory_order_relaxed);
+    snapshot.maxMicros = m_maxMicros.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+AssetTelemetry::AssetTelemetry()
+    : m_loads(0)
+    , m_failedLoads(0)
+    , m_reloads(0)
+    , m_bytesRead(0)
+    , m_cacheHits(0)
+    , m_cacheMisses(0)
+{
+}
+
+AssetTelemetry::~AssetTelemetry() {
+    for (auto& slot : m_types) {
+        const std::string* assetType = slot.assetType.load();
+        if (assetType != &OtherAssetTypes) {
+            delete assetType;
+        }
+    }
+}
+
+LatencyHistogram& AssetTelemetry::histogramFor(std::string_view assetType) {
+    // Slots fill front to back and are never freed, so a scan that reaches
+    // an empty slot knows the type is new and races only to claim that slot
+    for (size_t i = 0; i + 1 < m_types.size(); ++i) {
+        TypeSlot& slot = m_types[i];
+        const std::string* existing = slot.assetType.load(std::memory_order_acquire);
+        if (!existing) {
+            auto* claimed = new std::string(assetType);
+            if (slot.assetType.compare_exchange_strong(existing, claimed, std::memory_order_acq_rel)) {
+                return slot.latency;
+            }
+            delete claimed; // Another thread claimed it first; existing now holds its type
+        }
+        if (*existing == assetType) {
+            return slot.latency;
+        }
+    }
+
+    TypeSlot& other = m_types.back();
+    const std::string* expected = nullptr;
+    other.assetType.compare_exchange_strong(expected, &OtherAssetTypes, std::memory_order_acq_rel);
+    return other.latency;
+}
+
+void AssetTelemetry::recordLoad(std::string_view assetType, std::chrono::microseconds latency,
+                                uint64_t bytes, bool succeeded) {
+    m_loads.fetch_add(1, std::memory_order_relaxed);
+    if (succeeded) {
+        m_bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    } else {
+        m_failedLoads.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_latency.record(latency);
+    histogramFor(assetType).record(latency);
+}
+
+void AssetTelemetry::recordReload(uint64_t bytes) {
+    m_reloads.fetch_add(1, std::memory_order_relaxed);
+    m_bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+AssetLoadTelemetry AssetTelemetry::snapshot() const {
+    AssetLoadTelemetry telemetry;
+    telemetry.loads = m_loads.load(std::memory_order_relaxed);
+    telemetry.failedLoads = m_failedLoads.load(std::memory_order_relaxed);
+    telemetry.reloads = m_reloads.load(std::memory_order_relaxed);
+    telemetry.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    telemetry.cacheHits = m_cacheHits.load(std::memory_order_relaxed);
+    telemetry.cacheMisses = m_cacheMisses.load(std::memory_order_relaxed);
+    telemetry.latency = m_latency.snapshot();
+
+    for (const auto& slot : m_types) {
+        const std::string* assetType = slot.assetType.load(std::memory_order_acquire);
+        if (assetType) {
+            telemetry.byType.push_back({*assetType, slot.latency.snapshot()});
+        }
+    }
+    return telemetry;
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// Copy of a latency histogram. Bucket 0 counts sub-microsecond samples and
+// bucket i counts samples in [2^(i-1), 2^i) microseconds; the last bucket is
+// open ended.
+struct LatencyHistogramSnapshot {
+    static constexpr size_t BucketCount = 32;
+
+    std::array<uint64_t, BucketCount> buckets{};
+    uint64_t count = 0;
+    uint64_t totalMicros = 0;
+    uint64_t maxMicros = 0;
+
+    static uint64_t bucketUpperBound(size_t bucket) { return uint64_t(1) << bucket; }
+
+    double meanMicros() const { return count ? double(totalMicros) / double(count) : 0.0; }
+    // Upper bound of the bucket holding the given fraction (0..1) of samples
+    uint64_t percentileMicros(double fraction) const;
+};
+
+// Log2-bucketed latency histogram; recording is a handful of relaxed
+// atomic adds, so it is safe from any loader thread
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::microseconds latency);
+    LatencyHistogramSnapshot snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, LatencyHistogramSnapshot::BucketCount> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_totalMicros;
+    std::atomic<uint64_t> m_maxMicros;
+};
+
+struct AssetTypeLatency {
+    std::string assetType;
+    LatencyHistogramSnapshot latency;
+};
+
+struct AssetLoadTelemetry {
+    uint64_t loads = 0;          // Completed loads, including failures
+    uint64_t failedLoads = 0;
+    uint64_t reloads = 0;        // Hot reloads that swapped in a new payload
+    uint64_t bytesRead = 0;      // Payload bytes of successful loads and reloads
+    uint64_t cacheHits = 0;      // Requests served by an already registered asset
+    uint64_t cacheMisses = 0;
+    LatencyHistogramSnapshot latency;      // All asset types
+    std::vector<AssetTypeLatency> byType;  // In order of first appearance
+
+    double cacheHitRate() const {
+        uint64_t lookups = cacheHits + cacheMisses;
+        return lookups ? double(cacheHits) / double(lookups) : 0.0;
+    }
+};
+
+// Load counters and latency histograms, recorded from loader threads and
+// read without locks. Each asset type gets its own histogram; types beyond
+// MaxAssetTypes share a final "other" slot.
+class AssetTelemetry {
+public:
+    static constexpr size_t MaxAssetTypes = 32;
+
+    AssetTelemetry();
+    ~AssetTelemetry();
+
+    AssetTelemetry(const AssetTelemetry&) = delete;
+    AssetTelemetry& operator=(const AssetTelemetry&) = delete;
+
+    void recordLoad(std::string_view assetType, std::chrono::microseconds latency, uint64_t bytes, bool succeeded);
+    void recordReload(uint64_t bytes);
+    void recordCacheHit() { m_cacheHits.fetch_add(1, std::memory_order_relaxed); }
+    void recordCacheMiss() { m_cacheMisses.fetch_add(1, std::memory_order_relaxed); }
+
+    // Counters are read one by one, so a snapshot taken during loads may be
+    // off by the loads in flight, but never blocks them
+    AssetLoadTelemetry snapshot() const;
+
+private:
+    struct TypeSlot {
+        std::atomic<const std::string*> assetType{nullptr}; // Published once, never changed
+        LatencyHistogram latency;
+    };
+
+    LatencyHistogram& histogramFor(std::string_view assetType);
+
+    std::atomic<uint64_t> m_loads;
+    std::atomic<uint64_t> m_failedLoads;
+    std::atomic<uint64_t> m_reloads;
+    std::atomic<uint64_t> m_bytesRead;
+    std::atomic<uint64_t> m_cacheHits;
+    std::atomic<uint64_t> m_cacheMisses;
+    LatencyHistogram m_latency;
+    std::array<TypeSlot, MaxAssetTypes> m_types;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,212 @@
+#include "AssetWatcher.h"
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdint>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Aincrad {
+namespace World {
+
+AssetWatcher::AssetWatcher()
+    : m_debounce(DefaultDebounce)
+    , m_notifyFd(-1)
+    , m_wakeFd(-1)
+    , m_running(false)
+{
+}
+
+AssetWatcher::~AssetWatcher() {
+    stop();
+}
+
+bool AssetWatcher::isSupported() {
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(__linux__)
+
+namespace {
+
+// Finished writes and files moved into place count as changes; creation
+// only matters for new subdirectories, which need watches of their own
+constexpr uint32_t WatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+
+} // namespace
+
+void AssetWatcher::start(const std::vector<std::string>& directories, AssetChangeCallback callback,
+                         std::chrono::milliseconds debounce) {
+    stop();
+
+    m_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_notifyFd < 0 || m_wakeFd < 0) {
+        closeHandles();
+        throw std::runtime_error("Failed to create asset watcher");
+    }
+
+    try {
+        for (const auto& directory : directories) {
+            addWatchTree(directory, nullptr);
+        }
+    } catch (...) {
+        closeHandles();
+        throw;
+    }
+
+    m_callback = std::move(callback);
+    m_debounce = debounce;
+    m_running = true;
+    m_thread = std::thread(&AssetWatcher::run, this);
+}
+
+void AssetWatcher::stop() {
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(m_wakeFd, &one, sizeof(one));
+        (void)written; // The counter only saturates if the thread is already waking
+        m_thread.join();
+    }
+    m_running = false;
+    closeHandles();
+}
+
+void AssetWatcher::closeHandles() {
+    if (m_notifyFd >= 0) {
+        close(m_notifyFd); // Drops every watch with it
+        m_notifyFd = -1;
+    }
+    if (m_wakeFd >= 0) {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+    m_watches.clear();
+}
+
+void AssetWatcher::addWatchTree(const std::string& directory, std::set<std::string>* created) {
+    int wd = inotify_add_watch(m_notifyFd, directory.c_str(), WatchMask);
+    if (wd < 0) {
+        if (created) {
+            return; // Removed again before we got to it
+        }
+        throw std::runtime_error("Failed to watch asset directory: " + directory);
+    }
+    m_watches[wd] = directory;
+
+    // Anything written into a new directory before its watch existed would
+    // otherwise be missed, so report what is already there
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        std::string path = it->path().string();
+        if (it->is_directory(error)) {
+            addWatchTree(path, created);
+        } else if (created) {
+            created->insert(path);
+        }
+    }
+}
+
+void AssetWatcher::readEvents(std::set<std::string>& pending) {
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        ssize_t length = read(m_notifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return; // EAGAIN once drained
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += ssize_t(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_IGNORED) {
+                m_watches.erase(event->wd); // Directory deleted or unmounted
+                continue;
+            }
+            auto directory = m_watches.find(event->wd);
+            if (directory == m_watches.end() || event->len == 0) {
+                continue;
+            }
+
+            std::string path = directory->second + "/" + event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    addWatchTree(path, &pending);
+                }
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                pending.insert(path);
+            }
+        }
+    }
+}
+
+void AssetWatcher::run() {
+    using Clock = std::chrono::steady_clock;
+    std::set<std::string> pending;
+    Clock::time_point deadline;
+
+    for (;;) {
+        int timeout = -1;
+        if (!pending.empty()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            timeout = int(std::max<int64_t>(remaining.count(), 0));
+        }
+
+        pollfd fds[2] = {{m_notifyFd, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break; // stop()
+        }
+
+        if (fds[0].revents & POLLIN) {
+            readEvents(pending);
+            deadline = Clock::now() + m_debounce; // Restart the quiet period
+        } else if (!pending.empty() && Clock::now() >= deadline) {
+            std::vector<std::string> paths(pending.begin(), pending.end());
+            pending.clear();
+            m_callback(paths);
+        }
+    }
+    m_running = false;
+}
+
+#else
+
+void AssetWatcher::start(const std::vector<std::string>&, AssetChangeCallback, std::chrono::milliseconds) {
+    throw std::runtime_error("Asset hot reload is not supported on this platform");
+}
+
+void AssetWatcher::stop() {
+    m_running = false;
+}
+
+void AssetWatcher::run() {
+}
+
+void AssetWatcher::addWatchTree(const std::string&, std::set<std::string>*) {
+}
+
+void AssetWatcher::readEvents(std::set<std::string>&) {
+}
+
+void AssetWatcher::closeHandles() {
+}
+
+#endif
+
+} // namespace World
+} // namespace Aincrad
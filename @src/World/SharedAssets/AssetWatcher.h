@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// Called on the watcher thread with every file written since the last call
+using AssetChangeCallback = std::function<void(const std::vector<std::string>& paths)>;
+
+// Watches asset directories for finished writes and reports the changed
+// files in batches. Editors usually save through several events (truncate,
+// write, rename), so events are coalesced until the directories have been
+// quiet for the debounce interval. Backed by inotify; unsupported elsewhere.
+class AssetWatcher {
+public:
+    static constexpr std::chrono::milliseconds DefaultDebounce{50};
+
+    AssetWatcher();
+    ~AssetWatcher();
+
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+    static bool isSupported();
+
+    // Watches each directory and its subdirectories, including ones created
+    // later. Throws std::runtime_error if a directory cannot be watched or
+    // the platform has no watcher.
+    void start(const std::vector<std::string>& directories, AssetChangeCallback callback,
+               std::chrono::milliseconds debounce = DefaultDebounce);
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+private:
+    void run();
+    void addWatchTree(const std::string& directory, std::set<std::string>* created);
+    void readEvents(std::set<std::string>& pending);
+    void closeHandles();
+
+    AssetChangeCallback m_callback;
+    std::chrono::milliseconds m_debounce;
+    int m_notifyFd;
+    int m_wakeFd;
+    std::unordered_map<int, std::string> m_watches; // Watch descriptor to directory; watcher thread only once started
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,311 @@
+#include "AudioFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define AINCRAD_AUDIO_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AINCRAD_TARGET_AVX2
+#else
+#define AINCRAD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Aincrad {
+namespace World {
+
+using namespace AudioFormat;
+
+namespace {
+
+// Exact phases up to this many; rarer ratios snap to the nearest of these
+constexpr uint64_t MaxPhases = 1024;
+// Zero crossings on each side of the sinc when not downsampling
+constexpr double FilterHalfWidth = 32.0;
+// About 80 dB of stopband rejection
+constexpr double KaiserBeta = 8.0;
+// Passband as a fraction of the lower Nyquist rate, leaving room for the
+// transition band so nothing aliases back below it
+constexpr double Rolloff = 0.92;
+constexpr double Pi = 3.14159265358979323846;
+
+void validateAudio(const AudioBuffer& audio) {
+    if (audio.sampleRate == 0 || audio.channelCount == 0 || audio.channelCount > MaxChannelCount ||
+        audio.samples.size() % audio.channelCount != 0) {
+        throw std::runtime_error("Audio has no sample rate, an unsupported channel count or a partial frame");
+    }
+}
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; term > sum * 1e-12; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Eight running sums, reduced in a fixed order, on every path; taps is a
+// multiple of 8
+float reduceLanes(const float lanes[8]) {
+    return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+}
+
+float dotScalar(const float* x, const float* h, size_t taps) {
+    float lanes[8] = {};
+    for (size_t k = 0; k < taps; k += 8) {
+        for (size_t lane = 0; lane < 8; ++lane) {
+            lanes[lane] += x[k + lane] * h[k + lane];
+        }
+    }
+    return reduceLanes(lanes);
+}
+
+#if defined(AINCRAD_AUDIO_X86)
+float dotSSE2(const float* x, const float* h, size_t taps) {
+    __m128 low = _mm_setzero_ps();
+    __m128 high = _mm_setzero_ps();
+    for (size_t k = 0; k < taps; k += 8) {
+        low = _mm_add_ps(low, _mm_mul_ps(_mm_loadu_ps(x + k), _mm_loadu_ps(h + k)));
+        high = _mm_add_ps(high, _mm_mul_ps(_mm_loadu_ps(x + k + 4), _mm_loadu_ps(h + k + 4)));
+    }
+    float lanes[8];
+    _mm_storeu_ps(lanes, low);
+    _mm_storeu_ps(lanes + 4, high);
+    return reduceLanes(lanes);
+}
+
+AINCRAD_TARGET_AVX2
+float dotAVX2(const float* x, const float* h, size_t taps) {
+    __m256 sum = _mm256_setzero_ps();
+    for (size_t k = 0; k < taps; k += 8) {
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(x + k), _mm256_loadu_ps(h + k)));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, sum);
+    return reduceLanes(lanes);
+}
+#endif
+
+int16_t toPcm16(float sample) {
+    return int16_t(std::clamp(std::lround(double(sample) * 32767.0), -32768l, 32767l));
+}
+
+} // namespace
+
+AudioSimd detectAudioSimd() {
+#if defined(AINCRAD_AUDIO_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if (osSavesAvx && (info[1] & (1 << 5))) {
+            return AudioSimd::AVX2;
+        }
+    }
+    return AudioSimd::SSE2;
+#else
+    return __builtin_cpu_supports("avx2") ? AudioSimd::AVX2 : AudioSimd::SSE2;
+#endif
+#else
+    return AudioSimd::Scalar;
+#endif
+}
+
+AudioBuffer resampleAudio(const AudioBuffer& input, uint32_t sampleRate, bool looping, AudioSimd simd) {
+    validateAudio(input);
+    if (sampleRate == 0) {
+        throw std::runtime_error("Cannot resample audio to a zero sample rate");
+    }
+    if (sampleRate == input.sampleRate) {
+        return input;
+    }
+    auto dot = dotScalar;
+#if defined(AINCRAD_AUDIO_X86)
+    simd = std::min(simd, detectAudioSimd());
+    if (simd == AudioSimd::AVX2) {
+        dot = dotAVX2;
+    } else if (simd == AudioSimd::SSE2) {
+        dot = dotSSE2;
+    }
+#endif
+
+    // Output sample n sits n * down / up input samples in
+    const uint64_t divisor = std::gcd(uint64_t(input.sampleRate), uint64_t(sampleRate));
+    const uint64_t up = sampleRate / divisor;
+    const uint64_t down = input.sampleRate / divisor;
+    const uint64_t phases = std::min(up, MaxPhases);
+
+    // One row of taps per phase. Downsampling lowers the cutoff and
+    // stretches the filter to match.
+    const double scale = std::min(1.0, double(sampleRate) / double(input.sampleRate));
+    const double cutoff = 0.5 * scale * Rolloff; // Cycles per input sample
+    const size_t halfTaps = size_t(std::ceil(FilterHalfWidth / scale));
+    const size_t taps = (2 * halfTaps + 7) / 8 * 8;
+    const double windowNorm = besselI0(KaiserBeta);
+    std::vector<float> kernel(size_t(phases) * taps, 0.0f);
+    std::vector<double> row(2 * halfTaps);
+    for (uint64_t phase = 0; phase < phases; ++phase) {
+        const double fraction = double(phase) / double(phases);
+        double sum = 0.0;
+        for (size_t k = 0; k < row.size(); ++k) {
+            double x = double(k) - double(halfTaps) + 1.0 - fraction;
+            double u = x / double(halfTaps);
+            double window = besselI0(KaiserBeta * std::sqrt(std::max(0.0, 1.0 - u * u))) / windowNorm;
+            double sinc = x == 0.0 ? 1.0 : std::sin(2 * Pi * cutoff * x) / (2 * Pi * cutoff * x);
+            row[k] = sinc * window;
+            sum += row[k];
+        }
+        // Unity gain at DC for every phase, so there is no phase-rate ripple
+        for (size_t k = 0; k < row.size(); ++k) {
+            kernel[size_t(phase) * taps + k] = float(row[k] / sum);
+        }
+    }
+
+    const size_t channels = input.channelCount;
+    const size_t frames = input.samples.size() / channels;
+    const uint64_t outputFrames = (uint64_t(frames) * up + down / 2) / down;
+    AudioBuffer output;
+    output.sampleRate = sampleRate;
+    output.channelCount = input.channelCount;
+    output.samples.resize(size_t(outputFrames) * channels);
+
+    // Each channel is filtered from a contiguous copy with a margin of
+    // silence, or of the other end of the loop, on both sides
+    const size_t margin = taps;
+    std::vector<float> channel(frames + 2 * margin);
+    for (size_t c = 0; c < channels; ++c) {
+        for (size_t i = 0; i < channel.size(); ++i) {
+            long source = long(i) - long(margin);
+            if (looping && frames > 0) {
+                source = (source % long(frames) + long(frames)) % long(frames);
+            }
+            channel[i] = source >= 0 && size_t(source) < frames ? input.samples[size_t(source) * channels + c] : 0.0f;
+        }
+        for (uint64_t n = 0; n < outputFrames; ++n) {
+            uint64_t position = n * down;
+            uint64_t index = position / up;
+            uint64_t phase = position % up;
+            if (up > phases) {
+                phase = (phase * phases + up / 2) / up;
+                if (phase == phases) {
+                    phase = 0;
+                    ++index;
+                }
+            }
+            const float* x = channel.data() + margin + index + 1 - halfTaps;
+            output.samples[size_t(n) * channels + c] = dot(x, kernel.data() + size_t(phase) * taps, taps);
+        }
+    }
+    return output;
+}
+
+std::vector<uint8_t> buildAudio(const AudioBuffer& audio, const AudioBuildOptions& options) {
+    validateAudio(audio);
+    const AudioBuffer working = options.sampleRate != 0 && options.sampleRate != audio.sampleRate
+                                    ? resampleAudio(audio, options.sampleRate, options.looping)
+                                    : audio;
+
+    const size_t frameBytes = size_t(working.channelCount) * sizeof(int16_t);
+    const uint64_t frameCount = working.samples.size() / working.channelCount;
+    const uint64_t dataBytes = std::max<uint64_t>(frameCount * frameBytes, 1);
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.sampleRate = working.sampleRate;
+    header.channelCount = working.channelCount;
+    header.chunkSize = uint32_t(std::min<uint64_t>(MaxChunkSize, (dataBytes + ChunkAlignment - 1) / ChunkAlignment *
+                                                                     ChunkAlignment));
+    header.framesPerChunk = uint32_t(header.chunkSize / frameBytes);
+    const uint64_t chunkCount = (frameCount + header.framesPerChunk - 1) / header.framesPerChunk;
+    if (chunkCount >= UINT32_MAX) {
+        throw std::runtime_error("Audio is too long");
+    }
+    header.chunkCount = uint32_t(chunkCount);
+    header.flags = options.looping ? uint32_t(Looping) : 0u;
+    header.frameCount = frameCount;
+
+    std::vector<uint8_t> payload(size_t(chunkCount + 1) * header.chunkSize, 0);
+    std::memcpy(payload.data(), &header, sizeof(header));
+    for (uint64_t frame = 0; frame < frameCount; ++frame) {
+        uint8_t* target = payload.data() + size_t(frame / header.framesPerChunk + 1) * header.chunkSize +
+                          size_t(frame % header.framesPerChunk) * frameBytes;
+        for (uint32_t c = 0; c < working.channelCount; ++c) {
+            int16_t sample = toPcm16(working.samples[size_t(frame) * working.channelCount + c]);
+            std::memcpy(target + c * sizeof(int16_t), &sample, sizeof(sample));
+        }
+    }
+    return payload;
+}
+
+Header readAudioHeader(const uint8_t* data, size_t size) {
+    if (!AudioView::isAudio(data, size)) {
+        throw std::runtime_error("Not an audio payload");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != Version) {
+        throw std::runtime_error("Unsupported audio version " + std::to_string(header.version));
+    }
+    if (header.sampleRate == 0 || header.channelCount == 0 || header.channelCount > MaxChannelCount ||
+        header.chunkSize == 0 || header.chunkSize > MaxChunkSize || header.chunkSize % ChunkAlignment != 0 ||
+        header.framesPerChunk != header.chunkSize / (header.channelCount * sizeof(int16_t)) ||
+        header.chunkCount != (header.frameCount + header.framesPerChunk - 1) / header.framesPerChunk ||
+        (header.flags & ~uint32_t(Looping)) != 0) {
+        throw std::runtime_error("Malformed audio header");
+    }
+    return header;
+}
+
+bool AudioView::isAudio(const uint8_t* data, size_t size) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == Magic;
+}
+
+AudioView::AudioView(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_header(readAudioHeader(data, size))
+{
+    if (size / m_header.chunkSize < uint64_t(m_header.chunkCount) + 1) {
+        throw std::runtime_error("Audio payload is missing chunks");
+    }
+}
+
+const uint8_t* AudioView::chunk(uint32_t index) const {
+    if (index >= m_header.chunkCount) {
+        throw std::runtime_error("Audio has no chunk " + std::to_string(index));
+    }
+    return m_data + size_t(index + 1) * m_header.chunkSize;
+}
+
+size_t AudioView::readFrames(uint64_t first, size_t count, int16_t* output) const {
+    const size_t frameBytes = size_t(m_header.channelCount) * sizeof(int16_t);
+    size_t done = 0;
+    while (done < count && first + done < m_header.frameCount) {
+        uint64_t frame = first + done;
+        uint64_t inChunk = frame % m_header.framesPerChunk;
+        size_t run = size_t(std::min<uint64_t>({count - done, m_header.framesPerChunk - inChunk,
+                                                m_header.frameCount - frame}));
+        std::memcpy(output + done * m_header.channelCount,
+                    chunk(uint32_t(frame / m_header.framesPerChunk)) + inChunk * frameBytes, run * frameBytes);
+        done += run;
+    }
+    return done;
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// On-disk layout of an imported audio payload (little-endian):
+//   Header, zero-padded to chunkSize | chunk 0 | chunk 1 | ...
+// Every chunk is chunkSize bytes of interleaved 16-bit PCM, framesPerChunk
+// frames long; the last is zero-padded. Chunk i starts at (i + 1) *
+// chunkSize, so seeking is arithmetic. The importer compresses the payload
+// with a codec block size of chunkSize, which makes codec block i + 1 hold
+// exactly chunk i and lets a player read and decode chunks one at a time.
+namespace AudioFormat {
+
+constexpr uint32_t Magic = 0x55414941; // "AIAU"
+constexpr uint32_t Version = 1;
+constexpr uint32_t MaxChunkSize = 64 * 1024; // One StreamingReader slot
+constexpr uint32_t ChunkAlignment = 4096;
+constexpr uint32_t MaxChannelCount = 8;
+
+enum Flags : uint32_t {
+    Looping = 1 // Playback wraps from the last frame to the first
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t channelCount;
+    uint32_t chunkSize;      // Bytes, a multiple of ChunkAlignment up to MaxChunkSize
+    uint32_t framesPerChunk;
+    uint32_t chunkCount;
+    uint32_t flags;
+    uint64_t frameCount;
+};
+
+} // namespace AudioFormat
+
+// Decoded audio as the importer works on it
+struct AudioBuffer {
+    uint32_t sampleRate = 0;
+    uint32_t channelCount = 0;
+    std::vector<float> samples; // Interleaved, full scale is -1 to 1
+};
+
+// Instruction sets the resampler can use. The best one the CPU supports is
+// picked at run time; every path produces the same bits.
+enum class AudioSimd {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+AudioSimd detectAudioSimd();
+
+// Polyphase windowed-sinc (Kaiser) resampler. The rate ratio is reduced to
+// L/M and each output sample is one short FIR over the input with the
+// phase it falls on; the filter cuts below the lower of the two Nyquist
+// rates, so downsampling does not alias. Looping input wraps around at
+// the ends, so the loop point stays seamless. Throws std::runtime_error on
+// a zero rate, a bad channel count or samples that do not fill whole frames.
+AudioBuffer resampleAudio(const AudioBuffer& input, uint32_t sampleRate, bool looping = false,
+                          AudioSimd simd = detectAudioSimd());
+
+struct AudioBuildOptions {
+    uint32_t sampleRate = 0; // Resample to this rate; 0 keeps the source rate
+    bool looping = false;
+};
+
+// Produces a complete audio payload in the format above. Short sounds get
+// a chunk size just big enough to hold them.
+std::vector<uint8_t> buildAudio(const AudioBuffer& audio, const AudioBuildOptions& options);
+
+// Validates an audio header read from the first bytes of a payload. Throws
+// std::runtime_error if it is malformed.
+AudioFormat::Header readAudioHeader(const uint8_t* data, size_t size);
+
+// Zero-copy view of a fully resident audio payload
+class AudioView {
+public:
+    // Validates the header and that every chunk is present. Throws
+    // std::runtime_error on a malformed payload.
+    AudioView(const uint8_t* data, size_t size);
+
+    static bool isAudio(const uint8_t* data, size_t size);
+
+    const AudioFormat::Header& header() const { return m_header; }
+    uint32_t sampleRate() const { return m_header.sampleRate; }
+    uint32_t channelCount() const { return m_header.channelCount; }
+    uint64_t frameCount() const { return m_header.frameCount; }
+    bool looping() const { return (m_header.flags & AudioFormat::Looping) != 0; }
+    const uint8_t* chunk(uint32_t index) const;
+
+    // Copies up to count interleaved frames starting at first and returns
+    // how many there were
+    size_t readFrames(uint64_t first, size_t count, int16_t* output) const;
+
+private:
+    const uint8_t* m_data;
+    AudioFormat::Header m_header;
+};
+
+} // namespace World
+} // namespace Aincrad
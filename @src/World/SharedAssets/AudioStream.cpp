@@ -0,0 +1,228 @@
+#include "AudioStream.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+constexpr uint32_t NoChunk = std::numeric_limits<uint32_t>::max();
+
+std::vector<uint8_t> readRange(StreamingReadQueue& reader, const std::shared_ptr<StreamFile>& file,
+                               uint64_t offset, size_t size) {
+    std::vector<uint8_t> bytes(size);
+    reader.readInto(file, offset, size, bytes.data());
+    return bytes;
+}
+
+} // namespace
+
+AudioStream::AudioStream(const std::string& path, std::shared_ptr<StreamingReadQueue> reader,
+                         size_t readAheadChunks)
+    : m_reader(std::move(reader))
+    , m_file(std::make_shared<StreamFile>())
+    , m_lane(StreamingReadQueue::SharedLane)
+    , m_readAhead(0)
+    , m_header()
+    , m_decodedChunk(NoChunk)
+    , m_nextChunk(0)
+    , m_position(0)
+{
+    if (!m_reader) {
+        throw std::runtime_error("Audio streaming needs a streaming reader: " + path);
+    }
+    m_file->open(path);
+    const uint64_t fileSize = m_file->size();
+
+    // Compressed files locate each chunk through the block table, which
+    // sits at the front; block 0 is the padded header and block i + 1 is
+    // chunk i. Uncompressed files hold the chunks at fixed offsets.
+    std::vector<uint8_t> head =
+        readRange(*m_reader, m_file, 0, std::min<uint64_t>(fileSize, sizeof(CompressedFormat::Header)));
+    if (isCompressedAsset(head.data(), head.size())) {
+        CompressedFormat::Header codec;
+        std::memcpy(&codec, head.data(), sizeof(codec));
+        uint64_t tableSize = sizeof(codec) + uint64_t(codec.blockCount) * sizeof(CompressedFormat::BlockEntry);
+        if (tableSize > fileSize) {
+            throw std::runtime_error("Audio file is truncated: " + path);
+        }
+        std::vector<uint8_t> table = readRange(*m_reader, m_file, 0, size_t(tableSize));
+        m_chunks = compressedBlockTable(table.data(), table.size());
+        if (m_chunks.empty()) {
+            throw std::runtime_error("Not an audio payload: " + path);
+        }
+        std::vector<uint8_t> block = readRange(*m_reader, m_file, m_chunks[0].offset, m_chunks[0].compressedSize);
+        std::vector<uint8_t> first(m_chunks[0].rawSize);
+        decompressAssetBlock(m_chunks[0], block.data(), block.size(), first.data());
+        m_header = readAudioHeader(first.data(), first.size());
+        if (codec.blockSize != m_header.chunkSize || m_chunks.size() != size_t(m_header.chunkCount) + 1) {
+            throw std::runtime_error("Audio file was not compressed in chunk-sized blocks: " + path);
+        }
+        m_chunks.erase(m_chunks.begin());
+    } else {
+        std::vector<uint8_t> bytes =
+            readRange(*m_reader, m_file, 0, std::min<uint64_t>(fileSize, sizeof(AudioFormat::Header)));
+        m_header = readAudioHeader(bytes.data(), bytes.size());
+        if (fileSize / m_header.chunkSize < uint64_t(m_header.chunkCount) + 1) {
+            throw std::runtime_error("Audio file is truncated: " + path);
+        }
+        for (uint32_t i = 0; i < m_header.chunkCount; ++i) {
+            m_chunks.push_back({uint64_t(i + 1) * m_header.chunkSize, m_header.chunkSize, m_header.chunkSize});
+        }
+    }
+    for (const auto& chunk : m_chunks) {
+        if (chunk.rawSize != m_header.chunkSize || chunk.offset > fileSize ||
+            chunk.compressedSize > fileSize - chunk.offset) {
+            throw std::runtime_error("Audio file is truncated: " + path);
+        }
+    }
+
+    if (m_header.chunkSize > m_reader->getChunkSize()) {
+        throw std::runtime_error("Audio chunks do not fit the streaming reader's slots: " + path);
+    }
+
+    // The lane bounds how much of the shared ring this stream holds, read
+    // ahead or waiting to be decoded
+    m_readAhead = std::min(std::max<size_t>(readAheadChunks, 1), m_reader->getSlotCount());
+    m_lane = m_reader->openLane(m_readAhead);
+    m_decoded.resize(m_header.chunkSize);
+    try {
+        fill();
+    } catch (...) {
+        m_reader->closeLane(m_lane);
+        throw;
+    }
+}
+
+AudioStream::~AudioStream() {
+    // No callback runs once the lane is closed, so what arrived is final
+    m_reader->closeLane(m_lane);
+    for (const Arrival& arrival : m_arrivals) {
+        if (arrival.error == 0) {
+            m_reader->release(arrival.data);
+        }
+    }
+}
+
+void AudioStream::seek(uint64_t frame) {
+    if (frame > m_header.frameCount) {
+        throw std::runtime_error("Seek past the end of the audio");
+    }
+    m_position = frame;
+    uint32_t chunk = uint32_t(frame / m_header.framesPerChunk);
+    if (chunk != m_decodedChunk) {
+        m_nextChunk = chunk;
+    }
+    fill();
+}
+
+size_t AudioStream::read(int16_t* output, size_t frameCount, bool wait) {
+    const size_t channels = m_header.channelCount;
+    size_t done = 0;
+    while (done < frameCount) {
+        if (m_position >= m_header.frameCount) {
+            if (!looping() || m_header.frameCount == 0) {
+                break;
+            }
+            m_position = 0;
+        }
+        uint32_t chunk = uint32_t(m_position / m_header.framesPerChunk);
+        if (chunk != m_decodedChunk && !receive(chunk, wait)) {
+            break;
+        }
+        uint64_t inChunk = m_position % m_header.framesPerChunk;
+        size_t run = size_t(std::min<uint64_t>({frameCount - done, m_header.framesPerChunk - inChunk,
+                                                m_header.frameCount - m_position}));
+        std::memcpy(output + done * channels, m_decoded.data() + inChunk * channels * sizeof(int16_t),
+                    run * channels * sizeof(int16_t));
+        done += run;
+        m_position += run;
+    }
+    fill();
+    return done;
+}
+
+// Keeps the ring full with the chunks after the newest one requested,
+// wrapping around for loops
+void AudioStream::fill() {
+    while (m_header.chunkCount > 0) {
+        if (m_nextChunk >= m_header.chunkCount) {
+            if (!looping()) {
+                return;
+            }
+            m_nextChunk = 0;
+        }
+        if (m_pending.size() >= m_readAhead) {
+            return;
+        }
+        // Each read is one slot, so it arrives as one chunk or one failure
+        const auto& chunk = m_chunks[m_nextChunk];
+        m_reader->read(m_lane, m_file, chunk.offset, chunk.compressedSize,
+            [this](const StreamChunk& data) {
+                std::lock_guard<std::mutex> lock(m_arrivalMutex);
+                m_arrivals.push_back({data, 0});
+                m_arrived.notify_one();
+                return false;
+            },
+            [this](int error) {
+                if (error != 0) {
+                    std::lock_guard<std::mutex> lock(m_arrivalMutex);
+                    m_arrivals.push_back({StreamChunk(), error});
+                    m_arrived.notify_one();
+                }
+            });
+        m_pending.push_back(m_nextChunk++);
+    }
+}
+
+// Chunks arrive in submission order; any ahead of the wanted one were read
+// for a position playback has since left, and are dropped
+bool AudioStream::receive(uint32_t chunk, bool wait) {
+    for (;;) {
+        if (m_pending.empty()) {
+            m_nextChunk = chunk;
+            fill();
+            if (m_pending.empty()) {
+                return false;
+            }
+        }
+        Arrival arrival;
+        {
+            std::unique_lock<std::mutex> lock(m_arrivalMutex);
+            if (wait) {
+                m_arrived.wait(lock, [this] { return !m_arrivals.empty(); });
+            } else if (m_arrivals.empty()) {
+                return false;
+            }
+            arrival = m_arrivals.front();
+            m_arrivals.pop_front();
+        }
+        const StreamChunk& data = arrival.data;
+        uint32_t arrived = m_pending.front();
+        m_pending.pop_front();
+        const auto& block = m_chunks[arrived];
+        if (arrival.error != 0) {
+            throw std::runtime_error("Failed to read audio chunk " + std::to_string(arrived) + " from " +
+                                     m_file->path());
+        }
+        if (arrived == chunk) {
+            try {
+                decompressAssetBlock(block, data.data, data.size, m_decoded.data());
+            } catch (...) {
+                m_reader->release(data);
+                throw;
+            }
+            m_reader->release(data);
+            m_decodedChunk = chunk;
+            return true;
+        }
+        m_reader->release(data);
+        fill();
+    }
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AssetCodec.h"
+#include "AudioFormat.h"
+#include "StreamingReadQueue.h"
+
+namespace Aincrad {
+namespace World {
+
+// Plays an imported audio file from disk a chunk at a time, so a long
+// ambient loop holds a few chunks in memory rather than the whole sound.
+// Reads go through the shared streaming reader on a lane of its own that
+// holds at most readAheadChunks slots of the ring; each chunk is one codec
+// block, decoded only when playback reaches it. Compressed and uncompressed
+// loose files both stream. A stream keeps its read-ahead while it is not
+// being read, so the read-ahead of streams open at once should fit the
+// ring with a slot to spare for loads.
+//
+// One thread reads, seeks and destroys the stream.
+class AudioStream {
+public:
+    static constexpr size_t DefaultReadAhead = 4;
+
+    // Opens the file and reads its block table and audio header. Throws
+    // std::runtime_error if it is not an audio payload, its codec blocks do
+    // not line up with its chunks, or a chunk does not fit a reader slot.
+    AudioStream(const std::string& path, std::shared_ptr<StreamingReadQueue> reader,
+                size_t readAheadChunks = DefaultReadAhead);
+    // Cancels the stream's reads and hands back the chunks it holds
+    ~AudioStream();
+
+    AudioStream(const AudioStream&) = delete;
+    AudioStream& operator=(const AudioStream&) = delete;
+
+    const AudioFormat::Header& header() const { return m_header; }
+    uint64_t position() const { return m_position; }
+    bool looping() const { return (m_header.flags & AudioFormat::Looping) != 0; }
+    bool finished() const { return !looping() && m_position >= m_header.frameCount; }
+
+    // Moves playback to a frame. Reads already in flight for the old
+    // position are dropped as they land. Throws std::runtime_error past
+    // the end.
+    void seek(uint64_t frame);
+
+    // Copies up to frameCount interleaved frames into output, wrapping if
+    // the sound loops, and queues reads for the chunks after them. Without
+    // wait it never blocks, and returns short when the next chunk has not
+    // arrived yet. Throws std::runtime_error on a failed or short read.
+    size_t read(int16_t* output, size_t frameCount, bool wait = false);
+
+private:
+    // A chunk's read as delivered by the reader's I/O thread
+    struct Arrival {
+        StreamChunk data;
+        int error = 0;
+    };
+
+    void fill();
+    bool receive(uint32_t chunk, bool wait);
+
+    std::shared_ptr<StreamingReadQueue> m_reader;
+    std::shared_ptr<StreamFile> m_file;
+    StreamingReadQueue::Lane m_lane;
+    size_t m_readAhead;
+    AudioFormat::Header m_header;
+    std::vector<CompressedFormat::BlockEntry> m_chunks; // Where each chunk's bytes sit in the file
+    std::deque<uint32_t> m_pending;                     // Chunks requested and not taken yet, in order
+    std::deque<Arrival> m_arrivals;                     // Kept chunks and failures, oldest first
+    std::mutex m_arrivalMutex;
+    std::condition_variable m_arrived;
+    std::vector<uint8_t> m_decoded;
+    uint32_t m_decodedChunk;
+    uint32_t m_nextChunk;
+    uint64_t m_position;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// Hash map split into independently locked shards. Lookups take a shared
+// lock on one shard only, so readers on different threads rarely contend
+// and never block each other.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, size_t ShardCount = 64>
+class ConcurrentAssetTable {
+    static_assert((ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+
+public:
+    // Returns a default-constructed Value when the key is absent
+    Value find(const Key& key) const {
+        const Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        return it != shard.entries.end() ? it->second : Value();
+    }
+
+    // Insert-once: when several threads race on the same key, exactly one
+    // factory call runs and every caller receives its result. The factory
+    // runs under the shard lock and may throw, in which case nothing is
+    // inserted. The bool is true for the caller that inserted.
+    template <typename Factory>
+    std::pair<Value, bool> findOrInsert(const Key& key, Factory&& factory) {
+        Shard& shard = shardFor(key);
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.entries.find(key);
+            if (it != shard.entries.end()) {
+                return {it->second, false};
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            return {it->second, false};
+        }
+
+        Value value = factory();
+        shard.entries.emplace(key, value);
+        return {value, true};
+    }
+
+    // Removes and returns the entry, or a default-constructed Value
+    Value erase(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return Value();
+        }
+        Value value = std::move(it->second);
+        shard.entries.erase(it);
+        return value;
+    }
+
+    // Removes and returns the entry only if predicate(value) holds. The check
+    // runs under the exclusive shard lock, so no reader can copy the value
+    // between the check and the removal.
+    template <typename Predicate>
+    Value eraseIf(const Key& key, Predicate&& predicate) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end() || !predicate(it->second)) {
+            return Value();
+        }
+        Value value = std::move(it->second);
+        shard.entries.erase(it);
+        return value;
+    }
+
+    // Visits every entry one shard at a time; the visitor must not call back
+    // into the table
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const {
+        for (const Shard& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [key, value] : shard.entries) {
+                visitor(key, value);
+            }
+        }
+    }
+
+    // Copies the values out so callers can act on them without holding locks
+    std::vector<Value> values() const {
+        std::vector<Value> result;
+        forEach([&result](const Key&, const Value& value) { result.push_back(value); });
+        return result;
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const Shard& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (Shard& shard : m_shards) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.entries.clear();
+        }
+    }
+
+private:
+    // Padded so neighbouring shard locks do not share a cache line
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value, Hash> entries;
+    };
+
+    Shard& shardFor(const Key& key) {
+        return m_shards[shardIndex(key)];
+    }
+
+    const Shard& shardFor(const Key& key) const {
+        return m_shards[shardIndex(key)];
+    }
+
+    static size_t shardIndex(const Key& key) {
+        // Mix the high bits in; std::hash is the identity for integers
+        size_t hash = Hash()(key);
+        hash ^= hash >> 29;
+        return hash & (ShardCount - 1);
+    }
+
+    std::array<Shard, ShardCount> m_shards;
+};
+
+} // namespace World
+} // namespace Aincrad
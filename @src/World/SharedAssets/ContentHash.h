@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Aincrad {
+namespace World {
+
+// SHA-256 digest identifying a payload by its bytes
+struct ContentHash {
+    std::array<uint8_t, 32> bytes{};
+
+    std::string toHex() const;
+    // Accepts exactly 64 hex digits, either case
+    static std::optional<ContentHash> fromHex(std::string_view hex);
+
+    bool operator==(const ContentHash& other) const { return bytes == other.bytes; }
+    bool operator!=(const ContentHash& other) const { return bytes != other.bytes; }
+};
+
+// The digest is already uniform, so its leading bytes make a good table key
+struct ContentHashHasher {
+    size_t operator()(const ContentHash& hash) const {
+        size_t key;
+        std::memcpy(&key, hash.bytes.data(), sizeof(key));
+        return key;
+    }
+};
+
+// Incremental SHA-256 (FIPS 180-4) for hashing payloads streamed in pieces
+class Sha256 {
+public:
+    Sha256();
+
+    void update(const uint8_t* data, size_t size);
+    ContentHash finish();
+
+    static ContentHash hash(const uint8_t* data, size_t size);
+
+private:
+    void compress(const uint8_t* block);
+
+    std::array<uint32_t, 8> m_state;
+    std::array<uint8_t, 64> m_buffer;
+    size_t m_buffered;
+    uint64_t m_length;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Aincrad {
+namespace World {
+
+// Read-only memory mapping of a whole file. Pages are faulted in lazily by
+// the OS, so opening is O(1) regardless of file size.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    void open(const std::string& path);
+    void close();
+
+    // Getters
+    bool isOpen() const { return m_open; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    const std::string& path() const { return m_path; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    std::string m_path;
+    bool m_open;
+#if defined(_WIN32)
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+};
+
+} // namespace World
+} // namespace Aincrad
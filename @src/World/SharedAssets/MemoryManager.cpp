@@ -1,70 +1,502 @@
 #include "MemoryManager.h"
+#include <algorithm>
+#include <new>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace Aincrad {
 namespace World {
 
 MemoryManager::MemoryManager()
-    : m_totalAllocated(0)
+    : m_degradedAssets(0)
+    , m_releasing(0)
+    , m_totalAllocated(0)
+    , m_assetCount(0)
+    , m_inflation(0.0)
+    , m_useCounter(0)
+    , m_evictionCount(0)
+    , m_evictedBytes(0)
+    , m_qualityDrops(0)
+    , m_qualityRestores(0)
 {
 }
 
 MemoryManager::~MemoryManager() {
+    for (const auto& [asset, allocation] : m_allocatedMemory) {
+        release(allocation);
+    }
     m_allocatedMemory.clear();
     m_totalAllocated = 0;
 }
 
 void MemoryManager::configure(const MemoryConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_config = config;
+    for (auto& category : m_categories) {
+        auto budget = m_config.categoryBudgets.find(category.name);
+        category.budget = budget != m_config.categoryBudgets.end() ? budget->second : 0;
+    }
 }
 
-void MemoryManager::allocateMemory(const std::string& assetId, size_t size) {
-    // Check if we have enough memory
-    if (m_totalAllocated + size > m_config.maxMemoryUsage) {
-        throw std::runtime_error("Not enough memory available");
-    }
+void MemoryManager::setEvictionCallback(EvictionCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_evictionCallback = std::move(callback);
+}
+
+void MemoryManager::setQualityCallback(QualityCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_qualityCallback = std::move(callback);
+}
+
+void MemoryManager::setUseStampCallback(UseStampCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_useStampCallback = std::move(callback);
+}
+
+void* MemoryManager::allocateMemory(AssetHandle asset, size_t size, const std::string& category) {
+    std::unique_lock<std::mutex> lock(m_mutex);
 
     // Check if asset already has memory allocated
-    auto it = m_allocatedMemory.find(assetId);
-    if (it != m_allocatedMemory.end()) {
-        throw std::runtime_error("Asset already has memory allocated: " + assetId);
+    auto checkUnallocated = [this, asset] {
+        if (m_allocatedMemory.count(asset)) {
+            throw std::runtime_error("Asset already has memory allocated: handle " + std::to_string(asset.index));
+        }
+    };
+    checkUnallocated();
+
+    // Category budgets are soft: make room in the category when paging, but
+    // only the overall budget can fail the allocation
+    size_t categorySlot = categoryIndex(category);
+    uint64_t categoryBudget = m_categories[categorySlot].budget;
+    if (m_config.enablePaging && categoryBudget && usage(categorySlot) + size > categoryBudget &&
+        size <= categoryBudget) {
+        makeRoom(categorySlot, categoryBudget - size, lock);
     }
 
+    // Check if we have enough memory, making room first when paging
+    if (m_totalAllocated + size > m_config.maxMemoryUsage) {
+        if (m_config.enablePaging && size <= m_config.maxMemoryUsage) {
+            makeRoom(AllCategories, m_config.maxMemoryUsage - size, lock);
+        }
+        if (m_totalAllocated + size > m_config.maxMemoryUsage) {
+            throw std::runtime_error("Not enough memory available");
+        }
+    }
+
+    // Making room drops the lock for callbacks, so another caller may have
+    // allocated for the same asset in the meantime
+    checkUnallocated();
+
     // Allocate memory based on strategy
+    Allocation allocation{nullptr, size, std::chrono::microseconds(0), 0.0, 0, categorySlot, {}, false};
     switch (m_config.strategy) {
         case MemoryConfig::PagingStrategy::PoolAllocation:
-            // TODO: Implement pool allocation
+            // Not pooled: nothing on the load path allocates here, so a
+            // slab pool would serve no asset churn; heap until one does
+            allocation.block = ::operator new(size);
             break;
         case MemoryConfig::PagingStrategy::DynamicAllocation:
-            // TODO: Implement dynamic allocation
+            allocation.block = ::operator new(size);
             break;
         case MemoryConfig::PagingStrategy::PlatformSpecific:
-            // TODO: Implement platform-specific allocation
+            // TODO: Implement platform-specific allocation; heap until then
+            allocation.block = ::operator new(size);
             break;
         case MemoryConfig::PagingStrategy::QualityBased:
-            // TODO: Implement quality-based allocation
+            // Blocks owned here have a fixed size; quality steps apply to
+            // tracked payloads
+            allocation.block = ::operator new(size);
             break;
         default:
             throw std::runtime_error("Unknown paging strategy");
     }
 
-    m_allocatedMemory[assetId] = size;
-    m_totalAllocated += size;
+    markUsed(allocation);
+    void* block = allocation.block;
+    insert(asset, std::move(allocation));
+    return block;
 }
 
-void MemoryManager::deallocateMemory(const std::string& assetId) {
-    auto it = m_allocatedMemory.find(assetId);
+void MemoryManager::deallocateMemory(AssetHandle asset) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_allocatedMemory.find(asset);
     if (it != m_allocatedMemory.end()) {
-        m_totalAllocated -= it->second;
-        m_allocatedMemory.erase(it);
+        release(it->second);
+        erase(it);
+    }
+}
+
+void MemoryManager::deallocateMemory(const std::vector<AssetHandle>& assets) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (AssetHandle asset : assets) {
+        auto it = m_allocatedMemory.find(asset);
+        if (it != m_allocatedMemory.end()) {
+            release(it->second);
+            erase(it);
+        }
+    }
+}
+
+void MemoryManager::trackAsset(AssetHandle asset, size_t size, std::chrono::microseconds reloadCost,
+                               const std::string& category, bool reloaded) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_allocatedMemory.find(asset);
+    if (it == m_allocatedMemory.end()) {
+        it = insert(asset, Allocation{nullptr, 0, reloadCost, 0.0, 0, categoryIndex(category), {}, false});
+    }
+
+    // Loaded again before an eviction was retired; the entry is live again
+    setReleasing(it->second, false);
+
+    // Tracked payloads are owned elsewhere; only the accounting changes. A
+    // degraded asset is charged its degraded size until it is reloaded.
+    Allocation& allocation = it->second;
+    if (reloaded && !allocation.fullerSizes.empty()) {
+        allocation.fullerSizes.clear();
+        --m_categories[allocation.category].degradedAssets;
+        --m_degradedAssets;
+    }
+    if (!allocation.block && allocation.fullerSizes.empty()) {
+        resize(allocation, size);
+    }
+    allocation.reloadCost = reloadCost;
+    markUsed(allocation);
+}
+
+void MemoryManager::touch(AssetHandle asset) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_allocatedMemory.find(asset);
+    if (it != m_allocatedMemory.end()) {
+        markUsed(it->second);
+    }
+}
+
+size_t MemoryManager::getAllocatedSize(AssetHandle asset) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_allocatedMemory.find(asset);
+    return it != m_allocatedMemory.end() ? it->second.size : 0;
+}
+
+uint32_t MemoryManager::getQualityLevel(AssetHandle asset) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_allocatedMemory.find(asset);
+    return it != m_allocatedMemory.end() ? uint32_t(it->second.fullerSizes.size()) : 0;
+}
+
+MemoryStats MemoryManager::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MemoryStats stats = getCounters();
+    for (const auto& category : m_categories) {
+        stats.categories.push_back({category.name, category.budget, category.allocated,
+                                    category.assetCount, category.degradedAssets});
+    }
+    return stats;
+}
+
+MemoryStats MemoryManager::getCounters() const {
+    MemoryStats stats;
+    stats.totalAllocated = m_totalAllocated.load(std::memory_order_relaxed);
+    stats.assetCount = m_assetCount.load(std::memory_order_relaxed);
+    stats.evictionCount = m_evictionCount.load(std::memory_order_relaxed);
+    stats.evictedBytes = m_evictedBytes.load(std::memory_order_relaxed);
+    stats.qualityDrops = m_qualityDrops.load(std::memory_order_relaxed);
+    stats.qualityRestores = m_qualityRestores.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t MemoryManager::categoryIndex(const std::string& name) {
+    auto [it, inserted] = m_categoryIndex.emplace(name, m_categories.size());
+    if (inserted) {
+        auto budget = m_config.categoryBudgets.find(name);
+        m_categories.push_back({name, budget != m_config.categoryBudgets.end() ? budget->second : 0, 0, 0, 0, 0});
+    }
+    return it->second;
+}
+
+uint64_t MemoryManager::usage(size_t category) const {
+    return category == AllCategories ? m_totalAllocated.load() - m_releasing
+                                     : m_categories[category].allocated - m_categories[category].releasing;
+}
+
+std::unordered_map<AssetHandle, MemoryManager::Allocation, AssetHandleHash>::iterator
+MemoryManager::insert(AssetHandle asset, Allocation allocation) {
+    // Charging a duplicate would count bytes no entry can ever give back
+    auto [it, inserted] = m_allocatedMemory.emplace(asset, std::move(allocation));
+    if (!inserted) {
+        throw std::logic_error("Asset is already tracked: handle " + std::to_string(asset.index));
+    }
+    Category& category = m_categories[it->second.category];
+    category.allocated += it->second.size;
+    ++category.assetCount;
+    m_totalAllocated += it->second.size;
+    m_assetCount = m_allocatedMemory.size();
+    return it;
+}
+
+void MemoryManager::erase(std::unordered_map<AssetHandle, Allocation, AssetHandleHash>::iterator it) {
+    Allocation& allocation = it->second;
+    setReleasing(allocation, false);
+    Category& category = m_categories[allocation.category];
+    category.allocated -= allocation.size;
+    --category.assetCount;
+    if (!allocation.fullerSizes.empty()) {
+        --category.degradedAssets;
+        --m_degradedAssets;
+    }
+    m_totalAllocated -= allocation.size;
+    m_allocatedMemory.erase(it);
+    m_assetCount = m_allocatedMemory.size();
+}
+
+void MemoryManager::resize(Allocation& allocation, size_t size) {
+    Category& category = m_categories[allocation.category];
+    category.allocated = category.allocated - allocation.size + size;
+    m_totalAllocated = m_totalAllocated - allocation.size + size;
+    if (allocation.releasing) {
+        category.releasing = category.releasing - allocation.size + size;
+        m_releasing = m_releasing - allocation.size + size;
+    }
+    allocation.size = size;
+}
+
+void MemoryManager::setReleasing(Allocation& allocation, bool releasing) {
+    if (allocation.releasing == releasing) {
+        return;
+    }
+    Category& category = m_categories[allocation.category];
+    if (releasing) {
+        category.releasing += allocation.size;
+        m_releasing += allocation.size;
+    } else {
+        category.releasing -= allocation.size;
+        m_releasing -= allocation.size;
+    }
+    allocation.releasing = releasing;
+}
+
+void MemoryManager::release(const Allocation& allocation) {
+    ::operator delete(allocation.block);
+}
+
+void MemoryManager::markUsed(Allocation& allocation, uint64_t stamp) {
+    // GreedyDual-Size: assets that are cheap to reload per byte sit closest
+    // to the inflation floor, and every eviction raises the floor, so assets
+    // that are not touched again age out
+    double reloadMicros = double(allocation.reloadCost.count()) + 1.0;
+    allocation.credit = m_inflation + reloadMicros / double(allocation.size ? allocation.size : 1);
+    allocation.lastUse = stamp ? stamp : nextUseStamp();
+}
+
+void MemoryManager::foldUseStamps(size_t category) {
+    if (!m_useStampCallback) {
+        return;
+    }
+    for (auto& [asset, allocation] : m_allocatedMemory) {
+        if (category != AllCategories && allocation.category != category) {
+            continue;
+        }
+        uint64_t stamp = m_useStampCallback(asset);
+        if (stamp > allocation.lastUse) {
+            markUsed(allocation, stamp);
+        }
+    }
+}
+
+bool MemoryManager::usedSince(AssetHandle asset, uint64_t lastUse) const {
+    return m_useStampCallback && m_useStampCallback(asset) > lastUse;
+}
+
+void MemoryManager::makeRoom(size_t category, uint64_t target, std::unique_lock<std::mutex>& lock) {
+    if (m_config.strategy == MemoryConfig::PagingStrategy::QualityBased) {
+        reduceQuality(category, target, lock);
+    }
+    evictDownTo(target, lock, category);
+}
+
+void MemoryManager::reduceQuality(size_t category, uint64_t target, std::unique_lock<std::mutex>& lock) {
+    if (!m_qualityCallback || usage(category) <= target) {
+        return;
+    }
+
+    // Every asset in the category drops one level, least valuable first,
+    // before any asset drops a second one
+    foldUseStamps(category);
+    QualityCallback callback = m_qualityCallback;
+    for (uint32_t level = 1; level <= m_config.maxQualityLevel && usage(category) > target; ++level) {
+        struct Candidate {
+            AssetHandle asset;
+            double credit;
+            uint64_t lastUse;
+        };
+        std::vector<Candidate> candidates;
+        for (const auto& [asset, allocation] : m_allocatedMemory) {
+            if (!allocation.block && !allocation.releasing && allocation.fullerSizes.size() + 1 == level &&
+                (category == AllCategories || allocation.category == category)) {
+                candidates.push_back({asset, allocation.credit, allocation.lastUse});
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.credit != b.credit ? a.credit < b.credit : a.lastUse < b.lastUse;
+        });
+
+        for (const Candidate& candidate : candidates) {
+            if (usage(category) <= target) {
+                break;
+            }
+
+            // The callback may touch the asset, so it runs without our lock held
+            lock.unlock();
+            std::optional<size_t> size = callback(candidate.asset, level);
+            lock.lock();
+            auto it = m_allocatedMemory.find(candidate.asset);
+            if (!size || it == m_allocatedMemory.end() || it->second.releasing ||
+                it->second.fullerSizes.size() + 1 != level) {
+                continue;
+            }
+
+            Allocation& allocation = it->second;
+            if (allocation.fullerSizes.empty()) {
+                ++m_categories[allocation.category].degradedAssets;
+                ++m_degradedAssets;
+            }
+            allocation.fullerSizes.push_back(allocation.size);
+            resize(allocation, *size);
+            ++m_qualityDrops;
+        }
+    }
+}
+
+void MemoryManager::restoreQuality(size_t category, uint64_t target, std::unique_lock<std::mutex>& lock) {
+    if (!m_qualityCallback) {
+        return;
+    }
+
+    // Most recently used assets get their detail back first, one level per
+    // update, and only while the result stays under both low water marks
+    foldUseStamps(category);
+    struct Candidate {
+        AssetHandle asset;
+        uint64_t lastUse;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& [asset, allocation] : m_allocatedMemory) {
+        if (!allocation.fullerSizes.empty() && !allocation.releasing && allocation.category == category) {
+            candidates.push_back({asset, allocation.lastUse});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.lastUse > b.lastUse;
+    });
+
+    const uint64_t overallTarget = uint64_t(double(m_config.maxMemoryUsage) * m_config.evictionLowWater);
+    QualityCallback callback = m_qualityCallback;
+    for (const Candidate& candidate : candidates) {
+        auto it = m_allocatedMemory.find(candidate.asset);
+        if (it == m_allocatedMemory.end() || it->second.fullerSizes.empty()) {
+            continue;
+        }
+        size_t level = it->second.fullerSizes.size();
+        size_t fuller = it->second.fullerSizes.back();
+        uint64_t growth = fuller > it->second.size ? fuller - it->second.size : 0;
+        if (usage(category) + growth > target || m_totalAllocated + growth > overallTarget) {
+            continue;
+        }
+
+        lock.unlock();
+        std::optional<size_t> size = callback(candidate.asset, uint32_t(level - 1));
+        lock.lock();
+        it = m_allocatedMemory.find(candidate.asset);
+        if (!size || it == m_allocatedMemory.end() || it->second.fullerSizes.size() != level) {
+            continue;
+        }
+
+        Allocation& allocation = it->second;
+        allocation.fullerSizes.pop_back();
+        if (allocation.fullerSizes.empty()) {
+            --m_categories[allocation.category].degradedAssets;
+            --m_degradedAssets;
+        }
+        resize(allocation, *size);
+        ++m_qualityRestores;
+    }
+}
+
+void MemoryManager::evictDownTo(uint64_t target, std::unique_lock<std::mutex>& lock, size_t category) {
+    if (!m_evictionCallback || usage(category) <= target) {
+        return;
+    }
+
+    foldUseStamps(category);
+    struct Candidate {
+        AssetHandle asset;
+        double credit;
+        uint64_t lastUse;
+    };
+    std::vector<Candidate> candidates;
+    candidates.reserve(m_allocatedMemory.size());
+    for (const auto& [asset, allocation] : m_allocatedMemory) {
+        if (!allocation.releasing && (category == AllCategories || allocation.category == category)) {
+            candidates.push_back({asset, allocation.credit, allocation.lastUse});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.credit != b.credit ? a.credit < b.credit : a.lastUse < b.lastUse;
+    });
+
+    // The callback may unload assets, so it runs without our lock held
+    EvictionCallback callback = m_evictionCallback;
+    for (const Candidate& candidate : candidates) {
+        if (usage(category) <= target) {
+            break;
+        }
+
+        auto it = m_allocatedMemory.find(candidate.asset);
+        if (it == m_allocatedMemory.end() || it->second.releasing || it->second.lastUse != candidate.lastUse ||
+            usedSince(candidate.asset, candidate.lastUse)) {
+            continue; // Released or used since we ranked it
+        }
+        size_t size = it->second.size;
+
+        lock.unlock();
+        bool released = callback(candidate.asset);
+        lock.lock();
+        if (!released) {
+            continue;
+        }
+
+        // The owner deallocates the asset once its payload is really gone,
+        // which may be right away or at the next frame boundary. Until then
+        // it stays charged, so the budget never reads lower than what is
+        // resident.
+        m_inflation = std::max(m_inflation, candidate.credit);
+        m_evictedBytes += size;
+        ++m_evictionCount;
+        it = m_allocatedMemory.find(candidate.asset);
+        if (it != m_allocatedMemory.end() && it->second.lastUse == candidate.lastUse) {
+            setReleasing(it->second, true);
+        }
     }
 }
 
 void MemoryManager::update() {
+    std::unique_lock<std::mutex> lock(m_mutex);
     if (!m_config.enablePaging) {
         return;
     }
 
+    // Make room once usage approaches the overall budget or a category's
+    double budget = double(m_config.maxMemoryUsage);
+    if (m_totalAllocated > budget * m_config.evictionHighWater) {
+        makeRoom(AllCategories, uint64_t(budget * m_config.evictionLowWater), lock);
+    }
+    for (size_t i = 0; i < m_categories.size(); ++i) {
+        double categoryBudget = double(m_categories[i].budget);
+        if (categoryBudget > 0.0 && m_categories[i].allocated > categoryBudget * m_config.evictionHighWater) {
+            makeRoom(i, uint64_t(categoryBudget * m_config.evictionLowWater), lock);
+        }
+    }
+
     // Update memory management based on strategy
     switch (m_config.strategy) {
         case MemoryConfig::PagingStrategy::PoolAllocation:
@@ -77,7 +509,14 @@ void MemoryManager::update() {
             // TODO: Implement platform-specific update
             break;
         case MemoryConfig::PagingStrategy::QualityBased:
-            // TODO: Implement quality-based update
+            // Give detail back once a category has headroom again
+            for (size_t i = 0; i < m_categories.size() && m_degradedAssets > 0; ++i) {
+                if (m_categories[i].degradedAssets > 0) {
+                    uint64_t categoryBudget = m_categories[i].budget;
+                    restoreQuality(i, categoryBudget ? uint64_t(double(categoryBudget) * m_config.evictionLowWater)
+                                                     : UINT64_MAX, lock);
+                }
+            }
             break;
         default:
             throw std::runtime_error("Unknown paging strategy");
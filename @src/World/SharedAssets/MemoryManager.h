@@ -1,15 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "Asset.h"
+#include "AssetHandle.h"
 
 namespace Aincrad {
 namespace World {
 
 struct MemoryConfig {
-    int maxMemoryUsage;
+    uint64_t maxMemoryUsage;
     bool enablePaging;
     enum class PagingStrategy {
         PoolAllocation,
@@ -23,8 +31,56 @@ struct MemoryConfig {
         bool textureCompression;
         bool memoryManagement;
     } platformSettings;
+
+    // With paging enabled, update() starts evicting above the high water
+    // mark and stops once usage is back under the low water mark
+    float evictionHighWater = 0.9f;
+    float evictionLowWater = 0.8f;
+
+    // Soft budgets per asset type (texture, model, audio, ...) that apply on
+    // top of maxMemoryUsage, with the same water marks. Types without an
+    // entry only count against the overall budget.
+    std::unordered_map<std::string, uint64_t> categoryBudgets;
+
+    // QualityBased: how many quality steps (top mips, high LODs) an asset
+    // may drop under pressure before assets are evicted
+    uint32_t maxQualityLevel = 2;
+};
+
+struct MemoryCategoryStats {
+    std::string category;
+    uint64_t budget = 0;       // 0 when only the overall budget applies
+    size_t allocated = 0;
+    size_t assetCount = 0;
+    size_t degradedAssets = 0; // Assets below full quality
+};
+
+struct MemoryStats {
+    size_t totalAllocated = 0;  // Sum of requested and tracked sizes across assets
+    size_t assetCount = 0;
+    size_t evictionCount = 0;
+    size_t evictedBytes = 0;
+    size_t qualityDrops = 0;
+    size_t qualityRestores = 0;
+    std::vector<MemoryCategoryStats> categories; // Populated by getStats()
 };
 
+// Asked to release an asset chosen for eviction. Returns false to keep it,
+// e.g. while something outside the asset cache still holds it. Returning
+// true promises a deallocateMemory call for the asset, now or later; until
+// then it stays charged, since its payload is still resident, but it is not
+// offered again and eviction counts it as already gone.
+using EvictionCallback = std::function<bool(AssetHandle)>;
+// Asked to move a tracked asset to a quality level: 0 is full quality and
+// each level above drops detail, such as the top mip or the highest LOD.
+// Returns the asset's resident size at that level, or nullopt if it cannot
+// change.
+using QualityCallback = std::function<std::optional<size_t>(AssetHandle asset, uint32_t level)>;
+// Reports the newest nextUseStamp() recorded for an asset outside the
+// manager, or 0 if none. Runs under the manager's lock whenever it ranks
+// assets, so it must be cheap and must not call back into the manager.
+using UseStampCallback = std::function<uint64_t(AssetHandle asset)>;
+
 class MemoryManager {
 public:
     MemoryManager();
@@ -32,17 +88,113 @@ public:
 
     // Configuration
     void configure(const MemoryConfig& config);
+    void setEvictionCallback(EvictionCallback callback);
+    void setQualityCallback(QualityCallback callback);
+    void setUseStampCallback(UseStampCallback callback);
 
-    // Memory management
-    void allocateMemory(const std::string& assetId, size_t size);
-    void deallocateMemory(const std::string& assetId);
+    // Memory management; the returned block stays owned by the manager and
+    // is valid until deallocateMemory is called for the same asset. With
+    // paging enabled, allocation evicts idle assets before giving up, and
+    // makes room in its category when that is over budget. Blocks come from
+    // the heap under every strategy, PoolAllocation included: asset payloads
+    // are vectors owned by their Asset, shared through the blob store and
+    // reload snapshots past their handle, and are charged with trackAsset,
+    // so pooling is not used on the load path.
+    void* allocateMemory(AssetHandle asset, size_t size, const std::string& category = std::string());
+    void deallocateMemory(AssetHandle asset);
+    // Releases many assets under one lock; used by batched unloads
+    void deallocateMemory(const std::vector<AssetHandle>& assets);
     void update();
 
+    // Budget accounting for payloads that live outside the manager. Calling
+    // it again for a tracked asset refreshes its reload cost, and its size
+    // unless quality steps have changed it since. Pass reloaded when the
+    // payload was read again at full quality, which resets those steps.
+    // Only tracked assets can change quality.
+    void trackAsset(AssetHandle asset, size_t size, std::chrono::microseconds reloadCost,
+                    const std::string& category = std::string(), bool reloaded = false);
+
+    // Marks an asset as used, protecting it from eviction for longer
+    void touch(AssetHandle asset);
+    // Lock-free alternative for hot paths: stamp the use where the asset
+    // lives and report it through the use stamp callback. Stamps are folded
+    // in as if touched then, before assets are ranked for quality drops or
+    // eviction.
+    uint64_t nextUseStamp() { return m_useCounter.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    // Getters
+    size_t getAllocatedSize(AssetHandle asset) const;
+    uint32_t getQualityLevel(AssetHandle asset) const;
+    size_t getTotalAllocated() const { return m_totalAllocated.load(std::memory_order_relaxed); }
+    MemoryStats getStats() const;
+    // Lock-free counters only; leaves the category breakdown empty
+    MemoryStats getCounters() const;
+
 private:
+    struct Allocation {
+        void* block;
+        size_t size;
+        std::chrono::microseconds reloadCost;
+        double credit;    // GreedyDual-Size priority; lowest is evicted first
+        uint64_t lastUse; // Breaks ties in least recently used order
+        size_t category;  // Index into m_categories
+        std::vector<size_t> fullerSizes; // Size before each quality drop; the count is the quality level
+        bool releasing;   // Evicted; charged until its owner deallocates it
+    };
+
+    struct Category {
+        std::string name;
+        uint64_t budget;
+        size_t allocated;
+        size_t assetCount;
+        size_t degradedAssets;
+        size_t releasing; // Bytes of evicted assets not deallocated yet
+    };
+
+    static constexpr size_t AllCategories = SIZE_MAX;
+
+    size_t categoryIndex(const std::string& name);
+    // Charged bytes that are not already on their way out; what eviction and
+    // quality drops work against
+    uint64_t usage(size_t category) const;
+    // Throws std::logic_error if the asset already has an entry
+    std::unordered_map<AssetHandle, Allocation, AssetHandleHash>::iterator insert(AssetHandle asset,
+                                                                           Allocation allocation);
+    void erase(std::unordered_map<AssetHandle, Allocation, AssetHandleHash>::iterator it);
+    void resize(Allocation& allocation, size_t size);
+    void release(const Allocation& allocation);
+    void setReleasing(Allocation& allocation, bool releasing);
+    void markUsed(Allocation& allocation, uint64_t stamp = 0);
+    void foldUseStamps(size_t category);
+    bool usedSince(AssetHandle asset, uint64_t lastUse) const;
+    // Under pressure, QualityBased first drops quality across the category,
+    // one level at a time, and only then evicts
+    void makeRoom(size_t category, uint64_t target, std::unique_lock<std::mutex>& lock);
+    void reduceQuality(size_t category, uint64_t target, std::unique_lock<std::mutex>& lock);
+    void restoreQuality(size_t category, uint64_t target, std::unique_lock<std::mutex>& lock);
+    void evictDownTo(uint64_t target, std::unique_lock<std::mutex>& lock, size_t category = AllCategories);
+
     MemoryConfig m_config;
-    std::unordered_map<std::string, size_t> m_allocatedMemory;
-    size_t m_totalAllocated;
+    EvictionCallback m_evictionCallback;
+    QualityCallback m_qualityCallback;
+    UseStampCallback m_useStampCallback;
+    std::unordered_map<AssetHandle, Allocation, AssetHandleHash> m_allocatedMemory;
+    std::vector<Category> m_categories;
+    std::unordered_map<std::string, size_t> m_categoryIndex;
+    size_t m_degradedAssets;
+    uint64_t m_releasing;
+    // Counters are written under the mutex but atomic so stats can be read
+    // without it
+    std::atomic<size_t> m_totalAllocated;
+    std::atomic<size_t> m_assetCount;
+    double m_inflation; // Credit of the last eviction; ages untouched assets
+    std::atomic<uint64_t> m_useCounter;
+    std::atomic<size_t> m_evictionCount;
+    std::atomic<size_t> m_evictedBytes;
+    std::atomic<size_t> m_qualityDrops;
+    std::atomic<size_t> m_qualityRestores;
+    mutable std::mutex m_mutex;
 };
 
 } // namespace World
-} // namespace Aincrad 
\ No newline at end of file
+} // namespace Aincrad
@@ -0,0 +1,636 @@
+#include "MeshFormat.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace Aincrad {
+namespace World {
+
+using namespace MeshFormat;
+
+namespace {
+
+constexpr size_t BufferAlignment = 16;
+constexpr size_t ForsythCacheSize = 32;
+
+void validateIndices(const std::vector<uint32_t>& indices, size_t vertexCount) {
+    if (indices.size() % 3 != 0) {
+        throw std::runtime_error("Mesh index count is not a multiple of 3");
+    }
+    for (uint32_t index : indices) {
+        if (index >= vertexCount) {
+            throw std::runtime_error("Mesh index " + std::to_string(index) + " is out of range");
+        }
+    }
+}
+
+struct VertexBitsHash {
+    size_t operator()(const MeshVertex& vertex) const {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&vertex);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(MeshVertex); ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return size_t(hash);
+    }
+};
+
+struct VertexBitsEqual {
+    bool operator()(const MeshVertex& a, const MeshVertex& b) const {
+        return std::memcmp(&a, &b, sizeof(MeshVertex)) == 0;
+    }
+};
+
+// Forsyth's scoring: the three most recent vertices score flat so strips
+// do not zigzag, older cache entries decay, and vertices with few
+// triangles left get a boost so they are finished off rather than
+// stranded
+float vertexScore(int cachePosition, uint32_t remaining) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        score = cachePosition < 3 ? 0.75f
+                                  : std::pow(1.0f - float(cachePosition - 3) / float(ForsythCacheSize - 3), 1.5f);
+    }
+    return score + 2.0f / std::sqrt(float(remaining));
+}
+
+struct Vec3 {
+    float x, y, z;
+
+    Vec3 operator+(const Vec3& other) const { return {x + other.x, y + other.y, z + other.z}; }
+    Vec3 operator-(const Vec3& other) const { return {x - other.x, y - other.y, z - other.z}; }
+    Vec3 operator*(float scale) const { return {x * scale, y * scale, z * scale}; }
+    float dot(const Vec3& other) const { return x * other.x + y * other.y + z * other.z; }
+    Vec3 cross(const Vec3& other) const {
+        return {y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x};
+    }
+};
+
+Vec3 position(const MeshVertex& vertex) {
+    return {vertex.position[0], vertex.position[1], vertex.position[2]};
+}
+
+size_t alignUp(size_t value) {
+    return (value + BufferAlignment - 1) / BufferAlignment * BufferAlignment;
+}
+
+uint64_t lodEnd(const LodEntry& entry) {
+    return entry.indexOffset + uint64_t(entry.indexCount) * entry.indexSize;
+}
+
+// Checks the header and that the LODs are laid out coarsest first without
+// overlapping; only the header and table need to be in size
+const LodEntry* readLodTable(const uint8_t* data, size_t size) {
+    if (!MeshView::isMesh(data, size)) {
+        throw std::runtime_error("Not a mesh payload");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != Version) {
+        throw std::runtime_error("Unsupported mesh version " + std::to_string(header.version));
+    }
+    const uint32_t stride =
+        header.vertexFormat == VertexFormat::Float32 ? uint32_t(sizeof(MeshVertex)) : uint32_t(sizeof(QuantizedVertex));
+    if (header.vertexFormat > VertexFormat::Quantized || header.vertexStride != stride || header.lodCount == 0 ||
+        header.lodCount > MaxLodCount) {
+        throw std::runtime_error("Malformed mesh header");
+    }
+    if ((size - sizeof(Header)) / sizeof(LodEntry) < header.lodCount) {
+        throw std::runtime_error("Mesh payload is missing its LOD table");
+    }
+
+    // Far past any real payload, and low enough that the sums below cannot wrap
+    const uint64_t maxOffset = std::numeric_limits<uint64_t>::max() / 2;
+    const auto* lods = reinterpret_cast<const LodEntry*>(data + sizeof(Header));
+    uint64_t floor = sizeof(Header) + uint64_t(header.lodCount) * sizeof(LodEntry);
+    for (uint32_t level = header.lodCount; level-- > 0;) {
+        const LodEntry& lod = lods[level];
+        if ((lod.indexSize != 2 && lod.indexSize != 4) || lod.indexCount % 3 != 0 || lod.vertexOffset < floor ||
+            lod.vertexOffset > maxOffset || lod.indexOffset > maxOffset ||
+            lod.indexOffset < lod.vertexOffset + uint64_t(lod.vertexCount) * stride) {
+            throw std::runtime_error("Malformed mesh LOD table");
+        }
+        floor = lodEnd(lod);
+    }
+    return lods;
+}
+
+} // namespace
+
+MeshData weldVertices(const MeshData& mesh) {
+    validateIndices(mesh.indices, mesh.vertices.size());
+
+    MeshData welded;
+    std::unordered_map<MeshVertex, uint32_t, VertexBitsHash, VertexBitsEqual> unique;
+    std::vector<uint32_t> remap(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        auto [it, inserted] = unique.emplace(mesh.vertices[i], uint32_t(welded.vertices.size()));
+        if (inserted) {
+            welded.vertices.push_back(mesh.vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+
+    welded.indices.reserve(mesh.indices.size());
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        uint32_t a = remap[mesh.indices[i]];
+        uint32_t b = remap[mesh.indices[i + 1]];
+        uint32_t c = remap[mesh.indices[i + 2]];
+        if (a != b && b != c && a != c) {
+            welded.indices.insert(welded.indices.end(), {a, b, c});
+        }
+    }
+    return welded;
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    validateIndices(indices, vertexCount);
+    const size_t triangleCount = indices.size() / 3;
+
+    // Triangles around each vertex, compacted as they are emitted so each
+    // list only holds the ones still to draw
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : indices) {
+        ++remaining[index];
+    }
+    std::vector<size_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            adjacency[cursor[indices[i]]++] = uint32_t(i / 3);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> cache, nextCache;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    size_t scanCursor = 0;
+    long best = -1;
+    while (output.size() < indices.size()) {
+        // Nothing in the cache has work left: restart at the next triangle
+        if (best < 0) {
+            while (emitted[scanCursor]) {
+                ++scanCursor;
+            }
+            best = long(scanCursor);
+        }
+
+        const uint32_t* triangle = &indices[size_t(best) * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[size_t(best)] = true;
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t v = triangle[corner];
+            uint32_t* first = &adjacency[offsets[v]];
+            uint32_t* last = first + remaining[v] - 1;
+            *std::find(first, last + 1, uint32_t(best)) = *last;
+            --remaining[v];
+        }
+
+        // Most recent first; whatever falls off the end leaves the cache
+        nextCache.assign(triangle, triangle + 3);
+        for (uint32_t v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                nextCache.push_back(v);
+            }
+        }
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            uint32_t v = nextCache[i];
+            cachePosition[v] = i < ForsythCacheSize ? int(i) : -1;
+            float updated = vertexScore(cachePosition[v], remaining[v]);
+            float delta = updated - score[v];
+            score[v] = updated;
+            for (size_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+                triangleScore[adjacency[a]] += delta;
+            }
+        }
+        nextCache.resize(std::min(nextCache.size(), ForsythCacheSize));
+        cache.swap(nextCache);
+
+        best = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : cache) {
+            for (size_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+                if (triangleScore[adjacency[a]] > bestScore) {
+                    bestScore = triangleScore[adjacency[a]];
+                    best = long(adjacency[a]);
+                }
+            }
+        }
+    }
+    indices.swap(output);
+}
+
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices) {
+    validateIndices(indices, vertices.size());
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // Cluster boundaries are the triangles that miss on all three vertices
+    std::vector<size_t> clusterStarts;
+    std::vector<size_t> timestamps(vertices.size(), 0);
+    const size_t cacheSize = 16;
+    size_t time = cacheSize + 1;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        int misses = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t v = indices[t * 3 + corner];
+            if (time - timestamps[v] > cacheSize) {
+                timestamps[v] = time++;
+                ++misses;
+            }
+        }
+        if (misses == 3) {
+            clusterStarts.push_back(t);
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Area-weighted centroids and normals per cluster and for the mesh
+    const size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<Vec3> centroids(clusterCount, Vec3{0, 0, 0});
+    std::vector<Vec3> normals(clusterCount, Vec3{0, 0, 0});
+    std::vector<float> areas(clusterCount, 0.0f);
+    Vec3 meshCentroid{0, 0, 0};
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; ++c) {
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+            Vec3 a = position(vertices[indices[t * 3]]);
+            Vec3 b = position(vertices[indices[t * 3 + 1]]);
+            Vec3 d = position(vertices[indices[t * 3 + 2]]);
+            Vec3 normal = (b - a).cross(d - a);
+            float area = std::sqrt(normal.dot(normal));
+            centroids[c] = centroids[c] + (a + b + d) * (area / 3.0f);
+            normals[c] = normals[c] + normal;
+            areas[c] += area;
+        }
+        meshCentroid = meshCentroid + centroids[c];
+        meshArea += areas[c];
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid = meshCentroid * (1.0f / meshArea);
+    }
+
+    // Clusters facing away from the middle are on the outside and tend to
+    // cover the rest, so they go first
+    std::vector<float> keys(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        float length = std::sqrt(normals[c].dot(normals[c]));
+        if (areas[c] > 0.0f && length > 0.0f) {
+            keys[c] = (centroids[c] * (1.0f / areas[c]) - meshCentroid).dot(normals[c] * (1.0f / length));
+        }
+    }
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (size_t c : order) {
+        output.insert(output.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+void optimizeVertexFetch(MeshData& mesh) {
+    validateIndices(mesh.indices, mesh.vertices.size());
+    const uint32_t unused = UINT32_MAX;
+    std::vector<uint32_t> remap(mesh.vertices.size(), unused);
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (uint32_t& index : mesh.indices) {
+        if (remap[index] == unused) {
+            remap[index] = uint32_t(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices);
+}
+
+float averageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize) {
+    validateIndices(indices, vertexCount);
+    if (indices.empty()) {
+        return 0.0f;
+    }
+    std::vector<size_t> timestamps(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            ++misses;
+        }
+    }
+    return float(misses) / float(indices.size() / 3);
+}
+
+// Projects onto the octahedron |x| + |y| + |z| = 1 and folds the lower
+// half over the diagonals, so a unit normal fits in two bytes
+void encodeOctahedral(const float normal[3], int8_t output[2]) {
+    float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    if (length <= 0.0f) {
+        output[0] = output[1] = 0;
+        return;
+    }
+    float x = normal[0] / length;
+    float y = normal[1] / length;
+    if (normal[2] < 0.0f) {
+        float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+    output[0] = int8_t(std::lround(std::clamp(x, -1.0f, 1.0f) * 127.0f));
+    output[1] = int8_t(std::lround(std::clamp(y, -1.0f, 1.0f) * 127.0f));
+}
+
+void decodeOctahedral(const int8_t encoded[2], float normal[3]) {
+    float x = std::max(float(encoded[0]) / 127.0f, -1.0f);
+    float y = std::max(float(encoded[1]) / 127.0f, -1.0f);
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+    if (z < 0.0f) {
+        float unfoldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float unfoldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = unfoldedX;
+        y = unfoldedY;
+    }
+    float length = std::sqrt(x * x + y * y + z * z);
+    normal[0] = x / length;
+    normal[1] = y / length;
+    normal[2] = z / length;
+}
+
+// Round to nearest even, with overflow to infinity and half subnormals
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    const uint32_t magnitude = bits & 0x7FFFFFFF;
+    if (magnitude >= 0x7F800000) {
+        return uint16_t(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0));
+    }
+    if (magnitude >= 0x477FF000) { // 65520 and up round past the largest half
+        return uint16_t(sign | 0x7C00);
+    }
+    auto round = [](uint32_t mantissa, uint32_t shift) {
+        uint32_t result = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (result & 1))) {
+            ++result;
+        }
+        return result;
+    };
+    if (magnitude < 0x38800000) {
+        if (magnitude < 0x33000000) {
+            return sign;
+        }
+        uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+        return uint16_t(sign | round(mantissa, 126 - (magnitude >> 23)));
+    }
+    // A rounding carry moves into the exponent, which is still correct
+    return uint16_t(sign | round(magnitude - 0x38000000, 13));
+}
+
+float halfToFloat(uint16_t value) {
+    const uint32_t sign = uint32_t(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: shift the leading one up into the implicit bit
+        exponent = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+std::vector<uint8_t> buildMesh(const MeshData& mesh, const MeshBuildOptions& options) {
+    std::vector<MeshData> lods(1);
+    if (options.optimize) {
+        lods[0] = weldVertices(mesh);
+    } else {
+        validateIndices(mesh.indices, mesh.vertices.size());
+        lods[0] = mesh;
+    }
+    if (lods[0].vertices.size() > UINT32_MAX || lods[0].indices.size() > UINT32_MAX) {
+        throw std::runtime_error("Mesh is too large");
+    }
+
+    // Every LOD simplifies the full mesh, so errors do not stack up along
+    // the chain, and keeps only the vertices it still uses
+    std::vector<float> errors(1, 0.0f);
+    const uint32_t maxLodCount = std::clamp(options.maxLodCount, 1u, MaxLodCount);
+    if (maxLodCount > 1) {
+        const MeshData welded = options.optimize ? lods[0] : weldVertices(mesh);
+        size_t previous = welded.indices.size();
+        while (lods.size() < maxLodCount) {
+            size_t target = size_t(double(previous) * options.lodReduction) / 3 * 3;
+            MeshSimplification simplified = simplifyMesh(welded, target, options.maxLodError);
+            if (simplified.indices.empty() || simplified.indices.size() > previous - previous / 10) {
+                break;
+            }
+            previous = simplified.indices.size();
+            lods.push_back({welded.vertices, std::move(simplified.indices)});
+            errors.push_back(simplified.error);
+        }
+    }
+    for (size_t level = 0; level < lods.size(); ++level) {
+        if (options.optimize) {
+            optimizeVertexCache(lods[level].indices, lods[level].vertices.size());
+            optimizeOverdraw(lods[level].indices, lods[level].vertices);
+        }
+        if (options.optimize || level > 0) {
+            optimizeVertexFetch(lods[level]);
+        }
+    }
+
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.vertexFormat = options.quantize ? VertexFormat::Quantized : VertexFormat::Float32;
+    header.vertexStride = options.quantize ? uint32_t(sizeof(QuantizedVertex)) : uint32_t(sizeof(MeshVertex));
+    header.lodCount = uint32_t(lods.size());
+    const std::vector<MeshVertex>& full = lods[0].vertices;
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = full.empty() ? 0.0f : full[0].position[axis];
+        header.boundsMax[axis] = header.boundsMin[axis];
+        for (const auto& vertex : full) {
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], vertex.position[axis]);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], vertex.position[axis]);
+        }
+    }
+
+    std::vector<LodEntry> entries(lods.size());
+    size_t end = sizeof(Header) + entries.size() * sizeof(LodEntry);
+    for (size_t level = lods.size(); level-- > 0;) {
+        LodEntry& entry = entries[level];
+        entry.vertexCount = uint32_t(lods[level].vertices.size());
+        entry.indexCount = uint32_t(lods[level].indices.size());
+        entry.indexSize = lods[level].vertices.size() <= 65536 ? 2 : 4;
+        entry.error = errors[level];
+        entry.vertexOffset = alignUp(end);
+        entry.indexOffset = alignUp(entry.vertexOffset + size_t(entry.vertexCount) * header.vertexStride);
+        end = size_t(lodEnd(entry));
+    }
+
+    std::vector<uint8_t> payload(end);
+    std::memcpy(payload.data(), &header, sizeof(header));
+    std::memcpy(payload.data() + sizeof(header), entries.data(), entries.size() * sizeof(LodEntry));
+    for (size_t level = 0; level < lods.size(); ++level) {
+        const MeshData& lod = lods[level];
+        uint8_t* vertexData = payload.data() + entries[level].vertexOffset;
+        if (options.quantize) {
+            for (size_t i = 0; i < lod.vertices.size(); ++i) {
+                const MeshVertex& source = lod.vertices[i];
+                QuantizedVertex vertex{};
+                for (int axis = 0; axis < 3; ++axis) {
+                    float extent = header.boundsMax[axis] - header.boundsMin[axis];
+                    float unit = extent > 0.0f ? (source.position[axis] - header.boundsMin[axis]) / extent : 0.0f;
+                    vertex.position[axis] = uint16_t(std::lround(std::clamp(unit, 0.0f, 1.0f) * 65535.0f));
+                }
+                encodeOctahedral(source.normal, vertex.normal);
+                vertex.uv[0] = floatToHalf(source.uv[0]);
+                vertex.uv[1] = floatToHalf(source.uv[1]);
+                std::memcpy(vertexData + i * sizeof(vertex), &vertex, sizeof(vertex));
+            }
+        } else {
+            std::memcpy(vertexData, lod.vertices.data(), lod.vertices.size() * sizeof(MeshVertex));
+        }
+
+        uint8_t* indexData = payload.data() + entries[level].indexOffset;
+        if (entries[level].indexSize == 2) {
+            for (size_t i = 0; i < lod.indices.size(); ++i) {
+                uint16_t index = uint16_t(lod.indices[i]);
+                std::memcpy(indexData + i * 2, &index, 2);
+            }
+        } else {
+            std::memcpy(indexData, lod.indices.data(), lod.indices.size() * 4);
+        }
+    }
+    return payload;
+}
+
+bool MeshView::isMesh(const uint8_t* data, size_t size) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == Magic;
+}
+
+size_t MeshView::requiredSize(const uint8_t* data, size_t size, uint32_t level) {
+    const LodEntry* lods = readLodTable(data, size);
+    uint32_t lodCount = reinterpret_cast<const Header*>(data)->lodCount;
+    if (level >= lodCount) {
+        throw std::runtime_error("Mesh has no LOD " + std::to_string(level));
+    }
+    return size_t(lodEnd(lods[level]));
+}
+
+MeshView::MeshView(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_header(reinterpret_cast<const Header*>(data))
+    , m_lods(readLodTable(data, size))
+    , m_firstResident(m_header->lodCount)
+{
+    while (m_firstResident > 0 && lodEnd(m_lods[m_firstResident - 1]) <= size) {
+        --m_firstResident;
+    }
+    if (m_firstResident == m_header->lodCount) {
+        throw std::runtime_error("Mesh payload is missing its coarsest LOD");
+    }
+}
+
+MeshLodView MeshView::lod(uint32_t level) const {
+    if (level >= m_header->lodCount) {
+        throw std::runtime_error("Mesh has no LOD " + std::to_string(level));
+    }
+    if (level < m_firstResident) {
+        throw std::runtime_error("Mesh LOD " + std::to_string(level) + " is not resident");
+    }
+    return MeshLodView(m_data, m_header, &m_lods[level]);
+}
+
+size_t MeshView::residentSize(uint32_t dropped) const {
+    return size_t(lodEnd(m_lods[std::min(dropped, m_header->lodCount - 1)]));
+}
+
+MeshVertex MeshLodView::vertex(uint32_t index) const {
+    if (index >= m_entry->vertexCount) {
+        throw std::runtime_error("Mesh has no vertex " + std::to_string(index));
+    }
+    const uint8_t* data = vertexData() + size_t(index) * m_header->vertexStride;
+    MeshVertex vertex;
+    if (m_header->vertexFormat == VertexFormat::Float32) {
+        std::memcpy(&vertex, data, sizeof(vertex));
+        return vertex;
+    }
+
+    QuantizedVertex packed;
+    std::memcpy(&packed, data, sizeof(packed));
+    for (int axis = 0; axis < 3; ++axis) {
+        float extent = m_header->boundsMax[axis] - m_header->boundsMin[axis];
+        vertex.position[axis] = m_header->boundsMin[axis] + float(packed.position[axis]) / 65535.0f * extent;
+    }
+    decodeOctahedral(packed.normal, vertex.normal);
+    vertex.uv[0] = halfToFloat(packed.uv[0]);
+    vertex.uv[1] = halfToFloat(packed.uv[1]);
+    return vertex;
+}
+
+uint32_t MeshLodView::index(uint32_t position) const {
+    if (position >= m_entry->indexCount) {
+        throw std::runtime_error("Mesh has no index " + std::to_string(position));
+    }
+    if (m_entry->indexSize == 2) {
+        uint16_t index;
+        std::memcpy(&index, indexData() + size_t(position) * 2, 2);
+        return index;
+    }
+    uint32_t index;
+    std::memcpy(&index, indexData() + size_t(position) * 4, 4);
+    return index;
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// Full-precision vertex, as imported and as the unoptimized Float32 layout
+struct MeshVertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+// On-disk layout of an imported mesh payload (little-endian):
+//   Header | LodEntry[lodCount] | LOD n-1 vertices, indices | ... | LOD 0
+// LOD 0 is full detail. Each LOD has its own vertex and index buffer,
+// exactly what the GPU consumes, and the coarsest come first so a prefix
+// of the payload already holds a drawable mesh. All offsets are from the
+// start of the payload.
+namespace MeshFormat {
+
+constexpr uint32_t Magic = 0x534D4941; // "AIMS"
+constexpr uint32_t Version = 2;
+constexpr uint32_t MaxLodCount = 8;
+
+enum class VertexFormat : uint32_t {
+    Float32,  // MeshVertex, 32 bytes
+    Quantized // QuantizedVertex, 16 bytes
+};
+
+// Positions are unorm16 across the header's bounds, normals octahedral
+// snorm8 and UVs half floats
+struct QuantizedVertex {
+    uint16_t position[4]; // w is zero
+    int8_t normal[2];
+    uint8_t reserved[2];  // Zero
+    uint16_t uv[2];
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    VertexFormat vertexFormat;
+    uint32_t vertexStride;
+    uint32_t lodCount;
+    uint32_t reserved; // Zero
+    float boundsMin[3]; // Of LOD 0, which every coarser LOD lies within
+    float boundsMax[3];
+};
+
+struct LodEntry {
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize; // 2 when every index fits, otherwise 4
+    float error;        // Simplification error relative to the mesh's largest extent
+};
+
+} // namespace MeshFormat
+
+// Indexed triangle list
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// Merges vertices whose attributes are bit-identical and drops triangles
+// that collapse onto a repeated index. Throws std::runtime_error if the
+// index count is not a multiple of 3 or an index is out of range.
+MeshData weldVertices(const MeshData& mesh);
+
+// Reorders triangles so consecutive ones share vertices still in the GPU's
+// post-transform cache (Forsyth's linear-speed algorithm)
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+// Reorders the clusters of an optimized index list so outward-facing ones
+// draw first and hide what is behind them. Clusters break only where the
+// cache simulation starts cold, so the cache order survives.
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices);
+
+// Renumbers vertices in order of first use so fetches walk memory forward
+void optimizeVertexFetch(MeshData& mesh);
+
+// Vertex shader runs per triangle on a FIFO cache: 3 is the worst, and
+// 0.5 to 0.7 is typical of a well-ordered mesh
+float averageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize = 16);
+
+// Octahedral normal and half-float helpers behind QuantizedVertex
+void encodeOctahedral(const float normal[3], int8_t output[2]);
+void decodeOctahedral(const int8_t encoded[2], float normal[3]);
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+struct MeshBuildOptions {
+    bool optimize = true; // Weld, then the cache, overdraw and fetch passes
+    bool quantize = true; // QuantizedVertex instead of MeshVertex
+    uint32_t maxLodCount = 1;   // Including LOD 0, up to MeshFormat::MaxLodCount
+    float lodReduction = 0.5f;  // Each LOD aims for this fraction of the one before's triangles
+    float maxLodError = 0.02f;  // Relative to the mesh's largest extent
+};
+
+// Produces a complete mesh payload in the format above. LODs after the
+// first come from simplifyMesh on the welded mesh; the chain ends early
+// once a LOD would not shrink by a tenth within maxLodError.
+std::vector<uint8_t> buildMesh(const MeshData& mesh, const MeshBuildOptions& options);
+
+// One LOD of a mesh payload
+class MeshLodView {
+public:
+    MeshLodView(const uint8_t* data, const MeshFormat::Header* header, const MeshFormat::LodEntry* entry)
+        : m_data(data)
+        , m_header(header)
+        , m_entry(entry)
+    {
+    }
+
+    MeshFormat::VertexFormat vertexFormat() const { return m_header->vertexFormat; }
+    uint32_t vertexStride() const { return m_header->vertexStride; }
+    uint32_t vertexCount() const { return m_entry->vertexCount; }
+    uint32_t indexCount() const { return m_entry->indexCount; }
+    uint32_t indexSize() const { return m_entry->indexSize; }
+    float error() const { return m_entry->error; }
+    const uint8_t* vertexData() const { return m_data + m_entry->vertexOffset; }
+    size_t vertexDataSize() const { return size_t(m_entry->vertexCount) * m_header->vertexStride; }
+    const uint8_t* indexData() const { return m_data + m_entry->indexOffset; }
+    size_t indexDataSize() const { return size_t(m_entry->indexCount) * m_entry->indexSize; }
+
+    // CPU-side reads for collision and tools; the GPU reads the buffers
+    MeshVertex vertex(uint32_t index) const;
+    uint32_t index(uint32_t position) const;
+
+private:
+    const uint8_t* m_data;
+    const MeshFormat::Header* m_header;
+    const MeshFormat::LodEntry* m_entry;
+};
+
+// Zero-copy view of a mesh payload, or of a prefix of one while the rest
+// still streams in
+class MeshView {
+public:
+    // Validates the header and LOD table. size may stop short of the full
+    // payload as long as the coarsest LOD is present. Throws
+    // std::runtime_error on a malformed payload.
+    MeshView(const uint8_t* data, size_t size);
+
+    static bool isMesh(const uint8_t* data, size_t size);
+
+    // Payload bytes needed before a LOD can be drawn, read from the header
+    // and LOD table alone; what a streamer decodes up to, coarsest first.
+    // Throws std::runtime_error if those are not present or malformed.
+    static size_t requiredSize(const uint8_t* data, size_t size, uint32_t level);
+
+    MeshFormat::VertexFormat vertexFormat() const { return m_header->vertexFormat; }
+    uint32_t vertexStride() const { return m_header->vertexStride; }
+    uint32_t lodCount() const { return m_header->lodCount; }
+    uint32_t firstResidentLod() const { return m_firstResident; }
+    MeshLodView lod(uint32_t level) const;
+
+    // Bytes of payload left with the top dropped LODs released; what a
+    // quality handler reports for a mesh stepped down that many levels
+    size_t residentSize(uint32_t dropped) const;
+
+private:
+    const uint8_t* m_data;
+    const MeshFormat::Header* m_header;
+    const MeshFormat::LodEntry* m_lods;
+    uint32_t m_firstResident;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,332 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+// Borders weigh this much more than surface planes so outlines hold longest
+constexpr double BorderWeight = 10.0;
+// A surviving triangle may turn by up to about 75 degrees in one collapse
+constexpr double MinNormalCosine = 0.25;
+
+struct Vec3d {
+    double x, y, z;
+
+    Vec3d operator-(const Vec3d& other) const { return {x - other.x, y - other.y, z - other.z}; }
+    double dot(const Vec3d& other) const { return x * other.x + y * other.y + z * other.z; }
+    Vec3d cross(const Vec3d& other) const {
+        return {y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x};
+    }
+    double length() const { return std::sqrt(dot(*this)); }
+};
+
+// Sum of weighted squared distances to a set of planes: p'Ap + 2b'p + c,
+// with the total weight kept so the error reads as a mean squared distance
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    void addPlane(const Vec3d& normal, double distance, double planeWeight) {
+        a00 += planeWeight * normal.x * normal.x;
+        a01 += planeWeight * normal.x * normal.y;
+        a02 += planeWeight * normal.x * normal.z;
+        a11 += planeWeight * normal.y * normal.y;
+        a12 += planeWeight * normal.y * normal.z;
+        a22 += planeWeight * normal.z * normal.z;
+        b0 += planeWeight * normal.x * distance;
+        b1 += planeWeight * normal.y * distance;
+        b2 += planeWeight * normal.z * distance;
+        c += planeWeight * distance * distance;
+        weight += planeWeight;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        a00 += other.a00, a01 += other.a01, a02 += other.a02;
+        a11 += other.a11, a12 += other.a12, a22 += other.a22;
+        b0 += other.b0, b1 += other.b1, b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    double evaluate(const Vec3d& p) const {
+        double value = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z +
+                       2 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+                       2 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        return std::max(value, 0.0);
+    }
+};
+
+enum class VertexKind : uint8_t {
+    Manifold, // Moves along any edge
+    Border,   // On one open border; moves along it only
+    Locked    // On a seam, a corner or non-manifold geometry
+};
+
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? uint64_t(a) << 32 | b : uint64_t(b) << 32 | a;
+}
+
+struct Collapse {
+    double cost;
+    uint32_t from;
+    uint32_t to;
+};
+
+} // namespace
+
+MeshSimplification simplifyMesh(const MeshData& mesh, size_t targetIndexCount, float maxError) {
+    const size_t vertexCount = mesh.vertices.size();
+    if (mesh.indices.size() % 3 != 0) {
+        throw std::runtime_error("Mesh index count is not a multiple of 3");
+    }
+    for (uint32_t index : mesh.indices) {
+        if (index >= vertexCount) {
+            throw std::runtime_error("Mesh index " + std::to_string(index) + " is out of range");
+        }
+    }
+
+    MeshSimplification result;
+    result.indices = mesh.indices;
+    if (result.indices.size() <= targetIndexCount) {
+        return result;
+    }
+
+    std::vector<Vec3d> positions(vertexCount);
+    Vec3d low{0, 0, 0}, high{0, 0, 0};
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* p = mesh.vertices[v].position;
+        positions[v] = {p[0], p[1], p[2]};
+        if (v == 0) {
+            low = high = positions[v];
+        }
+        low = {std::min(low.x, p[0] * 1.0), std::min(low.y, p[1] * 1.0), std::min(low.z, p[2] * 1.0)};
+        high = {std::max(high.x, p[0] * 1.0), std::max(high.y, p[1] * 1.0), std::max(high.z, p[2] * 1.0)};
+    }
+    const double extent = std::max({high.x - low.x, high.y - low.y, high.z - low.z});
+    if (extent <= 0.0) {
+        return result;
+    }
+    const double costLimit = double(maxError) * maxError * extent * extent;
+
+    // Vertices at the same position are wedges of one corner; the topology
+    // is read at that level so seams do not look like borders
+    std::vector<uint32_t> corner(vertexCount);
+    std::vector<uint32_t> wedges;
+    {
+        std::vector<uint32_t> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0u);
+        auto less = [&](uint32_t a, uint32_t b) {
+            const float* p = mesh.vertices[a].position;
+            const float* q = mesh.vertices[b].position;
+            return std::lexicographical_compare(p, p + 3, q, q + 3);
+        };
+        std::sort(order.begin(), order.end(), less);
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (i == 0 || less(order[i - 1], order[i])) {
+                wedges.push_back(0);
+            }
+            corner[order[i]] = uint32_t(wedges.size() - 1);
+            ++wedges.back();
+        }
+    }
+
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            uint32_t a = corner[mesh.indices[i + e]];
+            uint32_t b = corner[mesh.indices[i + (e + 1) % 3]];
+            ++edgeUses[edgeKey(a, b)];
+        }
+    }
+    std::vector<uint32_t> borderEdges(wedges.size(), 0);
+    std::vector<bool> nonManifold(wedges.size(), false);
+    for (const auto& [key, uses] : edgeUses) {
+        uint32_t a = uint32_t(key >> 32);
+        uint32_t b = uint32_t(key);
+        if (uses == 1) {
+            ++borderEdges[a];
+            ++borderEdges[b];
+        } else if (uses > 2) {
+            nonManifold[a] = nonManifold[b] = true;
+        }
+    }
+    std::vector<VertexKind> kinds(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        uint32_t c = corner[v];
+        if (wedges[c] > 1 || nonManifold[c] || (borderEdges[c] != 0 && borderEdges[c] != 2)) {
+            kinds[v] = VertexKind::Locked;
+        } else {
+            kinds[v] = borderEdges[c] == 2 ? VertexKind::Border : VertexKind::Manifold;
+        }
+    }
+    auto isBorderEdge = [&](uint32_t a, uint32_t b) {
+        auto it = edgeUses.find(edgeKey(corner[a], corner[b]));
+        return it != edgeUses.end() && it->second == 1;
+    };
+
+    // Each triangle's plane, weighted by area, goes to its corners; open
+    // edges add a plane standing on them so borders resist moving inward
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        const uint32_t* t = &mesh.indices[i];
+        Vec3d normal = (positions[t[1]] - positions[t[0]]).cross(positions[t[2]] - positions[t[0]]);
+        double length = normal.length();
+        if (length <= 0.0) {
+            continue;
+        }
+        normal = {normal.x / length, normal.y / length, normal.z / length};
+        double distance = -normal.dot(positions[t[0]]);
+        for (int c = 0; c < 3; ++c) {
+            quadrics[t[c]].addPlane(normal, distance, length * 0.5);
+        }
+        for (int e = 0; e < 3; ++e) {
+            uint32_t a = t[e];
+            uint32_t b = t[(e + 1) % 3];
+            if (!isBorderEdge(a, b)) {
+                continue;
+            }
+            Vec3d edge = positions[b] - positions[a];
+            Vec3d side = edge.cross(normal);
+            double sideLength = side.length();
+            if (sideLength <= 0.0) {
+                continue;
+            }
+            side = {side.x / sideLength, side.y / sideLength, side.z / sideLength};
+            double sideDistance = -side.dot(positions[a]);
+            quadrics[a].addPlane(side, sideDistance, edge.dot(edge) * BorderWeight);
+            quadrics[b].addPlane(side, sideDistance, edge.dot(edge) * BorderWeight);
+        }
+    }
+
+    auto canCollapse = [&](uint32_t from, uint32_t to) {
+        return kinds[from] == VertexKind::Manifold || (kinds[from] == VertexKind::Border && isBorderEdge(from, to));
+    };
+    auto collapseCost = [&](uint32_t from, uint32_t to) {
+        Quadric merged = quadrics[from];
+        merged += quadrics[to];
+        return merged.weight > 0.0 ? merged.evaluate(positions[to]) / merged.weight : 0.0;
+    };
+
+    // Passes of independent collapses, cheapest first: each pass rebuilds
+    // adjacency, and a vertex touched by one collapse waits for the next pass
+    std::vector<uint32_t>& indices = result.indices;
+    const size_t targetTriangles = targetIndexCount / 3;
+    double worstCost = 0.0;
+    std::vector<uint32_t> offsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    while (indices.size() / 3 > targetTriangles) {
+        std::fill(offsets.begin(), offsets.end(), 0u);
+        for (uint32_t index : indices) {
+            ++offsets[index + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        adjacency.resize(indices.size());
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) {
+                adjacency[cursor[indices[i]]++] = uint32_t(i / 3);
+            }
+        }
+
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = indices[i + e];
+                uint32_t b = indices[i + (e + 1) % 3];
+                double forward = canCollapse(a, b) ? collapseCost(a, b) : -1.0;
+                double backward = canCollapse(b, a) ? collapseCost(b, a) : -1.0;
+                if (forward >= 0.0 && (backward < 0.0 || forward <= backward)) {
+                    collapses.push_back({forward, a, b});
+                } else if (backward >= 0.0) {
+                    collapses.push_back({backward, b, a});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            return a.cost < b.cost;
+        });
+
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(touched.begin(), touched.end(), false);
+        const size_t triangleCount = indices.size() / 3;
+        size_t removed = 0;
+        size_t applied = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > costLimit || triangleCount - removed <= targetTriangles) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+
+            // Moving from onto to must not turn any surviving triangle over,
+            // or up on its edge into a fin
+            bool flips = false;
+            size_t collapsing = 0;
+            for (uint32_t a = offsets[collapse.from]; a < offsets[collapse.from + 1] && !flips; ++a) {
+                const uint32_t* t = &indices[size_t(adjacency[a]) * 3];
+                if (t[0] == collapse.to || t[1] == collapse.to || t[2] == collapse.to) {
+                    ++collapsing;
+                    continue;
+                }
+                Vec3d before[3], after[3];
+                for (int c = 0; c < 3; ++c) {
+                    before[c] = positions[t[c]];
+                    after[c] = positions[t[c] == collapse.from ? collapse.to : t[c]];
+                }
+                Vec3d oldNormal = (before[1] - before[0]).cross(before[2] - before[0]);
+                Vec3d newNormal = (after[1] - after[0]).cross(after[2] - after[0]);
+                flips = newNormal.dot(oldNormal) <= MinNormalCosine * newNormal.length() * oldNormal.length();
+            }
+            if (flips) {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            for (uint32_t a = offsets[collapse.from]; a < offsets[collapse.from + 1]; ++a) {
+                const uint32_t* t = &indices[size_t(adjacency[a]) * 3];
+                touched[t[0]] = touched[t[1]] = touched[t[2]] = true;
+            }
+            touched[collapse.to] = true;
+            worstCost = std::max(worstCost, collapse.cost);
+            removed += collapsing;
+            ++applied;
+        }
+        if (applied == 0) {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            uint32_t a = remap[indices[i]];
+            uint32_t b = remap[indices[i + 1]];
+            uint32_t c = remap[indices[i + 2]];
+            if (a != b && b != c && a != c) {
+                indices[write++] = a;
+                indices[write++] = b;
+                indices[write++] = c;
+            }
+        }
+        indices.resize(write);
+    }
+
+    result.error = float(std::sqrt(worstCost) / extent);
+    return result;
+}
+
+} // namespace World
+} // namespace Aincrad
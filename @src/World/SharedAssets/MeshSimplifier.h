@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshFormat.h"
+
+namespace Aincrad {
+namespace World {
+
+struct MeshSimplification {
+    std::vector<uint32_t> indices; // Into the input's vertices
+    float error = 0.0f;            // Largest collapse error, relative to the mesh's largest extent
+};
+
+// Edge-collapse simplification driven by quadric error metrics (Garland and
+// Heckbert). Collapses move a vertex onto a neighbor, so the result indexes
+// a subset of the input's vertices and their attributes stay exact. Stops
+// at targetIndexCount, or before any collapse whose error would exceed
+// maxError. Open borders only slide along themselves, vertices on UV or
+// normal seams never move, and collapses that would flip a triangle are
+// skipped, so the outline and seams hold. Expects a welded mesh; throws
+// std::runtime_error on bad indices.
+MeshSimplification simplifyMesh(const MeshData& mesh, size_t targetIndexCount, float maxError);
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,338 @@
+#include "StreamingReadQueue.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+uint64_t makeTag(StreamingReadQueue::Lane lane, uint32_t read) {
+    return (uint64_t(lane) << 32) | read;
+}
+
+StreamingReadQueue::Lane tagLane(uint64_t tag) {
+    return StreamingReadQueue::Lane(tag >> 32);
+}
+
+uint32_t tagRead(uint64_t tag) {
+    return uint32_t(tag);
+}
+
+} // namespace
+
+StreamingReadQueue::StreamingReadQueue(size_t bufferSize, size_t chunkSize, bool allowIoUring)
+    : m_reader(bufferSize, chunkSize, allowIoUring)
+    , m_nextLane(SharedLane + 1)
+    , m_turn(SharedLane)
+    , m_nextRead(0)
+    , m_stopping(false)
+    , m_bytesRead(0)
+{
+    m_lanes[SharedLane].maxSlots = m_reader.getSlotCount();
+    m_thread = std::thread(&StreamingReadQueue::pumpLoop, this);
+}
+
+StreamingReadQueue::~StreamingReadQueue() {
+    std::vector<StreamReadDone> cancelled;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_callbacks.wait(lock, [this] {
+            return std::none_of(m_lanes.begin(), m_lanes.end(),
+                                [](const auto& lane) { return lane.second.delivering; });
+        });
+        for (auto it = m_reads.begin(); it != m_reads.end();) {
+            std::shared_ptr<Read> read = it->second;
+            ++it;
+            if (!read->settled) {
+                cancelled.push_back(settle(*read, m_lanes.at(read->lane)));
+            }
+            if (read->inFlight == 0) {
+                forget(*read);
+            }
+        }
+    }
+    m_wake.notify_one();
+
+    for (StreamReadDone& done : cancelled) {
+        if (done) {
+            done(ECANCELED);
+        }
+    }
+    m_thread.join();
+}
+
+StreamingReadQueue::Lane StreamingReadQueue::openLane(size_t maxSlots) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Lane lane = m_nextLane++;
+    m_lanes[lane].maxSlots = std::max<size_t>(1, std::min(maxSlots, m_reader.getSlotCount()));
+    return lane;
+}
+
+void StreamingReadQueue::closeLane(Lane lane) {
+    if (lane == SharedLane) {
+        return;
+    }
+
+    std::vector<StreamReadDone> cancelled;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto found = m_lanes.find(lane);
+        if (found == m_lanes.end() || found->second.closing) {
+            return;
+        }
+        LaneState& state = found->second;
+        state.closing = true;
+        m_callbacks.wait(lock, [&state] { return !state.delivering; });
+
+        for (auto it = m_reads.begin(); it != m_reads.end();) {
+            std::shared_ptr<Read> read = it->second;
+            ++it;
+            if (read->lane != lane) {
+                continue;
+            }
+            if (!read->settled) {
+                cancelled.push_back(settle(*read, state));
+            }
+            if (read->inFlight == 0) {
+                forget(*read);
+            }
+        }
+        // Otherwise the last chunk still in flight or kept drops the lane
+        state.closed = true;
+        if (state.held == 0) {
+            m_lanes.erase(found);
+        }
+    }
+
+    for (StreamReadDone& done : cancelled) {
+        if (done) {
+            done(ECANCELED);
+        }
+    }
+}
+
+void StreamingReadQueue::read(Lane lane, std::shared_ptr<const StreamFile> file, uint64_t offset, uint64_t size,
+                              StreamChunkConsumer consumer, StreamReadDone done) {
+    if (!file || !file->isOpen()) {
+        throw std::runtime_error("Streaming from a file that is not open");
+    }
+    if (size == 0) {
+        if (done) {
+            done(0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_lanes.find(lane);
+        if (m_stopping || found == m_lanes.end() || found->second.closing) {
+            throw std::runtime_error("Streaming lane is not open");
+        }
+
+        auto read = std::make_shared<Read>();
+        do {
+            read->id = m_nextRead++;
+        } while (m_reads.count(read->id) != 0);
+        read->lane = lane;
+        read->file = std::move(file);
+        read->offset = offset;
+        read->next = offset;
+        read->size = size;
+        read->consumer = std::move(consumer);
+        read->done = std::move(done);
+
+        m_reads.emplace(read->id, read);
+        found->second.queued.push_back(std::move(read));
+    }
+    m_wake.notify_one();
+}
+
+void StreamingReadQueue::readInto(std::shared_ptr<const StreamFile> file, uint64_t offset, size_t size,
+                                  uint8_t* destination) {
+    auto finished = std::make_shared<std::promise<int>>();
+    std::future<int> result = finished->get_future();
+    std::string path = file ? file->path() : std::string();
+
+    read(SharedLane, std::move(file), offset, size,
+        [destination, offset](const StreamChunk& chunk) {
+            std::memcpy(destination + (chunk.offset - offset), chunk.data, chunk.size);
+            return true;
+        },
+        [finished](int error) { finished->set_value(error); });
+
+    int error = result.get();
+    if (error != 0) {
+        throw std::runtime_error("Failed to stream " + std::to_string(size) + " bytes at offset " +
+                                 std::to_string(offset) + " of " + path + ": " + std::strerror(error));
+    }
+}
+
+void StreamingReadQueue::release(const StreamChunk& chunk) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_returned.push_back(chunk);
+    }
+    m_wake.notify_one();
+}
+
+void StreamingReadQueue::pumpLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        for (const StreamChunk& chunk : m_returned) {
+            releaseSlot(chunk);
+        }
+        m_returned.clear();
+
+        if (!m_stopping) {
+            submitReady();
+        }
+
+        if (m_reader.getPending() == 0) {
+            if (m_stopping) {
+                return;
+            }
+            m_wake.wait(lock);
+            continue;
+        }
+
+        // Nothing but this thread touches the reader, so it can wait unlocked
+        lock.unlock();
+        StreamChunk chunk;
+        m_reader.wait(chunk);
+        lock.lock();
+        deliver(chunk, lock);
+    }
+}
+
+void StreamingReadQueue::submitReady() {
+    // One chunk per lane per turn, until the ring is full or no lane can go
+    bool progressed = true;
+    while (progressed && m_reader.getInFlight() < m_reader.getSlotCount()) {
+        progressed = false;
+        auto it = m_lanes.upper_bound(m_turn);
+        for (size_t visited = 0; visited < m_lanes.size(); ++visited, ++it) {
+            if (it == m_lanes.end()) {
+                it = m_lanes.begin();
+            }
+            LaneState& lane = it->second;
+            if (lane.closing || lane.queued.empty() || lane.held >= lane.maxSlots) {
+                continue;
+            }
+
+            Read& read = *lane.queued.front();
+            size_t size = size_t(std::min<uint64_t>(m_reader.getChunkSize(), read.offset + read.size - read.next));
+            if (m_reader.submit(*read.file, read.next, size, makeTag(read.lane, read.id)) == 0) {
+                return;
+            }
+            read.next += size;
+            ++read.inFlight;
+            ++lane.held;
+            if (read.next == read.offset + read.size) {
+                lane.queued.pop_front();
+            }
+
+            m_turn = it->first;
+            progressed = true;
+            break;
+        }
+    }
+}
+
+void StreamingReadQueue::deliver(const StreamChunk& chunk, std::unique_lock<std::mutex>& lock) {
+    // Reads stay known until their last chunk lands, and lanes until their
+    // last slot is released
+    std::shared_ptr<Read> read = m_reads.at(tagRead(chunk.tag));
+    LaneState& lane = m_lanes.at(read->lane);
+    --read->inFlight;
+
+    bool deliverable = !read->settled && !lane.closing && !m_stopping;
+    int error = 0;
+    StreamReadDone done;
+    if (deliverable) {
+        size_t expected = size_t(std::min<uint64_t>(m_reader.getChunkSize(), read->offset + read->size - chunk.offset));
+        if (!chunk.ok() || chunk.size < expected) {
+            error = chunk.ok() ? EIO : chunk.error;
+            deliverable = false;
+            done = settle(*read, lane);
+        } else {
+            read->received += chunk.size;
+            m_bytesRead.fetch_add(chunk.size, std::memory_order_relaxed);
+            if (read->received == read->size) {
+                done = settle(*read, lane);
+            }
+        }
+    }
+
+    bool keep = false;
+    if (deliverable || done) {
+        lane.delivering = true;
+        lock.unlock();
+        if (deliverable) {
+            try {
+                keep = !read->consumer(chunk);
+            } catch (...) {
+                keep = false;
+                error = EIO;
+                if (!done) {
+                    // Not the last chunk; the read is cut short here
+                    lock.lock();
+                    done = settle(*read, lane);
+                    lock.unlock();
+                }
+            }
+        }
+        if (done) {
+            done(error);
+        }
+        lock.lock();
+        lane.delivering = false;
+        m_callbacks.notify_all();
+    }
+
+    if (!keep) {
+        releaseSlot(chunk);
+    }
+    if (read->settled && read->inFlight == 0) {
+        forget(*read);
+    }
+}
+
+void StreamingReadQueue::releaseSlot(const StreamChunk& chunk) {
+    m_reader.release(chunk);
+
+    auto found = m_lanes.find(tagLane(chunk.tag));
+    if (found == m_lanes.end()) {
+        return;
+    }
+    LaneState& lane = found->second;
+    --lane.held;
+    if (lane.closed && lane.held == 0) {
+        m_lanes.erase(found);
+    }
+}
+
+StreamReadDone StreamingReadQueue::settle(Read& read, LaneState& lane) {
+    read.settled = true;
+    auto queued = std::find_if(lane.queued.begin(), lane.queued.end(),
+                               [&read](const std::shared_ptr<Read>& entry) { return entry.get() == &read; });
+    if (queued != lane.queued.end()) {
+        lane.queued.erase(queued);
+    }
+    StreamReadDone done = std::move(read.done);
+    read.done = nullptr;
+    return done;
+}
+
+void StreamingReadQueue::forget(const Read& read) {
+    m_reads.erase(read.id);
+}
+
+} // namespace World
+} // namespace Aincrad
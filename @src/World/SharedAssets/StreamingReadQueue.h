@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "StreamingReader.h"
+
+namespace Aincrad {
+namespace World {
+
+// Receives a read's chunks in file order on the queue's I/O thread. Return
+// true to release the chunk when the callback returns, or false to keep the
+// view and hand it back later with StreamingReadQueue::release.
+using StreamChunkConsumer = std::function<bool(const StreamChunk& chunk)>;
+// Runs once per read: with 0 after its last chunk, or an errno-style code
+// if it failed, came up short or was cancelled. No chunk of the read is
+// delivered after it.
+using StreamReadDone = std::function<void(int error)>;
+
+// Shares one StreamingReader between any number of threads. An I/O thread
+// owns the reader: it submits queued reads a chunk at a time as slots free
+// up, and hands each completed chunk to its read's consumer as a view into
+// the staging ring. Reads belong to lanes, and a lane never holds more than
+// its share of slots, in flight or kept, so a stream reading ahead cannot
+// crowd out loads. Lanes take turns for free slots.
+class StreamingReadQueue {
+public:
+    using Lane = uint32_t;
+    // Open from the start and bounded only by the ring; asset loads use it
+    static constexpr Lane SharedLane = 0;
+
+    StreamingReadQueue(size_t bufferSize, size_t chunkSize = StreamingReader::DefaultChunkSize,
+                       bool allowIoUring = true);
+    // Cancels queued reads and lets those in flight land. Chunks consumers
+    // still keep are invalid afterwards.
+    ~StreamingReadQueue();
+
+    StreamingReadQueue(const StreamingReadQueue&) = delete;
+    StreamingReadQueue& operator=(const StreamingReadQueue&) = delete;
+
+    // A lane that may hold up to maxSlots slots of the ring. closeLane
+    // cancels the lane's reads and returns once none of its callbacks is
+    // running or will run again; release kept chunks before closing.
+    Lane openLane(size_t maxSlots);
+    void closeLane(Lane lane);
+
+    // Queues a read of size bytes from offset. Safe from any thread,
+    // including from callbacks. Throws std::runtime_error if the file is not
+    // open or the lane is not.
+    void read(Lane lane, std::shared_ptr<const StreamFile> file, uint64_t offset, uint64_t size,
+              StreamChunkConsumer consumer, StreamReadDone done = nullptr);
+    // Reads size bytes from offset on the shared lane, copying each chunk
+    // straight into destination, and blocks until they are all there.
+    // Throws std::runtime_error on a failed or short read. Must not be called
+    // from a callback.
+    void readInto(std::shared_ptr<const StreamFile> file, uint64_t offset, size_t size, uint8_t* destination);
+
+    // Hands back a chunk a consumer kept. Safe from any thread.
+    void release(const StreamChunk& chunk);
+
+    // Getters
+    bool usesIoUring() const { return m_reader.usesIoUring(); }
+    size_t getBufferSize() const { return m_reader.getBufferSize(); }
+    size_t getChunkSize() const { return m_reader.getChunkSize(); }
+    size_t getSlotCount() const { return m_reader.getSlotCount(); }
+    uint64_t getBytesRead() const { return m_bytesRead.load(std::memory_order_relaxed); } // Delivered to consumers
+
+private:
+    struct Read {
+        uint32_t id = 0;
+        Lane lane = SharedLane;
+        std::shared_ptr<const StreamFile> file; // Open until the last chunk lands
+        uint64_t next = 0;     // Offset of the next chunk to submit
+        uint64_t received = 0; // Bytes delivered so far
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        size_t inFlight = 0;
+        bool settled = false;  // done has been taken to run
+        StreamChunkConsumer consumer;
+        StreamReadDone done;
+    };
+
+    struct LaneState {
+        size_t maxSlots = 0;
+        size_t held = 0;         // Slots in flight, waiting or kept
+        bool closing = false;
+        bool closed = false;     // closeLane has returned
+        bool delivering = false; // One of the lane's callbacks is running
+        std::deque<std::shared_ptr<Read>> queued; // Reads with chunks left to submit
+    };
+
+    void pumpLoop();
+    void submitReady();
+    void deliver(const StreamChunk& chunk, std::unique_lock<std::mutex>& lock);
+    void releaseSlot(const StreamChunk& chunk);
+    StreamReadDone settle(Read& read, LaneState& lane);
+    void forget(const Read& read);
+
+    StreamingReader m_reader; // I/O thread only; under the mutex except while waiting
+    std::map<Lane, LaneState> m_lanes;
+    std::unordered_map<uint32_t, std::shared_ptr<Read>> m_reads; // Until settled and landed
+    std::vector<StreamChunk> m_returned; // Kept chunks handed back for the I/O thread to release
+    Lane m_nextLane;
+    Lane m_turn; // Lane that submitted last
+    uint32_t m_nextRead;
+    bool m_stopping;
+    std::atomic<uint64_t> m_bytesRead;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;      // Work for the I/O thread
+    std::condition_variable m_callbacks; // A lane's callback finished
+    std::thread m_thread;
+};
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,527 @@
+#include "StreamingReader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define AINCRAD_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace Aincrad {
+namespace World {
+
+namespace {
+
+constexpr size_t StagingAlignment = 4096;
+constexpr size_t FallbackWorkerCount = 2;
+constexpr int SubmitRetryCount = 64; // For a transiently busy submission queue
+
+} // namespace
+
+// StreamFile
+
+StreamFile::StreamFile()
+#if defined(_WIN32)
+    : m_handle(nullptr)
+#else
+    : m_fd(-1)
+#endif
+    , m_size(0)
+{
+}
+
+StreamFile::~StreamFile() {
+    close();
+}
+
+void StreamFile::open(const std::string& path) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file for streaming: " + path);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to query file size: " + path);
+    }
+
+    m_handle = file;
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for streaming: " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to query file size: " + path);
+    }
+
+    m_fd = fd;
+    m_size = static_cast<uint64_t>(info.st_size);
+#endif
+
+    m_path = path;
+}
+
+void StreamFile::close() {
+#if defined(_WIN32)
+    if (m_handle) {
+        CloseHandle(m_handle);
+        m_handle = nullptr;
+    }
+#else
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_size = 0;
+    m_path.clear();
+}
+
+bool StreamFile::isOpen() const {
+#if defined(_WIN32)
+    return m_handle != nullptr;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+// io_uring backend, driven through the raw syscalls so there is no liburing
+// dependency. One submission queue entry per slot is enough, since a slot
+// has at most one read in flight.
+
+#if defined(AINCRAD_HAS_IO_URING)
+
+struct StreamingReader::IoUring {
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    std::unique_ptr<iovec[]> iovecs;
+
+    ~IoUring() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqesSize);
+        }
+        if (cqRing != MAP_FAILED && cqRing != sqRing) {
+            munmap(cqRing, cqRingSize);
+        }
+        if (sqRing != MAP_FAILED) {
+            munmap(sqRing, sqRingSize);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    // Returns null when the kernel or sandbox does not allow io_uring
+    static std::unique_ptr<IoUring> create(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        auto ring = std::make_unique<IoUring>();
+        ring->fd = fd;
+        ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            ring->sqRingSize = ring->cqRingSize = std::max(ring->sqRingSize, ring->cqRingSize);
+        }
+
+        ring->sqRing = mmap(nullptr, ring->sqRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (ring->sqRing == MAP_FAILED) {
+            return nullptr;
+        }
+        ring->cqRing = singleMap ? ring->sqRing
+                                 : mmap(nullptr, ring->cqRingSize, PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cqRing == MAP_FAILED) {
+            return nullptr;
+        }
+        ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqes = static_cast<io_uring_sqe*>(mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE,
+                                                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (ring->sqes == MAP_FAILED) {
+            return nullptr;
+        }
+
+        auto* sq = static_cast<uint8_t*>(ring->sqRing);
+        auto* cq = static_cast<uint8_t*>(ring->cqRing);
+        ring->sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        ring->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        ring->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        ring->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        ring->cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        ring->iovecs = std::make_unique<iovec[]>(entries);
+        return ring;
+    }
+
+    bool submitRead(int file, void* buffer, size_t size, uint64_t offset, uint64_t userData) {
+        iovec& vector = iovecs[userData];
+        vector.iov_base = buffer;
+        vector.iov_len = size;
+
+        // We are the only producer, so the tail needs no atomic read
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = file;
+        sqe.off = offset;
+        sqe.addr = reinterpret_cast<uint64_t>(&vector);
+        sqe.len = 1;
+        sqe.user_data = userData;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        for (int attempt = 0; attempt < SubmitRetryCount; ++attempt) {
+            long submitted = syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0);
+            if (submitted == 1) {
+                return true;
+            }
+            if (submitted < 0 && errno != EINTR && errno != EAGAIN) {
+                break;
+            }
+        }
+
+        // Without SQPOLL the kernel only consumes entries inside enter, so an
+        // entry it has not taken can be withdrawn. Left queued, it would be
+        // submitted by the next enter and complete into a reused slot.
+        if (__atomic_load_n(sqHead, __ATOMIC_ACQUIRE) != tail + 1) {
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+            return false;
+        }
+        return true;
+    }
+
+    void waitForCompletion() {
+        syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+
+    template <typename Handler>
+    void reap(Handler&& handler) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            handler(cqe.user_data, cqe.res);
+            ++head;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+};
+
+#else
+
+struct StreamingReader::IoUring {
+};
+
+#endif
+
+// StreamingReader
+
+StreamingReader::StreamingReader(size_t bufferSize, size_t chunkSize, bool allowIoUring)
+    : m_chunkSize(chunkSize)
+    , m_slotCount(chunkSize ? bufferSize / chunkSize : 0)
+    , m_buffer(nullptr)
+    , m_freeCount(0)
+    , m_cursor(0)
+    , m_tail(0)
+    , m_queueHead(0)
+    , m_queueSize(0)
+    , m_stopping(false)
+{
+    if (m_slotCount == 0) {
+        throw std::invalid_argument("Streaming buffer must hold at least one chunk");
+    }
+
+    m_buffer = static_cast<uint8_t*>(::operator new(m_slotCount * m_chunkSize, std::align_val_t(StagingAlignment)));
+    m_slots = std::make_unique<Slot[]>(m_slotCount);
+    m_free = std::make_unique<uint32_t[]>(m_slotCount);
+    m_order = std::make_unique<uint32_t[]>(m_slotCount);
+    for (size_t i = m_slotCount; i-- > 0;) {
+        m_free[m_freeCount++] = static_cast<uint32_t>(i);
+    }
+
+#if defined(AINCRAD_HAS_IO_URING)
+    if (allowIoUring) {
+        m_ioUring = IoUring::create(static_cast<unsigned>(m_slotCount));
+    }
+#else
+    (void)allowIoUring;
+#endif
+
+    if (!m_ioUring) {
+        m_queue = std::make_unique<uint32_t[]>(m_slotCount);
+        for (size_t i = 0; i < FallbackWorkerCount; ++i) {
+            m_workers.emplace_back(&StreamingReader::workerLoop, this);
+        }
+    }
+}
+
+StreamingReader::~StreamingReader() {
+    // Let in-flight reads land before their buffers go away
+    if (m_ioUring) {
+        while (m_cursor != m_tail) {
+            StreamChunk chunk;
+            wait(chunk);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_submitted.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_ioUring.reset();
+    ::operator delete(m_buffer, std::align_val_t(StagingAlignment));
+}
+
+size_t StreamingReader::submit(const StreamFile& file, uint64_t offset, size_t size, uint64_t tag) {
+    if (!file.isOpen()) {
+        throw std::runtime_error("Streaming from a file that is not open");
+    }
+    if (m_freeCount == 0) {
+        return 0; // Ring is full; release chunks to make room
+    }
+
+    // Undelivered submissions never outnumber the slots they hold, so the
+    // order ring cannot overrun
+    size = std::min(size, m_chunkSize);
+    size_t index = m_free[--m_freeCount];
+    m_order[m_tail % m_slotCount] = static_cast<uint32_t>(index);
+    Slot& slot = m_slots[index];
+    slot.sequence = m_tail;
+    slot.offset = offset;
+    slot.tag = tag;
+    slot.requested = size;
+    slot.result = 0;
+    slot.file = file.nativeHandle();
+    slot.state.store(Pending, std::memory_order_release);
+    ++m_tail;
+
+#if defined(AINCRAD_HAS_IO_URING)
+    if (m_ioUring) {
+        submitRemainder(index);
+        return size;
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue[(m_queueHead + m_queueSize) % m_slotCount] = static_cast<uint32_t>(index);
+        ++m_queueSize;
+    }
+    m_submitted.notify_one();
+    return size;
+}
+
+bool StreamingReader::poll(StreamChunk& chunk) {
+    if (m_cursor == m_tail) {
+        return false;
+    }
+    if (m_ioUring) {
+        reapCompletions(false);
+    }
+    return takeCompleted(chunk);
+}
+
+bool StreamingReader::wait(StreamChunk& chunk) {
+    if (m_cursor == m_tail) {
+        return false;
+    }
+
+    Slot& slot = m_slots[m_order[m_cursor % m_slotCount]];
+    if (m_ioUring) {
+        while (slot.state.load(std::memory_order_acquire) != Complete) {
+            reapCompletions(true);
+        }
+    } else {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_completed.wait(lock, [&slot]() {
+            return slot.state.load(std::memory_order_acquire) == Complete;
+        });
+    }
+    return takeCompleted(chunk);
+}
+
+void StreamingReader::release(const StreamChunk& chunk) {
+    if (chunk.slot >= m_slotCount || m_slots[chunk.slot].state.load(std::memory_order_relaxed) != Received ||
+        m_slots[chunk.slot].sequence != chunk.sequence) {
+        throw std::logic_error("Streamed chunk released twice or before it was received");
+    }
+    m_slots[chunk.slot].state.store(Free, std::memory_order_relaxed);
+    m_free[m_freeCount++] = chunk.slot;
+}
+
+bool StreamingReader::takeCompleted(StreamChunk& chunk) {
+    size_t index = m_order[m_cursor % m_slotCount];
+    Slot& slot = m_slots[index];
+    if (slot.state.load(std::memory_order_acquire) != Complete) {
+        return false;
+    }
+    slot.state.store(Received, std::memory_order_relaxed);
+
+    chunk.data = slotData(index);
+    chunk.size = slot.result > 0 ? size_t(slot.result) : 0;
+    chunk.offset = slot.offset;
+    chunk.tag = slot.tag;
+    chunk.error = slot.result < 0 ? int(-slot.result) : 0;
+    chunk.sequence = m_cursor;
+    chunk.slot = static_cast<uint32_t>(index);
+    ++m_cursor;
+    return true;
+}
+
+void StreamingReader::reapCompletions(bool block) {
+#if defined(AINCRAD_HAS_IO_URING)
+    if (block) {
+        m_ioUring->waitForCompletion();
+    }
+    m_ioUring->reap([this](uint64_t index, int32_t result) {
+        Slot& slot = m_slots[index];
+        if (result < 0 && result != -EINTR && result != -EAGAIN) {
+            slot.result = result;
+        } else {
+            // Short reads continue where they stopped, as in readSlot, until
+            // the chunk is full or the file ends
+            slot.result += std::max(result, 0);
+            if (result != 0 && size_t(slot.result) < slot.requested) {
+                submitRemainder(size_t(index));
+                return;
+            }
+        }
+        slot.state.store(Complete, std::memory_order_release);
+    });
+#else
+    (void)block;
+#endif
+}
+
+void StreamingReader::submitRemainder(size_t index) {
+#if defined(AINCRAD_HAS_IO_URING)
+    Slot& slot = m_slots[index];
+    size_t done = size_t(slot.result);
+    if (!m_ioUring->submitRead(slot.file, slotData(index) + done, slot.requested - done, slot.offset + done,
+                               index)) {
+        // Surface a submission failure as a failed chunk
+        slot.result = -EIO;
+        slot.state.store(Complete, std::memory_order_release);
+    }
+#else
+    (void)index;
+#endif
+}
+
+void StreamingReader::readSlot(size_t index) {
+    Slot& slot = m_slots[index];
+    uint8_t* target = slotData(index);
+    size_t done = 0;
+
+    // Retry short reads until the chunk is full or the file ends
+    while (done < slot.requested) {
+#if defined(_WIN32)
+        OVERLAPPED overlapped = {};
+        uint64_t position = slot.offset + done;
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD read = 0;
+        if (!ReadFile(slot.file, target + done, static_cast<DWORD>(slot.requested - done), &read, &overlapped)) {
+            slot.result = GetLastError() == ERROR_HANDLE_EOF ? int64_t(done) : -EIO;
+            return;
+        }
+#else
+        ssize_t read = pread(slot.file, target + done, slot.requested - done,
+                             static_cast<off_t>(slot.offset + done));
+        if (read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            slot.result = -errno;
+            return;
+        }
+#endif
+        if (read == 0) {
+            break;
+        }
+        done += size_t(read);
+    }
+    slot.result = int64_t(done);
+}
+
+void StreamingReader::workerLoop() {
+    for (;;) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_submitted.wait(lock, [this]() { return m_stopping || m_queueSize > 0; });
+            if (m_queueSize == 0) {
+                return; // Stopping with nothing left to read
+            }
+            index = m_queue[m_queueHead];
+            m_queueHead = (m_queueHead + 1) % m_slotCount;
+            --m_queueSize;
+        }
+
+        readSlot(index);
+
+        // Publish under the lock so a waiting consumer cannot miss the wakeup
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots[index].state.store(Complete, std::memory_order_release);
+        }
+        m_completed.notify_all();
+    }
+}
+
+} // namespace World
+} // namespace Aincrad
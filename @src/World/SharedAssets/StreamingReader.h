@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// Read-only file opened for positioned streaming reads
+class StreamFile {
+public:
+    StreamFile();
+    ~StreamFile();
+
+    StreamFile(const StreamFile&) = delete;
+    StreamFile& operator=(const StreamFile&) = delete;
+
+    // Throws std::runtime_error if the file cannot be opened
+    void open(const std::string& path);
+    void close();
+
+    // Getters
+    bool isOpen() const;
+    uint64_t size() const { return m_size; }
+    const std::string& path() const { return m_path; }
+#if defined(_WIN32)
+    void* nativeHandle() const { return m_handle; }
+#else
+    int nativeHandle() const { return m_fd; }
+#endif
+
+private:
+#if defined(_WIN32)
+    void* m_handle;
+#else
+    int m_fd;
+#endif
+    uint64_t m_size;
+    std::string m_path;
+};
+
+// Zero-copy view of a completed read. data points into the reader's staging
+// ring and stays valid until the chunk is released.
+struct StreamChunk {
+    const uint8_t* data = nullptr;
+    size_t size = 0;       // Bytes read; short at end of file
+    uint64_t offset = 0;
+    uint64_t tag = 0;      // Caller's value from submit
+    int error = 0;         // errno-style code, 0 on success
+    uint64_t sequence = 0;
+    uint32_t slot = 0;     // Staging slot the data sits in
+
+    bool ok() const { return error == 0; }
+};
+
+// Streams file chunks through a fixed staging ring of bufferSize bytes split
+// into chunkSize slots. Reads are positioned and run on io_uring where the
+// kernel allows it, otherwise on a small pread thread pool. All memory is
+// reserved up front, so steady streaming allocates nothing and in-flight I/O
+// never holds more than bufferSize bytes. Chunks complete in submission
+// order from the consumer's point of view, but may be released in any
+// order, so a chunk kept for later does not hold up the rest of the ring.
+//
+// One thread submits, polls and releases; only the I/O backend is concurrent.
+class StreamingReader {
+public:
+    static constexpr size_t DefaultChunkSize = 64 * 1024;
+
+    StreamingReader(size_t bufferSize, size_t chunkSize = DefaultChunkSize, bool allowIoUring = true);
+    ~StreamingReader();
+
+    StreamingReader(const StreamingReader&) = delete;
+    StreamingReader& operator=(const StreamingReader&) = delete;
+
+    // Queues a read of up to chunkSize bytes into the next free slot and
+    // returns the number of bytes queued, or 0 when every slot is in use.
+    // The file must stay open until the chunk has been received.
+    size_t submit(const StreamFile& file, uint64_t offset, size_t size, uint64_t tag = 0);
+
+    // Takes the next chunk in submission order. poll returns false if it has
+    // not completed yet; wait blocks for it and returns false only when
+    // nothing is in flight.
+    bool poll(StreamChunk& chunk);
+    bool wait(StreamChunk& chunk);
+
+    // Returns a received chunk's slot to the ring. Throws std::logic_error
+    // for a chunk that is not received or already released.
+    void release(const StreamChunk& chunk);
+
+    // Getters
+    bool usesIoUring() const { return m_ioUring != nullptr; }
+    size_t getBufferSize() const { return m_slotCount * m_chunkSize; }
+    size_t getChunkSize() const { return m_chunkSize; }
+    size_t getSlotCount() const { return m_slotCount; }
+    size_t getInFlight() const { return m_slotCount - m_freeCount; } // Slots not released yet
+    size_t getPending() const { return size_t(m_tail - m_cursor); } // Chunks not received yet
+
+private:
+    enum SlotState : int {
+        Free,
+        Pending,
+        Complete,
+        Received
+    };
+
+    struct Slot {
+        std::atomic<int> state{Free};
+        uint64_t sequence = 0;
+        uint64_t offset = 0;
+        uint64_t tag = 0;
+        size_t requested = 0;
+        int64_t result = 0; // Bytes read so far, or a negated error code
+#if defined(_WIN32)
+        void* file = nullptr;
+#else
+        int file = -1;
+#endif
+    };
+
+    struct IoUring;
+
+    uint8_t* slotData(size_t slot) const { return m_buffer + slot * m_chunkSize; }
+    bool takeCompleted(StreamChunk& chunk);
+    void readSlot(size_t slot);
+    void submitRemainder(size_t slot);
+    void reapCompletions(bool block);
+    void workerLoop();
+
+    size_t m_chunkSize;
+    size_t m_slotCount;
+    uint8_t* m_buffer;
+    std::unique_ptr<Slot[]> m_slots;
+    std::unique_ptr<uint32_t[]> m_free;  // Stack of free slot indices
+    size_t m_freeCount;
+    std::unique_ptr<uint32_t[]> m_order; // Slot of each submission, by sequence
+    uint64_t m_cursor; // Next submission handed to the consumer
+    uint64_t m_tail;   // Next submission
+
+    // io_uring backend
+    std::unique_ptr<IoUring> m_ioUring;
+
+    // Thread-pool fallback; the queue is a fixed ring of slot indices
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<uint32_t[]> m_queue;
+    size_t m_queueHead;
+    size_t m_queueSize;
+    std::mutex m_mutex;
+    std::condition_variable m_submitted;
+    std::condition_variable m_completed;
+    bool m_stopping;
+};
+
+} // namespace World
+} // namespace Aincrad
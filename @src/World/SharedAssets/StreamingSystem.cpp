@@ -1,11 +1,29 @@
 #include "StreamingSystem.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
 
 namespace Aincrad {
 namespace World {
 
-StreamingSystem::StreamingSystem() {
+namespace {
+
+// Assets are loaded inside streamDistance but only evicted beyond this
+// multiple of it, so props on the boundary do not thrash
+constexpr float EvictionSlack = 1.1f;
+
+} // namespace
+
+StreamingSystem::StreamingSystem()
+    : m_config()
+    , m_cellSize(1.0f)
+    , m_streamingCount(0)
+    , m_loadingCount(0)
+    , m_residentCount(0)
+    , m_loadRequests(0)
+    , m_evictions(0)
+{
 }
 
 StreamingSystem::~StreamingSystem() {
@@ -13,51 +31,307 @@ StreamingSystem::~StreamingSystem() {
 }
 
 void StreamingSystem::configure(const StreamingConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_config = config;
+
+    // The staging ring is the whole I/O footprint, so it is sized once here
+    size_t bufferSize = config.streamBufferSize > 0 ? size_t(config.streamBufferSize) : 0;
+    std::shared_ptr<StreamingReadQueue> reader = std::atomic_load(&m_reader);
+    if (!config.enableStreaming || bufferSize < StreamingReader::DefaultChunkSize) {
+        std::atomic_store(&m_reader, std::shared_ptr<StreamingReadQueue>());
+    } else if (!reader || reader->getBufferSize() != bufferSize) {
+        std::atomic_store(&m_reader, std::make_shared<StreamingReadQueue>(bufferSize));
+    }
+
+    float cellSize = std::max(config.streamDistance, 1.0f);
+    if (cellSize != m_cellSize) {
+        m_cellSize = cellSize;
+        rebuildGrid();
+    }
+}
+
+std::shared_ptr<StreamingReadQueue> StreamingSystem::getReader() const {
+    // Lock-free, so load callbacks creating assets can hand them the ring
+    return std::atomic_load(&m_reader);
+}
+
+void StreamingSystem::setCallbacks(StreamingLoadCallback load, StreamingReleaseCallback release) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_loadCallback = std::move(load);
+    m_releaseCallback = std::move(release);
 }
 
-void StreamingSystem::startStreaming(const std::string& assetId) {
-    auto it = std::find(m_streamingAssets.begin(), m_streamingAssets.end(), assetId);
-    if (it != m_streamingAssets.end()) {
+void StreamingSystem::startStreaming(AssetHandle asset, const StreamingPosition& position) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_streamingAssets.count(asset)) {
         return;
     }
 
-    m_streamingAssets.push_back(assetId);
+    // Picked up by the next update if an observer is near its cell
+    StreamingEntry entry;
+    entry.position = position;
+    entry.cell = cellFor(position);
+    insertIntoCell(asset, entry.cell);
+    m_streamingAssets.emplace(asset, std::move(entry));
+    publishCounts();
 }
 
-void StreamingSystem::stopStreaming(const std::string& assetId) {
-    auto it = std::find(m_streamingAssets.begin(), m_streamingAssets.end(), assetId);
-    if (it != m_streamingAssets.end()) {
-        m_streamingAssets.erase(it);
+void StreamingSystem::stopStreaming(AssetHandle asset) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streamingAssets.find(asset);
+    if (it == m_streamingAssets.end()) {
+        return;
+    }
+
+    if (it->second.state != StreamingState::Evicted) {
+        evict(asset, it->second);
     }
+    removeFromCell(asset, it->second.cell);
+    m_streamingAssets.erase(it);
+    publishCounts();
+}
+
+void StreamingSystem::moveAsset(AssetHandle asset, const StreamingPosition& position) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streamingAssets.find(asset);
+    if (it == m_streamingAssets.end()) {
+        return;
+    }
+
+    StreamingEntry& entry = it->second;
+    entry.position = position;
+    CellKey cell = cellFor(position);
+    if (cell == entry.cell) {
+        return;
+    }
+    removeFromCell(asset, entry.cell);
+    insertIntoCell(asset, cell);
+    entry.cell = cell;
+
+    // Active cells cover every point in reach of an observer, so anything
+    // moved outside them is out of range and would otherwise never be visited
+    if (entry.state != StreamingState::Evicted && !m_activeCells.count(cell)) {
+        evict(asset, entry);
+        publishCounts();
+    }
+}
+
+void StreamingSystem::setObserver(uint32_t observerId, const StreamingPosition& position) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_observers[observerId] = position;
+}
+
+void StreamingSystem::removeObserver(uint32_t observerId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_observers.erase(observerId);
+}
+
+StreamingState StreamingSystem::getState(AssetHandle asset) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streamingAssets.find(asset);
+    return it != m_streamingAssets.end() ? it->second.state : StreamingState::Evicted;
+}
+
+size_t StreamingSystem::getStreamingAssetCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_streamingAssets.size();
+}
+
+StreamingStats StreamingSystem::getStats() const {
+    StreamingStats stats;
+    stats.streamingAssets = m_streamingCount.load(std::memory_order_relaxed);
+    stats.loadingAssets = m_loadingCount.load(std::memory_order_relaxed);
+    stats.residentAssets = m_residentCount.load(std::memory_order_relaxed);
+    stats.loadRequests = m_loadRequests.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StreamingSystem::publishCounts() {
+    m_streamingCount.store(m_streamingAssets.size(), std::memory_order_relaxed);
+    m_loadingCount.store(m_loadingAssets.size(), std::memory_order_relaxed);
 }
 
 void StreamingSystem::update() {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (!m_config.enableStreaming) {
         return;
     }
 
-    // Update streaming for each asset
-    for (const auto& assetId : m_streamingAssets) {
-        // TODO: Implement streaming update logic
-        switch (m_config.strategy) {
-            case StreamingConfig::StreamingStrategy::DistanceBased:
-                // TODO: Implement distance-based streaming
-                break;
-            case StreamingConfig::StreamingStrategy::PriorityBased:
-                // TODO: Implement priority-based streaming
-                break;
-            case StreamingConfig::StreamingStrategy::QualityBased:
-                // TODO: Implement quality-based streaming
-                break;
-            case StreamingConfig::StreamingStrategy::PlatformSpecific:
-                // TODO: Implement platform-specific streaming
-                break;
-            default:
-                throw std::runtime_error("Unknown streaming strategy");
+    // Promote finished loads, then re-check them: observers may have moved
+    // away while they were in flight
+    std::vector<AssetHandle> loading(m_loadingAssets.begin(), m_loadingAssets.end());
+    for (AssetHandle asset : loading) {
+        StreamingEntry& entry = m_streamingAssets.at(asset);
+        if (!entry.load.isReady()) {
+            continue;
+        }
+        m_loadingAssets.erase(asset);
+        try {
+            entry.load.ready.get();
+            entry.state = StreamingState::Resident;
+            m_residentCount.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::exception&) {
+            // Failed loads are dropped and retried when next in range
+            entry.load = AssetLoadHandle();
+            entry.state = StreamingState::Evicted;
+            continue;
+        }
+        evaluate(asset, entry);
+    }
+
+    // Update streaming based on strategy
+    switch (m_config.strategy) {
+        case StreamingConfig::StreamingStrategy::DistanceBased:
+            updateDistanceBased();
+            break;
+        case StreamingConfig::StreamingStrategy::PriorityBased:
+            // TODO: Implement priority-based streaming
+            break;
+        case StreamingConfig::StreamingStrategy::QualityBased:
+            // TODO: Implement quality-based streaming
+            break;
+        case StreamingConfig::StreamingStrategy::PlatformSpecific:
+            // TODO: Implement platform-specific streaming
+            break;
+        default:
+            throw std::runtime_error("Unknown streaming strategy");
+    }
+    publishCounts();
+}
+
+void StreamingSystem::updateDistanceBased() {
+    // Every cell that overlaps an observer's eviction radius
+    float reach = m_config.streamDistance * EvictionSlack;
+    std::unordered_set<CellKey> activeCells;
+    for (const auto& [observerId, position] : m_observers) {
+        int32_t minX = static_cast<int32_t>(std::floor((position.x - reach) / m_cellSize));
+        int32_t maxX = static_cast<int32_t>(std::floor((position.x + reach) / m_cellSize));
+        int32_t minZ = static_cast<int32_t>(std::floor((position.z - reach) / m_cellSize));
+        int32_t maxZ = static_cast<int32_t>(std::floor((position.z + reach) / m_cellSize));
+        for (int32_t x = minX; x <= maxX; ++x) {
+            for (int32_t z = minZ; z <= maxZ; ++z) {
+                activeCells.insert((uint64_t(uint32_t(x)) << 32) | uint32_t(z));
+            }
+        }
+    }
+
+    // Visit the active cells plus the ones observers just left, whose
+    // resident assets are now out of range
+    auto visit = [this](CellKey key) {
+        auto cell = m_cells.find(key);
+        if (cell == m_cells.end()) {
+            return;
+        }
+        for (AssetHandle asset : cell->second) {
+            evaluate(asset, m_streamingAssets.at(asset));
+        }
+    };
+    for (CellKey key : activeCells) {
+        visit(key);
+    }
+    for (CellKey key : m_activeCells) {
+        if (!activeCells.count(key)) {
+            visit(key);
+        }
+    }
+    m_activeCells = std::move(activeCells);
+}
+
+void StreamingSystem::evaluate(AssetHandle asset, StreamingEntry& entry) {
+    float distance = nearestObserverDistance(entry.position);
+
+    if (entry.state == StreamingState::Evicted) {
+        if (distance > m_config.streamDistance || !m_loadCallback) {
+            return;
+        }
+
+        // Nearer assets jump ahead in the loader's streaming band
+        float closeness = m_config.streamDistance > 0.0f ? 1.0f - distance / m_config.streamDistance : 1.0f;
+        int priority = static_cast<int>(closeness * 100.0f);
+        try {
+            entry.load = m_loadCallback(asset, priority);
+        } catch (const std::exception&) {
+            return; // Retried on the next visit
+        }
+        entry.state = StreamingState::Loading;
+        m_loadingAssets.insert(asset);
+        m_loadRequests.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (distance > m_config.streamDistance * EvictionSlack) {
+        evict(asset, entry);
+    }
+}
+
+void StreamingSystem::evict(AssetHandle asset, StreamingEntry& entry) {
+    if (entry.state == StreamingState::Resident) {
+        m_residentCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+
+    // Drop our reference first so the owner can actually free the asset
+    entry.load = AssetLoadHandle();
+    entry.state = StreamingState::Evicted;
+    m_loadingAssets.erase(asset);
+    if (m_releaseCallback) {
+        m_releaseCallback(asset);
+    }
+}
+
+float StreamingSystem::nearestObserverDistance(const StreamingPosition& position) const {
+    float nearest = std::numeric_limits<float>::infinity();
+    for (const auto& [observerId, observer] : m_observers) {
+        float dx = observer.x - position.x;
+        float dy = observer.y - position.y;
+        float dz = observer.z - position.z;
+        nearest = std::min(nearest, std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+    return nearest;
+}
+
+StreamingSystem::CellKey StreamingSystem::cellFor(const StreamingPosition& position) const {
+    int32_t x = static_cast<int32_t>(std::floor(position.x / m_cellSize));
+    int32_t z = static_cast<int32_t>(std::floor(position.z / m_cellSize));
+    return (uint64_t(uint32_t(x)) << 32) | uint32_t(z);
+}
+
+void StreamingSystem::insertIntoCell(AssetHandle asset, CellKey cell) {
+    m_cells[cell].push_back(asset);
+}
+
+void StreamingSystem::removeFromCell(AssetHandle asset, CellKey cell) {
+    auto it = m_cells.find(cell);
+    if (it == m_cells.end()) {
+        return;
+    }
+
+    // Order within a cell does not matter, so swap-and-pop
+    auto& assets = it->second;
+    auto found = std::find(assets.begin(), assets.end(), asset);
+    if (found != assets.end()) {
+        *found = assets.back();
+        assets.pop_back();
+    }
+    if (assets.empty()) {
+        m_cells.erase(it);
+    }
+}
+
+void StreamingSystem::rebuildGrid() {
+    m_cells.clear();
+    m_activeCells.clear();
+    for (auto& [asset, entry] : m_streamingAssets) {
+        entry.cell = cellFor(entry.position);
+        insertIntoCell(asset, entry.cell);
+
+        // Make sure the next update revisits anything still streamed in
+        if (entry.state != StreamingState::Evicted) {
+            m_activeCells.insert(entry.cell);
         }
     }
 }
 
 } // namespace World
-} // namespace Aincrad 
\ No newline at end of file
+} // namespace Aincrad
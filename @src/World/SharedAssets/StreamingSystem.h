@@ -1,9 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "Asset.h"
+#include "AssetHandle.h"
+#include "AssetLoader.h"
+#include "StreamingReadQueue.h"
 
 namespace Aincrad {
 namespace World {
@@ -26,6 +35,35 @@ struct StreamingConfig {
     } platformSettings;
 };
 
+struct StreamingPosition {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+enum class StreamingState {
+    Evicted,
+    Loading,
+    Resident
+};
+
+struct StreamingStats {
+    size_t streamingAssets = 0;
+    size_t loadingAssets = 0;
+    size_t residentAssets = 0;
+    uint64_t loadRequests = 0;  // Loads started by the streaming system
+    uint64_t evictions = 0;     // Loading or resident assets released
+};
+
+// Starts a streamed load; higher priorities are picked first
+using StreamingLoadCallback = std::function<AssetLoadHandle(AssetHandle asset, int priority)>;
+// Called after the streaming system has dropped its reference to an asset
+using StreamingReleaseCallback = std::function<void(AssetHandle asset)>;
+
+// Streams positioned assets in and out around observers. Assets are bucketed
+// into a uniform grid on the ground plane (x/z) with cells streamDistance
+// wide, so an update only visits the cells around each observer plus the
+// cells they just left, instead of every streamable asset.
 class StreamingSystem {
 public:
     StreamingSystem();
@@ -33,16 +71,71 @@ public:
 
     // Configuration
     void configure(const StreamingConfig& config);
+    // The callbacks run inside update() and must not call back into the
+    // streaming system, other than through getReader()
+    void setCallbacks(StreamingLoadCallback load, StreamingReleaseCallback release);
 
     // Streaming management
-    void startStreaming(const std::string& assetId);
-    void stopStreaming(const std::string& assetId);
+    void startStreaming(AssetHandle asset, const StreamingPosition& position);
+    void stopStreaming(AssetHandle asset);
+    void moveAsset(AssetHandle asset, const StreamingPosition& position);
     void update();
 
+    // Observers (players, cameras) that pull assets in around them
+    void setObserver(uint32_t observerId, const StreamingPosition& position);
+    void removeObserver(uint32_t observerId);
+
+    // Chunked file I/O through a staging ring of streamBufferSize bytes,
+    // shared by streamed asset loads and audio streams; null while streaming
+    // is disabled or the buffer is smaller than one chunk. Holders keep a
+    // replaced ring alive until they let go of it. Lock-free, and safe to
+    // call from the callbacks.
+    std::shared_ptr<StreamingReadQueue> getReader() const;
+
+    // Getters
+    StreamingState getState(AssetHandle asset) const;
+    size_t getStreamingAssetCount() const;
+    // Lock-free; counts are published at the end of every streaming call
+    StreamingStats getStats() const;
+
 private:
+    using CellKey = uint64_t;
+
+    struct StreamingEntry {
+        StreamingPosition position;
+        CellKey cell;
+        StreamingState state = StreamingState::Evicted;
+        AssetLoadHandle load; // Held while loading or resident
+    };
+
+    CellKey cellFor(const StreamingPosition& position) const;
+    void insertIntoCell(AssetHandle asset, CellKey cell);
+    void removeFromCell(AssetHandle asset, CellKey cell);
+    void rebuildGrid();
+    float nearestObserverDistance(const StreamingPosition& position) const;
+    void evaluate(AssetHandle asset, StreamingEntry& entry);
+    void evict(AssetHandle asset, StreamingEntry& entry);
+    void updateDistanceBased();
+    void publishCounts();
+
     StreamingConfig m_config;
-    std::vector<std::string> m_streamingAssets;
+    float m_cellSize;
+    StreamingLoadCallback m_loadCallback;
+    StreamingReleaseCallback m_releaseCallback;
+    std::unordered_map<AssetHandle, StreamingEntry, AssetHandleHash> m_streamingAssets;
+    std::unordered_map<CellKey, std::vector<AssetHandle>> m_cells;
+    std::unordered_map<uint32_t, StreamingPosition> m_observers;
+    std::unordered_set<CellKey> m_activeCells; // Cells evaluated last update
+    std::unordered_set<AssetHandle, AssetHandleHash> m_loadingAssets;
+    std::shared_ptr<StreamingReadQueue> m_reader; // Accessed with std::atomic_load/store
+    mutable std::mutex m_mutex;
+
+    std::atomic<size_t> m_streamingCount;
+    std::atomic<size_t> m_loadingCount;
+    std::atomic<size_t> m_residentCount;
+    std::atomic<uint64_t> m_loadRequests;
+    std::atomic<uint64_t> m_evictions;
 };
 
 } // namespace World
-} // namespace Aincrad 
\ No newline at end of file
+} // namespace Aincrad
@@ -0,0 +1,638 @@
+#include "TextureFormat.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define AINCRAD_TEXTURE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AINCRAD_TARGET_AVX2
+#else
+#define AINCRAD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Aincrad {
+namespace World {
+
+using namespace TextureFormat;
+
+namespace {
+
+constexpr size_t MipAlignment = 16;
+
+float srgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+const std::array<float, 256>& srgbTable() {
+    static const std::array<float, 256> table = []() {
+        std::array<float, 256> values{};
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = srgbToLinear(float(i) / 255.0f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+// Linear values at the midpoints between sRGB codes, so encoding is a
+// search that rounds exactly rather than a pow per channel
+const std::array<float, 255>& srgbThresholds() {
+    static const std::array<float, 255> table = []() {
+        std::array<float, 255> values{};
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = srgbToLinear((float(i) + 0.5f) / 255.0f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+uint8_t encodeChannel(float value, bool srgb) {
+    if (srgb) {
+        const auto& thresholds = srgbThresholds();
+        return uint8_t(std::upper_bound(thresholds.begin(), thresholds.end(), value) - thresholds.begin());
+    }
+    return uint8_t(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// Mips are filtered from the level above in float, premultiplied and in
+// linear light, and only quantized on the way out
+std::vector<float> toWorking(const TextureImage& image, bool srgb) {
+    const auto& table = srgbTable();
+    std::vector<float> working(image.pixels.size());
+    for (size_t i = 0; i < image.pixels.size(); i += 4) {
+        float alpha = float(image.pixels[i + 3]) / 255.0f;
+        for (size_t c = 0; c < 3; ++c) {
+            uint8_t value = image.pixels[i + c];
+            working[i + c] = (srgb ? table[value] : float(value) / 255.0f) * alpha;
+        }
+        working[i + 3] = alpha;
+    }
+    return working;
+}
+
+TextureImage fromWorking(const std::vector<float>& working, uint32_t width, uint32_t height, bool srgb) {
+    TextureImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(working.size());
+    for (size_t i = 0; i < working.size(); i += 4) {
+        float alpha = working[i + 3];
+        for (size_t c = 0; c < 3; ++c) {
+            image.pixels[i + c] = alpha > 0.0f ? encodeChannel(working[i + c] / alpha, srgb) : 0;
+        }
+        image.pixels[i + 3] = encodeChannel(alpha, false);
+    }
+    return image;
+}
+
+// Sums every 2x2 quad as (top left + bottom left) + (top right + bottom
+// right), in that order on every path, so the results match bit for bit
+void downsampleRowScalar(const float* row0, const float* row1, float* output, uint32_t width, uint32_t sourceWidth) {
+    for (uint32_t x = 0; x < width; ++x) {
+        const uint32_t x0 = std::min(2 * x, sourceWidth - 1) * 4;
+        const uint32_t x1 = std::min(2 * x + 1, sourceWidth - 1) * 4;
+        for (uint32_t c = 0; c < 4; ++c) {
+            output[x * 4 + c] = ((row0[x0 + c] + row1[x0 + c]) + (row0[x1 + c] + row1[x1 + c])) * 0.25f;
+        }
+    }
+}
+
+#if defined(AINCRAD_TEXTURE_X86)
+// One RGBA pixel per register
+void downsampleRowSSE2(const float* row0, const float* row1, float* output, uint32_t width, uint32_t sourceWidth) {
+    if (sourceWidth < 2) {
+        downsampleRowScalar(row0, row1, output, width, sourceWidth);
+        return;
+    }
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    for (uint32_t x = 0; x < width; ++x) {
+        __m128 left = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row1 + x * 8));
+        __m128 right = _mm_add_ps(_mm_loadu_ps(row0 + x * 8 + 4), _mm_loadu_ps(row1 + x * 8 + 4));
+        _mm_storeu_ps(output + x * 4, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+    }
+}
+
+// Two output pixels per register: each load covers one source quad's row,
+// and swapping 128-bit lanes lines the left columns up with the right
+AINCRAD_TARGET_AVX2
+void downsampleRowAVX2(const float* row0, const float* row1, float* output, uint32_t width, uint32_t sourceWidth) {
+    if (sourceWidth < 2) {
+        downsampleRowScalar(row0, row1, output, width, sourceWidth);
+        return;
+    }
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    uint32_t x = 0;
+    for (; x + 2 <= width; x += 2) {
+        __m256 first = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8));
+        __m256 second = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8 + 8), _mm256_loadu_ps(row1 + x * 8 + 8));
+        __m256 left = _mm256_permute2f128_ps(first, second, 0x20);
+        __m256 right = _mm256_permute2f128_ps(first, second, 0x31);
+        _mm256_storeu_ps(output + x * 4, _mm256_mul_ps(_mm256_add_ps(left, right), quarter));
+    }
+    downsampleRowSSE2(row0 + x * 8, row1 + x * 8, output + x * 4, width - x, sourceWidth - 2 * x);
+}
+#endif
+
+void downsample(const std::vector<float>& source, uint32_t sourceWidth, uint32_t sourceHeight,
+                std::vector<float>& output, uint32_t width, uint32_t height, TextureSimd simd) {
+    auto row = downsampleRowScalar;
+#if defined(AINCRAD_TEXTURE_X86)
+    if (simd == TextureSimd::AVX2) {
+        row = downsampleRowAVX2;
+    } else if (simd == TextureSimd::SSE2) {
+        row = downsampleRowSSE2;
+    }
+#endif
+    output.resize(size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y) {
+        const float* row0 = source.data() + size_t(std::min(2 * y, sourceHeight - 1)) * sourceWidth * 4;
+        const float* row1 = source.data() + size_t(std::min(2 * y + 1, sourceHeight - 1)) * sourceWidth * 4;
+        row(row0, row1, output.data() + size_t(y) * width * 4, width, sourceWidth);
+    }
+}
+
+void validateImage(const TextureImage& image) {
+    if (image.width == 0 || image.height == 0 || image.pixels.size() != size_t(image.width) * image.height * 4) {
+        throw std::runtime_error("Texture image is empty or its pixels do not match its size");
+    }
+}
+
+// BC1 and BC3 share the 5:6:5 color block: two endpoints and a 2-bit index
+// per pixel into the endpoints and the two colors between them
+struct Color {
+    float r, g, b;
+};
+
+uint16_t packColor(const Color& color) {
+    auto quantize = [](float value, int bits) {
+        int max = (1 << bits) - 1;
+        return std::clamp(int(value * float(max) / 255.0f + 0.5f), 0, max);
+    };
+    return uint16_t(quantize(color.r, 5) << 11 | quantize(color.g, 6) << 5 | quantize(color.b, 5));
+}
+
+std::array<uint8_t, 3> unpackColor(uint16_t packed) {
+    uint8_t r = uint8_t((packed >> 11) & 31);
+    uint8_t g = uint8_t((packed >> 5) & 63);
+    uint8_t b = uint8_t(packed & 31);
+    return {uint8_t(r << 3 | r >> 2), uint8_t(g << 2 | g >> 4), uint8_t(b << 3 | b >> 2)};
+}
+
+std::array<std::array<uint8_t, 3>, 4> colorPalette(uint16_t color0, uint16_t color1) {
+    auto a = unpackColor(color0);
+    auto b = unpackColor(color1);
+    std::array<std::array<uint8_t, 3>, 4> palette{a, b, {}, {}};
+    for (size_t c = 0; c < 3; ++c) {
+        palette[2][c] = uint8_t((2 * a[c] + b[c]) / 3);
+        palette[3][c] = uint8_t((a[c] + 2 * b[c]) / 3);
+    }
+    return palette;
+}
+
+// Picks the nearest palette entry per pixel; returns the packed indices
+// and the total squared error
+uint32_t colorIndices(const uint8_t* block, uint16_t color0, uint16_t color1, uint64_t& error) {
+    auto palette = colorPalette(color0, color1);
+    uint32_t indices = 0;
+    error = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint32_t best = 0;
+        uint32_t bestError = std::numeric_limits<uint32_t>::max();
+        for (uint32_t p = 0; p < 4; ++p) {
+            uint32_t distance = 0;
+            for (size_t c = 0; c < 3; ++c) {
+                int delta = int(block[i * 4 + c]) - int(palette[p][c]);
+                distance += uint32_t(delta * delta);
+            }
+            if (distance < bestError) {
+                best = p;
+                bestError = distance;
+            }
+        }
+        indices |= best << (2 * i);
+        error += bestError;
+    }
+    return indices;
+}
+
+// Endpoints from the extremes along the block's principal axis, then one
+// least-squares pass over the chosen indices, keeping it if it helps
+void encodeColorBlock(const uint8_t* block, uint8_t* output) {
+    Color mean{0, 0, 0};
+    for (uint32_t i = 0; i < 16; ++i) {
+        mean.r += block[i * 4];
+        mean.g += block[i * 4 + 1];
+        mean.b += block[i * 4 + 2];
+    }
+    mean = {mean.r / 16, mean.g / 16, mean.b / 16};
+
+    float covariance[6] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        float r = block[i * 4] - mean.r;
+        float g = block[i * 4 + 1] - mean.g;
+        float b = block[i * 4 + 2] - mean.b;
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+    Color axis{1, 1, 1};
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        Color next{covariance[0] * axis.r + covariance[1] * axis.g + covariance[2] * axis.b,
+                   covariance[1] * axis.r + covariance[3] * axis.g + covariance[4] * axis.b,
+                   covariance[2] * axis.r + covariance[4] * axis.g + covariance[5] * axis.b};
+        float length = std::max({std::fabs(next.r), std::fabs(next.g), std::fabs(next.b)});
+        if (length < 1e-6f) {
+            break;
+        }
+        axis = {next.r / length, next.g / length, next.b / length};
+    }
+
+    float low = std::numeric_limits<float>::max();
+    float high = std::numeric_limits<float>::lowest();
+    Color lowColor = mean;
+    Color highColor = mean;
+    for (uint32_t i = 0; i < 16; ++i) {
+        Color pixel{float(block[i * 4]), float(block[i * 4 + 1]), float(block[i * 4 + 2])};
+        float projection = pixel.r * axis.r + pixel.g * axis.g + pixel.b * axis.b;
+        if (projection < low) {
+            low = projection;
+            lowColor = pixel;
+        }
+        if (projection > high) {
+            high = projection;
+            highColor = pixel;
+        }
+    }
+
+    uint16_t color0 = packColor(highColor);
+    uint16_t color1 = packColor(lowColor);
+    uint64_t error;
+    uint32_t indices = colorIndices(block, color0, color1, error);
+
+    // Solve for the endpoints that best fit the pixels' palette weights
+    static const float weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    float aa = 0, ab = 0, bb = 0;
+    Color ax{0, 0, 0}, bx{0, 0, 0};
+    for (uint32_t i = 0; i < 16; ++i) {
+        float t = weights[(indices >> (2 * i)) & 3];
+        float s = 1.0f - t;
+        aa += s * s;
+        ab += s * t;
+        bb += t * t;
+        ax = {ax.r + s * block[i * 4], ax.g + s * block[i * 4 + 1], ax.b + s * block[i * 4 + 2]};
+        bx = {bx.r + t * block[i * 4], bx.g + t * block[i * 4 + 1], bx.b + t * block[i * 4 + 2]};
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) > 1e-6f) {
+        auto solve = [&](float a, float b, float& first, float& second) {
+            first = (bb * a - ab * b) / determinant;
+            second = (aa * b - ab * a) / determinant;
+        };
+        Color first, second;
+        solve(ax.r, bx.r, first.r, second.r);
+        solve(ax.g, bx.g, first.g, second.g);
+        solve(ax.b, bx.b, first.b, second.b);
+        uint16_t refined0 = packColor(first);
+        uint16_t refined1 = packColor(second);
+        uint64_t refinedError;
+        uint32_t refinedIndices = colorIndices(block, refined0, refined1, refinedError);
+        if (refinedError < error) {
+            color0 = refined0;
+            color1 = refined1;
+            indices = refinedIndices;
+        }
+    }
+
+    // color0 must be the larger for the four-color mode; a flat block uses
+    // index 0 only, which means the same in either mode
+    if (color0 < color1) {
+        std::swap(color0, color1);
+        indices ^= 0x55555555; // 0 <-> 1 and 2 <-> 3
+    } else if (color0 == color1) {
+        indices = 0;
+    }
+    std::memcpy(output, &color0, 2);
+    std::memcpy(output + 2, &color1, 2);
+    std::memcpy(output + 4, &indices, 4);
+}
+
+std::array<uint8_t, 8> alphaPalette(uint8_t alpha0, uint8_t alpha1) {
+    std::array<uint8_t, 8> palette{alpha0, alpha1};
+    if (alpha0 > alpha1) {
+        for (int i = 2; i < 8; ++i) {
+            palette[i] = uint8_t(((8 - i) * alpha0 + (i - 1) * alpha1) / 7);
+        }
+    } else {
+        for (int i = 2; i < 6; ++i) {
+            palette[i] = uint8_t(((6 - i) * alpha0 + (i - 1) * alpha1) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    return palette;
+}
+
+// Always the eight-value mode between the block's extremes
+void encodeAlphaBlock(const uint8_t* block, uint8_t* output) {
+    uint8_t alpha0 = 0;
+    uint8_t alpha1 = 255;
+    for (uint32_t i = 0; i < 16; ++i) {
+        alpha0 = std::max(alpha0, block[i * 4 + 3]);
+        alpha1 = std::min(alpha1, block[i * 4 + 3]);
+    }
+    uint64_t indices = 0;
+    if (alpha0 > alpha1) {
+        auto palette = alphaPalette(alpha0, alpha1);
+        for (uint32_t i = 0; i < 16; ++i) {
+            uint64_t best = 0;
+            int bestError = 256;
+            for (uint32_t p = 0; p < 8; ++p) {
+                int distance = std::abs(int(block[i * 4 + 3]) - int(palette[p]));
+                if (distance < bestError) {
+                    best = p;
+                    bestError = distance;
+                }
+            }
+            indices |= best << (3 * i);
+        }
+    }
+    output[0] = alpha0;
+    output[1] = alpha1;
+    for (int i = 0; i < 6; ++i) {
+        output[2 + i] = uint8_t(indices >> (8 * i));
+    }
+}
+
+size_t blockBytes(PixelFormat format) {
+    return format == PixelFormat::BC1 ? 8 : 16;
+}
+
+} // namespace
+
+TextureSimd detectTextureSimd() {
+#if defined(AINCRAD_TEXTURE_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if (osSavesAvx && (info[1] & (1 << 5))) {
+            return TextureSimd::AVX2;
+        }
+    }
+    return TextureSimd::SSE2;
+#else
+    return __builtin_cpu_supports("avx2") ? TextureSimd::AVX2 : TextureSimd::SSE2;
+#endif
+#else
+    return TextureSimd::Scalar;
+#endif
+}
+
+std::vector<TextureImage> generateMipChain(const TextureImage& image, bool srgb, TextureSimd simd) {
+    validateImage(image);
+    simd = std::min(simd, detectTextureSimd());
+
+    std::vector<TextureImage> chain{image};
+    std::vector<float> working = toWorking(image, srgb);
+    std::vector<float> next;
+    uint32_t width = image.width;
+    uint32_t height = image.height;
+    while (width > 1 || height > 1) {
+        uint32_t nextWidth = std::max(1u, width / 2);
+        uint32_t nextHeight = std::max(1u, height / 2);
+        downsample(working, width, height, next, nextWidth, nextHeight, simd);
+        working.swap(next);
+        width = nextWidth;
+        height = nextHeight;
+        chain.push_back(fromWorking(working, width, height, srgb));
+    }
+    return chain;
+}
+
+size_t blockCompressedSize(PixelFormat format, uint32_t width, uint32_t height) {
+    if (format == PixelFormat::RGBA8) {
+        return size_t(width) * height * 4;
+    }
+    return size_t((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+std::vector<uint8_t> encodeBlocks(PixelFormat format, const TextureImage& image) {
+    validateImage(image);
+    if (format == PixelFormat::RGBA8) {
+        return image.pixels;
+    }
+
+    std::vector<uint8_t> output(blockCompressedSize(format, image.width, image.height));
+    uint8_t* block = output.data();
+    uint8_t pixels[16 * 4];
+    for (uint32_t by = 0; by < image.height; by += 4) {
+        for (uint32_t bx = 0; bx < image.width; bx += 4) {
+            for (uint32_t i = 0; i < 16; ++i) {
+                uint32_t x = std::min(bx + i % 4, image.width - 1);
+                uint32_t y = std::min(by + i / 4, image.height - 1);
+                std::memcpy(pixels + i * 4, image.pixels.data() + (size_t(y) * image.width + x) * 4, 4);
+            }
+            if (format == PixelFormat::BC3) {
+                encodeAlphaBlock(pixels, block);
+                block += 8;
+            }
+            encodeColorBlock(pixels, block);
+            block += 8;
+        }
+    }
+    return output;
+}
+
+TextureImage decodeBlocks(PixelFormat format, const uint8_t* data, size_t size, uint32_t width, uint32_t height) {
+    if (size != blockCompressedSize(format, width, height)) {
+        throw std::runtime_error("Texture data does not match its size");
+    }
+    TextureImage image;
+    image.width = width;
+    image.height = height;
+    if (format == PixelFormat::RGBA8) {
+        image.pixels.assign(data, data + size);
+        return image;
+    }
+
+    image.pixels.resize(size_t(width) * height * 4);
+    const uint8_t* block = data;
+    for (uint32_t by = 0; by < height; by += 4) {
+        for (uint32_t bx = 0; bx < width; bx += 4) {
+            std::array<uint8_t, 16> alpha;
+            alpha.fill(255);
+            if (format == PixelFormat::BC3) {
+                auto palette = alphaPalette(block[0], block[1]);
+                uint64_t indices = 0;
+                for (int i = 0; i < 6; ++i) {
+                    indices |= uint64_t(block[2 + i]) << (8 * i);
+                }
+                for (uint32_t i = 0; i < 16; ++i) {
+                    alpha[i] = palette[(indices >> (3 * i)) & 7];
+                }
+                block += 8;
+            }
+
+            uint16_t color0, color1;
+            uint32_t indices;
+            std::memcpy(&color0, block, 2);
+            std::memcpy(&color1, block + 2, 2);
+            std::memcpy(&indices, block + 4, 4);
+            block += 8;
+            auto palette = colorPalette(color0, color1);
+            // BC1's three-color mode: the midpoint, then transparent black
+            bool threeColor = format == PixelFormat::BC1 && color0 <= color1;
+            if (threeColor) {
+                for (size_t c = 0; c < 3; ++c) {
+                    palette[2][c] = uint8_t((palette[0][c] + palette[1][c]) / 2);
+                    palette[3][c] = 0;
+                }
+            }
+
+            for (uint32_t i = 0; i < 16; ++i) {
+                uint32_t x = bx + i % 4;
+                uint32_t y = by + i / 4;
+                if (x >= width || y >= height) {
+                    continue;
+                }
+                uint32_t index = (indices >> (2 * i)) & 3;
+                uint8_t* pixel = image.pixels.data() + (size_t(y) * width + x) * 4;
+                std::memcpy(pixel, palette[index].data(), 3);
+                pixel[3] = threeColor && index == 3 ? 0 : alpha[i];
+            }
+        }
+    }
+    return image;
+}
+
+std::vector<uint8_t> buildTexture(const TextureImage& image, const TextureBuildOptions& options) {
+    validateImage(image);
+    std::vector<TextureImage> chain = options.generateMips ? generateMipChain(image, options.srgb)
+                                                           : std::vector<TextureImage>{image};
+
+    PixelFormat format = PixelFormat::RGBA8;
+    if (options.blockCompress) {
+        bool opaque = true;
+        for (size_t i = 3; i < image.pixels.size() && opaque; i += 4) {
+            opaque = image.pixels[i] == 255;
+        }
+        format = opaque ? PixelFormat::BC1 : PixelFormat::BC3;
+    }
+
+    size_t offset = sizeof(Header) + chain.size() * sizeof(MipEntry);
+    std::vector<MipEntry> mips;
+    for (const auto& level : chain) {
+        offset = (offset + MipAlignment - 1) / MipAlignment * MipAlignment;
+        size_t size = blockCompressedSize(format, level.width, level.height);
+        mips.push_back({offset, size, level.width, level.height});
+        offset += size;
+    }
+
+    std::vector<uint8_t> payload(offset);
+    Header header{Magic, Version, image.width, image.height, uint32_t(chain.size()), format,
+                  options.srgb ? uint32_t(SRGB) : 0u, 0};
+    std::memcpy(payload.data(), &header, sizeof(header));
+    std::memcpy(payload.data() + sizeof(header), mips.data(), mips.size() * sizeof(MipEntry));
+    for (size_t level = 0; level < chain.size(); ++level) {
+        std::vector<uint8_t> data = encodeBlocks(format, chain[level]);
+        std::memcpy(payload.data() + mips[level].offset, data.data(), data.size());
+    }
+    return payload;
+}
+
+std::vector<uint8_t> dropTopMips(const uint8_t* data, size_t size, uint32_t dropped) {
+    TextureView view(data, size);
+    dropped = std::min(dropped, view.mipCount() - 1);
+
+    std::vector<MipEntry> mips;
+    size_t offset = sizeof(Header) + size_t(view.mipCount() - dropped) * sizeof(MipEntry);
+    for (uint32_t level = dropped; level < view.mipCount(); ++level) {
+        TextureView::Mip mip = view.mip(level);
+        offset = (offset + MipAlignment - 1) / MipAlignment * MipAlignment;
+        mips.push_back({offset, mip.size, mip.width, mip.height});
+        offset += mip.size;
+    }
+
+    std::vector<uint8_t> payload(offset);
+    Header header{Magic, Version, mips[0].width, mips[0].height, uint32_t(mips.size()), view.format(),
+                  view.srgb() ? uint32_t(SRGB) : 0u, 0};
+    std::memcpy(payload.data(), &header, sizeof(header));
+    std::memcpy(payload.data() + sizeof(header), mips.data(), mips.size() * sizeof(MipEntry));
+    for (size_t i = 0; i < mips.size(); ++i) {
+        TextureView::Mip mip = view.mip(dropped + uint32_t(i));
+        std::memcpy(payload.data() + mips[i].offset, mip.data, mip.size);
+    }
+    return payload;
+}
+
+bool TextureView::isTexture(const uint8_t* data, size_t size) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == Magic;
+}
+
+TextureView::TextureView(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_header(reinterpret_cast<const Header*>(data))
+    , m_mips(reinterpret_cast<const MipEntry*>(data + sizeof(Header)))
+{
+    if (!isTexture(data, size)) {
+        throw std::runtime_error("Not a texture payload");
+    }
+    if (m_header->version != Version) {
+        throw std::runtime_error("Unsupported texture version " + std::to_string(m_header->version));
+    }
+    if (m_header->format > PixelFormat::BC3 || m_header->mipCount == 0 || m_header->mipCount > MaxMipCount ||
+        sizeof(Header) + size_t(m_header->mipCount) * sizeof(MipEntry) > size) {
+        throw std::runtime_error("Malformed texture header");
+    }
+
+    uint32_t width = m_header->width;
+    uint32_t height = m_header->height;
+    for (uint32_t level = 0; level < m_header->mipCount; ++level) {
+        const MipEntry& mip = m_mips[level];
+        if (mip.width != width || mip.height != height || mip.offset > size || mip.size > size - mip.offset ||
+            mip.size != blockCompressedSize(m_header->format, width, height)) {
+            throw std::runtime_error("Malformed texture mip " + std::to_string(level));
+        }
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+    }
+}
+
+TextureView::Mip TextureView::mip(uint32_t level) const {
+    if (level >= m_header->mipCount) {
+        throw std::runtime_error("Texture has no mip " + std::to_string(level));
+    }
+    const MipEntry& mip = m_mips[level];
+    return {mip.width, mip.height, m_data + mip.offset, size_t(mip.size)};
+}
+
+size_t TextureView::residentSize(uint32_t dropped) const {
+    size_t size = 0;
+    for (uint32_t level = std::min(dropped, m_header->mipCount - 1); level < m_header->mipCount; ++level) {
+        size += m_mips[level].size;
+    }
+    return size;
+}
+
+} // namespace World
+} // namespace Aincrad
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aincrad {
+namespace World {
+
+// On-disk layout of an imported texture payload (little-endian):
+//   Header | MipEntry[mipCount] | mip data
+// Mips run from full size down to 1x1. Block-compressed mips are stored as
+// rows of 4x4 blocks, padded out to whole blocks, so they upload to the GPU
+// as they are. All offsets are from the start of the payload.
+namespace TextureFormat {
+
+constexpr uint32_t Magic = 0x58544941; // "AITX"
+constexpr uint32_t Version = 1;
+constexpr uint32_t MaxMipCount = 32;
+
+enum class PixelFormat : uint32_t {
+    RGBA8, // 4 bytes per pixel
+    BC1,   // 8 bytes per 4x4 block; opaque color
+    BC3    // 16 bytes per 4x4 block; color plus interpolated alpha
+};
+
+enum Flags : uint32_t {
+    SRGB = 1 // Color channels are sRGB encoded
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    PixelFormat format;
+    uint32_t flags;
+    uint32_t reserved; // Zero
+};
+
+struct MipEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+} // namespace TextureFormat
+
+// Uncompressed RGBA8 pixels, rows top to bottom, alpha not premultiplied
+struct TextureImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Instruction sets the mip filter can use. The best one the CPU supports is
+// picked at run time; every level produces the same bits.
+enum class TextureSimd {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+TextureSimd detectTextureSimd();
+
+// Builds the full mip chain down to 1x1, starting with a copy of the image.
+// Each level is a 2x2 box filter of the one above, averaged in linear light
+// when srgb is set and weighted by alpha, so dark fringes do not bleed in
+// around cutouts. Odd sizes round down. Throws std::runtime_error on an
+// empty image or one whose pixel count does not match its size.
+std::vector<TextureImage> generateMipChain(const TextureImage& image, bool srgb,
+                                           TextureSimd simd = detectTextureSimd());
+
+// Block compression. Sizes need not be multiples of 4; edge blocks repeat
+// the last row and column. BC1 ignores alpha; BC3 keeps it.
+size_t blockCompressedSize(TextureFormat::PixelFormat format, uint32_t width, uint32_t height);
+std::vector<uint8_t> encodeBlocks(TextureFormat::PixelFormat format, const TextureImage& image);
+// Software decode, for tools and GPUs without BC support
+TextureImage decodeBlocks(TextureFormat::PixelFormat format, const uint8_t* data, size_t size,
+                          uint32_t width, uint32_t height);
+
+struct TextureBuildOptions {
+    bool srgb = true;          // Off for normal maps and other data textures
+    bool generateMips = true;
+    bool blockCompress = true; // BC1 when fully opaque, BC3 otherwise; raw RGBA8 when off
+};
+
+// Produces a complete texture payload in the format above
+std::vector<uint8_t> buildTexture(const TextureImage& image, const TextureBuildOptions& options);
+
+// Copy of a texture payload without its top dropped mips, so the next one
+// down becomes the base level; the smallest mip always stays. Throws
+// std::runtime_error on a malformed payload.
+std::vector<uint8_t> dropTopMips(const uint8_t* data, size_t size, uint32_t dropped);
+
+// Zero-copy view of a texture payload
+class TextureView {
+public:
+    struct Mip {
+        uint32_t width;
+        uint32_t height;
+        const uint8_t* data;
+        size_t size;
+    };
+
+    // Validates the header and mip bounds. Throws std::runtime_error on a
+    // malformed payload.
+    TextureView(const uint8_t* data, size_t size);
+
+    static bool isTexture(const uint8_t* data, size_t size);
+
+    uint32_t width() const { return m_header->width; }
+    uint32_t height() const { return m_header->height; }
+    uint32_t mipCount() const { return m_header->mipCount; }
+    TextureFormat::PixelFormat format() const { return m_header->format; }
+    bool srgb() const { return (m_header->flags & TextureFormat::SRGB) != 0; }
+    Mip mip(uint32_t level) const;
+
+    // Bytes of mip data left with the top dropped mips released; what a
+    // quality handler reports for a texture stepped down that many levels
+    size_t residentSize(uint32_t dropped) const;
+
+private:
+    const uint8_t* m_data;
+    const TextureFormat::Header* m_header;
+    const TextureFormat::MipEntry* m_mips;
+};
+
+} // namespace World
+} // namespace Aincrad
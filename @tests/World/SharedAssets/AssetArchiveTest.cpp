@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "World/SharedAssets/Asset.h"
+#include "World/SharedAssets/AssetArchive.h"
+
+using namespace Aincrad::World;
+
+class AssetArchiveTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        AssetArchiveWriter writer;
+        for (int i = 0; i < kEntryCount; ++i) {
+            writer.addData(entryName(i), entryData(i));
+        }
+        writer.addData("empty", {});
+        writer.write(m_path);
+    }
+
+    void TearDown() override {
+        AssetArchive::releaseShared();
+        std::remove(m_path.c_str());
+    }
+
+    static std::string entryName(int i) {
+        return "floor1/prop_" + std::to_string(i) + ".mesh";
+    }
+
+    static std::vector<uint8_t> entryData(int i) {
+        std::vector<uint8_t> data(size_t(i) * 997 + 1);
+        for (size_t j = 0; j < data.size(); ++j) {
+            data[j] = uint8_t(i * 31 + j);
+        }
+        return data;
+    }
+
+    static AssetMetadata archivedAsset(const std::string& path, const std::string& entry) {
+        AssetMetadata metadata;
+        metadata.assetId = entry;
+        metadata.assetType = "model";
+        metadata.sourcePath = path;
+        metadata.archiveEntry = entry;
+        return metadata;
+    }
+
+    static constexpr int kEntryCount = 50;
+    const std::string m_path = "asset_archive_test.aipk";
+};
+
+TEST_F(AssetArchiveTest, Crc32MatchesReference) {
+    const std::string check = "123456789";
+    EXPECT_EQ(ArchiveFormat::crc32(reinterpret_cast<const uint8_t*>(check.data()), check.size()), 0xCBF43926u);
+}
+
+TEST_F(AssetArchiveTest, FindsAlignedVerifiedEntries) {
+    AssetArchive archive;
+    archive.open(m_path);
+    ASSERT_EQ(archive.size(), size_t(kEntryCount + 1));
+
+    for (int i = 0; i < kEntryCount; ++i) {
+        auto entry = archive.find(entryName(i));
+        ASSERT_TRUE(entry.has_value()) << entryName(i);
+        EXPECT_EQ(entry->name, entryName(i));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(entry->data) % ArchiveFormat::DefaultAlignment, 0u);
+        EXPECT_TRUE(entry->verify());
+        EXPECT_EQ(std::vector<uint8_t>(entry->data, entry->data + entry->size), entryData(i));
+    }
+
+    auto empty = archive.find("empty");
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_EQ(empty->size, 0u);
+    EXPECT_FALSE(archive.find("floor1/missing.mesh").has_value());
+}
+
+TEST_F(AssetArchiveTest, RejectsDuplicatesAndMalformedFiles) {
+    AssetArchiveWriter writer;
+    writer.addData("same", {1});
+    writer.addData("same", {2});
+    EXPECT_THROW(writer.write("asset_archive_duplicate.aipk"), std::runtime_error);
+    std::remove("asset_archive_duplicate.aipk");
+
+    {
+        std::ofstream file("asset_archive_bad.aipk", std::ios::binary);
+        file << "not an archive at all, just some text";
+    }
+    AssetArchive archive;
+    EXPECT_THROW(archive.open("asset_archive_bad.aipk"), std::runtime_error);
+    std::remove("asset_archive_bad.aipk");
+}
+
+TEST_F(AssetArchiveTest, AssetLoadsFromArchive) {
+    AssetLoadingConfig config{};
+    config.strategy = AssetLoadingConfig::LoadingStrategy::Immediate;
+
+    auto asset = std::make_shared<Asset>(archivedAsset(m_path, entryName(7)));
+    asset->load(config).get();
+    EXPECT_EQ(*asset->getPayload(), entryData(7));
+
+    auto missing = std::make_shared<Asset>(archivedAsset(m_path, "floor1/missing.mesh"));
+    EXPECT_THROW(missing->load(config).get(), std::runtime_error);
+}
+
+TEST_F(AssetArchiveTest, DetectsCorruptedPayload) {
+    // Flip one payload byte of an entry, located through the table of contents
+    std::fstream file(m_path, std::ios::binary | std::ios::in | std::ios::out);
+    ArchiveFormat::Header header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    ArchiveFormat::TocEntry toc;
+    file.seekg(std::streamoff(header.tocOffset + sizeof(toc))); // Entry 0 is "empty"
+    file.read(reinterpret_cast<char*>(&toc), sizeof(toc));
+    ASSERT_GT(toc.size, 0u);
+    file.seekp(std::streamoff(toc.offset));
+    file.put(char(0xFF));
+    file.close();
+
+    AssetArchive archive;
+    archive.open(m_path);
+    EXPECT_FALSE(archive.entry(1).verify());
+
+    AssetLoadingConfig config{};
+    config.strategy = AssetLoadingConfig::LoadingStrategy::Immediate;
+    auto asset = std::make_shared<Asset>(archivedAsset(m_path, std::string(archive.entry(1).name)));
+    EXPECT_THROW(asset->load(config).get(), std::runtime_error);
+}
+
+TEST_F(AssetArchiveTest, StoresIdenticalPayloadsOnce) {
+    const std::string path = "asset_archive_dedup.aipk";
+    std::vector<uint8_t> shared(10000, 0x5A);
+    AssetArchiveWriter writer;
+    writer.addData("windows/grass.tex", shared);
+    writer.addData("linux/grass.tex", shared);
+    writer.addData("linux/rock.tex", entryData(3));
+    writer.write(path);
+
+    AssetArchive archive;
+    archive.open(path);
+    auto windows = archive.find("windows/grass.tex");
+    auto linuxEntry = archive.find("linux/grass.tex");
+    ASSERT_TRUE(windows.has_value());
+    ASSERT_TRUE(linuxEntry.has_value());
+    EXPECT_EQ(windows->data, linuxEntry->data);
+    EXPECT_TRUE(linuxEntry->verify());
+    EXPECT_EQ(std::vector<uint8_t>(windows->data, windows->data + windows->size), shared);
+    EXPECT_EQ(archive.find("linux/rock.tex")->size, entryData(3).size());
+
+    // Header page, three pages of shared bytes and the rock; a second copy
+    // of the shared bytes would need three more pages
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    EXPECT_LT(uint64_t(file.tellg()), 5 * uint64_t(ArchiveFormat::DefaultAlignment));
+    file.close();
+    std::remove(path.c_str());
+}
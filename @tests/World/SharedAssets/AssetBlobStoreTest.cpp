@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "World/SharedAssets/AssetBlobStore.h"
+#include "World/SharedAssets/ContentHash.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+ContentHash hashOf(const std::string& text) {
+    return Sha256::hash(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+AssetBlobStore::Payload payloadOf(const std::string& text) {
+    return std::make_shared<const std::vector<uint8_t>>(text.begin(), text.end());
+}
+
+} // namespace
+
+TEST(AssetBlobStoreTest, Sha256MatchesReference) {
+    EXPECT_EQ(hashOf("").toHex(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(hashOf("abc").toHex(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(hashOf("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq").toHex(),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // Fed in uneven pieces across block boundaries
+    std::string million(1000000, 'a');
+    Sha256 sha;
+    for (size_t offset = 0; offset < million.size(); offset += 4093) {
+        size_t size = std::min<size_t>(4093, million.size() - offset);
+        sha.update(reinterpret_cast<const uint8_t*>(million.data()) + offset, size);
+    }
+    EXPECT_EQ(sha.finish().toHex(), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+TEST(AssetBlobStoreTest, HexRoundTrips) {
+    ContentHash hash = hashOf("floor1/terrain.tex");
+    auto parsed = ContentHash::fromHex(hash.toHex());
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(*parsed, hash);
+
+    std::string upper = hash.toHex();
+    for (auto& c : upper) {
+        c = char(toupper(c));
+    }
+    EXPECT_EQ(ContentHash::fromHex(upper), hash);
+    EXPECT_FALSE(ContentHash::fromHex("abc").has_value());
+    EXPECT_FALSE(ContentHash::fromHex(std::string(64, 'g')).has_value());
+}
+
+TEST(AssetBlobStoreTest, SharesPayloadsWhileHeld) {
+    AssetBlobStore store;
+    ContentHash hash = hashOf("shared bytes");
+    EXPECT_EQ(store.acquire(hash), nullptr);
+
+    auto first = store.publish(hash, payloadOf("shared bytes"));
+    EXPECT_EQ(store.acquire(hash), first);
+
+    // A racing load of the same bytes gets the copy that is already resident
+    auto second = store.publish(hash, payloadOf("shared bytes"));
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(store.getStats().sharedLoads, 2u);
+    EXPECT_EQ(store.getStats().sharedBytes, 2 * std::string("shared bytes").size());
+
+    // Once every holder lets go the blob is gone, not cached
+    first.reset();
+    second.reset();
+    EXPECT_EQ(store.acquire(hash), nullptr);
+
+    // Released blobs are swept as the table grows
+    for (int i = 0; i < 1000; ++i) {
+        std::string text = "blob " + std::to_string(i);
+        store.publish(hashOf(text), payloadOf(text));
+    }
+    EXPECT_EQ(store.getStats().sharedLoads, 2u);
+}
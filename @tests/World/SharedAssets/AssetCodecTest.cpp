@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "World/SharedAssets/Asset.h"
+#include "World/SharedAssets/AssetCodec.h"
+#include "World/SharedAssets/AssetLoader.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+// Texture-like data: long runs, repeated rows and a little noise
+std::vector<uint8_t> compressibleData(size_t size) {
+    std::mt19937 random(7);
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (i % 4096) < 1024 ? uint8_t(i / 4096) : uint8_t((i % 61) * 3);
+        if (random() % 97 == 0) {
+            data[i] = uint8_t(random());
+        }
+    }
+    return data;
+}
+
+std::vector<uint8_t> randomData(size_t size) {
+    std::mt19937 random(11);
+    std::vector<uint8_t> data(size);
+    for (auto& byte : data) {
+        byte = uint8_t(random());
+    }
+    return data;
+}
+
+std::vector<uint8_t> roundTrip(const std::vector<uint8_t>& data, uint32_t blockSize) {
+    std::vector<uint8_t> compressed = compressAsset(data.data(), data.size(), blockSize);
+    EXPECT_TRUE(isCompressedAsset(compressed.data(), compressed.size()));
+    std::vector<uint8_t> output(compressedAssetRawSize(compressed.data(), compressed.size()));
+    decompressAsset(compressed.data(), compressed.size(), output.data(), output.size());
+    return output;
+}
+
+} // namespace
+
+TEST(AssetCodecTest, RoundTripsAcrossBlockBoundaries) {
+    for (size_t size : {size_t(0), size_t(1), size_t(11), size_t(12), size_t(4096), size_t(300000)}) {
+        std::vector<uint8_t> data = compressibleData(size);
+        EXPECT_EQ(roundTrip(data, 64 * 1024), data) << size;
+    }
+
+    // A single byte repeated exercises overlapping matches
+    std::vector<uint8_t> run(100000, 0xAB);
+    std::vector<uint8_t> compressed = compressAsset(run.data(), run.size());
+    EXPECT_LT(compressed.size(), run.size() / 50);
+    EXPECT_EQ(roundTrip(run, CompressedFormat::DefaultBlockSize), run);
+
+    std::vector<uint8_t> texture = compressibleData(1 << 20);
+    EXPECT_LT(compressAsset(texture.data(), texture.size()).size(), texture.size() / 2);
+}
+
+TEST(AssetCodecTest, StoresIncompressibleBlocksRaw) {
+    std::vector<uint8_t> data = randomData(200000);
+    std::vector<uint8_t> compressed = compressAsset(data.data(), data.size(), 64 * 1024);
+
+    size_t overhead = sizeof(CompressedFormat::Header) + 4 * sizeof(CompressedFormat::BlockEntry);
+    EXPECT_EQ(compressed.size(), data.size() + overhead);
+    EXPECT_EQ(roundTrip(data, 64 * 1024), data);
+
+    // Uncompressed payloads are not mistaken for compressed ones
+    EXPECT_FALSE(isCompressedAsset(data.data(), data.size()));
+}
+
+TEST(AssetCodecTest, RejectsCorruptPayloads) {
+    std::vector<uint8_t> data = compressibleData(150000);
+    std::vector<uint8_t> compressed = compressAsset(data.data(), data.size(), 64 * 1024);
+    std::vector<uint8_t> output(data.size());
+
+    std::vector<uint8_t> truncated(compressed.begin(), compressed.end() - 100);
+    EXPECT_THROW(decompressAsset(truncated.data(), truncated.size(), output.data(), output.size()),
+                 std::runtime_error);
+
+    std::vector<uint8_t> wrongSize(data.size() - 1);
+    EXPECT_THROW(decompressAsset(compressed.data(), compressed.size(), wrongSize.data(), wrongSize.size()),
+                 std::runtime_error);
+
+    // Garbage in a compressed block must fail cleanly rather than overrun
+    size_t blocksStart = sizeof(CompressedFormat::Header) + 3 * sizeof(CompressedFormat::BlockEntry);
+    std::mt19937 random(3);
+    for (int trial = 0; trial < 200; ++trial) {
+        std::vector<uint8_t> corrupt = compressed;
+        size_t at = blocksStart + random() % (corrupt.size() - blocksStart);
+        corrupt[at] ^= uint8_t(1 + random() % 255);
+        try {
+            decompressAsset(corrupt.data(), corrupt.size(), output.data(), output.size());
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+TEST(AssetCodecTest, RejectsHeadersClaimingMoreThanTheirBytes) {
+    using namespace CompressedFormat;
+    auto payload = [](const Header& header, const std::vector<BlockEntry>& blocks, size_t dataSize) {
+        std::vector<uint8_t> bytes(sizeof(Header) + blocks.size() * sizeof(BlockEntry) + dataSize);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        if (!blocks.empty()) {
+            std::memcpy(bytes.data() + sizeof(Header), blocks.data(), blocks.size() * sizeof(BlockEntry));
+        }
+        return bytes;
+    };
+
+    // A consistent header and table whose blocks all point at one byte
+    // would have a reader allocate 64 MiB for a file of under a hundred bytes
+    Header inflated{Magic, Version, MaxBlockSize, 4, uint64_t(4) * MaxBlockSize};
+    uint64_t dataStart = sizeof(Header) + 4 * sizeof(BlockEntry);
+    std::vector<BlockEntry> shared(4, BlockEntry{dataStart, 1, MaxBlockSize});
+    std::vector<uint8_t> bytes = payload(inflated, shared, 1);
+    EXPECT_THROW(compressedAssetRawSize(bytes.data(), bytes.size()), std::runtime_error);
+    EXPECT_THROW(compressedBlockTable(bytes.data(), bytes.size()), std::runtime_error);
+
+    // Blocks past MaxBlockSize are rejected, as is an inflated size without
+    // the table to match it
+    Header oversized{Magic, Version, MaxBlockSize * 2, 1, uint64_t(MaxBlockSize) * 2};
+    bytes = payload(oversized, {BlockEntry{sizeof(Header) + sizeof(BlockEntry), MaxBlockSize, MaxBlockSize * 2}}, 0);
+    EXPECT_THROW(compressedAssetRawSize(bytes.data(), bytes.size()), std::runtime_error);
+    std::vector<uint8_t> data = compressibleData(1000);
+    std::vector<uint8_t> compressed = compressAsset(data.data(), data.size(), 256);
+    Header header;
+    std::memcpy(&header, compressed.data(), sizeof(header));
+    header.rawSize *= 1000;
+    std::memcpy(compressed.data(), &header, sizeof(header));
+    EXPECT_THROW(compressedAssetRawSize(compressed.data(), compressed.size()), std::runtime_error);
+
+    // Rounding the block count up must not wrap to an empty table
+    Header wrapping{Magic, Version, 64 * 1024, 0, UINT64_MAX - 10};
+    bytes = payload(wrapping, {}, 0);
+    EXPECT_THROW(compressedAssetRawSize(bytes.data(), bytes.size()), std::runtime_error);
+    EXPECT_THROW(compressedPrefixSize(bytes.data(), bytes.size(), 0), std::runtime_error);
+    std::vector<uint8_t> output(16);
+    EXPECT_THROW(decompressAssetPrefix(bytes.data(), bytes.size(), output.data(), output.size()), std::runtime_error);
+
+    EXPECT_THROW(compressAsset(data.data(), data.size(), MaxBlockSize + 1), std::invalid_argument);
+}
+
+TEST(AssetCodecTest, DecodesPrefixesFromTheFrontOfTheFile) {
+    std::vector<uint8_t> data = compressibleData(300000);
+    std::vector<uint8_t> compressed = compressAsset(data.data(), data.size(), 64 * 1024);
+
+    // The header and table alone say how far to read
+    size_t table = sizeof(CompressedFormat::Header) + 5 * sizeof(CompressedFormat::BlockEntry);
+    EXPECT_EQ(compressedPrefixSize(compressed.data(), table, 0), table);
+    for (size_t prefix : {size_t(1), size_t(64 * 1024), size_t(100000), size_t(300000)}) {
+        uint64_t needed = compressedPrefixSize(compressed.data(), table, prefix);
+        ASSERT_LE(needed, compressed.size());
+        std::vector<uint8_t> output(prefix);
+        decompressAssetPrefix(compressed.data(), size_t(needed), output.data(), output.size());
+        EXPECT_TRUE(std::equal(output.begin(), output.end(), data.begin())) << prefix;
+    }
+    EXPECT_LT(compressedPrefixSize(compressed.data(), table, 100000), compressed.size() / 2);
+    EXPECT_EQ(compressedPrefixSize(compressed.data(), table, 300000), compressed.size());
+
+    std::vector<uint8_t> output(100000);
+    uint64_t tooShort = compressedPrefixSize(compressed.data(), table, 100000) - 1;
+    EXPECT_THROW(decompressAssetPrefix(compressed.data(), size_t(tooShort), output.data(), output.size()),
+                 std::runtime_error);
+    EXPECT_THROW(compressedPrefixSize(compressed.data(), table, 300001), std::runtime_error);
+    EXPECT_THROW(compressedPrefixSize(compressed.data(), table - 1, 1), std::runtime_error);
+}
+
+TEST(AssetCodecTest, LoaderDecodesBlocksInParallel) {
+    AssetLoader loader(4);
+    std::atomic<size_t> calls{0};
+    std::vector<std::atomic<int>> seen(64);
+    loader.parallelFor(seen.size(), [&](size_t i) {
+        seen[i].fetch_add(1);
+        calls.fetch_add(1);
+    }, 0, AssetLoadingConfig::LoadingStrategy::Immediate);
+    EXPECT_EQ(calls.load(), seen.size());
+    for (const auto& count : seen) {
+        EXPECT_EQ(count.load(), 1);
+    }
+
+    EXPECT_THROW(loader.parallelFor(8, [](size_t i) {
+        if (i == 5) {
+            throw std::runtime_error("bad block");
+        }
+    }, 0, AssetLoadingConfig::LoadingStrategy::Immediate), std::runtime_error);
+
+    // A compressed payload on disk loads as its raw bytes from a worker
+    const std::string path = "asset_codec_test.bin";
+    std::vector<uint8_t> data = compressibleData(1 << 20);
+    std::vector<uint8_t> compressed = compressAsset(data.data(), data.size(), 64 * 1024);
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(compressed.data()),
+                                                std::streamsize(compressed.size()));
+
+    AssetMetadata metadata;
+    metadata.assetId = "floor1/terrain.tex";
+    metadata.assetType = "texture";
+    metadata.sourcePath = path;
+    AssetLoadingConfig config{};
+    config.asyncLoading = true;
+    config.strategy = AssetLoadingConfig::LoadingStrategy::Streaming;
+
+    auto asset = std::make_shared<Asset>(metadata);
+    asset->load(config, &loader).get();
+    EXPECT_EQ(*asset->getPayload(), data);
+    std::remove(path.c_str());
+}
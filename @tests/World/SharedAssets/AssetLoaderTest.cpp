@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "World/SharedAssets/AssetLoader.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+AssetLoadingConfig makeAsyncConfig(int priority, AssetLoadingConfig::LoadingStrategy strategy) {
+    AssetLoadingConfig config{};
+    config.asyncLoading = true;
+    config.streaming = true;
+    config.priority = priority;
+    config.strategy = strategy;
+    return config;
+}
+
+} // namespace
+
+TEST(AssetLoaderTest, RunsHigherPriorityFirst) {
+    AssetLoader loader(1);
+
+    // Hold the only worker so every task below is queued before any runs
+    std::promise<void> gate;
+    std::promise<void> started;
+    std::shared_future<void> gateFuture = gate.get_future().share();
+    loader.submit(0, AssetLoadingConfig::LoadingStrategy::Streaming, [gateFuture, &started]() {
+        started.set_value();
+        gateFuture.wait();
+    });
+    started.get_future().wait();
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    std::promise<void> done;
+    auto record = [&](int id) {
+        return [&, id]() {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(id);
+            if (order.size() == 4) {
+                done.set_value();
+            }
+        };
+    };
+
+    loader.submit(1, AssetLoadingConfig::LoadingStrategy::Background, record(1));
+    loader.submit(1, AssetLoadingConfig::LoadingStrategy::Streaming, record(2));
+    loader.submit(5, AssetLoadingConfig::LoadingStrategy::Streaming, record(3));
+    loader.submit(1, AssetLoadingConfig::LoadingStrategy::Streaming, record(4));
+    EXPECT_EQ(loader.getQueueDepth(), 4u);
+
+    gate.set_value();
+    done.get_future().wait();
+
+    EXPECT_EQ(order, (std::vector<int>{3, 2, 4, 1}));
+}
+
+TEST(AssetLoaderTest, AsyncLoadReadsPayload) {
+    const std::string path = "asset_loader_test_payload.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "headerPAYLOAD";
+    }
+
+    AssetMetadata metadata;
+    metadata.assetId = "payload_asset";
+    metadata.assetType = "texture";
+    metadata.sourcePath = path;
+    metadata.sourceOffset = 6;
+    metadata.sourceSize = 7;
+
+    AssetLoader loader(2);
+    auto asset = std::make_shared<Asset>(metadata);
+    auto config = makeAsyncConfig(1, AssetLoadingConfig::LoadingStrategy::Streaming);
+
+    auto first = asset->load(config, &loader);
+    auto second = asset->load(config, &loader);
+    first.get();
+
+    EXPECT_TRUE(asset->isLoaded());
+    EXPECT_TRUE(second.valid());
+    auto payload = asset->getPayload();
+    EXPECT_EQ(std::string(payload->begin(), payload->end()), "PAYLOAD");
+
+    asset->unload();
+    EXPECT_EQ(asset->getLoadState(), AssetLoadState::Unloaded);
+    std::remove(path.c_str());
+}
+
+TEST(AssetLoaderTest, MissingPayloadFails) {
+    AssetMetadata metadata;
+    metadata.assetId = "missing_asset";
+    metadata.assetType = "model";
+    metadata.sourcePath = "does/not/exist.bin";
+
+    AssetLoader loader(1);
+    auto asset = std::make_shared<Asset>(metadata);
+    auto future = asset->load(makeAsyncConfig(1, AssetLoadingConfig::LoadingStrategy::Background), &loader);
+
+    EXPECT_THROW(future.get(), std::runtime_error);
+    EXPECT_EQ(asset->getLoadState(), AssetLoadState::Failed);
+}
@@ -1,5 +1,16 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include "World/SharedAssets/AssetCodec.h"
 #include "World/SharedAssets/AssetManager.h"
+#include "World/SharedAssets/MeshFormat.h"
+#include "World/SharedAssets/TextureFormat.h"
 
 using namespace Aincrad::World;
 
@@ -13,6 +24,19 @@ protected:
         m_assetManager.reset();
     }
 
+    void addAsset(const std::string& assetId, const std::string& assetType,
+                  const std::vector<std::string>& dependencies) {
+        AssetMetadata metadata;
+        metadata.assetId = assetId;
+        metadata.assetType = assetType;
+        metadata.platforms = {"windows", "mac", "linux"};
+        metadata.dependencies = dependencies;
+        metadata.version = "1.0.0";
+        metadata.permissions = "public";
+        metadata.usage = "test";
+        m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+    }
+
     std::unique_ptr<AssetManager> m_assetManager;
 };
 
@@ -56,8 +80,10 @@ TEST_F(AssetManagerTest, UnloadAsset) {
     ASSERT_NE(asset, nullptr);
     EXPECT_TRUE(asset->isLoaded());
 
-    // Unload asset
+    // Unload asset; it is released at the next frame boundary
     m_assetManager->unloadAsset("test_asset");
+    EXPECT_TRUE(asset->isLoaded());
+    m_assetManager->flushUnloads();
     EXPECT_FALSE(asset->isLoaded());
 }
 
@@ -158,6 +184,22 @@ TEST_F(AssetManagerTest, AssetDependencies) {
 
     // Validate asset dependencies
     EXPECT_TRUE(m_assetManager->m_assetDatabase->validateAsset("test_asset"));
+
+    // Dependents come from the reverse index, once per dependent
+    auto& database = *m_assetManager->m_assetDatabase;
+    AssetHandle dependency = database.getHandle("dependency_asset");
+    metadata.assetId = "second_asset";
+    metadata.dependencies = {"dependency_asset", "dependency_asset"};
+    database.addAssetMetadata(metadata);
+    auto dependents = database.getDependents(dependency);
+    std::sort(dependents.begin(), dependents.end(), [](AssetHandle a, AssetHandle b) { return a.index < b.index; });
+    EXPECT_EQ(dependents,
+              (std::vector<AssetHandle>{database.getHandle("test_asset"), database.getHandle("second_asset")}));
+
+    database.removeAssetMetadata("test_asset");
+    EXPECT_EQ(database.getDependents(dependency), std::vector<AssetHandle>{database.getHandle("second_asset")});
+    database.removeAssetMetadata("second_asset");
+    EXPECT_TRUE(database.getDependents(dependency).empty());
 }
 
 TEST_F(AssetManagerTest, InvalidDependencies) {
@@ -176,4 +218,630 @@ TEST_F(AssetManagerTest, InvalidDependencies) {
 
     // Validate asset dependencies
     EXPECT_FALSE(m_assetManager->m_assetDatabase->validateAsset("test_asset"));
-} 
\ No newline at end of file
+} 
+
+TEST_F(AssetManagerTest, DependencyCycle) {
+    addAsset("material_a", "material", {"material_b"});
+    addAsset("material_b", "material", {"material_a"});
+
+    EXPECT_FALSE(m_assetManager->m_assetDatabase->validateAsset("material_a"));
+    EXPECT_THROW(m_assetManager->m_assetDatabase->buildDependencyGraph("material_a"), std::runtime_error);
+    EXPECT_THROW(m_assetManager->loadAssetGraph("material_a"), std::runtime_error);
+}
+
+TEST_F(AssetManagerTest, DependencyGraphWaves) {
+    // prefab -> (material_a, material_b) -> shared texture
+    addAsset("texture", "texture", {});
+    addAsset("material_a", "material", {"texture"});
+    addAsset("material_b", "material", {"texture"});
+    addAsset("prefab", "prefab", {"material_a", "material_b"});
+
+    auto& database = *m_assetManager->m_assetDatabase;
+    auto graph = database.buildDependencyGraph("prefab");
+    ASSERT_EQ(graph.waves.size(), 3u);
+    ASSERT_EQ(graph.waves[0].size(), 1u);
+    EXPECT_EQ(database.getAssetId(graph.waves[0][0]), "texture");
+    EXPECT_EQ(graph.waves[1].size(), 2u);
+    ASSERT_EQ(graph.waves[2].size(), 1u);
+    EXPECT_EQ(database.getAssetId(graph.waves[2][0]), "prefab");
+    EXPECT_EQ(graph.order.size(), 4u);
+    EXPECT_EQ(graph.order.back(), database.getHandle("prefab"));
+}
+
+TEST_F(AssetManagerTest, LoadAssetGraph) {
+    addAsset("texture", "texture", {});
+    addAsset("material_a", "material", {"texture"});
+    addAsset("material_b", "material", {"texture"});
+    addAsset("prefab", "prefab", {"material_a", "material_b"});
+
+    auto handle = m_assetManager->loadAssetGraph("prefab");
+    handle.ready.get();
+
+    ASSERT_NE(handle.asset, nullptr);
+    EXPECT_TRUE(handle.asset->isLoaded());
+    EXPECT_EQ(handle.assets.size(), 4u);
+    for (const auto& [id, asset] : handle.assets) {
+        EXPECT_TRUE(asset->isLoaded()) << asset->getMetadata().assetId;
+    }
+
+    // Shared dependencies resolve to the same asset instance
+    AssetHandle texture = m_assetManager->resolveHandle("texture");
+    EXPECT_EQ(m_assetManager->loadAsset("texture"), handle.assets.at(texture));
+
+    auto path = handle.criticalPath();
+    ASSERT_EQ(path.assets.size(), 3u);
+    EXPECT_EQ(path.assets.front(), texture);
+    EXPECT_EQ(path.assets.back(), m_assetManager->resolveHandle("prefab"));
+}
+
+TEST_F(AssetManagerTest, ConcurrentLoadSharesInstances) {
+    for (int i = 0; i < 32; ++i) {
+        addAsset("asset_" + std::to_string(i), "texture", {});
+    }
+
+    // Every thread loads every asset; racing loaders must agree on one instance
+    std::vector<std::vector<std::shared_ptr<Asset>>> results(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 32; ++i) {
+                results[t].push_back(m_assetManager->loadAsset("asset_" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < 32; ++i) {
+        EXPECT_TRUE(results[0][i]->isLoaded());
+        for (size_t t = 1; t < results.size(); ++t) {
+            EXPECT_EQ(results[t][i], results[0][i]);
+        }
+    }
+    EXPECT_EQ(m_assetManager->m_loadedAssets.size(), 32u);
+}
+
+TEST_F(AssetManagerTest, HandlesSurviveReAdd) {
+    addAsset("texture", "texture", {});
+    addAsset("material", "material", {"texture"});
+
+    auto& database = *m_assetManager->m_assetDatabase;
+    AssetHandle texture = database.getHandle("texture");
+    ASSERT_TRUE(texture.isValid());
+    EXPECT_EQ(database.getDependencies(database.getHandle("material")), std::vector<AssetHandle>{texture});
+
+    // A removed dependency keeps its handle while something still references it
+    database.removeAssetMetadata("texture");
+    EXPECT_EQ(database.getAssetMetadata(texture), nullptr);
+    EXPECT_FALSE(database.validateAsset("material"));
+    addAsset("texture", "texture", {});
+    EXPECT_EQ(database.getHandle("texture"), texture);
+    EXPECT_TRUE(database.validateAsset("material"));
+
+    // Once nothing references it, the slot is recycled under a new generation
+    database.removeAssetMetadata("material");
+    database.removeAssetMetadata("texture");
+    addAsset("other", "audio", {});
+    AssetHandle other = database.getHandle("other");
+    EXPECT_EQ(other.index, texture.index);
+    EXPECT_NE(other.generation, texture.generation);
+    EXPECT_EQ(database.getAssetMetadata(texture), nullptr);
+}
+
+TEST_F(AssetManagerTest, RegistryKeysStayValidAcrossGrowthAndReuse) {
+    // IDs past the short-string buffer, enough of them to grow the slots
+    AssetHandleRegistry registry;
+    auto id = [](size_t i) { return "floor1/props/long_asset_identifier_" + std::to_string(i); };
+    std::vector<AssetHandle> handles;
+    for (size_t i = 0; i < 2000; ++i) {
+        handles.push_back(registry.intern(id(i)));
+    }
+    for (size_t i = 0; i < handles.size(); ++i) {
+        ASSERT_EQ(registry.find(id(i)), handles[i]) << i;
+    }
+
+    // A reused slot answers to its new ID only
+    registry.release(handles[7]);
+    EXPECT_FALSE(registry.find(id(7)).isValid());
+    AssetHandle reused = registry.intern(std::string_view("floor2/reused_long_asset_identifier"));
+    EXPECT_EQ(reused.index, handles[7].index);
+    EXPECT_EQ(registry.find("floor2/reused_long_asset_identifier"), reused);
+    EXPECT_EQ(registry.getAssetId(reused), "floor2/reused_long_asset_identifier");
+    EXPECT_EQ(registry.find(id(1999)), handles[1999]);
+    EXPECT_EQ(registry.size(), 2000u);
+}
+
+TEST_F(AssetManagerTest, EvictionSkipsAssetsHeldOutsideTheCache) {
+    const std::string payloadPath = "asset_manager_eviction_payload.bin";
+    {
+        std::ofstream payload(payloadPath, std::ios::binary);
+        payload << std::string(600, 'x');
+    }
+    for (const char* assetId : {"held", "idle"}) {
+        AssetMetadata metadata;
+        metadata.assetId = assetId;
+        metadata.assetType = "texture";
+        metadata.sourcePath = payloadPath;
+        m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+    }
+
+    MemoryConfig config;
+    config.maxMemoryUsage = 1000;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::PoolAllocation;
+    m_assetManager->m_memoryManager->configure(config);
+
+    auto held = m_assetManager->loadAsset("held");
+    m_assetManager->loadAsset("idle");
+    EXPECT_EQ(m_assetManager->m_memoryManager->getTotalAllocated(), 1200u);
+
+    m_assetManager->update();
+    EXPECT_TRUE(held->isLoaded());
+    EXPECT_EQ(m_assetManager->m_loadedAssets.find(m_assetManager->resolveHandle("held")), held);
+    EXPECT_EQ(m_assetManager->m_loadedAssets.find(m_assetManager->resolveHandle("idle")), nullptr);
+    EXPECT_EQ(m_assetManager->m_memoryManager->getTotalAllocated(), 600u);
+
+    std::remove(payloadPath.c_str());
+}
+
+TEST_F(AssetManagerTest, HotReloadSwapsChangedPayloadsAndDependents) {
+    if (!AssetWatcher::isSupported()) {
+        GTEST_SKIP() << "No file watcher on this platform";
+    }
+
+    const std::filesystem::path directory = "asset_manager_hot_reload";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto writePayload = [&](const std::string& name, const std::string& contents) {
+        std::ofstream payload(directory / name, std::ios::binary | std::ios::trunc);
+        payload << contents;
+    };
+    writePayload("base.bin", "old");
+    writePayload("material.bin", "material");
+
+    AssetMetadata base;
+    base.assetId = "base";
+    base.assetType = "texture";
+    base.sourcePath = (directory / "base.bin").string();
+    m_assetManager->m_assetDatabase->addAssetMetadata(base);
+    AssetMetadata material;
+    material.assetId = "material";
+    material.assetType = "material";
+    material.dependencies = {"base"};
+    material.sourcePath = (directory / "material.bin").string();
+    m_assetManager->m_assetDatabase->addAssetMetadata(material);
+
+    auto graph = m_assetManager->loadAssetGraph("material");
+    graph.ready.get();
+    auto baseAsset = m_assetManager->loadAsset("base");
+    auto oldPayload = baseAsset->getPayload();
+
+    std::mutex mutex;
+    std::condition_variable reloadedCondition;
+    std::vector<std::string> reloaded;
+    m_assetManager->enableHotReload({directory.string()},
+        [&](const std::shared_ptr<Asset>& asset, std::exception_ptr error) {
+            EXPECT_FALSE(error);
+            std::lock_guard<std::mutex> lock(mutex);
+            reloaded.push_back(asset->getMetadata().assetId);
+            reloadedCondition.notify_all();
+        });
+    writePayload("base.bin", "new payload");
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(reloadedCondition.wait_for(lock, std::chrono::seconds(5),
+                                               [&]() { return reloaded.size() >= 2; }));
+        EXPECT_EQ(reloaded, (std::vector<std::string>{"base", "material"}));
+    }
+    m_assetManager->disableHotReload();
+
+    // Same Asset, new payload; snapshots taken before the swap stay intact
+    auto newPayload = baseAsset->getPayload();
+    EXPECT_EQ(std::string(newPayload->begin(), newPayload->end()), "new payload");
+    EXPECT_EQ(baseAsset->getPayloadVersion(), 2u);
+    EXPECT_EQ(std::string(oldPayload->begin(), oldPayload->end()), "old");
+    EXPECT_EQ(m_assetManager->m_memoryManager->getAllocatedSize(baseAsset->getHandle()), 11u);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(AssetManagerTest, StatsReportLoadsAndCacheHits) {
+    const std::string payloadPath = "asset_manager_stats_payload.bin";
+    {
+        std::ofstream payload(payloadPath, std::ios::binary);
+        payload << std::string(256, 'x');
+    }
+    AssetMetadata metadata;
+    metadata.assetId = "stats_texture";
+    metadata.assetType = "texture";
+    metadata.sourcePath = payloadPath;
+    m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+    addAsset("stats_model", "model", {});
+
+    m_assetManager->loadAsset("stats_texture");
+    m_assetManager->loadAsset("stats_texture");
+    m_assetManager->loadAsset("stats_model");
+
+    auto stats = m_assetManager->stats();
+    EXPECT_EQ(stats.loads.loads, 2u);
+    EXPECT_EQ(stats.loads.failedLoads, 0u);
+    EXPECT_EQ(stats.loads.bytesRead, 256u);
+    EXPECT_EQ(stats.loads.cacheMisses, 2u);
+    EXPECT_EQ(stats.loads.cacheHits, 1u);
+    ASSERT_EQ(stats.loads.byType.size(), 2u);
+    EXPECT_EQ(stats.loads.byType[0].assetType, "texture");
+    EXPECT_EQ(stats.loads.byType[0].latency.count, 1u);
+    EXPECT_EQ(stats.memory.assetCount, 2u);
+    EXPECT_EQ(stats.memory.totalAllocated, 256u);
+    EXPECT_EQ(stats.loadQueueDepth, 0u);
+
+    std::remove(payloadPath.c_str());
+}
+
+TEST_F(AssetManagerTest, LoadAssetsReportsPerAssetResults) {
+    const std::string packPath = "asset_manager_batch_pack.bin";
+    {
+        std::ofstream pack(packPath, std::ios::binary);
+        pack << "aaaabbbbcccc";
+    }
+    auto addSlice = [&](const std::string& assetId, uint64_t offset, std::vector<std::string> dependencies) {
+        AssetMetadata metadata;
+        metadata.assetId = assetId;
+        metadata.assetType = "texture";
+        metadata.dependencies = std::move(dependencies);
+        metadata.sourcePath = packPath;
+        metadata.sourceOffset = offset;
+        metadata.sourceSize = 4;
+        m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+    };
+    addSlice("slice_c", 8, {"slice_a"});
+    addSlice("slice_b", 4, {"slice_a"});
+    addSlice("slice_a", 0, {});
+    addSlice("broken", 4, {"not_there"});
+    AssetMetadata truncated;
+    truncated.assetId = "truncated";
+    truncated.assetType = "texture";
+    truncated.sourcePath = packPath;
+    truncated.sourceOffset = 100;
+    m_assetManager->m_assetDatabase->addAssetMetadata(truncated);
+    addAsset("needs_truncated", "material", {"truncated"});
+
+    auto results = m_assetManager->loadAssets(
+        {"slice_c", "missing", "slice_b", "broken", "slice_c", "needs_truncated"});
+    ASSERT_EQ(results.size(), 6u);
+
+    EXPECT_TRUE(results[0].ok());
+    auto sliceC = results[0].asset->getPayload();
+    EXPECT_EQ(std::string(sliceC->begin(), sliceC->end()), "cccc");
+    EXPECT_FALSE(results[1].ok());
+    EXPECT_FALSE(results[1].handle.isValid());
+    EXPECT_TRUE(results[2].ok());
+    EXPECT_FALSE(results[3].ok());
+    EXPECT_NE(results[3].error.find("not_there"), std::string::npos);
+    EXPECT_EQ(results[4].asset, results[0].asset);
+    EXPECT_FALSE(results[5].ok());
+    EXPECT_NE(results[5].error.find("dependency truncated"), std::string::npos);
+
+    // Each asset in the combined closure was read once, slice_a included
+    auto stats = m_assetManager->stats();
+    EXPECT_EQ(stats.loads.loads, 5u);
+    EXPECT_EQ(stats.loads.failedLoads, 1u);
+    EXPECT_TRUE(m_assetManager->loadAsset("slice_a")->isLoaded());
+
+    std::remove(packPath.c_str());
+}
+
+TEST_F(AssetManagerTest, StreamedLoadsReadThroughTheStagingRing) {
+    const std::string packPath = "asset_manager_streamed_pack.bin";
+    std::vector<uint8_t> contents(300 * 1024);
+    for (size_t i = 0; i < contents.size(); ++i) {
+        contents[i] = uint8_t(i * 7 + (i >> 9));
+    }
+    {
+        std::ofstream pack(packPath, std::ios::binary);
+        pack.write(reinterpret_cast<const char*>(contents.data()), std::streamsize(contents.size()));
+    }
+    AssetMetadata metadata;
+    metadata.assetId = "streamed";
+    metadata.assetType = "texture";
+    metadata.sourcePath = packPath;
+    metadata.sourceOffset = 1000;
+    metadata.sourceSize = 200 * 1024;
+    m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+    metadata.assetId = "immediate";
+    m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+
+    auto reader = m_assetManager->getStreamingSystem().getReader();
+    ASSERT_NE(reader, nullptr);
+    auto streamed = m_assetManager->loadAssetAsync("streamed");
+    streamed.ready.get();
+    EXPECT_EQ(reader->getBytesRead(), metadata.sourceSize);
+    auto streamedPayload = streamed.asset->getPayload();
+    EXPECT_TRUE(std::equal(streamedPayload->begin(), streamedPayload->end(), contents.begin() + 1000));
+    EXPECT_EQ(streamedPayload->size(), metadata.sourceSize);
+
+    // Other strategies read the file directly
+    auto immediate = m_assetManager->loadAssetAsync("immediate", 1, AssetLoadingConfig::LoadingStrategy::Immediate);
+    immediate.ready.get();
+    EXPECT_EQ(reader->getBytesRead(), metadata.sourceSize);
+    EXPECT_EQ(*immediate.asset->getPayload(), *streamed.asset->getPayload());
+
+    std::remove(packPath.c_str());
+}
+
+TEST_F(AssetManagerTest, StreamingUpdateLoadsUncachedAssets) {
+    const std::string path = "asset_manager_streamed_in.bin";
+    std::vector<uint8_t> contents(100 * 1024);
+    for (size_t i = 0; i < contents.size(); ++i) {
+        contents[i] = uint8_t(i * 13);
+    }
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(contents.data()), std::streamsize(contents.size()));
+    }
+    AssetMetadata metadata;
+    metadata.assetId = "streamed_in";
+    metadata.assetType = "model";
+    metadata.sourcePath = path;
+    m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+    AssetHandle handle = m_assetManager->m_assetDatabase->getHandle("streamed_in");
+
+    // The load callback creates the asset inside the streaming update
+    StreamingSystem& streaming = m_assetManager->getStreamingSystem();
+    streaming.startStreaming(handle, {10.0f, 0.0f, 10.0f});
+    streaming.setObserver(0, {0.0f, 0.0f, 0.0f});
+    m_assetManager->update();
+    EXPECT_NE(streaming.getState(handle), StreamingState::Evicted);
+
+    for (int frame = 0; frame < 500 && streaming.getState(handle) != StreamingState::Resident; ++frame) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        m_assetManager->update();
+    }
+    ASSERT_EQ(streaming.getState(handle), StreamingState::Resident);
+    auto asset = m_assetManager->loadAsset("streamed_in");
+    EXPECT_EQ(*asset->getPayload(), contents);
+    EXPECT_EQ(streaming.getReader()->getBytesRead(), contents.size());
+
+    std::remove(path.c_str());
+}
+
+TEST_F(AssetManagerTest, StreamedMeshesLoadTheCoarsestLodFirst) {
+    MeshData grid;
+    for (uint32_t y = 0; y < 32; ++y) {
+        for (uint32_t x = 0; x < 32; ++x) {
+            for (auto [cx, cy] : {std::pair{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y}, {x + 1, y + 1}, {x, y + 1}}) {
+                float height = 4.0f * std::sin(cx * 0.1f) * std::cos(cy * 0.1f);
+                grid.indices.push_back(uint32_t(grid.vertices.size()));
+                grid.vertices.push_back({{float(cx), float(cy), height}, {0, 0, 1}, {cx / 32.0f, cy / 32.0f}});
+            }
+        }
+    }
+    MeshBuildOptions options;
+    options.maxLodCount = 4;
+    const auto full = buildMesh(grid, options);
+    const MeshView view(full.data(), full.size());
+    ASSERT_EQ(view.lodCount(), 4u);
+    const size_t coarse = view.residentSize(3);
+
+    auto reader = m_assetManager->getStreamingSystem().getReader();
+    ASSERT_NE(reader, nullptr);
+    AssetLoadingConfig config = m_assetManager->makeLoadingConfig(false, 1, AssetLoadingConfig::LoadingStrategy::Streaming);
+    for (bool compressed : {false, true}) {
+        const std::string path = "asset_manager_streamed_mesh.bin";
+        {
+            auto bytes = compressed ? compressAsset(full.data(), full.size(), 4096) : full;
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+        }
+        AssetMetadata metadata;
+        metadata.assetId = compressed ? "mesh_compressed" : "mesh";
+        metadata.assetType = "model";
+        metadata.sourcePath = path;
+
+        // The load settles on the prefix that holds the coarsest LOD
+        auto asset = std::make_shared<Asset>(metadata);
+        asset->setStreamingReader(reader);
+        asset->load(config).get();
+        EXPECT_TRUE(asset->isPartial());
+        EXPECT_EQ(asset->getQualityLevel(), 3u);
+        auto prefix = asset->getPayload();
+        ASSERT_EQ(prefix->size(), coarse);
+        EXPECT_TRUE(std::equal(prefix->begin(), prefix->end(), full.begin()));
+        EXPECT_EQ(MeshView(prefix->data(), coarse).firstResidentLod(), 3u);
+
+        // Refining swaps in the whole mesh, once
+        EXPECT_TRUE(asset->refinePayload());
+        EXPECT_FALSE(asset->isPartial());
+        EXPECT_EQ(asset->getQualityLevel(), 0u);
+        EXPECT_EQ(*asset->getPayload(), full);
+        EXPECT_FALSE(asset->refinePayload());
+
+        // Through the manager, refinement follows on its own and is charged
+        m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+        auto handle = m_assetManager->loadAssetAsync(metadata.assetId);
+        handle.ready.get();
+        auto& memory = m_assetManager->getMemoryManager();
+        for (int i = 0; i < 500 && memory.getAllocatedSize(handle.asset->getHandle()) != full.size(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        EXPECT_EQ(memory.getAllocatedSize(handle.asset->getHandle()), full.size());
+        EXPECT_FALSE(handle.asset->isPartial());
+        EXPECT_EQ(*handle.asset->getPayload(), full);
+        std::remove(path.c_str());
+    }
+}
+
+TEST_F(AssetManagerTest, UpdateTicksOnlyAssetsWithPendingWork) {
+    std::vector<std::shared_ptr<Asset>> assets;
+    for (int i = 0; i < 100; ++i) {
+        addAsset("resident_" + std::to_string(i), "model", {});
+        assets.push_back(m_assetManager->loadAsset("resident_" + std::to_string(i)));
+    }
+
+    int fadeTicks = 0;
+    int decodeTicks = 0;
+    assets[3]->addUpdateTask([&fadeTicks]() { return ++fadeTicks < 3; });
+    assets[7]->addUpdateTask([&decodeTicks]() { return ++decodeTicks < 1; });
+    assets[7]->addUpdateTask([&decodeTicks]() { return ++decodeTicks < 2; });
+    EXPECT_EQ(m_assetManager->stats().updatingAssets, 2u);
+
+    m_assetManager->update();
+    EXPECT_EQ(fadeTicks, 1);
+    EXPECT_EQ(decodeTicks, 2);
+    EXPECT_EQ(m_assetManager->stats().updatingAssets, 1u); // Both decode tasks finished
+
+    m_assetManager->update();
+    m_assetManager->update();
+    EXPECT_EQ(fadeTicks, 3);
+    EXPECT_EQ(decodeTicks, 2);
+    EXPECT_EQ(m_assetManager->stats().updatingAssets, 0u);
+
+    // Unloading drops pending work
+    assets[3]->addUpdateTask([&fadeTicks]() { return ++fadeTicks > 0; });
+    m_assetManager->unloadAsset("resident_3");
+    m_assetManager->flushUnloads();
+    m_assetManager->update();
+    EXPECT_EQ(fadeTicks, 3);
+    EXPECT_EQ(m_assetManager->stats().updatingAssets, 0u);
+}
+
+TEST_F(AssetManagerTest, IdenticalPayloadsShareOneCopy) {
+    const std::string windowsPath = "asset_manager_blob_windows.bin";
+    const std::string linuxPath = "asset_manager_blob_linux.bin";
+    const std::string contents = "identical texture bytes";
+    std::ofstream(windowsPath, std::ios::binary) << contents;
+    std::ofstream(linuxPath, std::ios::binary) << contents;
+    std::string hash = Sha256::hash(reinterpret_cast<const uint8_t*>(contents.data()), contents.size()).toHex();
+
+    auto addVariant = [&](const std::string& assetId, const std::string& platform,
+                          const std::string& path, const std::string& contentHash) {
+        AssetMetadata metadata;
+        metadata.assetId = assetId;
+        metadata.assetType = "texture";
+        metadata.platforms = {platform};
+        metadata.sourcePath = path;
+        metadata.contentHash = contentHash;
+        m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+    };
+    addVariant("floor1/grass_windows", "windows", windowsPath, hash);
+    addVariant("floor1/grass_linux", "linux", linuxPath, hash);
+    addVariant("floor1/grass_unhashed", "mac", linuxPath, "");
+    addVariant("floor1/grass_stale", "vr", linuxPath, std::string(64, '0'));
+
+    auto windowsVariant = m_assetManager->loadAsset("floor1/grass_windows");
+    auto linuxVariant = m_assetManager->loadAsset("floor1/grass_linux");
+    EXPECT_EQ(windowsVariant->getPayload(), linuxVariant->getPayload());
+    EXPECT_EQ(m_assetManager->stats().blobs.sharedLoads, 1u);
+    EXPECT_EQ(m_assetManager->stats().blobs.sharedBytes, contents.size());
+
+    // Without a matching hash the bytes are read into a private copy
+    auto unhashed = m_assetManager->loadAsset("floor1/grass_unhashed");
+    auto stale = m_assetManager->loadAsset("floor1/grass_stale");
+    EXPECT_NE(unhashed->getPayload(), windowsVariant->getPayload());
+    EXPECT_NE(stale->getPayload(), windowsVariant->getPayload());
+    auto stalePayload = stale->getPayload();
+    EXPECT_EQ(std::string(stalePayload->begin(), stalePayload->end()), contents);
+
+    // The shared copy outlives the asset that read it
+    auto shared = windowsVariant->getPayload();
+    m_assetManager->unloadAsset("floor1/grass_windows");
+    EXPECT_EQ(linuxVariant->getPayload(), shared);
+
+    std::remove(windowsPath.c_str());
+    std::remove(linuxPath.c_str());
+}
+
+TEST_F(AssetManagerTest, QualityStepsTrimTheResidentPayload) {
+    const std::string payloadPath = "asset_manager_quality_texture.bin";
+    TextureImage image;
+    image.width = 64;
+    image.height = 64;
+    image.pixels.assign(64 * 64 * 4, 200);
+    auto full = buildTexture(image, TextureBuildOptions());
+    std::ofstream(payloadPath, std::ios::binary).write(reinterpret_cast<const char*>(full.data()), full.size());
+
+    AssetMetadata metadata;
+    metadata.assetId = "floor1/stone";
+    metadata.assetType = "texture";
+    metadata.sourcePath = payloadPath;
+    m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+
+    MemoryConfig config;
+    config.maxMemoryUsage = 1024 * 1024 * 1024;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::QualityBased;
+    config.evictionLowWater = 0.5f;
+    config.categoryBudgets = {{"texture", full.size()}};
+    MemoryManager& memory = m_assetManager->getMemoryManager();
+    memory.configure(config);
+
+    // Over the texture budget, the built-in handler drops the top mip from
+    // the payload itself, and the budget charges what is really resident
+    auto texture = m_assetManager->loadAsset("floor1/stone");
+    m_assetManager->update();
+    ASSERT_EQ(texture->getQualityLevel(), 1u);
+    auto reducedPayload = texture->getPayload();
+    TextureView reduced(reducedPayload->data(), reducedPayload->size());
+    EXPECT_EQ(reduced.width(), 32u);
+    EXPECT_LT(reducedPayload->size() * 3, full.size());
+    EXPECT_EQ(memory.getAllocatedSize(texture->getHandle()), reducedPayload->size());
+
+    // With headroom again the full payload is read back in
+    config.categoryBudgets = {{"texture", 4 * full.size()}};
+    memory.configure(config);
+    m_assetManager->update();
+    EXPECT_EQ(texture->getQualityLevel(), 0u);
+    EXPECT_EQ(*texture->getPayload(), full);
+    EXPECT_EQ(memory.getAllocatedSize(texture->getHandle()), full.size());
+
+    std::remove(payloadPath.c_str());
+}
+
+TEST_F(AssetManagerTest, UnloadsRetireInBatchesAtTheFrameBoundary) {
+    const std::string payloadPath = "asset_manager_unload_payload.bin";
+    std::ofstream(payloadPath, std::ios::binary) << std::string(100, 'x');
+    std::vector<std::shared_ptr<Asset>> crowd;
+    for (int i = 0; i < 200; ++i) {
+        AssetMetadata metadata;
+        metadata.assetId = "npc_" + std::to_string(i);
+        metadata.assetType = "model";
+        metadata.sourcePath = payloadPath;
+        m_assetManager->m_assetDatabase->addAssetMetadata(metadata);
+        crowd.push_back(m_assetManager->loadAsset(metadata.assetId));
+    }
+    EXPECT_EQ(m_assetManager->m_memoryManager->getTotalAllocated(), 20000u);
+
+    // A mass despawn only detaches the assets; nothing is released yet
+    for (int i = 0; i < 200; ++i) {
+        m_assetManager->unloadAsset("npc_" + std::to_string(i));
+    }
+    EXPECT_EQ(m_assetManager->stats().pendingUnloads, 200u);
+    EXPECT_TRUE(crowd[0]->isLoaded());
+    EXPECT_EQ(m_assetManager->m_memoryManager->getTotalAllocated(), 20000u);
+
+    // A load after the unload starts fresh and keeps its budget
+    auto respawned = m_assetManager->loadAsset("npc_7");
+    EXPECT_NE(respawned, crowd[7]);
+
+    // With no budget one chunk of 64 retires per frame and the rest carry
+    // over; npc_7 is in it but its handle is charged to the new asset now
+    m_assetManager->setUnloadBudget(std::chrono::microseconds(0));
+    m_assetManager->update();
+    EXPECT_EQ(m_assetManager->m_memoryManager->getTotalAllocated(), 20000u - 63 * 100);
+    m_assetManager->setUnloadBudget(std::chrono::milliseconds(100));
+    m_assetManager->update();
+    EXPECT_EQ(m_assetManager->m_memoryManager->getTotalAllocated(), 100u);
+
+    // Payloads are released on a worker; flushing waits for them
+    m_assetManager->flushUnloads();
+    EXPECT_EQ(m_assetManager->stats().pendingUnloads, 0u);
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_FALSE(crowd[i]->isLoaded()) << i;
+    }
+    EXPECT_TRUE(respawned->isLoaded());
+    EXPECT_EQ(m_assetManager->m_memoryManager->getAllocatedSize(respawned->getHandle()), 100u);
+
+    std::remove(payloadPath.c_str());
+}
@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "World/SharedAssets/AssetDatabase.h"
+#include "World/SharedAssets/AssetMetadataIndex.h"
+
+using namespace Aincrad::World;
+
+class AssetMetadataIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        AssetMetadataIndexWriter writer;
+        for (int i = 0; i < kAssetCount; ++i) {
+            AssetMetadata metadata;
+            metadata.assetId = "asset_" + std::to_string(i);
+            metadata.assetType = i % 2 ? "texture" : "model";
+            metadata.platforms = i % 3 ? std::vector<std::string>{"windows", "linux"}
+                                       : std::vector<std::string>{"linux", "vr"};
+            if (i > 0) {
+                metadata.dependencies = {"asset_" + std::to_string(i - 1)};
+            }
+            metadata.version = "1.0." + std::to_string(i);
+            metadata.permissions = "public";
+            metadata.usage = "test";
+            metadata.sourcePath = "assets/pack.bin";
+            metadata.sourceOffset = uint64_t(i) * 4096;
+            metadata.sourceSize = 4096;
+            metadata.contentHash = i % 2 ? std::string(64, 'f') : "";
+            writer.add(metadata);
+        }
+        writer.write(m_path);
+    }
+
+    void TearDown() override {
+        std::remove(m_path.c_str());
+    }
+
+    static constexpr int kAssetCount = 1000;
+    const std::string m_path = "asset_metadata_index_test.bin";
+};
+
+TEST_F(AssetMetadataIndexTest, FindsEveryEntry) {
+    AssetMetadataIndex index;
+    index.open(m_path);
+    ASSERT_EQ(index.size(), size_t(kAssetCount));
+
+    for (int i = 0; i < kAssetCount; ++i) {
+        std::string id = "asset_" + std::to_string(i);
+        auto view = index.find(id);
+        ASSERT_TRUE(view.has_value()) << id;
+        EXPECT_EQ(view->assetId(), id);
+        EXPECT_EQ(view->assetType(), i % 2 ? "texture" : "model");
+        EXPECT_EQ(formatAssetVersion(view->version()), "1.0." + std::to_string(i));
+        EXPECT_EQ(view->sourceOffset(), uint64_t(i) * 4096);
+        EXPECT_EQ(view->contentHash(), i % 2 ? std::string(64, 'f') : "");
+        EXPECT_TRUE(view->supports(AssetPlatform::Linux));
+        EXPECT_EQ(view->supports(AssetPlatform::Windows), i % 3 != 0);
+        EXPECT_EQ(view->supports(AssetPlatform::VR), i % 3 == 0);
+        EXPECT_FALSE(view->supports(AssetPlatform::Mac));
+        ASSERT_EQ(view->dependencyCount(), i > 0 ? 1u : 0u);
+    }
+
+    EXPECT_FALSE(index.find("missing_asset").has_value());
+    EXPECT_FALSE(index.find("").has_value());
+
+    // Platform views were compiled in, in slot order
+    EXPECT_EQ(index.platformSlots(AssetPlatform::Linux).size(), size_t(kAssetCount));
+    EXPECT_EQ(index.platformSlots(AssetPlatform::Mac).size(), 0u);
+    auto vr = index.platformSlots(AssetPlatform::VR);
+    EXPECT_EQ(vr.size(), size_t((kAssetCount + 2) / 3));
+    EXPECT_TRUE(std::is_sorted(vr.begin(), vr.end()));
+    for (uint32_t slot : vr) {
+        EXPECT_TRUE(index.entry(slot).supports(AssetPlatform::VR));
+    }
+}
+
+TEST(AssetPlatformTest, PacksVersionsAndPlatforms) {
+    EXPECT_EQ(packAssetVersion(""), 0u);
+    EXPECT_LT(packAssetVersion("1.9.0"), packAssetVersion("1.10.0"));
+    EXPECT_LT(packAssetVersion("1.10.99"), packAssetVersion("2"));
+    EXPECT_EQ(formatAssetVersion(packAssetVersion("3.1")), "3.1.0");
+    EXPECT_EQ(formatAssetVersion(packAssetVersion("65535.65535.4294967295")), "65535.65535.4294967295");
+    EXPECT_EQ(formatAssetVersion(0), "");
+    for (const char* bad : {"v1", "1..2", "1.2.3.4", "1.", "65536.0.0", "1.0-beta"}) {
+        EXPECT_THROW(packAssetVersion(bad), std::runtime_error) << bad;
+    }
+
+    // Stored versions keep whatever the packed form cannot give back
+    EXPECT_TRUE(storeAssetVersion("").exact);
+    EXPECT_TRUE(storeAssetVersion("1.2.3").exact);
+    for (const char* loose : {"0.0.0", "1.2", "1.0.0-beta", "v1"}) {
+        EXPECT_FALSE(storeAssetVersion(loose).exact) << loose;
+    }
+    EXPECT_EQ(storeAssetVersion("1.0.0-beta").packed, packAssetVersion("1.0.0"));
+    EXPECT_EQ(storeAssetVersion("v1").packed, 0u);
+
+    PlatformMask mask = toPlatformMask({"vr", "windows"});
+    EXPECT_EQ(mask, platformBit(AssetPlatform::Windows) | platformBit(AssetPlatform::VR));
+    EXPECT_EQ(platformNames(mask), (std::vector<std::string>{"windows", "vr"}));
+    EXPECT_THROW(toPlatformMask({"dreamcast"}), std::runtime_error);
+}
+
+TEST_F(AssetMetadataIndexTest, RejectsMalformedFile) {
+    const std::string badPath = "asset_metadata_index_bad.bin";
+    {
+        FILE* file = std::fopen(badPath.c_str(), "wb");
+        std::fputs("not an index", file);
+        std::fclose(file);
+    }
+
+    AssetMetadataIndex index;
+    EXPECT_THROW(index.open(badPath), std::runtime_error);
+
+    // Entries whose references point past their regions fail when read
+    std::vector<uint8_t> bytes;
+    {
+        std::ifstream input(m_path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    MetadataIndexFormat::Header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    auto writeCorrupted = [&](auto&& corrupt) {
+        std::vector<uint8_t> copy = bytes;
+        for (uint32_t slot = 0; slot < header.entryCount; ++slot) {
+            MetadataIndexFormat::Entry entry;
+            uint8_t* at = copy.data() + header.entriesOffset + slot * sizeof(entry);
+            std::memcpy(&entry, at, sizeof(entry));
+            corrupt(entry);
+            std::memcpy(at, &entry, sizeof(entry));
+        }
+        std::ofstream(badPath, std::ios::binary).write(reinterpret_cast<const char*>(copy.data()),
+                                                       std::streamsize(copy.size()));
+    };
+
+    writeCorrupted([&](MetadataIndexFormat::Entry& entry) {
+        entry.assetId.length = uint32_t(header.stringsSize);
+    });
+    {
+        AssetMetadataIndex corrupted;
+        corrupted.open(badPath);
+        EXPECT_THROW(corrupted.entry(1).assetId(), std::runtime_error);
+        EXPECT_THROW(corrupted.find("asset_1"), std::runtime_error);
+    }
+
+    writeCorrupted([&](MetadataIndexFormat::Entry& entry) {
+        entry.dependencies.first = 0xFFFFFFF0u;
+    });
+    {
+        AssetMetadataIndex corrupted;
+        corrupted.open(badPath);
+        EXPECT_THROW(corrupted.entry(1).dependency(0), std::runtime_error);
+        EXPECT_NO_THROW(corrupted.entry(1).assetId());
+    }
+    std::remove(badPath.c_str());
+}
+
+TEST(AssetDatabaseTest, KeepsVersionsAsWritten) {
+    const std::vector<std::string> versions = {"", "0.0.0", "1.2", "1.0.0-beta", "2.3.4", "release"};
+    const std::string path = "asset_metadata_versions_test.bin";
+    AssetMetadataIndexWriter writer;
+    for (size_t i = 0; i < versions.size(); ++i) {
+        AssetMetadata metadata;
+        metadata.assetId = "indexed_" + std::to_string(i);
+        metadata.version = versions[i];
+        writer.add(metadata);
+    }
+    writer.write(path);
+
+    auto index = std::make_shared<AssetMetadataIndex>();
+    index->open(path);
+    AssetDatabase database;
+    database.attachIndex(index);
+    for (size_t i = 0; i < versions.size(); ++i) {
+        AssetMetadata metadata;
+        metadata.assetId = "runtime_" + std::to_string(i);
+        metadata.version = versions[i];
+        database.addAssetMetadata(metadata);
+    }
+
+    for (size_t i = 0; i < versions.size(); ++i) {
+        EXPECT_EQ(database.getAssetMetadata("indexed_" + std::to_string(i))->version, versions[i]);
+        EXPECT_EQ(database.getAssetMetadata("runtime_" + std::to_string(i))->version, versions[i]);
+    }
+    EXPECT_EQ(index->find("indexed_3")->version(), packAssetVersion("1.0.0"));
+    index.reset();
+    database.attachIndex(nullptr);
+    std::remove(path.c_str());
+}
+
+TEST_F(AssetMetadataIndexTest, DatabaseServesIndexedEntries) {
+    auto index = std::make_shared<AssetMetadataIndex>();
+    index->open(m_path);
+
+    AssetDatabase database;
+    database.attachIndex(index);
+
+    auto metadata = database.getAssetMetadata("asset_10");
+    ASSERT_NE(metadata, nullptr);
+    EXPECT_EQ(metadata->dependencies, std::vector<std::string>{"asset_9"});
+    EXPECT_EQ(database.getAssetMetadata("asset_10"), metadata);
+    EXPECT_TRUE(database.validateAsset("asset_10"));
+
+    // Runtime entries overlay the index, and indexed ids stay unique
+    AssetMetadata extra;
+    extra.assetId = "runtime_asset";
+    extra.assetType = "audio";
+    database.addAssetMetadata(extra);
+    EXPECT_NE(database.getAssetMetadata("runtime_asset"), nullptr);
+    EXPECT_THROW(database.addAssetMetadata(*metadata), std::runtime_error);
+
+    database.removeAssetMetadata("asset_10");
+    EXPECT_EQ(database.getAssetMetadata("asset_10"), nullptr);
+    EXPECT_FALSE(database.validateAsset("asset_11"));
+}
+
+TEST_F(AssetMetadataIndexTest, PlatformViewsCoverRuntimeAndIndexedEntries) {
+    auto index = std::make_shared<AssetMetadataIndex>();
+    index->open(m_path);
+
+    AssetDatabase database;
+    database.attachIndex(index);
+
+    AssetMetadata runtime;
+    runtime.assetId = "runtime_vr_asset";
+    runtime.assetType = "audio";
+    runtime.platforms = {"vr", "mac"};
+    runtime.version = "2.1";
+    database.addAssetMetadata(runtime);
+
+    AssetMetadata bad = runtime;
+    bad.assetId = "bad_platform";
+    bad.platforms = {"dreamcast"};
+    EXPECT_THROW(database.addAssetMetadata(bad), std::runtime_error);
+    EXPECT_FALSE(database.getHandle("bad_platform").isValid());
+
+    // One indexed entry already materialized, one hidden
+    database.getHandle("asset_3");
+    database.removeAssetMetadata("asset_6");
+
+    // Indexed entries resolve as the view is read; removed ones read as invalid
+    auto vr = database.getAssetsForPlatform(AssetPlatform::VR);
+    EXPECT_EQ(vr.size(), size_t((kAssetCount + 2) / 3) + 1);
+    std::unordered_set<std::string> ids;
+    size_t hidden = 0;
+    for (AssetHandle handle : vr) {
+        if (!handle.isValid()) {
+            ++hidden;
+            continue;
+        }
+        EXPECT_TRUE(ids.insert(database.getAssetId(handle)).second) << "listed twice";
+    }
+    EXPECT_EQ(hidden, 1u);
+    EXPECT_EQ(ids.size(), size_t((kAssetCount + 2) / 3));
+    EXPECT_TRUE(ids.count("runtime_vr_asset"));
+    EXPECT_TRUE(ids.count("asset_3"));
+    EXPECT_FALSE(ids.count("asset_6"));
+    EXPECT_EQ(database.getAssetsForPlatform(AssetPlatform::Mac).size(), 1u);
+
+    // Handles from the view materialize on use, with the metadata intact
+    auto metadata = database.getAssetMetadata(database.getHandle("asset_9"));
+    ASSERT_NE(metadata, nullptr);
+    EXPECT_EQ(metadata->platforms, (std::vector<std::string>{"linux", "vr"}));
+    EXPECT_EQ(metadata->version, "1.0.9");
+    EXPECT_EQ(metadata->dependencies, std::vector<std::string>{"asset_8"});
+    EXPECT_EQ(database.getAssetMetadata("runtime_vr_asset")->version, "2.1");
+
+    // Removing runtime entries refreshes the views
+    database.removeAssetMetadata("runtime_vr_asset");
+    EXPECT_TRUE(database.getAssetsForPlatform(AssetPlatform::Mac).empty());
+
+    // Dependency spans survive the arena compacting after mass removals
+    for (int i = 0; i < 100; ++i) {
+        AssetMetadata prop;
+        prop.assetId = "prop_" + std::to_string(i);
+        prop.assetType = "model";
+        prop.dependencies = {"asset_" + std::to_string(i), "asset_" + std::to_string(i + 1)};
+        database.addAssetMetadata(prop);
+    }
+    for (int i = 0; i < 80; ++i) {
+        database.removeAssetMetadata("prop_" + std::to_string(i));
+    }
+    for (int i = 80; i < 100; ++i) {
+        EXPECT_EQ(database.getDependencies(database.getHandle("prop_" + std::to_string(i))),
+                  (std::vector<AssetHandle>{database.getHandle("asset_" + std::to_string(i)),
+                                            database.getHandle("asset_" + std::to_string(i + 1))}));
+    }
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "World/SharedAssets/AssetPrefetcher.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+// Shaped like SAO::World::WorldSystem, FloorManager and TeleportGate
+struct FakeLocation {
+    uint32_t floor;
+    float x, y, z;
+};
+
+struct FakeGate {
+    uint32_t id;
+    FakeLocation location;
+    FakeLocation destination;
+    bool active;
+
+    uint32_t getId() const { return id; }
+    const FakeLocation& getLocation() const { return location; }
+    const FakeLocation& getDestination() const { return destination; }
+    bool isActive() const { return active; }
+};
+
+struct FakeFloor {
+    std::vector<std::shared_ptr<FakeGate>> gates;
+    std::vector<std::shared_ptr<FakeGate>> getTeleportGates() const { return gates; }
+};
+
+struct FakeWorld {
+    std::vector<std::shared_ptr<FakeFloor>> floors;
+    std::vector<std::shared_ptr<FakeFloor>> getAllFloors() const { return floors; }
+};
+
+bool contains(const std::vector<std::string>& assets, const std::string& asset) {
+    return std::find(assets.begin(), assets.end(), asset) != assets.end();
+}
+
+} // namespace
+
+class AssetPrefetcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PrefetchConfig config;
+        config.lookAheadSeconds = 5.0f;
+        m_prefetcher.configure(config);
+        m_prefetcher.setCallback([this](const std::string& assetId, int) { m_requests.push_back(assetId); });
+
+        m_prefetcher.setFloorAssets(1, {"floor1_terrain"});
+        m_prefetcher.setFloorAssets(2, {"floor2_terrain"});
+        m_prefetcher.addZone(1, {"town", {1, 0.0f, 0.0f, 0.0f}, 20.0f, {"town_props"}});
+        m_prefetcher.addZone(1, {"forest", {1, 0.0f, 0.0f, 300.0f}, 50.0f, {"forest_trees"}});
+        m_prefetcher.addZone(2, {"arrival", {2, 10.0f, 0.0f, 10.0f}, 30.0f, {"arrival_plaza"}});
+
+        FakeWorld world;
+        auto floor = std::make_shared<FakeFloor>();
+        floor->gates.push_back(std::make_shared<FakeGate>(
+            FakeGate{1, {1, 100.0f, 0.0f, 0.0f}, {2, 0.0f, 0.0f, 0.0f}, true}));
+        floor->gates.push_back(std::make_shared<FakeGate>(
+            FakeGate{2, {1, -100.0f, 0.0f, 0.0f}, {3, 0.0f, 0.0f, 0.0f}, false}));
+        world.floors.push_back(floor);
+        m_prefetcher.syncGates(world);
+    }
+
+    AssetPrefetcher m_prefetcher;
+    std::vector<std::string> m_requests;
+    AssetPrefetcher::Clock::time_point m_start = AssetPrefetcher::Clock::now();
+};
+
+TEST_F(AssetPrefetcherTest, IdlePlayerWarmsOnlyItsSurroundings) {
+    m_prefetcher.observePlayer(7, {1, 0.0f, 0.0f, 0.0f}, m_start);
+    m_prefetcher.update(m_start);
+
+    EXPECT_EQ(m_prefetcher.getPredictedAssets(), (std::vector<std::string>{"floor1_terrain", "town_props"}));
+    EXPECT_EQ(m_requests, m_prefetcher.getPredictedAssets());
+}
+
+TEST_F(AssetPrefetcherTest, HeadingForAGateWarmsTheFloorBehindIt) {
+    m_prefetcher.observePlayer(7, {1, 0.0f, 0.0f, 0.0f}, m_start);
+    m_prefetcher.observePlayer(7, {1, 40.0f, 0.0f, 0.0f}, m_start + std::chrono::seconds(1));
+    m_prefetcher.update(m_start + std::chrono::seconds(1));
+
+    auto predicted = m_prefetcher.getPredictedAssets();
+    EXPECT_TRUE(contains(predicted, "floor2_terrain"));
+    EXPECT_TRUE(contains(predicted, "arrival_plaza"));
+    EXPECT_FALSE(contains(predicted, "forest_trees"));
+    EXPECT_EQ(predicted.front(), "floor1_terrain"); // Needed now, before the gate
+
+    // Already requested assets wait for the reissue interval
+    size_t requested = m_requests.size();
+    m_prefetcher.update(m_start + std::chrono::seconds(2));
+    EXPECT_EQ(m_requests.size(), requested);
+    m_prefetcher.update(m_start + std::chrono::seconds(12));
+    EXPECT_EQ(m_requests.size(), requested * 2);
+}
+
+TEST_F(AssetPrefetcherTest, TeleportRestartsTheMovementEstimate) {
+    m_prefetcher.observePlayer(7, {1, 0.0f, 0.0f, 0.0f}, m_start);
+    m_prefetcher.observePlayer(7, {1, 0.0f, 0.0f, 100.0f}, m_start + std::chrono::seconds(1));
+    m_prefetcher.update(m_start + std::chrono::seconds(1));
+    EXPECT_TRUE(contains(m_prefetcher.getPredictedAssets(), "forest_trees"));
+
+    m_prefetcher.observePlayer(7, {2, 0.0f, 0.0f, 0.0f}, m_start + std::chrono::seconds(2));
+    m_prefetcher.update(m_start + std::chrono::seconds(2));
+    EXPECT_EQ(m_prefetcher.getPredictedAssets(), (std::vector<std::string>{"arrival_plaza", "floor2_terrain"}));
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "World/SharedAssets/AssetTelemetry.h"
+
+using namespace Aincrad::World;
+using std::chrono::microseconds;
+
+TEST(AssetTelemetryTest, HistogramBucketsByPowerOfTwo) {
+    LatencyHistogram histogram;
+    histogram.record(microseconds(0));
+    histogram.record(microseconds(1));
+    histogram.record(microseconds(3));
+    histogram.record(microseconds(1000));
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 4u);
+    EXPECT_EQ(snapshot.totalMicros, 1004u);
+    EXPECT_EQ(snapshot.maxMicros, 1000u);
+    EXPECT_EQ(snapshot.buckets[0], 1u);  // [0, 1)
+    EXPECT_EQ(snapshot.buckets[1], 1u);  // [1, 2)
+    EXPECT_EQ(snapshot.buckets[2], 1u);  // [2, 4)
+    EXPECT_EQ(snapshot.buckets[10], 1u); // [512, 1024)
+
+    EXPECT_EQ(snapshot.percentileMicros(0.5), 2u);
+    EXPECT_EQ(snapshot.percentileMicros(0.75), 4u);
+    EXPECT_EQ(snapshot.percentileMicros(1.0), 1000u); // Clamped to the largest sample
+    EXPECT_DOUBLE_EQ(snapshot.meanMicros(), 251.0);
+}
+
+TEST(AssetTelemetryTest, CountsPerTypeAcrossThreads) {
+    AssetTelemetry telemetry;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&telemetry, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                telemetry.recordLoad(t % 2 ? "mesh" : "texture", microseconds(i), 10, i % 100 != 0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto snapshot = telemetry.snapshot();
+    EXPECT_EQ(snapshot.loads, 4000u);
+    EXPECT_EQ(snapshot.failedLoads, 40u);
+    EXPECT_EQ(snapshot.bytesRead, 39600u);
+    ASSERT_EQ(snapshot.byType.size(), 2u);
+    for (const auto& type : snapshot.byType) {
+        EXPECT_TRUE(type.assetType == "mesh" || type.assetType == "texture");
+        EXPECT_EQ(type.latency.count, 2000u);
+    }
+}
+
+TEST(AssetTelemetryTest, ExtraTypesShareTheOtherSlot) {
+    AssetTelemetry telemetry;
+    for (size_t i = 0; i < AssetTelemetry::MaxAssetTypes + 5; ++i) {
+        telemetry.recordLoad("type" + std::to_string(i), microseconds(1), 0, true);
+    }
+
+    auto snapshot = telemetry.snapshot();
+    ASSERT_EQ(snapshot.byType.size(), AssetTelemetry::MaxAssetTypes);
+    EXPECT_EQ(snapshot.byType.back().assetType, "other");
+    EXPECT_EQ(snapshot.byType.back().latency.count, 6u);
+}
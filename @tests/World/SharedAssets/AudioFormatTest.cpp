@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "World/SharedAssets/AudioFormat.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+// Sine on the left, cosine on the right
+AudioBuffer tone(double frequency, uint32_t sampleRate, size_t frames, float amplitude = 0.5f) {
+    AudioBuffer audio{sampleRate, 2, {}};
+    for (size_t i = 0; i < frames; ++i) {
+        double phase = 2 * Pi * frequency * double(i) / sampleRate;
+        audio.samples.push_back(amplitude * float(std::sin(phase)));
+        audio.samples.push_back(amplitude * float(std::cos(phase)));
+    }
+    return audio;
+}
+
+// RMS of one channel, away from the ends where the filter sees silence
+double rms(const AudioBuffer& audio, uint32_t channel) {
+    size_t frames = audio.samples.size() / audio.channelCount;
+    double sum = 0.0;
+    for (size_t i = frames / 10; i < frames - frames / 10; ++i) {
+        double sample = audio.samples[i * audio.channelCount + channel];
+        sum += sample * sample;
+    }
+    return std::sqrt(sum / double(frames - 2 * (frames / 10)));
+}
+
+} // namespace
+
+TEST(AudioFormatTest, ResamplesTonesAccurately) {
+    AudioBuffer output = resampleAudio(tone(1000.0, 44100, 44100), 48000);
+    EXPECT_EQ(output.sampleRate, 48000u);
+    EXPECT_EQ(output.channelCount, 2u);
+    ASSERT_EQ(output.samples.size(), 48000u * 2);
+    double worst = 0.0;
+    for (size_t i = 100; i < 47900; ++i) {
+        double phase = 2 * Pi * 1000.0 * double(i) / 48000.0;
+        worst = std::max(worst, std::fabs(output.samples[i * 2] - 0.5 * std::sin(phase)));
+        worst = std::max(worst, std::fabs(output.samples[i * 2 + 1] - 0.5 * std::cos(phase)));
+    }
+    EXPECT_LT(worst, 5e-4);
+
+    // Going down to 22.05 kHz keeps a 5 kHz tone and removes a 15 kHz one
+    // rather than folding it down to 7.05 kHz
+    EXPECT_NEAR(rms(resampleAudio(tone(5000.0, 48000, 48000), 22050), 0), 0.5 / std::sqrt(2.0), 0.005);
+    EXPECT_LT(rms(resampleAudio(tone(15000.0, 48000, 48000), 22050), 0), 0.001);
+
+    EXPECT_EQ(resampleAudio(tone(1000.0, 48000, 10), 48000).samples, tone(1000.0, 48000, 10).samples);
+    EXPECT_THROW(resampleAudio(tone(1000.0, 48000, 10), 0), std::runtime_error);
+    AudioBuffer partial = tone(1000.0, 48000, 10);
+    partial.samples.pop_back();
+    EXPECT_THROW(resampleAudio(partial, 44100), std::runtime_error);
+}
+
+TEST(AudioFormatTest, SimdPathsMatchScalar) {
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    AudioBuffer input{44100, 3, std::vector<float>(3 * 20000)};
+    for (float& sample : input.samples) {
+        sample = noise(random);
+    }
+    // 48 kHz has 160 exact phases; 44.099 kHz needs snapping to the table
+    for (uint32_t rate : {48000u, 22050u, 44099u}) {
+        AudioBuffer scalar = resampleAudio(input, rate, false, AudioSimd::Scalar);
+        EXPECT_EQ(scalar.samples.size(), size_t((20000ull * rate + 22050) / 44100) * 3) << rate;
+        EXPECT_EQ(resampleAudio(input, rate, false, AudioSimd::SSE2).samples, scalar.samples) << rate;
+        EXPECT_EQ(resampleAudio(input, rate, false, AudioSimd::AVX2).samples, scalar.samples) << rate;
+    }
+}
+
+TEST(AudioFormatTest, LoopsResampleAcrossTheSeam) {
+    // 441 whole cycles, so the loop point falls between two periods
+    AudioBuffer loop = tone(441.0, 44100, 44100);
+    AudioBuffer looped = resampleAudio(loop, 48000, true);
+    AudioBuffer open = resampleAudio(loop, 48000, false);
+    ASSERT_EQ(looped.samples.size(), 48000u * 2);
+    for (size_t i : {size_t(0), size_t(1), size_t(47999)}) {
+        double phase = 2 * Pi * 441.0 * double(i) / 48000.0;
+        EXPECT_NEAR(looped.samples[i * 2 + 1], 0.5 * std::cos(phase), 5e-4) << i;
+    }
+    // Without wrapping the filter runs into silence at the ends
+    EXPECT_GT(std::fabs(open.samples[1] - 0.5f), 0.01f);
+}
+
+TEST(AudioFormatTest, BuildsChunkedPayloadsTheViewReads) {
+    AudioBuffer audio = tone(440.0, 48000, 100000);
+    AudioBuildOptions options;
+    options.looping = true;
+    std::vector<uint8_t> payload = buildAudio(audio, options);
+    ASSERT_TRUE(AudioView::isAudio(payload.data(), payload.size()));
+    AudioView view(payload.data(), payload.size());
+    EXPECT_EQ(view.sampleRate(), 48000u);
+    EXPECT_EQ(view.channelCount(), 2u);
+    EXPECT_EQ(view.frameCount(), 100000u);
+    EXPECT_TRUE(view.looping());
+    EXPECT_EQ(view.header().chunkSize, AudioFormat::MaxChunkSize);
+    EXPECT_EQ(view.header().framesPerChunk, 16384u);
+    EXPECT_EQ(view.header().chunkCount, 7u);
+    EXPECT_EQ(payload.size(), 8u * AudioFormat::MaxChunkSize);
+
+    // Frames read across a chunk boundary match the source to 16 bits
+    std::vector<int16_t> frames(2 * 1000);
+    ASSERT_EQ(view.readFrames(16000, 1000, frames.data()), 1000u);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_NEAR(frames[i] / 32767.0, audio.samples[16000 * 2 + i], 1.0 / 32767) << i;
+    }
+    EXPECT_EQ(view.readFrames(99990, 1000, frames.data()), 10u);
+    EXPECT_THROW(view.chunk(7), std::runtime_error);
+
+    // A short sound gets a chunk size to match, and resamples on request
+    options.looping = false;
+    options.sampleRate = 24000;
+    std::vector<uint8_t> blip = buildAudio(tone(440.0, 48000, 1000), options);
+    AudioView blipView(blip.data(), blip.size());
+    EXPECT_EQ(blipView.sampleRate(), 24000u);
+    EXPECT_EQ(blipView.frameCount(), 500u);
+    EXPECT_EQ(blipView.header().chunkSize, AudioFormat::ChunkAlignment);
+    EXPECT_EQ(blip.size(), 2u * AudioFormat::ChunkAlignment);
+
+    EXPECT_THROW(AudioView(payload.data(), payload.size() - 1), std::runtime_error);
+    std::vector<uint8_t> corrupt = payload;
+    AudioFormat::Header header;
+    std::memcpy(&header, corrupt.data(), sizeof(header));
+    header.frameCount += 16384;
+    std::memcpy(corrupt.data(), &header, sizeof(header));
+    EXPECT_THROW(AudioView(corrupt.data(), corrupt.size()), std::runtime_error);
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "World/SharedAssets/AssetCodec.h"
+#include "World/SharedAssets/AudioFormat.h"
+#include "World/SharedAssets/AudioStream.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+// Every sample distinct enough that a misplaced chunk shows
+AudioBuffer rampAudio(size_t frames) {
+    AudioBuffer audio{48000, 2, {}};
+    for (size_t i = 0; i < frames; ++i) {
+        audio.samples.push_back(float(i % 30011) / 30011.0f);
+        audio.samples.push_back(-float(i % 7919) / 7919.0f);
+    }
+    return audio;
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+                                                std::streamsize(bytes.size()));
+}
+
+// What the stream should produce from frame first on, wrapping if asked
+std::vector<int16_t> expectedFrames(const AudioView& view, uint64_t first, size_t count) {
+    std::vector<int16_t> frames(count * view.channelCount());
+    size_t done = 0;
+    while (done < count) {
+        done += view.readFrames((first + done) % view.frameCount(), count - done,
+                                frames.data() + done * view.channelCount());
+    }
+    return frames;
+}
+
+std::shared_ptr<StreamingReadQueue> makeReader(size_t slots = 8) {
+    return std::make_shared<StreamingReadQueue>(slots * StreamingReader::DefaultChunkSize);
+}
+
+std::vector<int16_t> readAll(AudioStream& stream, size_t count, size_t step) {
+    std::vector<int16_t> frames(count * stream.header().channelCount);
+    size_t done = 0;
+    while (done < count) {
+        size_t read = stream.read(frames.data() + done * stream.header().channelCount,
+                                  std::min(step, count - done), true);
+        if (read == 0) {
+            break;
+        }
+        done += read;
+    }
+    frames.resize(done * stream.header().channelCount);
+    return frames;
+}
+
+} // namespace
+
+TEST(AudioStreamTest, StreamsChunksInOrderAndSeeks) {
+    const std::string path = "audio_stream_test.bin";
+    std::vector<uint8_t> payload = buildAudio(rampAudio(150000), AudioBuildOptions());
+    AudioView view(payload.data(), payload.size());
+    writeFile(path, compressAsset(payload.data(), payload.size(), view.header().chunkSize));
+
+    auto reader = makeReader();
+    {
+        AudioStream stream(path, reader, 3);
+        EXPECT_EQ(stream.header().frameCount, 150000u);
+        EXPECT_FALSE(stream.looping());
+        EXPECT_EQ(readAll(stream, 200000, 4000), expectedFrames(view, 0, 150000));
+        EXPECT_TRUE(stream.finished());
+        int16_t frame[2];
+        EXPECT_EQ(stream.read(frame, 1), 0u);
+
+        // Back to the middle of a chunk, then forward past reads in flight
+        stream.seek(70000);
+        EXPECT_FALSE(stream.finished());
+        EXPECT_EQ(readAll(stream, 5000, 700), expectedFrames(view, 70000, 5000));
+        stream.seek(140000);
+        EXPECT_EQ(readAll(stream, 20000, 3000), expectedFrames(view, 140000, 10000));
+        EXPECT_THROW(stream.seek(150001), std::runtime_error);
+
+        // Without waiting, reads come back short until chunks land
+        stream.seek(0);
+        std::vector<int16_t> frames(2 * 50000);
+        size_t done = 0;
+        for (int attempt = 0; done < 50000 && attempt < 1000000; ++attempt) {
+            done += stream.read(frames.data() + done * 2, 50000 - done);
+        }
+        EXPECT_EQ(frames, expectedFrames(view, 0, 50000));
+    }
+
+    // Uncompressed payloads stream from fixed offsets
+    writeFile(path, payload);
+    {
+        AudioStream stream(path, reader);
+        stream.seek(33000);
+        EXPECT_EQ(readAll(stream, 1000, 1000), expectedFrames(view, 33000, 1000));
+    }
+
+    // Blocks that straddle chunks cannot be fetched one chunk at a time
+    writeFile(path, compressAsset(payload.data(), payload.size()));
+    EXPECT_THROW(AudioStream stream(path, reader), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(AudioStreamTest, LoopsWrapToTheStart) {
+    const std::string path = "audio_stream_loop_test.bin";
+    AudioBuildOptions options;
+    options.looping = true;
+    std::vector<uint8_t> payload = buildAudio(rampAudio(40000), options);
+    AudioView view(payload.data(), payload.size());
+    writeFile(path, compressAsset(payload.data(), payload.size(), view.header().chunkSize));
+
+    {
+        AudioStream stream(path, makeReader(), 2);
+        EXPECT_TRUE(stream.looping());
+        stream.seek(35000);
+        EXPECT_EQ(readAll(stream, 100000, 2500), expectedFrames(view, 35000, 100000));
+        EXPECT_FALSE(stream.finished());
+        EXPECT_EQ(stream.position(), (35000u + 100000u) % 40000u);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(AudioStreamTest, StreamsShareOneReader) {
+    const std::string path = "audio_stream_shared_test.bin";
+    AudioBuildOptions options;
+    options.looping = true;
+    std::vector<uint8_t> payload = buildAudio(rampAudio(60000), options);
+    AudioView view(payload.data(), payload.size());
+    writeFile(path, compressAsset(payload.data(), payload.size(), view.header().chunkSize));
+
+    // Three streams on one ring, each held to its read-ahead
+    auto reader = makeReader(8);
+    std::vector<std::unique_ptr<AudioStream>> streams;
+    for (int i = 0; i < 3; ++i) {
+        streams.push_back(std::make_unique<AudioStream>(path, reader, 2));
+        streams.back()->seek(i * 10000);
+    }
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 3; ++i) {
+            uint64_t first = (i * 10000 + round * 20000) % 60000;
+            EXPECT_EQ(readAll(*streams[i], 20000, 1500), expectedFrames(view, first, 20000)) << i;
+        }
+    }
+
+    // Loads still get the slots the streams leave, while they hold theirs
+    auto file = std::make_shared<StreamFile>();
+    file->open(path);
+    std::vector<uint8_t> bytes(1000);
+    reader->readInto(file, 0, bytes.size(), bytes.data());
+    streams.clear();
+    std::remove(path.c_str());
+}
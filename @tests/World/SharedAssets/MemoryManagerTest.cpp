@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "World/SharedAssets/MemoryManager.h"
+
+using namespace Aincrad::World;
+
+class MemoryManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        MemoryConfig config;
+        config.maxMemoryUsage = 64 * 1024 * 1024;
+        config.enablePaging = true;
+        config.strategy = MemoryConfig::PagingStrategy::PoolAllocation;
+        m_memoryManager.configure(config);
+    }
+
+    MemoryManager m_memoryManager;
+};
+
+TEST_F(MemoryManagerTest, AllocationTracksAssets) {
+    AssetHandle texture{0, 1};
+    AssetHandle model{1, 1};
+
+    void* textureBlock = m_memoryManager.allocateMemory(texture, 3000);
+    void* modelBlock = m_memoryManager.allocateMemory(model, 512 * 1024);
+    ASSERT_NE(textureBlock, nullptr);
+    ASSERT_NE(modelBlock, nullptr);
+    std::memset(textureBlock, 0xAB, 3000);
+    std::memset(modelBlock, 0xCD, 512 * 1024);
+
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(texture), 3000u);
+    EXPECT_EQ(m_memoryManager.getTotalAllocated(), 3000u + 512 * 1024);
+    EXPECT_THROW(m_memoryManager.allocateMemory(texture, 16), std::runtime_error);
+
+    EXPECT_EQ(m_memoryManager.getStats().assetCount, 2u);
+
+    m_memoryManager.deallocateMemory(texture);
+    m_memoryManager.deallocateMemory(model);
+    EXPECT_EQ(m_memoryManager.getTotalAllocated(), 0u);
+    EXPECT_EQ(m_memoryManager.getStats().assetCount, 0u);
+}
+
+TEST_F(MemoryManagerTest, EvictsCheapestIdleAssetsFirst) {
+    MemoryConfig config;
+    config.maxMemoryUsage = 1000;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::PoolAllocation;
+    config.evictionHighWater = 0.9f;
+    config.evictionLowWater = 0.5f;
+    m_memoryManager.configure(config);
+
+    std::vector<AssetHandle> evicted;
+    m_memoryManager.setEvictionCallback([&evicted](AssetHandle asset) {
+        evicted.push_back(asset);
+        return true;
+    });
+
+    AssetHandle cheap{0, 1};
+    AssetHandle expensive{1, 1};
+    AssetHandle recent{2, 1};
+    m_memoryManager.trackAsset(cheap, 320, std::chrono::microseconds(10));
+    m_memoryManager.trackAsset(expensive, 320, std::chrono::microseconds(100000));
+    m_memoryManager.trackAsset(recent, 320, std::chrono::microseconds(10));
+    m_memoryManager.touch(cheap);
+
+    // 960 bytes is over the high water mark; evict down to 500
+    m_memoryManager.update();
+    EXPECT_EQ(evicted, (std::vector<AssetHandle>{recent, cheap}));
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(expensive), 320u);
+
+    auto stats = m_memoryManager.getStats();
+    EXPECT_EQ(stats.evictionCount, 2u);
+    EXPECT_EQ(stats.evictedBytes, 640u);
+
+    // Evicted payloads stay charged until their owner deallocates them, and
+    // are not evicted again in the meantime
+    EXPECT_EQ(stats.totalAllocated, 960u);
+    m_memoryManager.update();
+    EXPECT_EQ(m_memoryManager.getStats().evictionCount, 2u);
+    m_memoryManager.deallocateMemory(evicted);
+    EXPECT_EQ(m_memoryManager.getTotalAllocated(), 320u);
+}
+
+TEST_F(MemoryManagerTest, LockFreeUseStampsCountWhenRanking) {
+    MemoryConfig config;
+    config.maxMemoryUsage = 1000;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::PoolAllocation;
+    config.evictionHighWater = 0.9f;
+    config.evictionLowWater = 0.5f;
+    m_memoryManager.configure(config);
+
+    std::vector<AssetHandle> evicted;
+    m_memoryManager.setEvictionCallback([&evicted](AssetHandle asset) {
+        evicted.push_back(asset);
+        return true;
+    });
+
+    AssetHandle first{0, 1};
+    AssetHandle second{1, 1};
+    AssetHandle third{2, 1};
+    m_memoryManager.trackAsset(first, 320, std::chrono::microseconds(10));
+    m_memoryManager.trackAsset(second, 320, std::chrono::microseconds(10));
+    m_memoryManager.trackAsset(third, 320, std::chrono::microseconds(10));
+
+    // Stamped outside the manager, as cache hits do, without touching it
+    uint64_t firstUse = 0;
+    m_memoryManager.setUseStampCallback([&firstUse, first](AssetHandle asset) -> uint64_t {
+        return asset == first ? firstUse : 0;
+    });
+    firstUse = m_memoryManager.nextUseStamp();
+
+    m_memoryManager.update();
+    EXPECT_EQ(evicted, (std::vector<AssetHandle>{second, third}));
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(first), 320u);
+}
+
+TEST_F(MemoryManagerTest, AllocationEvictsInsteadOfThrowing) {
+    MemoryConfig config;
+    config.maxMemoryUsage = 4096;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::PoolAllocation;
+    m_memoryManager.configure(config);
+
+    AssetHandle pinned{0, 1};
+    AssetHandle idle{1, 1};
+    AssetHandle incoming{2, 1};
+    m_memoryManager.allocateMemory(pinned, 1024);
+    m_memoryManager.allocateMemory(idle, 2048);
+
+    // The owner only gives up the idle asset, and releases it right away
+    m_memoryManager.setEvictionCallback([this, idle](AssetHandle asset) {
+        if (asset != idle) {
+            return false;
+        }
+        m_memoryManager.deallocateMemory(asset);
+        return true;
+    });
+
+    EXPECT_NE(m_memoryManager.allocateMemory(incoming, 2048), nullptr);
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(idle), 0u);
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(pinned), 1024u);
+    EXPECT_THROW(m_memoryManager.allocateMemory(AssetHandle{3, 1}, 2048), std::runtime_error);
+
+    // Budgets are 64-bit
+    config.maxMemoryUsage = uint64_t(8) * 1024 * 1024 * 1024;
+    m_memoryManager.configure(config);
+    m_memoryManager.trackAsset(AssetHandle{4, 1}, size_t(3) * 1024 * 1024 * 1024, std::chrono::microseconds(0));
+    EXPECT_EQ(m_memoryManager.getTotalAllocated(), size_t(3) * 1024 * 1024 * 1024 + 1024 + 2048);
+}
+
+TEST_F(MemoryManagerTest, AllocationRaceDuringCategoryEvictionIsCaught) {
+    MemoryConfig config;
+    config.maxMemoryUsage = 64 * 1024;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::PoolAllocation;
+    config.categoryBudgets = {{"texture", 1000}};
+    m_memoryManager.configure(config);
+
+    AssetHandle idle{0, 1};
+    AssetHandle incoming{1, 1};
+    m_memoryManager.trackAsset(idle, 600, std::chrono::microseconds(0), "texture");
+
+    // Another caller allocates the same asset while the callback runs unlocked
+    m_memoryManager.setEvictionCallback([this, incoming](AssetHandle) {
+        m_memoryManager.allocateMemory(incoming, 100, "texture");
+        return true;
+    });
+
+    EXPECT_THROW(m_memoryManager.allocateMemory(incoming, 500, "texture"), std::runtime_error);
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(incoming), 100u);
+    EXPECT_EQ(m_memoryManager.getTotalAllocated(), 700u);
+    EXPECT_EQ(m_memoryManager.getStats().assetCount, 2u);
+}
+
+TEST_F(MemoryManagerTest, QualityBasedDropsDetailBeforeEvicting) {
+    MemoryConfig config;
+    config.maxMemoryUsage = 1000000;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::QualityBased;
+    config.evictionHighWater = 0.9f;
+    config.evictionLowWater = 0.5f;
+    config.categoryBudgets = {{"texture", 1000}};
+    m_memoryManager.configure(config);
+
+    std::vector<AssetHandle> evicted;
+    m_memoryManager.setEvictionCallback([this, &evicted](AssetHandle asset) {
+        evicted.push_back(asset);
+        m_memoryManager.deallocateMemory(asset);
+        return true;
+    });
+    // Each level drops the top mip, leaving a quarter of the texture
+    m_memoryManager.setQualityCallback([](AssetHandle, uint32_t level) -> std::optional<size_t> {
+        return size_t(320) >> (2 * level);
+    });
+
+    AssetHandle first{0, 1};
+    AssetHandle second{1, 1};
+    AssetHandle third{2, 1};
+    AssetHandle model{3, 1};
+    m_memoryManager.trackAsset(first, 320, std::chrono::microseconds(10), "texture");
+    m_memoryManager.trackAsset(second, 320, std::chrono::microseconds(10), "texture");
+    m_memoryManager.trackAsset(third, 320, std::chrono::microseconds(10), "texture");
+    m_memoryManager.trackAsset(model, 5000, std::chrono::microseconds(10), "model");
+
+    // 960 texture bytes is over the category's high water mark; two mip
+    // drops bring it to 480, under the low water mark, with nothing evicted
+    m_memoryManager.update();
+    EXPECT_TRUE(evicted.empty());
+    EXPECT_EQ(m_memoryManager.getQualityLevel(first), 1u);
+    EXPECT_EQ(m_memoryManager.getQualityLevel(second), 1u);
+    EXPECT_EQ(m_memoryManager.getQualityLevel(third), 0u);
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(first), 80u);
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(model), 5000u);
+
+    auto stats = m_memoryManager.getStats();
+    EXPECT_EQ(stats.qualityDrops, 2u);
+    ASSERT_EQ(stats.categories.size(), 2u);
+    EXPECT_EQ(stats.categories[0].category, "texture");
+    EXPECT_EQ(stats.categories[0].allocated, 480u);
+    EXPECT_EQ(stats.categories[0].degradedAssets, 2u);
+
+    // Headroom returns one level at a time while it fits under the low water mark
+    m_memoryManager.deallocateMemory(third);
+    m_memoryManager.update();
+    EXPECT_EQ(m_memoryManager.getStats().qualityRestores, 1u);
+    EXPECT_EQ(m_memoryManager.getStats().categories[0].allocated, 400u);
+    m_memoryManager.update();
+    EXPECT_EQ(m_memoryManager.getStats().qualityRestores, 1u);
+
+    // Assets that cannot drop further are evicted, and only from the category
+    m_memoryManager.setQualityCallback([](AssetHandle, uint32_t) { return std::optional<size_t>(); });
+    m_memoryManager.trackAsset(AssetHandle{4, 1}, 600, std::chrono::microseconds(10), "texture");
+    m_memoryManager.update();
+    EXPECT_FALSE(evicted.empty());
+    EXPECT_LE(m_memoryManager.getStats().categories[0].allocated, 500u);
+    EXPECT_EQ(m_memoryManager.getAllocatedSize(model), 5000u);
+}
+
+TEST_F(MemoryManagerTest, TrackingAgainKeepsQualitySteps) {
+    MemoryConfig config;
+    config.maxMemoryUsage = 1000000;
+    config.enablePaging = true;
+    config.strategy = MemoryConfig::PagingStrategy::QualityBased;
+    config.evictionLowWater = 0.5f;
+    config.categoryBudgets = {{"texture", 1000}};
+    m_memoryManager.configure(config);
+    m_memoryManager.setQualityCallback([](AssetHandle, uint32_t level) -> std::optional<size_t> {
+        return size_t(960) >> (2 * level);
+    });
+
+    AssetHandle texture{0, 1};
+    m_memoryManager.trackAsset(texture, 960, std::chrono::microseconds(10), "texture");
+    m_memoryManager.update();
+    ASSERT_EQ(m_memoryManager.getQualityLevel(texture), 1u);
+    ASSERT_EQ(m_memoryManager.getTotalAllocated(), 240u);
+
+    // A cache hit re-tracks the asset with its full payload size, but the
+    // degraded payload is what is resident
+    m_memoryManager.trackAsset(texture, 960, std::chrono::microseconds(10), "texture");
+    EXPECT_EQ(m_memoryManager.getQualityLevel(texture), 1u);
+    EXPECT_EQ(m_memoryManager.getTotalAllocated(), 240u);
+    EXPECT_EQ(m_memoryManager.getStats().categories[0].degradedAssets, 1u);
+
+    // A hot reload brings back full quality and its full size
+    m_memoryManager.trackAsset(texture, 1000, std::chrono::microseconds(10), "texture", true);
+    EXPECT_EQ(m_memoryManager.getQualityLevel(texture), 0u);
+    EXPECT_EQ(m_memoryManager.getTotalAllocated(), 1000u);
+    EXPECT_EQ(m_memoryManager.getStats().categories[0].degradedAssets, 0u);
+}
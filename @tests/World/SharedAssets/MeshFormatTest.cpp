@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "World/SharedAssets/AssetCodec.h"
+#include "World/SharedAssets/MeshFormat.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+// A size x size grid of quads in the plane z = height, facing +z, with
+// every triangle carrying its own copy of its vertices, as a naive
+// exporter writes them
+MeshData gridMesh(uint32_t size, float height = 0.0f) {
+    MeshData mesh;
+    auto corner = [&](uint32_t x, uint32_t y) {
+        MeshVertex vertex{{float(x), float(y), height}, {0, 0, 1}, {float(x) / size, float(y) / size}};
+        mesh.indices.push_back(uint32_t(mesh.vertices.size()));
+        mesh.vertices.push_back(vertex);
+    };
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            corner(x, y), corner(x + 1, y), corner(x + 1, y + 1);
+            corner(x, y), corner(x + 1, y + 1), corner(x, y + 1);
+        }
+    }
+    return mesh;
+}
+
+void shuffleTriangles(std::vector<uint32_t>& indices, unsigned seed) {
+    std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+    std::memcpy(triangles.data(), indices.data(), indices.size() * 4);
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+    std::memcpy(indices.data(), triangles.data(), indices.size() * 4);
+}
+
+// Triangles as a sorted list, each rotated to start at its smallest index
+// so winding is kept but the starting corner does not matter
+std::vector<std::array<uint32_t, 3>> triangleSet(const std::vector<uint32_t>& indices) {
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        std::array<uint32_t, 3> triangle{indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+} // namespace
+
+TEST(MeshFormatTest, WeldsDuplicateVertices) {
+    MeshData quad = gridMesh(1);
+    ASSERT_EQ(quad.vertices.size(), 6u);
+    quad.indices.insert(quad.indices.end(), {0, 3, 1}); // Collapses once 0 and 3 merge
+
+    MeshData welded = weldVertices(quad);
+    EXPECT_EQ(welded.vertices.size(), 4u);
+    EXPECT_EQ(welded.indices, (std::vector<uint32_t>{0, 1, 2, 0, 2, 3}));
+
+    quad.indices.push_back(6);
+    EXPECT_THROW(weldVertices(quad), std::runtime_error);
+    quad.indices.insert(quad.indices.end(), {0, 0});
+    EXPECT_THROW(weldVertices(quad), std::runtime_error);
+}
+
+TEST(MeshFormatTest, CacheOrderCutsVertexShaderWork) {
+    MeshData mesh = weldVertices(gridMesh(40));
+    shuffleTriangles(mesh.indices, 3);
+    float before = averageCacheMissRatio(mesh.indices, mesh.vertices.size());
+    EXPECT_GT(before, 2.0f);
+
+    std::vector<uint32_t> optimized = mesh.indices;
+    optimizeVertexCache(optimized, mesh.vertices.size());
+    float after = averageCacheMissRatio(optimized, mesh.vertices.size());
+    EXPECT_LT(after, 0.8f) << before;
+    EXPECT_EQ(triangleSet(optimized), triangleSet(mesh.indices));
+
+    // Reordering clusters keeps every triangle and nearly all of the gain
+    optimizeOverdraw(optimized, mesh.vertices);
+    EXPECT_EQ(triangleSet(optimized), triangleSet(mesh.indices));
+    EXPECT_LT(averageCacheMissRatio(optimized, mesh.vertices.size()), after * 1.05f);
+
+    // Fetch order follows first use
+    MeshData fetched{mesh.vertices, optimized};
+    optimizeVertexFetch(fetched);
+    uint32_t next = 0;
+    for (uint32_t index : fetched.indices) {
+        ASSERT_LE(index, next);
+        next = std::max(next, index + 1);
+    }
+    EXPECT_EQ(next, fetched.vertices.size());
+}
+
+TEST(MeshFormatTest, OutwardClustersDrawFirst) {
+    // Two stacked sheets facing +z: the one in front hides the one behind,
+    // so it should be drawn first even though the input lists it last
+    MeshData back = gridMesh(4, -1.0f);
+    MeshData front = gridMesh(4, 1.0f);
+    MeshData mesh = back;
+    for (uint32_t index : front.indices) {
+        mesh.indices.push_back(index + uint32_t(back.vertices.size()));
+    }
+    mesh.vertices.insert(mesh.vertices.end(), front.vertices.begin(), front.vertices.end());
+    mesh = weldVertices(mesh);
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    optimizeOverdraw(mesh.indices, mesh.vertices);
+
+    size_t half = mesh.indices.size() / 2;
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        EXPECT_EQ(mesh.vertices[mesh.indices[i]].position[2], i < half ? 1.0f : -1.0f) << i;
+    }
+}
+
+TEST(MeshFormatTest, QuantizationHelpersRoundTrip) {
+    std::mt19937 random(9);
+    std::normal_distribution<float> gaussian;
+    for (int i = 0; i < 10000; ++i) {
+        float normal[3] = {gaussian(random), gaussian(random), gaussian(random)};
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (float& component : normal) {
+            component /= length;
+        }
+        int8_t encoded[2];
+        float decoded[3];
+        encodeOctahedral(normal, encoded);
+        decodeOctahedral(encoded, decoded);
+        EXPECT_GT(normal[0] * decoded[0] + normal[1] * decoded[1] + normal[2] * decoded[2], 0.999f);
+    }
+
+    for (float value : {0.0f, -0.0f, 0.5f, 1.0f, -2.0f, 1.0009765625f, 65504.0f, 5.9604645e-8f, 6.1035156e-5f}) {
+        EXPECT_EQ(halfToFloat(floatToHalf(value)), value);
+    }
+    EXPECT_EQ(floatToHalf(1.0f), 0x3C00);
+    EXPECT_EQ(floatToHalf(1.00048828125f), 0x3C00); // Halfway rounds to even
+    EXPECT_EQ(floatToHalf(1.0f / 3.0f), 0x3555);
+    EXPECT_EQ(floatToHalf(70000.0f), 0x7C00);
+    EXPECT_EQ(floatToHalf(-1e-10f), 0x8000);
+    EXPECT_TRUE(std::isnan(halfToFloat(floatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(MeshFormatTest, BuildsPayloadsTheViewReads) {
+    MeshData mesh = gridMesh(16);
+    shuffleTriangles(mesh.indices, 5);
+
+    auto payload = buildMesh(mesh, MeshBuildOptions());
+    ASSERT_TRUE(MeshView::isMesh(payload.data(), payload.size()));
+    MeshView meshView(payload.data(), payload.size());
+    ASSERT_EQ(meshView.lodCount(), 1u);
+    MeshLodView view = meshView.lod(0);
+    EXPECT_EQ(view.vertexFormat(), MeshFormat::VertexFormat::Quantized);
+    EXPECT_EQ(view.vertexStride(), 16u);
+    EXPECT_EQ(view.vertexCount(), 17u * 17);
+    EXPECT_EQ(view.indexCount(), mesh.indices.size());
+    EXPECT_EQ(view.indexSize(), 2u);
+    EXPECT_EQ(view.vertexDataSize(), 17u * 17 * 16);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.indexData()) % 4, reinterpret_cast<uintptr_t>(payload.data()) % 4);
+
+    // Every source triangle comes back within quantization error
+    std::vector<std::array<float, 9>> expected, actual;
+    auto collect = [](std::vector<std::array<float, 9>>& out, auto corner, size_t count) {
+        for (size_t t = 0; t < count; ++t) {
+            std::array<float, 9> triangle;
+            for (int c = 0; c < 3; ++c) {
+                MeshVertex vertex = corner(t * 3 + c);
+                for (int axis = 0; axis < 3; ++axis) {
+                    triangle[c * 3 + axis] = std::round(vertex.position[axis] * 1000.0f) / 1000.0f;
+                }
+                EXPECT_NEAR(vertex.normal[2], 1.0f, 1e-3f);
+                EXPECT_NEAR(vertex.uv[0] * 16.0f, vertex.position[0], 1e-2f);
+            }
+            // Rotate so the smallest corner leads, as in triangleSet
+            std::array<float, 9> best = triangle;
+            for (int r = 1; r < 3; ++r) {
+                std::array<float, 9> rotated;
+                for (int i = 0; i < 9; ++i) {
+                    rotated[i] = triangle[(i + r * 3) % 9];
+                }
+                best = std::min(best, rotated);
+            }
+            out.push_back(best);
+        }
+        std::sort(out.begin(), out.end());
+    };
+    collect(expected, [&](size_t i) { return mesh.vertices[mesh.indices[i]]; }, mesh.indices.size() / 3);
+    collect(actual, [&](size_t i) { return view.vertex(view.index(uint32_t(i))); }, view.indexCount() / 3);
+    EXPECT_EQ(actual, expected);
+
+    // Unoptimized float output is the input as it was
+    MeshBuildOptions raw;
+    raw.optimize = false;
+    raw.quantize = false;
+    auto rawPayload = buildMesh(mesh, raw);
+    MeshLodView rawView = MeshView(rawPayload.data(), rawPayload.size()).lod(0);
+    EXPECT_EQ(rawView.vertexStride(), sizeof(MeshVertex));
+    ASSERT_EQ(rawView.vertexCount(), mesh.vertices.size());
+    EXPECT_EQ(std::memcmp(rawView.vertexData(), mesh.vertices.data(), rawView.vertexDataSize()), 0);
+    EXPECT_EQ(rawView.index(7), mesh.indices[7]);
+
+    // Past 65536 vertices indices widen to 32 bits
+    auto large = buildMesh(gridMesh(256), MeshBuildOptions());
+    MeshLodView largeView = MeshView(large.data(), large.size()).lod(0);
+    EXPECT_EQ(largeView.vertexCount(), 257u * 257);
+    EXPECT_EQ(largeView.indexSize(), 4u);
+
+    EXPECT_THROW(MeshView(payload.data(), payload.size() - 1), std::runtime_error);
+    EXPECT_THROW(view.vertex(view.vertexCount()), std::runtime_error);
+}
+
+TEST(MeshFormatTest, StreamsLodsCoarsestFirst) {
+    MeshData mesh = gridMesh(32);
+    for (MeshVertex& vertex : mesh.vertices) {
+        vertex.position[2] = 4.0f * std::sin(vertex.position[0] * 0.1f) * std::cos(vertex.position[1] * 0.1f);
+    }
+    MeshBuildOptions options;
+    options.maxLodCount = 4;
+    auto payload = buildMesh(mesh, options);
+    MeshView view(payload.data(), payload.size());
+    ASSERT_EQ(view.lodCount(), 4u);
+    EXPECT_EQ(view.firstResidentLod(), 0u);
+    EXPECT_EQ(view.lod(0).indexCount(), mesh.indices.size());
+    EXPECT_EQ(view.lod(0).error(), 0.0f);
+    EXPECT_EQ(view.residentSize(0), payload.size());
+
+    // Each LOD is smaller, within the error bound, and sits before the one
+    // it stands in for
+    const size_t table = sizeof(MeshFormat::Header) + view.lodCount() * sizeof(MeshFormat::LodEntry);
+    for (uint32_t level = 1; level < view.lodCount(); ++level) {
+        MeshLodView finer = view.lod(level - 1);
+        MeshLodView coarser = view.lod(level);
+        EXPECT_LT(coarser.indexCount(), finer.indexCount() * 0.9) << level;
+        EXPECT_LT(coarser.vertexCount(), finer.vertexCount()) << level;
+        EXPECT_GE(coarser.error(), finer.error()) << level;
+        EXPECT_LE(coarser.error(), options.maxLodError) << level;
+        for (uint32_t i = 0; i < coarser.indexCount(); ++i) {
+            ASSERT_LT(coarser.index(i), coarser.vertexCount());
+        }
+        EXPECT_LT(MeshView::requiredSize(payload.data(), table, level),
+                  MeshView::requiredSize(payload.data(), table, level - 1));
+        EXPECT_EQ(view.residentSize(level), MeshView::requiredSize(payload.data(), table, level));
+    }
+
+    // A streamer decodes the table, then only as far as the coarsest LOD
+    auto compressed = compressAsset(payload.data(), payload.size(), 4096);
+    std::vector<uint8_t> head(table);
+    decompressAssetPrefix(compressed.data(), size_t(compressedPrefixSize(compressed.data(), compressed.size(), table)),
+                          head.data(), head.size());
+    const uint32_t coarsest = view.lodCount() - 1;
+    std::vector<uint8_t> prefix(MeshView::requiredSize(head.data(), head.size(), coarsest));
+    uint64_t read = compressedPrefixSize(compressed.data(), compressed.size(), prefix.size());
+    EXPECT_LT(read, compressed.size() / 2);
+    decompressAssetPrefix(compressed.data(), size_t(read), prefix.data(), prefix.size());
+
+    MeshView partial(prefix.data(), prefix.size());
+    EXPECT_EQ(partial.firstResidentLod(), coarsest);
+    EXPECT_THROW(partial.lod(0), std::runtime_error);
+    ASSERT_EQ(partial.lod(coarsest).indexDataSize(), view.lod(coarsest).indexDataSize());
+    EXPECT_EQ(std::memcmp(partial.lod(coarsest).indexData(), view.lod(coarsest).indexData(),
+                          view.lod(coarsest).indexDataSize()), 0);
+
+    EXPECT_THROW(MeshView(prefix.data(), prefix.size() - 1), std::runtime_error);
+    EXPECT_THROW(MeshView::requiredSize(payload.data(), table - 1, 0), std::runtime_error);
+    EXPECT_THROW(view.lod(view.lodCount()), std::runtime_error);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "World/SharedAssets/MeshFormat.h"
+#include "World/SharedAssets/MeshSimplifier.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+// A welded size x size grid of quads facing +z, with z = height(x, y)
+template <typename Height>
+MeshData heightField(uint32_t size, Height height) {
+    MeshData mesh;
+    for (uint32_t y = 0; y <= size; ++y) {
+        for (uint32_t x = 0; x <= size; ++x) {
+            mesh.vertices.push_back({{float(x), float(y), height(float(x), float(y))},
+                                     {0, 0, 1},
+                                     {float(x) / size, float(y) / size}});
+        }
+    }
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            uint32_t v = y * (size + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {v, v + 1, v + size + 2, v, v + size + 2, v + size + 1});
+        }
+    }
+    return mesh;
+}
+
+MeshData flatGrid(uint32_t size) {
+    return heightField(size, [](float, float) { return 0.0f; });
+}
+
+// Signed area of the triangles projected onto the xy plane; negative for
+// any that flipped over
+std::vector<float> projectedAreas(const MeshData& mesh, const std::vector<uint32_t>& indices) {
+    std::vector<float> areas;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const float* a = mesh.vertices[indices[i]].position;
+        const float* b = mesh.vertices[indices[i + 1]].position;
+        const float* c = mesh.vertices[indices[i + 2]].position;
+        areas.push_back(0.5f * ((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])));
+    }
+    return areas;
+}
+
+} // namespace
+
+TEST(MeshSimplifierTest, FlatGridKeepsItsOutline) {
+    MeshData mesh = flatGrid(16);
+    MeshSimplification result = simplifyMesh(mesh, 0, 0.01f);
+    EXPECT_LT(result.indices.size(), mesh.indices.size() / 20);
+    EXPECT_EQ(result.error, 0.0f);
+
+    // Same area, nothing turned over, and the corners survive
+    float total = 0.0f;
+    for (float area : projectedAreas(mesh, result.indices)) {
+        EXPECT_GT(area, 0.0f);
+        total += area;
+    }
+    EXPECT_FLOAT_EQ(total, 256.0f);
+    for (uint32_t corner : {0u, 16u, 17u * 16, 17u * 17 - 1}) {
+        EXPECT_NE(std::find(result.indices.begin(), result.indices.end(), corner), result.indices.end()) << corner;
+    }
+}
+
+TEST(MeshSimplifierTest, StopsAtTargetOrErrorBound) {
+    MeshData mesh = heightField(32, [](float x, float y) { return 4.0f * std::sin(x * 0.2f) * std::cos(y * 0.2f); });
+
+    size_t target = mesh.indices.size() / 2 / 3 * 3;
+    MeshSimplification half = simplifyMesh(mesh, target, 1.0f);
+    EXPECT_LE(half.indices.size(), target);
+    EXPECT_GE(half.indices.size() + 6, target);
+
+    // With no target the error bound decides, and a looser bound goes further
+    MeshSimplification tight = simplifyMesh(mesh, 0, 0.002f);
+    MeshSimplification loose = simplifyMesh(mesh, 0, 0.02f);
+    EXPECT_LE(tight.error, 0.002f);
+    EXPECT_LE(loose.error, 0.02f);
+    EXPECT_GT(tight.indices.size(), loose.indices.size());
+    EXPECT_LT(loose.indices.size(), mesh.indices.size() / 4);
+    // Triangles standing on the curved border project to nothing, but
+    // none may face down
+    for (float area : projectedAreas(mesh, loose.indices)) {
+        EXPECT_GE(area, 0.0f);
+    }
+
+    // Already small enough: nothing to do
+    EXPECT_EQ(simplifyMesh(mesh, mesh.indices.size(), 0.02f).indices, mesh.indices);
+}
+
+TEST(MeshSimplifierTest, SeamVerticesStayPut) {
+    // Split the UVs down x = 8, so the column there carries two wedges
+    MeshData mesh = flatGrid(16);
+    std::vector<uint32_t> seamCopy(mesh.vertices.size(), UINT32_MAX);
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        float minX = 16.0f;
+        for (int c = 0; c < 3; ++c) {
+            minX = std::min(minX, mesh.vertices[mesh.indices[i + c]].position[0]);
+        }
+        for (int c = 0; minX >= 8.0f && c < 3; ++c) {
+            uint32_t& index = mesh.indices[i + c];
+            if (mesh.vertices[index].position[0] == 8.0f) {
+                if (seamCopy[index] == UINT32_MAX) {
+                    seamCopy[index] = uint32_t(mesh.vertices.size());
+                    MeshVertex copy = mesh.vertices[index];
+                    copy.uv[0] += 1.0f;
+                    mesh.vertices.push_back(copy);
+                }
+                index = seamCopy[index];
+            }
+        }
+    }
+
+    MeshSimplification result = simplifyMesh(mesh, 0, 0.01f);
+    EXPECT_LT(result.indices.size(), mesh.indices.size() / 4);
+    for (uint32_t v = 0; v < mesh.vertices.size(); ++v) {
+        if (mesh.vertices[v].position[0] == 8.0f) {
+            EXPECT_NE(std::find(result.indices.begin(), result.indices.end(), v), result.indices.end()) << v;
+        }
+    }
+
+    mesh.indices.push_back(uint32_t(mesh.vertices.size()));
+    EXPECT_THROW(simplifyMesh(mesh, 0, 0.01f), std::runtime_error);
+}
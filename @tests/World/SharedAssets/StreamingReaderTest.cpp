@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "World/SharedAssets/StreamingReadQueue.h"
+#include "World/SharedAssets/StreamingReader.h"
+
+using namespace Aincrad::World;
+
+class StreamingReaderTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        m_contents.resize(kFileSize);
+        for (size_t i = 0; i < m_contents.size(); ++i) {
+            m_contents[i] = uint8_t((i * 131) ^ (i >> 11));
+        }
+        std::ofstream file(m_path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(m_contents.data()), std::streamsize(m_contents.size()));
+    }
+
+    void TearDown() override {
+        std::remove(m_path.c_str());
+    }
+
+    static constexpr size_t kFileSize = 1024 * 1024 + 1000;
+    static constexpr size_t kChunkSize = 64 * 1024;
+    const std::string m_path = "streaming_reader_test.bin";
+    std::vector<uint8_t> m_contents;
+};
+
+TEST_P(StreamingReaderTest, StreamsWholeFileInOrder) {
+    StreamFile file;
+    file.open(m_path);
+    ASSERT_EQ(file.size(), kFileSize);
+
+    StreamingReader reader(4 * kChunkSize, kChunkSize, GetParam());
+    ASSERT_EQ(reader.getSlotCount(), 4u);
+
+    uint64_t submitted = 0;
+    uint64_t received = 0;
+    StreamChunk chunk;
+    while (received < kFileSize) {
+        // Keep the ring full; submit reports 0 once every slot is busy
+        while (submitted < kFileSize) {
+            size_t queued = reader.submit(file, submitted, kChunkSize, submitted / kChunkSize);
+            if (queued == 0) {
+                break;
+            }
+            submitted += queued;
+        }
+        EXPECT_LE(reader.getInFlight(), reader.getSlotCount());
+
+        ASSERT_TRUE(reader.wait(chunk));
+        ASSERT_TRUE(chunk.ok()) << chunk.error;
+        EXPECT_EQ(chunk.offset, received);
+        EXPECT_EQ(chunk.tag, received / kChunkSize);
+        ASSERT_EQ(chunk.size, std::min<uint64_t>(kChunkSize, kFileSize - received));
+        EXPECT_EQ(std::memcmp(chunk.data, m_contents.data() + received, chunk.size), 0);
+        received += chunk.size;
+        reader.release(chunk);
+    }
+
+    EXPECT_EQ(reader.getInFlight(), 0u);
+    EXPECT_FALSE(reader.wait(chunk));
+}
+
+TEST_P(StreamingReaderTest, ShortReadAtEndAndReleaseInAnyOrder) {
+    StreamFile file;
+    file.open(m_path);
+    StreamingReader reader(2 * kChunkSize, kChunkSize, GetParam());
+
+    EXPECT_EQ(reader.submit(file, kFileSize - 100, kChunkSize), kChunkSize);
+    EXPECT_EQ(reader.submit(file, 0, 10), 10u);
+    EXPECT_EQ(reader.submit(file, 0, 10), 0u);
+
+    StreamChunk tail;
+    StreamChunk head;
+    ASSERT_TRUE(reader.wait(tail));
+    EXPECT_EQ(tail.size, 100u);
+    ASSERT_TRUE(reader.wait(head));
+    EXPECT_EQ(head.size, 10u);
+
+    // A chunk kept back does not hold up the slot released after it
+    reader.release(head);
+    EXPECT_THROW(reader.release(head), std::logic_error);
+    EXPECT_EQ(reader.submit(file, 10, 10), 10u);
+    StreamChunk next;
+    ASSERT_TRUE(reader.wait(next));
+    EXPECT_EQ(next.offset, 10u);
+    EXPECT_EQ(std::memcmp(tail.data, m_contents.data() + kFileSize - 100, 100), 0);
+    reader.release(next);
+    reader.release(tail);
+    EXPECT_EQ(reader.getInFlight(), 0u);
+}
+
+TEST_P(StreamingReaderTest, ReadQueueCopiesWholeRangesAndFailsShortOnes) {
+    auto file = std::make_shared<StreamFile>();
+    file->open(m_path);
+    StreamingReadQueue queue(4 * kChunkSize, kChunkSize, GetParam());
+
+    // Several readers at once share the ring without seeing each other's chunks
+    std::vector<std::vector<uint8_t>> copies(3, std::vector<uint8_t>(kFileSize - 7));
+    std::vector<std::thread> readers;
+    for (auto& copy : copies) {
+        readers.emplace_back([&queue, &file, &copy] { queue.readInto(file, 7, copy.size(), copy.data()); });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    for (const auto& copy : copies) {
+        EXPECT_TRUE(std::equal(copy.begin(), copy.end(), m_contents.begin() + 7));
+    }
+
+    std::vector<uint8_t> past(200);
+    EXPECT_THROW(queue.readInto(file, kFileSize - 100, past.size(), past.data()), std::runtime_error);
+}
+
+TEST_P(StreamingReaderTest, ReadQueueLaneHoldsAtMostItsShare) {
+    auto file = std::make_shared<StreamFile>();
+    file->open(m_path);
+    StreamingReadQueue queue(4 * kChunkSize, kChunkSize, GetParam());
+    StreamingReadQueue::Lane lane = queue.openLane(2);
+
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::vector<StreamChunk> kept;
+    int result = -1;
+    queue.read(lane, file, 0, 4 * kChunkSize,
+        [&](const StreamChunk& chunk) {
+            std::lock_guard<std::mutex> lock(mutex);
+            kept.push_back(chunk);
+            arrived.notify_all();
+            return false;
+        },
+        [&](int error) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result = error;
+            arrived.notify_all();
+        });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(arrived.wait_for(lock, std::chrono::seconds(5), [&] { return kept.size() == 2; }));
+    // Loads on the shared lane still get the rest of the ring
+    lock.unlock();
+    std::vector<uint8_t> copy(kChunkSize);
+    queue.readInto(file, kChunkSize, copy.size(), copy.data());
+    EXPECT_TRUE(std::equal(copy.begin(), copy.end(), m_contents.begin() + kChunkSize));
+    lock.lock();
+    EXPECT_EQ(kept.size(), 2u);
+
+    // Handing one back lets the next chunk through, in file order
+    queue.release(kept[0]);
+    ASSERT_TRUE(arrived.wait_for(lock, std::chrono::seconds(5), [&] { return kept.size() == 3; }));
+    EXPECT_EQ(kept[2].offset, 2 * kChunkSize);
+    EXPECT_EQ(std::memcmp(kept[2].data, m_contents.data() + 2 * kChunkSize, kChunkSize), 0);
+    EXPECT_EQ(result, -1);
+
+    queue.release(kept[1]);
+    queue.release(kept[2]);
+    ASSERT_TRUE(arrived.wait_for(lock, std::chrono::seconds(5), [&] { return result == 0; }));
+    queue.release(kept[3]);
+
+    // Closing cancels what the lane has queued
+    kept.clear();
+    result = -1;
+    lock.unlock();
+    queue.read(lane, file, 0, 8 * kChunkSize, [&](const StreamChunk& chunk) {
+            std::lock_guard<std::mutex> guard(mutex);
+            kept.push_back(chunk);
+            return false;
+        },
+        [&](int error) {
+            std::lock_guard<std::mutex> guard(mutex);
+            result = error;
+        });
+    queue.closeLane(lane);
+    lock.lock();
+    EXPECT_LE(kept.size(), 2u);
+    EXPECT_EQ(result, ECANCELED);
+    for (const auto& chunk : kept) {
+        queue.release(chunk);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, StreamingReaderTest, ::testing::Values(true, false));
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <vector>
+#include "World/SharedAssets/StreamingSystem.h"
+
+using namespace Aincrad::World;
+
+class StreamingSystemTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        StreamingConfig config{};
+        config.enableStreaming = true;
+        config.streamBufferSize = 1024 * 1024;
+        config.streamDistance = 100.0f;
+        config.strategy = StreamingConfig::StreamingStrategy::DistanceBased;
+        m_streaming.configure(config);
+
+        // Loads complete on the next update unless a test holds them back
+        m_streaming.setCallbacks(
+            [this](AssetHandle asset, int) {
+                m_loads.push_back(asset);
+                std::promise<void> promise;
+                promise.set_value();
+                AssetLoadHandle handle;
+                handle.ready = promise.get_future().share();
+                return handle;
+            },
+            [this](AssetHandle asset) { m_releases.push_back(asset); });
+    }
+
+    StreamingSystem m_streaming;
+    std::vector<AssetHandle> m_loads;
+    std::vector<AssetHandle> m_releases;
+};
+
+TEST_F(StreamingSystemTest, StreamsAroundObservers) {
+    AssetHandle near{0, 1};
+    AssetHandle edge{1, 1};
+    AssetHandle far{2, 1};
+    m_streaming.startStreaming(near, {10.0f, 0.0f, 0.0f});
+    m_streaming.startStreaming(edge, {0.0f, 0.0f, 95.0f});
+    m_streaming.startStreaming(far, {500.0f, 0.0f, 500.0f});
+    m_streaming.setObserver(1, {0.0f, 0.0f, 0.0f});
+
+    m_streaming.update();
+    EXPECT_EQ(m_streaming.getState(near), StreamingState::Loading);
+    EXPECT_EQ(m_streaming.getState(edge), StreamingState::Loading);
+    EXPECT_EQ(m_streaming.getState(far), StreamingState::Evicted);
+
+    m_streaming.update();
+    EXPECT_EQ(m_streaming.getState(near), StreamingState::Resident);
+    EXPECT_EQ(m_streaming.getState(edge), StreamingState::Resident);
+    EXPECT_EQ(m_loads.size(), 2u);
+
+    // Slightly past streamDistance is inside the eviction slack
+    m_streaming.setObserver(1, {0.0f, 0.0f, -10.0f});
+    m_streaming.update();
+    EXPECT_EQ(m_streaming.getState(edge), StreamingState::Resident);
+    EXPECT_TRUE(m_releases.empty());
+
+    // Walking away releases everything the observer left behind
+    m_streaming.setObserver(1, {2000.0f, 0.0f, 0.0f});
+    m_streaming.update();
+    EXPECT_EQ(m_streaming.getState(near), StreamingState::Evicted);
+    EXPECT_EQ(m_streaming.getState(edge), StreamingState::Evicted);
+    EXPECT_EQ(m_releases.size(), 2u);
+}
+
+TEST_F(StreamingSystemTest, LoadsOnlyAssetsInRange) {
+    // A 100 x 100 grid of props, 50 units apart
+    for (uint32_t i = 0; i < 10000; ++i) {
+        m_streaming.startStreaming(AssetHandle{i, 1}, {float(i % 100) * 50.0f, 0.0f, float(i / 100) * 50.0f});
+    }
+    EXPECT_EQ(m_streaming.getStreamingAssetCount(), 10000u);
+
+    m_streaming.setObserver(1, {2500.0f, 0.0f, 2500.0f});
+    m_streaming.update();
+
+    // Points on a 50 unit lattice within 100 units of a lattice point
+    EXPECT_EQ(m_loads.size(), 13u);
+    for (AssetHandle asset : m_loads) {
+        EXPECT_EQ(m_streaming.getState(asset), StreamingState::Loading);
+    }
+}
+
+TEST_F(StreamingSystemTest, MovedAndStoppedAssetsAreReleased) {
+    AssetHandle moving{0, 1};
+    AssetHandle stopped{1, 1};
+    m_streaming.startStreaming(moving, {0.0f, 0.0f, 0.0f});
+    m_streaming.startStreaming(stopped, {20.0f, 0.0f, 0.0f});
+    m_streaming.setObserver(1, {0.0f, 0.0f, 0.0f});
+    m_streaming.update();
+    m_streaming.update();
+    ASSERT_EQ(m_streaming.getState(moving), StreamingState::Resident);
+
+    m_streaming.moveAsset(moving, {5000.0f, 0.0f, 5000.0f});
+    EXPECT_EQ(m_streaming.getState(moving), StreamingState::Evicted);
+
+    m_streaming.stopStreaming(stopped);
+    EXPECT_EQ(m_releases, (std::vector<AssetHandle>{moving, stopped}));
+    EXPECT_EQ(m_streaming.getStreamingAssetCount(), 1u);
+
+    m_streaming.update();
+    EXPECT_EQ(m_loads.size(), 2u);
+}
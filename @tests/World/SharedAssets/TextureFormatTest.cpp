@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "World/SharedAssets/TextureFormat.h"
+
+using namespace Aincrad::World;
+
+namespace {
+
+TextureImage makeImage(uint32_t width, uint32_t height) {
+    TextureImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(size_t(width) * height * 4);
+    return image;
+}
+
+// Smooth color ramps with a little noise, like a photographed surface
+TextureImage photoImage(uint32_t width, uint32_t height, bool withAlpha) {
+    std::mt19937 random(5);
+    TextureImage image = makeImage(width, height);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* pixel = &image.pixels[(size_t(y) * width + x) * 4];
+            pixel[0] = uint8_t(x * 255 / width);
+            pixel[1] = uint8_t(y * 255 / height);
+            pixel[2] = uint8_t(128 + random() % 8);
+            pixel[3] = withAlpha ? uint8_t((x + y) * 255 / (width + height)) : 255;
+        }
+    }
+    return image;
+}
+
+int maxChannelError(const TextureImage& a, const TextureImage& b, size_t firstChannel, size_t lastChannel) {
+    int worst = 0;
+    for (size_t i = 0; i < a.pixels.size(); i += 4) {
+        for (size_t c = firstChannel; c <= lastChannel; ++c) {
+            worst = std::max(worst, std::abs(int(a.pixels[i + c]) - int(b.pixels[i + c])));
+        }
+    }
+    return worst;
+}
+
+} // namespace
+
+TEST(TextureFormatTest, MipChainIsGammaCorrectAndSameOnEveryPath) {
+    // A black and white checkerboard averages to half the light, which is
+    // sRGB 188, not the 128 a naive average of the codes gives
+    TextureImage checker = makeImage(8, 8);
+    for (size_t i = 0; i < 64; ++i) {
+        uint8_t value = ((i % 8) + (i / 8)) % 2 ? 255 : 0;
+        checker.pixels[i * 4] = checker.pixels[i * 4 + 1] = checker.pixels[i * 4 + 2] = value;
+        checker.pixels[i * 4 + 3] = 255;
+    }
+    auto chain = generateMipChain(checker, true);
+    ASSERT_EQ(chain.size(), 4u);
+    EXPECT_EQ(chain[1].pixels[0], 188);
+    EXPECT_EQ(chain[3].width, 1u);
+    EXPECT_EQ(generateMipChain(checker, false)[1].pixels[0], 128);
+
+    // Odd, non-square sizes, compared across every instruction set
+    TextureImage image = photoImage(37, 13, true);
+    auto scalar = generateMipChain(image, true, TextureSimd::Scalar);
+    ASSERT_EQ(scalar.size(), 6u);
+    EXPECT_EQ(scalar[1].width, 18u);
+    EXPECT_EQ(scalar[1].height, 6u);
+    EXPECT_EQ(scalar[5].width, 1u);
+    EXPECT_EQ(scalar[5].height, 1u);
+    for (TextureSimd simd : {TextureSimd::SSE2, TextureSimd::AVX2}) {
+        auto chain = generateMipChain(image, true, simd);
+        ASSERT_EQ(chain.size(), scalar.size());
+        for (size_t level = 0; level < chain.size(); ++level) {
+            EXPECT_EQ(chain[level].pixels, scalar[level].pixels) << int(simd) << " level " << level;
+        }
+    }
+
+    EXPECT_THROW(generateMipChain(makeImage(0, 4), true), std::runtime_error);
+}
+
+TEST(TextureFormatTest, MipsWeightColorByAlpha) {
+    // Opaque red beside transparent green: the mip keeps the red instead of
+    // blending in a green that was never visible
+    TextureImage image = makeImage(2, 1);
+    image.pixels = {255, 0, 0, 255, 0, 255, 0, 0};
+    auto chain = generateMipChain(image, true);
+    ASSERT_EQ(chain.size(), 2u);
+    EXPECT_EQ(chain[1].pixels, (std::vector<uint8_t>{255, 0, 0, 128}));
+}
+
+TEST(TextureFormatTest, BlockCompressionStaysCloseToTheSource) {
+    TextureImage opaque = photoImage(64, 64, false);
+    auto bc1 = encodeBlocks(TextureFormat::PixelFormat::BC1, opaque);
+    EXPECT_EQ(bc1.size(), 64u * 64 / 2);
+    TextureImage decoded = decodeBlocks(TextureFormat::PixelFormat::BC1, bc1.data(), bc1.size(), 64, 64);
+    EXPECT_LE(maxChannelError(decoded, opaque, 0, 2), 12);
+    EXPECT_EQ(maxChannelError(decoded, opaque, 3, 3), 0);
+
+    // Edge blocks of odd sizes are padded, and only real pixels come back
+    TextureImage smooth = photoImage(64, 64, true);
+    TextureImage odd = makeImage(6, 5);
+    for (uint32_t y = 0; y < 5; ++y) {
+        std::copy_n(&smooth.pixels[size_t(y) * 64 * 4], 6 * 4, &odd.pixels[size_t(y) * 6 * 4]);
+    }
+    auto bc3 = encodeBlocks(TextureFormat::PixelFormat::BC3, odd);
+    EXPECT_EQ(bc3.size(), blockCompressedSize(TextureFormat::PixelFormat::BC3, 6, 5));
+    EXPECT_EQ(bc3.size(), 4u * 16);
+    decoded = decodeBlocks(TextureFormat::PixelFormat::BC3, bc3.data(), bc3.size(), 6, 5);
+    EXPECT_EQ(decoded.pixels.size(), odd.pixels.size());
+    EXPECT_LE(maxChannelError(decoded, odd, 0, 2), 12);
+    EXPECT_LE(maxChannelError(decoded, odd, 3, 3), 3);
+
+    // A flat block comes back exactly where 5:6:5 can hold it
+    TextureImage flat = makeImage(4, 4);
+    for (size_t i = 0; i < 16; ++i) {
+        flat.pixels[i * 4] = 255;
+        flat.pixels[i * 4 + 3] = 255;
+    }
+    auto block = encodeBlocks(TextureFormat::PixelFormat::BC1, flat);
+    EXPECT_EQ(decodeBlocks(TextureFormat::PixelFormat::BC1, block.data(), block.size(), 4, 4).pixels, flat.pixels);
+
+    EXPECT_THROW(decodeBlocks(TextureFormat::PixelFormat::BC1, bc1.data(), bc1.size() - 1, 64, 64),
+                 std::runtime_error);
+}
+
+TEST(TextureFormatTest, BuildsPayloadsTheViewReads) {
+    TextureBuildOptions options;
+    auto payload = buildTexture(photoImage(64, 32, false), options);
+    ASSERT_TRUE(TextureView::isTexture(payload.data(), payload.size()));
+    TextureView view(payload.data(), payload.size());
+    EXPECT_EQ(view.format(), TextureFormat::PixelFormat::BC1);
+    EXPECT_TRUE(view.srgb());
+    EXPECT_EQ(view.width(), 64u);
+    EXPECT_EQ(view.mipCount(), 7u);
+    EXPECT_EQ(view.mip(1).width, 32u);
+    EXPECT_EQ(view.mip(1).size, 32u * 16 / 2);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.mip(2).data) % 16, reinterpret_cast<uintptr_t>(payload.data()) % 16);
+
+    // Dropping the top mip leaves about a quarter of the memory
+    EXPECT_EQ(view.residentSize(0), view.residentSize(1) + view.mip(0).size);
+    EXPECT_LT(view.residentSize(1) * 3, view.residentSize(0));
+    EXPECT_EQ(view.residentSize(100), view.mip(6).size);
+
+    // What a quality step keeps resident is a smaller texture in its own right
+    auto reduced = dropTopMips(payload.data(), payload.size(), 2);
+    TextureView reducedView(reduced.data(), reduced.size());
+    EXPECT_EQ(reducedView.width(), 16u);
+    EXPECT_EQ(reducedView.height(), 8u);
+    EXPECT_EQ(reducedView.mipCount(), 5u);
+    EXPECT_EQ(std::vector<uint8_t>(reducedView.mip(0).data, reducedView.mip(0).data + reducedView.mip(0).size),
+              std::vector<uint8_t>(view.mip(2).data, view.mip(2).data + view.mip(2).size));
+    auto smallest = dropTopMips(payload.data(), payload.size(), 100);
+    EXPECT_EQ(TextureView(smallest.data(), smallest.size()).mipCount(), 1u);
+
+    auto translucent = buildTexture(photoImage(16, 16, true), options);
+    EXPECT_EQ(TextureView(translucent.data(), translucent.size()).format(), TextureFormat::PixelFormat::BC3);
+
+    // Uncompressed, unmipped and linear stores the image as it is
+    options.blockCompress = false;
+    options.generateMips = false;
+    options.srgb = false;
+    TextureImage source = photoImage(5, 3, true);
+    auto raw = buildTexture(source, options);
+    TextureView rawView(raw.data(), raw.size());
+    EXPECT_EQ(rawView.format(), TextureFormat::PixelFormat::RGBA8);
+    EXPECT_FALSE(rawView.srgb());
+    ASSERT_EQ(rawView.mipCount(), 1u);
+    EXPECT_EQ(std::vector<uint8_t>(rawView.mip(0).data, rawView.mip(0).data + rawView.mip(0).size), source.pixels);
+    EXPECT_THROW(rawView.mip(1), std::runtime_error);
+
+    EXPECT_THROW(TextureView(payload.data(), payload.size() - 1), std::runtime_error);
+    EXPECT_FALSE(TextureView::isTexture(raw.data() + 4, raw.size() - 4));
+}
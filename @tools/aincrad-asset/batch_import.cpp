@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <json/json.h>
+#include "World/SharedAssets/AssetCodec.h"
+#include "World/SharedAssets/AudioFormat.h"
+#include "World/SharedAssets/ContentHash.h"
+#include "World/SharedAssets/MeshFormat.h"
+#include "World/SharedAssets/TextureFormat.h"
+
+// Part of every cache entry; bump it whenever an importer's output changes
+// so cached outputs from older tools are rebuilt
+const std::string BatchToolVersion = "2-codec" + std::to_string(Aincrad::World::CompressedFormat::Version) +
+                                     "-texture" + std::to_string(Aincrad::World::TextureFormat::Version) +
+                                     "-mesh" + std::to_string(Aincrad::World::MeshFormat::Version) +
+                                     "-audio" + std::to_string(Aincrad::World::AudioFormat::Version);
+
+// Runs a fixed set of tasks across threads. Each worker owns a deque and
+// works through it from the front; a worker that runs dry steals from the
+// back of the others, so one huge input does not leave the rest idle.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t workerCount)
+        : m_queues(std::max<size_t>(1, workerCount))
+    {
+    }
+
+    // Tasks are dealt round-robin in the given order, so pass the largest
+    // first. Blocks until every task has run; tasks must not throw.
+    void run(std::vector<std::function<void()>> tasks) {
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            m_queues[i % m_queues.size()].tasks.push_back(std::move(tasks[i]));
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t worker = 0; worker < m_queues.size(); ++worker) {
+            workers.emplace_back([this, worker]() {
+                std::function<void()> task;
+                while (take(worker, task)) {
+                    task();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // No task adds more, so once every queue is empty the worker is done
+    bool take(size_t worker, std::function<void()>& task) {
+        for (size_t offset = 0; offset < m_queues.size(); ++offset) {
+            Queue& queue = m_queues[(worker + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            if (offset == 0) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            } else {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<Queue> m_queues;
+};
+
+struct BatchJob {
+    std::string type;
+    std::string input;
+    std::string output;
+    std::string platform;
+    uint32_t lodCount = 1; // Models only
+    uintmax_t inputSize = 0;
+};
+
+// Source extensions each importer accepts when a directory is given
+std::string inferAssetType(const std::filesystem::path& file) {
+    static const std::unordered_map<std::string, std::string> types = {
+        {".fbx", "model"}, {".obj", "model"}, {".gltf", "model"}, {".glb", "model"},
+        {".png", "texture"}, {".jpg", "texture"}, {".jpeg", "texture"}, {".tga", "texture"}, {".ppm", "texture"}, {".pgm", "texture"},
+        {".wav", "audio"}, {".ogg", "audio"}, {".flac", "audio"},
+    };
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return char(std::tolower(c));
+    });
+    auto it = types.find(extension);
+    return it != types.end() ? it->second : std::string();
+}
+
+// A directory imports every recognized file under it, mirroring the tree
+// under the output directory. A manifest is JSON of the form
+// {"imports": [{"type", "input", "output", "platform", "lods"}]}, where
+// relative outputs land under the output directory and platform and lods
+// are optional.
+std::vector<BatchJob> collectBatchJobs(const std::string& input, const std::string& outputDirectory,
+                                       const std::string& platform, uint32_t lodCount) {
+    std::vector<BatchJob> jobs;
+    std::filesystem::path outputRoot(outputDirectory);
+    if (std::filesystem::is_directory(input)) {
+        std::filesystem::path root(input);
+        for (const auto& item : std::filesystem::recursive_directory_iterator(root)) {
+            std::string type = item.is_regular_file() ? inferAssetType(item.path()) : std::string();
+            if (type.empty()) {
+                continue;
+            }
+            std::filesystem::path output = outputRoot / std::filesystem::relative(item.path(), root);
+            output.replace_extension(".aincrad");
+            jobs.push_back({type, item.path().string(), output.generic_string(), platform, lodCount});
+        }
+    } else {
+        std::ifstream manifest(input);
+        Json::Value root;
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        if (!manifest.is_open() || !Json::parseFromStream(builder, manifest, &root, &errors)) {
+            throw std::runtime_error("Failed to read batch manifest " + input + ": " + errors);
+        }
+        for (const auto& entry : root["imports"]) {
+            std::filesystem::path output(entry["output"].asString());
+            if (output.is_relative()) {
+                output = outputRoot / output;
+            }
+            jobs.push_back({entry["type"].asString(), entry["input"].asString(), output.generic_string(),
+                            entry.get("platform", platform).asString(), entry.get("lods", lodCount).asUInt()});
+        }
+    }
+
+    std::unordered_map<std::string, std::string> outputs;
+    for (auto& job : jobs) {
+        if (job.type != "model" && job.type != "texture" && job.type != "audio") {
+            throw std::runtime_error("Unsupported asset type for " + job.input + ": " + job.type);
+        }
+        if (job.platform.empty()) {
+            throw std::runtime_error("No platform for " + job.input);
+        }
+        if (job.lodCount == 0 || job.lodCount > Aincrad::World::MeshFormat::MaxLodCount) {
+            throw std::runtime_error("LOD count for " + job.input + " must be 1 to " +
+                                     std::to_string(Aincrad::World::MeshFormat::MaxLodCount));
+        }
+        auto [it, inserted] = outputs.emplace(job.output, job.input);
+        if (!inserted) {
+            throw std::runtime_error("Inputs " + it->second + " and " + job.input + " both write " + job.output);
+        }
+        std::error_code error;
+        job.inputSize = std::filesystem::file_size(job.input, error);
+        if (error) {
+            throw std::runtime_error("Input file does not exist: " + job.input);
+        }
+    }
+    return jobs;
+}
+
+// The cache maps each output to the hash of the input it was built from,
+// with the type, platform, LOD count and tool version that built it
+std::string batchCacheKey(const BatchJob& job, const std::string& inputHash) {
+    return inputHash + " " + job.type + " " + job.platform + " lods" + std::to_string(job.lodCount) + " " +
+           BatchToolVersion;
+}
+
+void runBatchImport(const std::string& input, const std::string& outputDirectory, const std::string& platform,
+                    uint32_t lodCount, size_t workerCount, bool force) {
+    std::vector<BatchJob> jobs = collectBatchJobs(input, outputDirectory, platform, lodCount);
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::cout << "Batch importing " << jobs.size() << " inputs on " << workerCount << " threads" << std::endl;
+
+    const std::filesystem::path cachePath = std::filesystem::path(outputDirectory) / ".aincrad-cache.json";
+    Json::Value cache(Json::objectValue);
+    {
+        std::ifstream file(cachePath);
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        if (file.is_open() && !Json::parseFromStream(builder, file, &cache, &errors)) {
+            std::cerr << "Warning: ignoring unreadable cache " << cachePath.string() << std::endl;
+            cache = Json::Value(Json::objectValue);
+        }
+    }
+
+    // Largest inputs first so they start early and the tail is small ones
+    std::sort(jobs.begin(), jobs.end(), [](const BatchJob& a, const BatchJob& b) {
+        return a.inputSize > b.inputSize;
+    });
+
+    std::vector<std::string> keys(jobs.size()); // Empty unless the output is built and current
+    std::atomic<size_t> skipped{0};
+    std::atomic<size_t> failed{0};
+    std::mutex logMutex;
+    std::vector<std::function<void()>> tasks;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        std::string cached = cache.get(jobs[i].output, "").asString();
+        tasks.push_back([&, i, cached]() {
+            const BatchJob& job = jobs[i];
+            std::ostringstream log;
+            try {
+                std::vector<uint8_t> source = readSourceFile(job.input);
+                std::string key = batchCacheKey(job, Aincrad::World::Sha256::hash(source.data(), source.size()).toHex());
+                if (!force && key == cached && std::filesystem::exists(job.output)) {
+                    keys[i] = key;
+                    skipped.fetch_add(1);
+                    return;
+                }
+
+                std::filesystem::path output(job.output);
+                if (output.has_parent_path()) {
+                    std::filesystem::create_directories(output.parent_path());
+                }
+                if (job.type == "model") {
+                    importModel(job.input, job.output, job.platform, log, job.lodCount);
+                } else if (job.type == "texture") {
+                    importTexture(job.input, job.output, job.platform, log);
+                } else {
+                    importAudio(job.input, job.output, job.platform, log);
+                }
+                keys[i] = key;
+            } catch (const std::exception& e) {
+                log << "Error: " << job.input << ": " << e.what() << std::endl;
+                failed.fetch_add(1);
+            }
+
+            // Each job's lines print together rather than interleaved
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cout << log.str() << std::flush;
+        });
+    }
+    WorkStealingPool(workerCount).run(std::move(tasks));
+
+    // Entries for outputs not in this batch are kept; failed ones are dropped
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (keys[i].empty()) {
+            cache.removeMember(jobs[i].output);
+        } else {
+            cache[jobs[i].output] = keys[i];
+        }
+    }
+    std::filesystem::create_directories(cachePath.parent_path());
+    std::filesystem::path temporary = cachePath;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << Json::writeString(Json::StreamWriterBuilder(), cache);
+        if (!file) {
+            throw std::runtime_error("Failed to write batch cache: " + temporary.string());
+        }
+    }
+    std::filesystem::rename(temporary, cachePath);
+
+    std::cout << "Imported " << jobs.size() - skipped - failed << ", skipped " << skipped << " unchanged, "
+              << failed << " failed" << std::endl;
+    if (failed > 0) {
+        throw std::runtime_error(std::to_string(failed.load()) + " of " + std::to_string(jobs.size()) +
+                                 " imports failed");
+    }
+}
@@ -0,0 +1,55 @@
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include "World/SharedAssets/Asset.h"
+#include "World/SharedAssets/AssetDatabase.h"
+#include "World/SharedAssets/AssetMetadataIndex.h"
+#include "World/SharedAssets/ContentHash.h"
+
+// Hashes the decoded payload so the runtime can share identical bytes across
+// assets. Payloads that cannot be read here keep an empty hash and simply
+// are not shared.
+bool fillContentHash(Aincrad::World::AssetMetadata& metadata) {
+    using namespace Aincrad::World;
+    if (!metadata.contentHash.empty() || metadata.sourcePath.empty()) {
+        return false;
+    }
+
+    AssetLoadingConfig config{};
+    config.strategy = AssetLoadingConfig::LoadingStrategy::Immediate;
+    auto asset = std::make_shared<Asset>(metadata);
+    try {
+        asset->load(config).get();
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: not hashing " << metadata.assetId << ": " << e.what() << std::endl;
+        return false;
+    }
+    auto payload = asset->getPayload();
+    metadata.contentHash = Sha256::hash(payload->data(), payload->size()).toHex();
+    return true;
+}
+
+void compileMetadata(const std::string& inputFile, const std::string& outputFile) {
+    std::cout << "Compiling metadata index from " << inputFile << " to " << outputFile << std::endl;
+
+    std::ifstream input(inputFile);
+    if (!input.is_open()) {
+        throw std::runtime_error("Failed to open metadata file: " + inputFile);
+    }
+
+    Aincrad::World::AssetMetadataIndexWriter writer;
+    size_t count = 0;
+    size_t hashed = 0;
+    for (auto& metadata : Aincrad::World::parseAssetMetadataJson(input)) {
+        if (fillContentHash(metadata)) {
+            ++hashed;
+        }
+        writer.add(metadata);
+        ++count;
+    }
+    writer.write(outputFile);
+
+    std::cout << "Wrote " << count << " entries, hashed " << hashed << " payloads" << std::endl;
+}
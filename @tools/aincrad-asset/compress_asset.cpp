@@ -0,0 +1,51 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include "World/SharedAssets/AssetCodec.h"
+#include "World/SharedAssets/AssetManager.h"
+#include "World/SharedAssets/AssetPlatform.h"
+
+// Writes the payload in the block-compressed format the runtime decodes in
+// parallel on load. Compression runs once at import, so it may be slow.
+void writeCompressedAsset(const std::vector<uint8_t>& payload, const std::string& outputFile,
+                          std::ostream& log = std::cout,
+                          uint32_t blockSize = Aincrad::World::CompressedFormat::DefaultBlockSize) {
+    std::vector<uint8_t> compressed = Aincrad::World::compressAsset(payload.data(), payload.size(), blockSize);
+
+    std::ofstream output(outputFile, std::ios::binary | std::ios::trunc);
+    if (!output.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()))) {
+        throw std::runtime_error("Failed to write asset: " + outputFile);
+    }
+
+    log << "Compressed " << payload.size() << " bytes to " << compressed.size() << std::endl;
+}
+
+std::vector<uint8_t> readSourceFile(const std::string& inputFile) {
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        throw std::runtime_error("Failed to open input file: " + inputFile);
+    }
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+// The importers follow the runtime's switches for the target platform. PC VR
+// headsets render on a desktop GPU, so VR follows Windows.
+Aincrad::World::AssetLoadingConfig::PlatformSpecificSettings platformSettingsFor(const std::string& platform) {
+    using Aincrad::World::AssetPlatform;
+    auto parsed = Aincrad::World::parseAssetPlatform(platform);
+    if (!parsed) {
+        throw std::runtime_error("Unknown platform: " + platform);
+    }
+    auto settings = Aincrad::World::AssetManager::defaultPlatformSettings();
+    switch (*parsed) {
+        case AssetPlatform::Mac:
+            return settings.mac;
+        case AssetPlatform::Linux:
+            return settings.linux;
+        default:
+            return settings.windows;
+    }
+}
@@ -1,14 +1,127 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <vector>
 #include "../../src/World/SharedAssets/Asset.h"
 #include "../../src/World/SharedAssets/AssetManager.h"
+#include "World/SharedAssets/AudioFormat.h"
 
-void importAudio(const std::string& inputFile, const std::string& outputFile, const std::string& platform) {
-    std::cout << "Importing audio from " << inputFile << " to " << outputFile << " for platform " << platform << std::endl;
-    // TODO: Implement audio import logic
-    // 1. Load external audio (WAV/OGG)
-    // 2. Convert to internal format
-    // 3. Optimize for target platform
-    // 4. Save to output file
-} 
\ No newline at end of file
+// PCM WAV with 8, 16, 24 or 32-bit integer or 32 or 64-bit float samples
+Aincrad::World::AudioBuffer decodeWav(const std::vector<uint8_t>& file) {
+    auto read16 = [&](size_t at) { return uint32_t(file[at] | file[at + 1] << 8); };
+    auto read32 = [&](size_t at) { return read16(at) | read16(at + 2) << 16; };
+    if (file.size() < 12 || std::memcmp(file.data(), "RIFF", 4) != 0 || std::memcmp(&file[8], "WAVE", 4) != 0) {
+        throw std::runtime_error("Not a WAV file");
+    }
+
+    uint32_t formatTag = 0;
+    uint32_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint32_t bits = 0;
+    size_t dataStart = 0;
+    size_t dataSize = 0;
+    for (size_t position = 12; position + 8 <= file.size();) {
+        const uint32_t chunkSize = read32(position + 4);
+        const size_t body = position + 8;
+        const size_t size = std::min<size_t>(chunkSize, file.size() - body);
+        if (std::memcmp(&file[position], "fmt ", 4) == 0 && size >= 16) {
+            formatTag = read16(body);
+            channels = read16(body + 2);
+            sampleRate = read32(body + 4);
+            bits = read16(body + 14);
+            // Extensible files carry the real format in the sub-format GUID
+            if (formatTag == 0xFFFE && size >= 26) {
+                formatTag = read16(body + 24);
+            }
+        } else if (std::memcmp(&file[position], "data", 4) == 0) {
+            dataStart = body;
+            dataSize = size;
+        }
+        position = body + size + (size & 1);
+    }
+
+    const bool isFloat = formatTag == 3 && (bits == 32 || bits == 64);
+    const bool isInteger = formatTag == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+    if (!isFloat && !isInteger) {
+        throw std::runtime_error("Unsupported WAV: only PCM and float samples are read");
+    }
+    if (channels == 0 || channels > Aincrad::World::AudioFormat::MaxChannelCount || sampleRate == 0) {
+        throw std::runtime_error("Unsupported WAV: " + std::to_string(channels) + " channels at " +
+                                 std::to_string(sampleRate) + " Hz");
+    }
+    if (dataStart == 0) {
+        throw std::runtime_error("WAV file has no data chunk");
+    }
+
+    const size_t bytesPerSample = bits / 8;
+    const size_t frames = dataSize / (bytesPerSample * channels);
+    Aincrad::World::AudioBuffer audio;
+    audio.sampleRate = sampleRate;
+    audio.channelCount = channels;
+    audio.samples.resize(frames * channels);
+    for (size_t i = 0; i < audio.samples.size(); ++i) {
+        const uint8_t* sample = &file[dataStart + i * bytesPerSample];
+        float value;
+        if (isFloat && bits == 32) {
+            std::memcpy(&value, sample, sizeof(value));
+        } else if (isFloat) {
+            double wide;
+            std::memcpy(&wide, sample, sizeof(wide));
+            value = float(wide);
+        } else if (bits == 8) {
+            value = (float(sample[0]) - 128.0f) / 128.0f; // 8-bit WAV is unsigned
+        } else {
+            // Left-align the little-endian integer, then scale from full range
+            uint32_t raw = 0;
+            for (size_t b = 0; b < bytesPerSample; ++b) {
+                raw |= uint32_t(sample[b]) << (32 - bits + 8 * b);
+            }
+            value = float(int32_t(raw) / 2147483648.0);
+        }
+        audio.samples[i] = value;
+    }
+    return audio;
+}
+
+// Ambient beds and music meant to repeat are named *_loop; they stream
+// round without a gap and are resampled as a continuous signal
+bool isLoopingAudio(const std::string& inputFile) {
+    std::string stem = std::filesystem::path(inputFile).stem().string();
+    std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) {
+        return char(std::tolower(c));
+    });
+    const std::string suffix = "_loop";
+    return stem.size() > suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void importAudio(const std::string& inputFile, const std::string& outputFile, const std::string& platform,
+                 std::ostream& log = std::cout) {
+    using namespace Aincrad::World;
+    log << "Importing audio from " << inputFile << " to " << outputFile << " for platform " << platform << std::endl;
+
+    std::string extension = std::filesystem::path(inputFile).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return char(std::tolower(c));
+    });
+    if (extension != ".wav") {
+        throw std::runtime_error("No decoder for " + extension + " audio; export " + inputFile + " as WAV");
+    }
+    AudioBuffer audio = decodeWav(readSourceFile(inputFile));
+
+    AudioBuildOptions options;
+    options.sampleRate = platformSettingsFor(platform).audioSampleRate;
+    options.looping = isLoopingAudio(inputFile);
+    std::vector<uint8_t> payload = buildAudio(audio, options);
+
+    // One codec block per chunk, so players can fetch and decode a chunk
+    // at a time
+    AudioView view(payload.data(), payload.size());
+    log << "Built " << view.channelCount() << " channel audio, " << audio.sampleRate << " Hz to "
+        << view.sampleRate() << " Hz, " << view.frameCount() << " frames in " << view.header().chunkCount
+        << " chunks" << (view.looping() ? ", looping" : "") << std::endl;
+    writeCompressedAsset(payload, outputFile, log, view.header().chunkSize);
+}
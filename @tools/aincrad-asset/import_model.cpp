@@ -1,14 +1,180 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
 #include <stdexcept>
+#include <vector>
 #include "../../src/World/SharedAssets/Asset.h"
 #include "../../src/World/SharedAssets/AssetManager.h"
+#include "World/SharedAssets/MeshFormat.h"
 
-void importModel(const std::string& inputFile, const std::string& outputFile, const std::string& platform) {
-    std::cout << "Importing model from " << inputFile << " to " << outputFile << " for platform " << platform << std::endl;
-    // TODO: Implement model import logic
-    // 1. Load external model (FBX/OBJ/GLTF)
-    // 2. Convert to internal format
-    // 3. Optimize for target platform
-    // 4. Save to output file
-} 
\ No newline at end of file
+// Wavefront OBJ: positions, UVs and normals, with polygons fanned into
+// triangles. Corners sharing a position/UV/normal triple share a vertex.
+// Corners without a normal get the area-weighted normal of the faces
+// around their position.
+Aincrad::World::MeshData decodeObj(const std::vector<uint8_t>& file) {
+    using Aincrad::World::MeshVertex;
+    std::vector<std::array<float, 3>> positions, normals;
+    std::vector<std::array<float, 2>> uvs;
+    std::map<std::array<long, 3>, uint32_t> corners;
+    std::vector<long> positionOf; // Per vertex, for filling in missing normals
+    std::vector<bool> hasNormal;
+    std::vector<std::array<float, 3>> faceNormals;
+    Aincrad::World::MeshData mesh;
+
+    // 1-based, or negative counting back from the end
+    auto resolve = [](const std::string& token, size_t count, size_t line) -> long {
+        if (token.empty()) {
+            return -1;
+        }
+        long index = std::stol(token);
+        index = index < 0 ? long(count) + index : index - 1;
+        if (index < 0 || size_t(index) >= count) {
+            throw std::runtime_error("OBJ line " + std::to_string(line) + ": index " + token + " out of range");
+        }
+        return index;
+    };
+
+    std::istringstream input(std::string(file.begin(), file.end()));
+    std::string text;
+    for (size_t line = 1; std::getline(input, text); ++line) {
+        std::istringstream fields(text);
+        std::string keyword;
+        fields >> keyword;
+        if (keyword == "v" || keyword == "vn") {
+            std::array<float, 3> value{};
+            if (!(fields >> value[0] >> value[1] >> value[2])) {
+                throw std::runtime_error("OBJ line " + std::to_string(line) + ": expected three numbers");
+            }
+            (keyword == "v" ? positions : normals).push_back(value);
+        } else if (keyword == "vt") {
+            std::array<float, 2> value{};
+            if (!(fields >> value[0] >> value[1])) {
+                throw std::runtime_error("OBJ line " + std::to_string(line) + ": expected two numbers");
+            }
+            uvs.push_back(value);
+        } else if (keyword == "f") {
+            std::vector<uint32_t> polygon;
+            std::string corner;
+            while (fields >> corner) {
+                std::array<std::string, 3> parts;
+                size_t part = 0;
+                for (char c : corner) {
+                    if (c == '/' && part < 2) {
+                        ++part;
+                    } else {
+                        parts[part] += c;
+                    }
+                }
+                std::array<long, 3> key{resolve(parts[0], positions.size(), line), resolve(parts[1], uvs.size(), line),
+                                        resolve(parts[2], normals.size(), line)};
+                if (key[0] < 0) {
+                    throw std::runtime_error("OBJ line " + std::to_string(line) + ": face corner without a position");
+                }
+                auto [it, inserted] = corners.emplace(key, uint32_t(mesh.vertices.size()));
+                if (inserted) {
+                    MeshVertex vertex{};
+                    std::copy_n(positions[size_t(key[0])].begin(), 3, vertex.position);
+                    if (key[1] >= 0) {
+                        std::copy_n(uvs[size_t(key[1])].begin(), 2, vertex.uv);
+                    }
+                    if (key[2] >= 0) {
+                        std::copy_n(normals[size_t(key[2])].begin(), 3, vertex.normal);
+                    }
+                    mesh.vertices.push_back(vertex);
+                    positionOf.push_back(key[0]);
+                    hasNormal.push_back(key[2] >= 0);
+                }
+                polygon.push_back(it->second);
+            }
+            if (polygon.size() < 3) {
+                throw std::runtime_error("OBJ line " + std::to_string(line) + ": face with fewer than three corners");
+            }
+            for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i], polygon[i + 1]});
+            }
+        }
+    }
+    if (mesh.indices.empty()) {
+        throw std::runtime_error("OBJ file has no faces");
+    }
+
+    if (std::find(hasNormal.begin(), hasNormal.end(), false) != hasNormal.end()) {
+        faceNormals.assign(positions.size(), {0, 0, 0});
+        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+            const float* a = mesh.vertices[mesh.indices[i]].position;
+            const float* b = mesh.vertices[mesh.indices[i + 1]].position;
+            const float* c = mesh.vertices[mesh.indices[i + 2]].position;
+            float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            float cross[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+            for (size_t corner = 0; corner < 3; ++corner) {
+                auto& sum = faceNormals[size_t(positionOf[mesh.indices[i + corner]])];
+                for (int axis = 0; axis < 3; ++axis) {
+                    sum[axis] += cross[axis];
+                }
+            }
+        }
+        for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+            if (!hasNormal[v]) {
+                const auto& sum = faceNormals[size_t(positionOf[v])];
+                float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                for (int axis = 0; axis < 3; ++axis) {
+                    mesh.vertices[v].normal[axis] = length > 0.0f ? sum[axis] / length : (axis == 2 ? 1.0f : 0.0f);
+                }
+            }
+        }
+    }
+    return mesh;
+}
+
+void importModel(const std::string& inputFile, const std::string& outputFile, const std::string& platform,
+                 std::ostream& log = std::cout, uint32_t lodCount = 1) {
+    using namespace Aincrad::World;
+    log << "Importing model from " << inputFile << " to " << outputFile << " for platform " << platform << std::endl;
+    if (lodCount == 0 || lodCount > MeshFormat::MaxLodCount) {
+        throw std::runtime_error("LOD count must be 1 to " + std::to_string(MeshFormat::MaxLodCount));
+    }
+
+    std::string extension = std::filesystem::path(inputFile).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return char(std::tolower(c));
+    });
+    if (extension != ".obj") {
+        throw std::runtime_error("No reader for " + extension + " models; export " + inputFile + " as OBJ");
+    }
+    MeshData mesh = decodeObj(readSourceFile(inputFile));
+
+    MeshBuildOptions options;
+    options.optimize = platformSettingsFor(platform).meshOptimization;
+    options.quantize = options.optimize;
+    options.maxLodCount = lodCount;
+    std::vector<uint8_t> payload = buildMesh(mesh, options);
+
+    MeshView view(payload.data(), payload.size());
+    MeshLodView full = view.lod(0);
+    std::vector<uint32_t> indices(full.indexCount());
+    for (uint32_t i = 0; i < full.indexCount(); ++i) {
+        indices[i] = full.index(i);
+    }
+    log << "Built " << full.vertexCount() << " vertices and " << full.indexCount() / 3 << " triangles ("
+        << mesh.vertices.size() << " vertices before welding), ACMR "
+        << averageCacheMissRatio(mesh.indices, mesh.vertices.size()) << " -> "
+        << averageCacheMissRatio(indices, full.vertexCount()) << ", " << view.vertexStride() << "-byte vertices"
+        << std::endl;
+    for (uint32_t level = 1; level < view.lodCount(); ++level) {
+        MeshLodView lod = view.lod(level);
+        log << "LOD " << level << ": " << lod.vertexCount() << " vertices and " << lod.indexCount() / 3
+            << " triangles, error " << lod.error() << std::endl;
+    }
+    if (view.lodCount() < lodCount) {
+        log << "Stopped at " << view.lodCount() << " LODs; further ones would not shrink within the error bound"
+            << std::endl;
+    }
+    writeCompressedAsset(payload, outputFile, log);
+}
@@ -1,14 +1,188 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <vector>
 #include "../../src/World/SharedAssets/Asset.h"
 #include "../../src/World/SharedAssets/AssetManager.h"
+#include "World/SharedAssets/TextureFormat.h"
 
-void importTexture(const std::string& inputFile, const std::string& outputFile, const std::string& platform) {
-    std::cout << "Importing texture from " << inputFile << " to " << outputFile << " for platform " << platform << std::endl;
-    // TODO: Implement texture import logic
-    // 1. Load external texture (PNG/JPG)
-    // 2. Convert to internal format
-    // 3. Optimize for target platform
-    // 4. Save to output file
-} 
\ No newline at end of file
+// Uncompressed or RLE true-color and grayscale TGA, 8, 24 or 32 bits
+Aincrad::World::TextureImage decodeTga(const std::vector<uint8_t>& file) {
+    if (file.size() < 18) {
+        throw std::runtime_error("TGA file truncated");
+    }
+    const uint8_t idLength = file[0];
+    const uint8_t imageType = file[2];
+    const uint32_t width = uint32_t(file[12] | file[13] << 8);
+    const uint32_t height = uint32_t(file[14] | file[15] << 8);
+    const uint32_t bytesPerPixel = file[16] / 8u;
+    const uint8_t descriptor = file[17];
+    const bool grayscale = imageType == 3 || imageType == 11;
+    const bool rle = imageType == 10 || imageType == 11;
+    if (file[1] != 0 || (imageType != 2 && imageType != 3 && imageType != 10 && imageType != 11) ||
+        (grayscale ? bytesPerPixel != 1 : bytesPerPixel != 3 && bytesPerPixel != 4) || width == 0 || height == 0) {
+        throw std::runtime_error("Unsupported TGA: only true-color and grayscale images are read");
+    }
+
+    // Unpack the pixel stream to RGBA in file order first
+    std::vector<uint8_t> pixels(size_t(width) * height * 4);
+    size_t position = 18 + idLength;
+    auto readPixel = [&](uint8_t* output) {
+        if (position + bytesPerPixel > file.size()) {
+            throw std::runtime_error("TGA file truncated");
+        }
+        const uint8_t* input = &file[position];
+        position += bytesPerPixel;
+        if (grayscale) {
+            output[0] = output[1] = output[2] = input[0];
+            output[3] = 255;
+        } else {
+            output[0] = input[2];
+            output[1] = input[1];
+            output[2] = input[0];
+            output[3] = bytesPerPixel == 4 ? input[3] : 255;
+        }
+    };
+    for (size_t pixel = 0; pixel < size_t(width) * height;) {
+        size_t count = 1;
+        bool repeat = false;
+        if (rle) {
+            if (position >= file.size()) {
+                throw std::runtime_error("TGA file truncated");
+            }
+            uint8_t packet = file[position++];
+            count = (packet & 0x7F) + 1u;
+            repeat = (packet & 0x80) != 0;
+            count = std::min(count, size_t(width) * height - pixel);
+        }
+        readPixel(&pixels[pixel * 4]);
+        for (size_t i = 1; i < count; ++i) {
+            if (repeat) {
+                std::copy_n(&pixels[pixel * 4], 4, &pixels[(pixel + i) * 4]);
+            } else {
+                readPixel(&pixels[(pixel + i) * 4]);
+            }
+        }
+        pixel += count;
+    }
+
+    // Rows are stored bottom up and left to right unless the descriptor flips them
+    Aincrad::World::TextureImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(pixels.size());
+    const bool topDown = (descriptor & 0x20) != 0;
+    const bool rightToLeft = (descriptor & 0x10) != 0;
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t sourceX = rightToLeft ? width - 1 - x : x;
+            uint32_t sourceY = topDown ? y : height - 1 - y;
+            std::copy_n(&pixels[(size_t(sourceY) * width + sourceX) * 4], 4,
+                        &image.pixels[(size_t(y) * width + x) * 4]);
+        }
+    }
+    return image;
+}
+
+// Binary PPM (P6) and PGM (P5) with up to 8 bits per channel
+Aincrad::World::TextureImage decodePnm(const std::vector<uint8_t>& file) {
+    size_t position = 2;
+    auto readNumber = [&]() {
+        while (position < file.size()) {
+            if (file[position] == '#') {
+                while (position < file.size() && file[position] != '\n') {
+                    ++position;
+                }
+            } else if (std::isspace(file[position])) {
+                ++position;
+            } else {
+                break;
+            }
+        }
+        uint32_t value = 0;
+        size_t start = position;
+        while (position < file.size() && std::isdigit(file[position]) && position - start < 9) {
+            value = value * 10 + uint32_t(file[position++] - '0');
+        }
+        if (position == start) {
+            throw std::runtime_error("Malformed PPM header");
+        }
+        return value;
+    };
+    if (file.size() < 2 || file[0] != 'P' || (file[1] != '6' && file[1] != '5')) {
+        throw std::runtime_error("Unsupported PPM: only binary P6 and P5 images are read");
+    }
+    const uint32_t channels = file[1] == '6' ? 3 : 1;
+    const uint32_t width = readNumber();
+    const uint32_t height = readNumber();
+    const uint32_t maxValue = readNumber();
+    ++position; // The single whitespace byte before the pixels
+    if (width == 0 || height == 0 || maxValue == 0 || maxValue > 255) {
+        throw std::runtime_error("Unsupported PPM: only 8-bit images are read");
+    }
+    if (position > file.size() || file.size() - position < size_t(width) * height * channels) {
+        throw std::runtime_error("PPM file truncated");
+    }
+
+    Aincrad::World::TextureImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(size_t(width) * height * 4);
+    for (size_t i = 0; i < size_t(width) * height; ++i) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            uint32_t value = file[position + i * channels + (channels == 3 ? c : 0)];
+            image.pixels[i * 4 + c] = uint8_t((value * 255 + maxValue / 2) / maxValue);
+        }
+        image.pixels[i * 4 + 3] = 255;
+    }
+    return image;
+}
+
+// Normal maps and other data textures are named *_n, *_normal or *_linear
+// and are filtered as plain numbers rather than as sRGB color
+bool isLinearTexture(const std::string& inputFile) {
+    std::string stem = std::filesystem::path(inputFile).stem().string();
+    std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) {
+        return char(std::tolower(c));
+    });
+    for (const std::string suffix : {"_n", "_normal", "_linear"}) {
+        if (stem.size() > suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void importTexture(const std::string& inputFile, const std::string& outputFile, const std::string& platform,
+                   std::ostream& log = std::cout) {
+    using namespace Aincrad::World;
+    log << "Importing texture from " << inputFile << " to " << outputFile << " for platform " << platform << std::endl;
+
+    std::string extension = std::filesystem::path(inputFile).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return char(std::tolower(c));
+    });
+    std::vector<uint8_t> source = readSourceFile(inputFile);
+    TextureImage image;
+    if (extension == ".tga") {
+        image = decodeTga(source);
+    } else if (extension == ".ppm" || extension == ".pgm") {
+        image = decodePnm(source);
+    } else {
+        throw std::runtime_error("No decoder for " + extension + " textures; export " + inputFile + " as TGA");
+    }
+
+    TextureBuildOptions options;
+    options.srgb = !isLinearTexture(inputFile);
+    options.blockCompress = platformSettingsFor(platform).textureCompression;
+    std::vector<uint8_t> payload = buildTexture(image, options);
+
+    TextureView view(payload.data(), payload.size());
+    static const char* formats[] = {"RGBA8", "BC1", "BC3"};
+    log << "Built " << view.width() << "x" << view.height() << " " << formats[uint32_t(view.format())]
+        << (view.srgb() ? " sRGB" : " linear") << " with " << view.mipCount() << " mips" << std::endl;
+    writeCompressedAsset(payload, outputFile, log);
+}
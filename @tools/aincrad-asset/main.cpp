@@ -3,22 +3,29 @@
 #include <stdexcept>
 #include <filesystem>
 #include <cxxopts.hpp>
+#include "compress_asset.cpp"
 #include "import_model.cpp"
 #include "import_texture.cpp"
 #include "import_audio.cpp"
 #include "export_model.cpp"
 #include "export_texture.cpp"
 #include "export_audio.cpp"
+#include "compile_metadata.cpp"
+#include "pack_archive.cpp"
+#include "batch_import.cpp"
 
 int main(int argc, char* argv[]) {
     cxxopts::Options options("aincrad-asset", "Aincrad Asset Management CLI Tool");
     options.add_options()
         ("h,help", "Show help")
-        ("c,command", "Command to execute (import/export)", cxxopts::value<std::string>())
+        ("c,command", "Command to execute (import/export/compile-metadata/pack/batch)", cxxopts::value<std::string>())
         ("t,type", "Asset type (model/texture/audio)", cxxopts::value<std::string>())
-        ("i,input", "Input file path", cxxopts::value<std::string>())
-        ("o,output", "Output file path", cxxopts::value<std::string>())
-        ("p,platform", "Target platform (windows/mac/linux/vr)", cxxopts::value<std::string>());
+        ("i,input", "Input file path (directory for pack, directory or manifest for batch)", cxxopts::value<std::string>())
+        ("o,output", "Output file path (directory for batch)", cxxopts::value<std::string>())
+        ("p,platform", "Target platform (windows/mac/linux/vr)", cxxopts::value<std::string>())
+        ("j,jobs", "Batch worker threads (default: one per core)", cxxopts::value<size_t>())
+        ("f,force", "Batch: rebuild outputs even when the cache says they are current")
+        ("l,lods", "Model LODs to generate, including full detail (default: 1)", cxxopts::value<uint32_t>());
 
     try {
         auto result = options.parse(argc, argv);
@@ -28,19 +35,25 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
-        if (!result.count("command") || !result.count("type") || 
-            !result.count("input") || !result.count("output") || 
-            !result.count("platform")) {
+        // compile-metadata and pack work on whole files or directories, so they need no type or
+        // platform; batch infers each type and may take platforms from its manifest
+        bool isContainerCommand = result.count("command") &&
+            (result["command"].as<std::string>() == "compile-metadata" ||
+             result["command"].as<std::string>() == "pack" ||
+             result["command"].as<std::string>() == "batch");
+        if (!result.count("command") || !result.count("input") || !result.count("output") ||
+            (!isContainerCommand && (!result.count("type") || !result.count("platform")))) {
             std::cerr << "Error: Missing required arguments" << std::endl;
             std::cout << options.help() << std::endl;
             return 1;
         }
 
         std::string command = result["command"].as<std::string>();
-        std::string type = result["type"].as<std::string>();
+        std::string type = result.count("type") ? result["type"].as<std::string>() : "";
         std::string inputFile = result["input"].as<std::string>();
         std::string outputFile = result["output"].as<std::string>();
-        std::string platform = result["platform"].as<std::string>();
+        std::string platform = result.count("platform") ? result["platform"].as<std::string>() : "";
+        uint32_t lodCount = result.count("lods") ? result["lods"].as<uint32_t>() : 1;
 
         // Validate input file exists
         if (!std::filesystem::exists(inputFile)) {
@@ -50,12 +63,21 @@ int main(int argc, char* argv[]) {
 
         // Create output directory if it doesn't exist
         std::filesystem::path outputPath(outputFile);
-        std::filesystem::create_directories(outputPath.parent_path());
+        if (outputPath.has_parent_path()) {
+            std::filesystem::create_directories(outputPath.parent_path());
+        }
 
         // Execute command
-        if (command == "import") {
+        if (command == "compile-metadata") {
+            compileMetadata(inputFile, outputFile);
+        } else if (command == "pack") {
+            packArchive(inputFile, outputFile);
+        } else if (command == "batch") {
+            runBatchImport(inputFile, outputFile, platform, lodCount,
+                           result.count("jobs") ? result["jobs"].as<size_t>() : 0, result.count("force") > 0);
+        } else if (command == "import") {
             if (type == "model") {
-                importModel(inputFile, outputFile, platform);
+                importModel(inputFile, outputFile, platform, std::cout, lodCount);
             } else if (type == "texture") {
                 importTexture(inputFile, outputFile, platform);
             } else if (type == "audio") {
@@ -0,0 +1,34 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include "World/SharedAssets/AssetArchive.h"
+
+void packArchive(const std::string& inputDirectory, const std::string& outputFile) {
+    std::cout << "Packing " << inputDirectory << " into " << outputFile << std::endl;
+
+    std::filesystem::path root(inputDirectory);
+    if (!std::filesystem::is_directory(root)) {
+        throw std::runtime_error("Pack input must be a directory: " + inputDirectory);
+    }
+
+    // Entry names are paths relative to the input directory with '/'
+    // separators, which is what metadata "entry" values refer to
+    std::vector<std::filesystem::path> files;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(root)) {
+        if (item.is_regular_file()) {
+            files.push_back(item.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    Aincrad::World::AssetArchiveWriter writer;
+    for (const auto& file : files) {
+        writer.addFile(std::filesystem::relative(file, root).generic_string(), file.string());
+    }
+    writer.write(outputFile);
+
+    std::cout << "Packed " << files.size() << " entries" << std::endl;
+}